@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisParticleSplatterBenchmark.h"
+
+#include <cmath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+#include "KisParticleSplatter.h"
+
+namespace {
+
+/**
+ * The number of dabs and the number of the wu-particles per dab are
+ * similar to a thick 300px spray or hairy brush
+ */
+const int numDabs = 20;
+const int numParticles = 5000;
+const int dabRadius = 150;
+
+QVector<QPointF> generateParticles()
+{
+    qsrand(1);
+
+    QVector<QPointF> particles;
+    for (int i = 0; i < numParticles; i++) {
+        const qreal angle = 2 * M_PI * qrand() / RAND_MAX;
+        const qreal length = dabRadius * qreal(qrand()) / RAND_MAX;
+
+        particles << QPointF(dabRadius + length * std::cos(angle),
+                             dabRadius + length * std::sin(angle));
+    }
+
+    return particles;
+}
+
+void splitParticle(const QPointF &pos, int *x, int *y, quint8 *opacities)
+{
+    *x = int(pos.x());
+    *y = int(pos.y());
+    const qreal fx = pos.x() - *x;
+    const qreal fy = pos.y() - *y;
+
+    opacities[0] = qRound((1.0 - fx) * (1.0 - fy) * 255);
+    opacities[1] = qRound((fx)  * (1.0 - fy) * 255);
+    opacities[2] = qRound((1.0 - fx) * (fy)  * 255);
+    opacities[3] = qRound((fx)  * (fy)  * 255);
+}
+
+void addModeRows()
+{
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("overwrite") << int(KisParticleSplatter::OverwriteMode);
+    QTest::newRow("add-opacity") << int(KisParticleSplatter::AddOpacityMode);
+    QTest::newRow("composite") << int(KisParticleSplatter::CompositeMode);
+}
+
+}
+
+void KisParticleSplatterBenchmark::benchmarkPerPixel_data()
+{
+    addModeRows();
+}
+
+void KisParticleSplatterBenchmark::benchmarkPerPixel()
+{
+    QFETCH(int, mode);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoCompositeOp *op = cs->compositeOp(COMPOSITE_OVER);
+    const int pixelSize = cs->pixelSize();
+    const QVector<QPointF> particles = generateParticles();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    KoColor color(Qt::red, cs);
+
+    QBENCHMARK {
+        for (int dab = 0; dab < numDabs; dab++) {
+            dev->clear();
+            KisRandomAccessorSP it = dev->createRandomAccessorNG(0, 0);
+
+            Q_FOREACH (const QPointF &pos, particles) {
+                int x, y;
+                quint8 opacities[4];
+                splitParticle(pos, &x, &y, opacities);
+
+                for (int i = 0; i < 4; i++) {
+                    it->moveTo(x + (i & 1), y + (i >> 1));
+
+                    if (mode == KisParticleSplatter::OverwriteMode) {
+                        memcpy(it->rawData(), color.data(), pixelSize);
+                        cs->setOpacity(it->rawData(), opacities[i], 1);
+                    } else if (mode == KisParticleSplatter::AddOpacityMode) {
+                        const quint8 opacity =
+                            qMin<quint16>(OPACITY_OPAQUE_U8, opacities[i] + cs->opacityU8(it->rawData()));
+                        memcpy(it->rawData(), color.data(), pixelSize);
+                        cs->setOpacity(it->rawData(), opacity, 1);
+                    } else {
+                        color.setOpacity(opacities[i]);
+                        op->composite(it->rawData(), pixelSize, color.data(), pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void KisParticleSplatterBenchmark::benchmarkSplatter_data()
+{
+    addModeRows();
+}
+
+void KisParticleSplatterBenchmark::benchmarkSplatter()
+{
+    QFETCH(int, mode);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QVector<QPointF> particles = generateParticles();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    KoColor color(Qt::red, cs);
+
+    KisParticleSplatter splatter((KisParticleSplatter::Mode(mode)));
+
+    QBENCHMARK {
+        for (int dab = 0; dab < numDabs; dab++) {
+            dev->clear();
+            splatter.setDevice(dev);
+            splatter.setColor(color);
+
+            Q_FOREACH (const QPointF &pos, particles) {
+                int x, y;
+                quint8 opacities[4];
+                splitParticle(pos, &x, &y, opacities);
+
+                for (int i = 0; i < 4; i++) {
+                    splatter.addPixel(x + (i & 1), y + (i >> 1), opacities[i]);
+                }
+            }
+
+            splatter.flush();
+        }
+    }
+}
+
+QTEST_MAIN(KisParticleSplatterBenchmark)
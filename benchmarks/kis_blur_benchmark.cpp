@@ -37,6 +37,10 @@
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
 
+#include <kis_convolution_painter.h>
+#include <kis_gaussian_kernel.h>
+#include <kis_recursive_gaussian.h>
+
 void KisBlurBenchmark::initTestCase()
 {
     m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();    
@@ -87,6 +91,48 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+void KisBlurBenchmark::benchmarkGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<bool>("useRecursive");
+
+    QTest::newRow("spatial-16") << 16.0 << false;
+    QTest::newRow("recursive-16") << 16.0 << true;
+    QTest::newRow("spatial-50") << 50.0 << false;
+    QTest::newRow("recursive-50") << 50.0 << true;
+    QTest::newRow("spatial-200") << 200.0 << false;
+    QTest::newRow("recursive-200") << 200.0 << true;
+}
+
+void KisBlurBenchmark::benchmarkGaussian()
+{
+    QFETCH(qreal, radius);
+    QFETCH(bool, useRecursive);
 
+    const QRect rect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    const QBitArray channelFlags = m_colorSpace->channelFlags(true, true);
+
+    QBENCHMARK_ONCE {
+        KisPaintDeviceSP device = new KisPaintDevice(*m_device);
+
+        if (useRecursive) {
+            KisRecursiveGaussian::applyPass(device, device, rect, radius,
+                                            Qt::Horizontal, channelFlags, 0);
+            KisRecursiveGaussian::applyPass(device, device, rect, radius,
+                                            Qt::Vertical, channelFlags, 0);
+        } else {
+            KisConvolutionPainter horizPainter(device, KisConvolutionPainter::SPATIAL);
+            horizPainter.setChannelFlags(channelFlags);
+            horizPainter.applyMatrix(KisGaussianKernel::createHorizontalKernel(radius), m_device,
+                                     rect.topLeft(), rect.topLeft(), rect.size(), BORDER_REPEAT);
+
+            KisPaintDeviceSP interm = new KisPaintDevice(*device);
+            KisConvolutionPainter verticalPainter(device, KisConvolutionPainter::SPATIAL);
+            verticalPainter.setChannelFlags(channelFlags);
+            verticalPainter.applyMatrix(KisGaussianKernel::createVerticalKernel(radius), interm,
+                                        rect.topLeft(), rect.topLeft(), rect.size(), BORDER_REPEAT);
+        }
+    }
+}
 
 QTEST_MAIN(KisBlurBenchmark)
@@ -39,7 +39,10 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFilter();
-    
+
+    void benchmarkGaussian_data();
+    void benchmarkGaussian();
+
 };
 
 #endif
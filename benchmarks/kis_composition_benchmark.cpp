@@ -47,8 +47,11 @@
 #include <KoColorSpaceTraits.h>
 #include <KoCompositeOpAlphaDarken.h>
 #include <KoCompositeOpOver.h>
+#include <KoCompositeOpGeneric.h>
 #include "KoOptimizedCompositeOpFactory.h"
 
+#include <typeinfo>
+
 // for posix_memalign()
 #include <stdlib.h>
 
@@ -322,7 +325,7 @@ bool compareTwoOpsPixels(QVector<Tile> &tiles, channel_type prec) {
     return true;
 }
 
-bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp *op2)
+bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp *op2, float floatPrecision = 2e-7)
 {
     Q_ASSERT(op1->colorSpace()->pixelSize() == op2->colorSpace()->pixelSize());
     const quint32 pixelSize = op1->colorSpace()->pixelSize();
@@ -355,7 +358,7 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
         compareResult = compareTwoOpsPixels<quint8>(tiles, 10);
     }
     else if (pixelSize == 16) {
-        compareResult = compareTwoOpsPixels<float>(tiles, 2e-7);
+        compareResult = compareTwoOpsPixels<float>(tiles, floatPrecision);
     }
     else {
         qFatal("Pixel size %i is not implemented", pixelSize);
@@ -710,6 +713,103 @@ void KisCompositionBenchmark::compareRgbF32OverOps()
     delete opAct;
 }
 
+/**
+ * Creates legacy versions of all the separable composite ops, so
+ * that they could be compared against the vectorized ones
+ */
+template<class Traits>
+QList<KoCompositeOp*> createLegacyGenericSCOps(const KoColorSpace *cs)
+{
+    typedef typename Traits::channels_type T;
+    QList<KoCompositeOp*> ops;
+
+#define ADD_LEGACY_OP(id, func) \
+    ops << new KoCompositeOpGenericSC<Traits, &func<T> >(cs, id, id, KoCompositeOp::categoryMix())
+
+    ADD_LEGACY_OP(COMPOSITE_MULT, cfMultiply);
+    ADD_LEGACY_OP(COMPOSITE_SCREEN, cfScreen);
+    ADD_LEGACY_OP(COMPOSITE_OVERLAY, cfOverlay);
+    ADD_LEGACY_OP(COMPOSITE_HARD_LIGHT, cfHardLight);
+    ADD_LEGACY_OP(COMPOSITE_SOFT_LIGHT_PHOTOSHOP, cfSoftLight);
+    ADD_LEGACY_OP(COMPOSITE_SOFT_LIGHT_SVG, cfSoftLightSvg);
+    ADD_LEGACY_OP(COMPOSITE_DODGE, cfColorDodge);
+    ADD_LEGACY_OP(COMPOSITE_BURN, cfColorBurn);
+    ADD_LEGACY_OP(COMPOSITE_ADD, cfAddition);
+    ADD_LEGACY_OP(COMPOSITE_LINEAR_DODGE, cfAddition);
+    ADD_LEGACY_OP(COMPOSITE_LINEAR_BURN, cfLinearBurn);
+    ADD_LEGACY_OP(COMPOSITE_SUBTRACT, cfSubtract);
+    ADD_LEGACY_OP(COMPOSITE_INVERSE_SUBTRACT, cfInverseSubtract);
+    ADD_LEGACY_OP(COMPOSITE_DARKEN, cfDarkenOnly);
+    ADD_LEGACY_OP(COMPOSITE_LIGHTEN, cfLightenOnly);
+    ADD_LEGACY_OP(COMPOSITE_DIFF, cfDifference);
+    ADD_LEGACY_OP(COMPOSITE_EXCLUSION, cfExclusion);
+    ADD_LEGACY_OP(COMPOSITE_DIVIDE, cfDivide);
+    ADD_LEGACY_OP(COMPOSITE_LINEAR_LIGHT, cfLinearLight);
+    ADD_LEGACY_OP(COMPOSITE_PIN_LIGHT, cfPinLight);
+    ADD_LEGACY_OP(COMPOSITE_VIVID_LIGHT, cfVividLight);
+    ADD_LEGACY_OP(COMPOSITE_HARD_MIX, cfHardMix);
+    ADD_LEGACY_OP(COMPOSITE_HARD_MIX_PHOTOSHOP, cfHardMixPhotoshop);
+    ADD_LEGACY_OP(COMPOSITE_GRAIN_MERGE, cfGrainMerge);
+    ADD_LEGACY_OP(COMPOSITE_GRAIN_EXTRACT, cfGrainExtract);
+    ADD_LEGACY_OP(COMPOSITE_ALLANON, cfAllanon);
+    ADD_LEGACY_OP(COMPOSITE_PARALLEL, cfParallel);
+    ADD_LEGACY_OP(COMPOSITE_EQUIVALENCE, cfEquivalence);
+    ADD_LEGACY_OP(COMPOSITE_ADDITIVE_SUBTRACTIVE, cfAdditiveSubtractive);
+    ADD_LEGACY_OP(COMPOSITE_GEOMETRIC_MEAN, cfGeometricMean);
+    ADD_LEGACY_OP(COMPOSITE_HARD_OVERLAY, cfHardOverlay);
+    ADD_LEGACY_OP(COMPOSITE_GLOW, cfGlow);
+    ADD_LEGACY_OP(COMPOSITE_REFLECT, cfReflect);
+    ADD_LEGACY_OP(COMPOSITE_HEAT, cfHeat);
+    ADD_LEGACY_OP(COMPOSITE_FREEZE, cfFreeze);
+    ADD_LEGACY_OP(COMPOSITE_GAMMA_DARK, cfGammaDark);
+    ADD_LEGACY_OP(COMPOSITE_GAMMA_LIGHT, cfGammaLight);
+    ADD_LEGACY_OP(COMPOSITE_ARC_TANGENT, cfArcTangent);
+
+#undef ADD_LEGACY_OP
+
+    return ops;
+}
+
+/**
+ * Returns the op the color space actually uses for the blending mode of
+ * \p legacyOp, or null if it is not an optimized one
+ */
+const KoCompositeOp* registeredOptimizedGenericSCOp(const KoCompositeOp *legacyOp)
+{
+    const KoCompositeOp *op = legacyOp->colorSpace()->compositeOp(legacyOp->id());
+    return op && typeid(*op) != typeid(*legacyOp) ? op : 0;
+}
+
+template<class Traits>
+void compareGenericSCOps(const KoColorSpace *cs, float floatPrecision)
+{
+    QList<KoCompositeOp*> legacyOps = createLegacyGenericSCOps<Traits>(cs);
+
+    Q_FOREACH (KoCompositeOp *opExp, legacyOps) {
+        const KoCompositeOp *opAct = registeredOptimizedGenericSCOp(opExp);
+
+        if (!opAct) {
+            dbgKrita << "No optimized version for" << opExp->id() << "skipping...";
+            continue;
+        }
+
+        dbgKrita << "Comparing" << opExp->id();
+        QVERIFY2(compareTwoOps(true, opAct, opExp, floatPrecision), opExp->id().toLatin1());
+        QVERIFY2(compareTwoOps(false, opAct, opExp, floatPrecision), opExp->id().toLatin1());
+    }
+
+    qDeleteAll(legacyOps);
+}
+
+void KisCompositionBenchmark::compareRgbF32GenericSCOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+
+    // the legacy ops do a part of the math in doubles, so the
+    // precision is a bit lower than for the Over op
+    compareGenericSCOps<KoRgbF32Traits>(cs, 1e-4);
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenLegacy()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -774,6 +874,37 @@ void KisCompositionBenchmark::testRgbF32CompositeOverOptimized()
     delete op;
 }
 
+template<class Traits>
+void benchmarkGenericSCOps(const KoColorSpace *cs, bool useOptimized)
+{
+    QList<KoCompositeOp*> legacyOps = createLegacyGenericSCOps<Traits>(cs);
+
+    Q_FOREACH (KoCompositeOp *legacyOp, legacyOps) {
+        const KoCompositeOp *optimizedOp = useOptimized ? registeredOptimizedGenericSCOp(legacyOp) : 0;
+        const KoCompositeOp *op = optimizedOp ? optimizedOp : legacyOp;
+
+        dbgKrita << "Testing Composite Op:" << op->id()
+                 << "(" << (optimizedOp ? "Optimized" : "Legacy") << ")";
+
+        benchmarkCompositeOp(op, true, 0.5, 0.3, 0, 0, ALPHA_RANDOM, ALPHA_RANDOM);
+        benchmarkCompositeOp(op, false, 1.0, 1.0, 0, 0, ALPHA_RANDOM, ALPHA_UNIT);
+    }
+
+    qDeleteAll(legacyOps);
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeGenericSCLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    benchmarkGenericSCOps<KoRgbF32Traits>(cs, false);
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeGenericSCOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    benchmarkGenericSCOps<KoRgbF32Traits>(cs, true);
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenReal_Aligned()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
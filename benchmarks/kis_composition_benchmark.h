@@ -45,6 +45,7 @@ private Q_SLOTS:
     void compareOverOps();
     void compareOverOpsNoMask();
     void compareRgbF32OverOps();
+    void compareRgbF32GenericSCOps();
 
     void testRgb8CompositeAlphaDarkenLegacy();
     void testRgb8CompositeAlphaDarkenOptimized();
@@ -58,6 +59,9 @@ private Q_SLOTS:
     void testRgbF32CompositeOverLegacy();
     void testRgbF32CompositeOverOptimized();
 
+    void testRgbF32CompositeGenericSCLegacy();
+    void testRgbF32CompositeGenericSCOptimized();
+
     void testRgb8CompositeAlphaDarkenReal_Aligned();
     void testRgb8CompositeOverReal_Aligned();
 
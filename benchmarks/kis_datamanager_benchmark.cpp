@@ -21,6 +21,8 @@
 
 #include <QTest>
 #include <kis_datamanager.h>
+#include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
 
 // RGBA
 #define PIXEL_SIZE 4
@@ -198,5 +200,112 @@ void KisDatamanagerBenchmark::benchmarkMemCpy()
     delete[] dst;
 }
 
+/**
+ * Fills the tile data with a smooth gradient and some noise, which is
+ * quite close to what one can see in a real painting
+ */
+static void fillTileWithGradient(KisTileData *td, int pixelSize)
+{
+    qsrand(17);
+
+    quint8 *ptr = td->data();
+    for (int y = 0; y < KisTileData::HEIGHT; y++) {
+        for (int x = 0; x < KisTileData::WIDTH; x++) {
+            for (int i = 0; i < pixelSize; i++) {
+                *ptr++ = quint8((x + y) * (i + 1) / 2 + (qrand() & 0x3));
+            }
+        }
+    }
+}
+
+void KisDatamanagerBenchmark::benchmarkCompressTiles_data()
+{
+    QTest::addColumn<QString>("compressionName");
+    QTest::addColumn<int>("pixelSize");
+    QTest::addColumn<bool>("useDictionary");
+
+    Q_FOREACH (const QString &name, KisTileCompressor2::supportedCompressions()) {
+        QTest::newRow(QString("%1-rgba8").arg(name).toLatin1()) << name << 4 << false;
+        QTest::newRow(QString("%1-rgba16").arg(name).toLatin1()) << name << 8 << false;
+
+        if (name == "ZSTD") {
+            QTest::newRow(QString("%1-dict-rgba8").arg(name).toLatin1()) << name << 4 << true;
+            QTest::newRow(QString("%1-dict-rgba16").arg(name).toLatin1()) << name << 8 << true;
+        }
+    }
+}
+
+void KisDatamanagerBenchmark::benchmarkCompressTiles()
+{
+    QFETCH(QString, compressionName);
+    QFETCH(int, pixelSize);
+    QFETCH(bool, useDictionary);
+
+    QByteArray defaultPixel(pixelSize, 0);
+    KisTiledDataManager dm(pixelSize, (const quint8*)defaultPixel.constData());
+    KisTileSP tile = dm.getTile(0, 0, true);
+    tile->lockForWrite();
+
+    KisTileData *td = tile->tileData();
+    fillTileWithGradient(td, pixelSize);
+
+    KisTileCompressor2 compressor(compressionName, useDictionary);
+
+    const qint32 bufferSize = compressor.tileDataBufferSize(td);
+    QByteArray buffer(bufferSize, 0);
+    qint32 bytesWritten = 0;
+
+    // let the dictionary be trained before the measurement
+    if (useDictionary) {
+        for (int i = 0; i < 256; i++) {
+            compressor.compressTileData(td, (quint8*)buffer.data(), bufferSize, bytesWritten);
+        }
+    }
+
+    QBENCHMARK {
+        compressor.compressTileData(td, (quint8*)buffer.data(), bufferSize, bytesWritten);
+    }
+
+    qDebug() << "Compression ratio:" << qreal(bufferSize - 1) / bytesWritten;
+
+    tile->unlock();
+}
+
+void KisDatamanagerBenchmark::benchmarkDecompressTiles_data()
+{
+    benchmarkCompressTiles_data();
+}
+
+void KisDatamanagerBenchmark::benchmarkDecompressTiles()
+{
+    QFETCH(QString, compressionName);
+    QFETCH(int, pixelSize);
+    QFETCH(bool, useDictionary);
+
+    QByteArray defaultPixel(pixelSize, 0);
+    KisTiledDataManager dm(pixelSize, (const quint8*)defaultPixel.constData());
+    KisTileSP tile = dm.getTile(0, 0, true);
+    tile->lockForWrite();
+
+    KisTileData *td = tile->tileData();
+    fillTileWithGradient(td, pixelSize);
+
+    KisTileCompressor2 compressor(compressionName, useDictionary);
+
+    const qint32 bufferSize = compressor.tileDataBufferSize(td);
+    QByteArray buffer(bufferSize, 0);
+    qint32 bytesWritten = 0;
+
+    // let the dictionary be trained before the measurement
+    for (int i = 0; i < 256; i++) {
+        compressor.compressTileData(td, (quint8*)buffer.data(), bufferSize, bytesWritten);
+    }
+
+    QBENCHMARK {
+        compressor.decompressTileData((quint8*)buffer.data(), bytesWritten, td);
+    }
+
+    tile->unlock();
+}
 
 QTEST_MAIN(KisDatamanagerBenchmark)
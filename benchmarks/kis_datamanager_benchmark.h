@@ -36,6 +36,11 @@ private Q_SLOTS:
     void benchmarkExtent();
     void benchmarkClear();
     void benchmarkMemCpy();
+
+    void benchmarkCompressTiles_data();
+    void benchmarkCompressTiles();
+    void benchmarkDecompressTiles_data();
+    void benchmarkDecompressTiles();
 };
 
 #endif
@@ -25,6 +25,7 @@
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 #include <KoColor.h>
 
 #include <kis_image.h>
@@ -32,6 +33,8 @@
 #include "kis_floodfill_benchmark.h"
 
 #include <kis_fill_painter.h>
+#include <kis_pixel_selection.h>
+#include <floodfill/kis_scanline_fill.h>
 
 #include <KoCompositeOps.h>
 
@@ -104,6 +107,48 @@ void KisFloodFillBenchmark::benchmarkFlood()
     //out.save("fill_output.png");
 }
 
+void KisFloodFillBenchmark::benchmarkFloodSelection_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<bool>("parallelMode");
+
+    QTest::newRow("u8-sequential") << Integer8BitsColorDepthID.id() << false;
+    QTest::newRow("u8-parallel") << Integer8BitsColorDepthID.id() << true;
+    QTest::newRow("u16-sequential") << Integer16BitsColorDepthID.id() << false;
+    QTest::newRow("u16-parallel") << Integer16BitsColorDepthID.id() << true;
+    QTest::newRow("f32-sequential") << Float32BitsColorDepthID.id() << false;
+    QTest::newRow("f32-parallel") << Float32BitsColorDepthID.id() << true;
+}
+
+void KisFloodFillBenchmark::benchmarkFloodSelection()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(bool, parallelMode);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+
+    const QRect imageRect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+
+    // a big closed area crossed by the antialiased-like "lineart" strokes
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->fill(imageRect, KoColor(Qt::white, cs));
+
+    for (int i = 1; i < 16; i++) {
+        const int pos = i * TEST_IMAGE_WIDTH / 16;
+        device->fill(QRect(pos, 0, 2, TEST_IMAGE_HEIGHT - 100), KoColor(Qt::black, cs));
+        device->fill(QRect(pos + 2, 0, 1, TEST_IMAGE_HEIGHT - 100), KoColor(Qt::lightGray, cs));
+    }
+
+    QBENCHMARK_ONCE {
+        KisPixelSelectionSP selection = new KisPixelSelection();
+
+        KisScanlineFill fill(device, QPoint(10, 10), imageRect);
+        fill.setThreshold(15);
+        fill.setParallelMode(parallelMode);
+        fill.fillSelection(selection);
+    }
+}
 
 void KisFloodFillBenchmark::cleanupTestCase()
 {
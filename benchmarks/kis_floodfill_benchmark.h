@@ -42,6 +42,9 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFlood();
+
+    void benchmarkFloodSelection_data();
+    void benchmarkFloodSelection();
     
     
     
@@ -228,4 +228,44 @@ void KisLowMemoryBenchmark::memory2000History100Pool500HugeBrush()
                       2000, 600, 500, 0);
 }
 
+/**
+ * Stresses the swap itself: the limits are so low that most of the
+ * painted tiles (and all the history) go to the swap and come back
+ * on every cycle. Compare the cycle times of the different swap
+ * backends in the logs with the indexes 1, 2 and 3.
+ */
+void KisLowMemoryBenchmark::benchmarkSwapStress(bool useMappedSwapFile, bool uncompressed, int index)
+{
+    QString presetFileName = "autobrush_300px.kpp";
+    // one cycle takes about 48 MiB of memory (total 960 MiB)
+    QRectF rect(150,150,4000,4000);
+    qreal step = 250;
+    int numCycles = 20;
+
+    KisImageConfig config(false);
+    config.setUseMappedSwapFile(useMappedSwapFile);
+    config.setSwapUncompressedTiles(uncompressed);
+
+    benchmarkWideArea(presetFileName, rect, step, numCycles, true,
+                      500, 100, 50, index);
+
+    config.setUseMappedSwapFile(config.useMappedSwapFile(true));
+    config.setSwapUncompressedTiles(config.swapUncompressedTiles(true));
+}
+
+void KisLowMemoryBenchmark::memory500History100Pool50SwapWindow()
+{
+    benchmarkSwapStress(false, false, 1);
+}
+
+void KisLowMemoryBenchmark::memory500History100Pool50SwapMapped()
+{
+    benchmarkSwapStress(true, false, 2);
+}
+
+void KisLowMemoryBenchmark::memory500History100Pool50SwapMappedUncompressed()
+{
+    benchmarkSwapStress(true, true, 3);
+}
+
 QTEST_MAIN(KisLowMemoryBenchmark)
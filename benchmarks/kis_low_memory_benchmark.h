@@ -31,7 +31,13 @@ private Q_SLOTS:
 
     void memory2000History100Pool500HugeBrush();
 
+    void memory500History100Pool50SwapWindow();
+    void memory500History100Pool50SwapMapped();
+    void memory500History100Pool50SwapMappedUncompressed();
+
 private:
+    void benchmarkSwapStress(bool useMappedSwapFile, bool uncompressed, int index);
+
     void benchmarkWideArea(const QString presetFileName,
                            const QRectF &rect, qreal vstep,
                            int numCycles,
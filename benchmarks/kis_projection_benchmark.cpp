@@ -20,9 +20,14 @@
 #include "kis_projection_benchmark.h"
 #include "kis_benchmark_values.h"
 
+#include <QThread>
+
 #include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOpRegistry.h>
 
 #include <kis_group_layer.h>
+#include <kis_paint_layer.h>
 #include <kis_paint_device.h>
 #include <KisDocument.h>
 #include <kis_image.h>
@@ -58,5 +63,77 @@ void KisProjectionBenchmark::benchmarkLoading()
     }
 }
 
+void addThreadCountRows()
+{
+    QTest::addColumn<int>("threads");
+
+    const int idealThreadCount = qMax(1, QThread::idealThreadCount());
+
+    for (int i = 1; i < idealThreadCount; i *= 2) {
+        QTest::newRow(QString("threads-%1").arg(i).toLatin1()) << i;
+    }
+
+    QTest::newRow(QString("threads-%1").arg(idealThreadCount).toLatin1()) << idealThreadCount;
+}
+
+void KisProjectionBenchmark::benchmarkRefreshGraph_data()
+{
+    addThreadCountRows();
+}
+
+void KisProjectionBenchmark::benchmarkRefreshGraph()
+{
+    QFETCH(int, threads);
+
+    KisDocument *doc = KisPart::instance()->createDocument();
+    doc->loadNativeFormat(QString(FILES_DATA_DIR) + QDir::separator() + "load_test.kra");
+
+    KisImageSP image = doc->image();
+    image->waitForDone();
+    image->setWorkingThreadsLimit(threads);
+
+    QBENCHMARK {
+        image->refreshGraph();
+        image->waitForDone();
+    }
+
+    delete doc;
+}
+
+void KisProjectionBenchmark::benchmarkMergeLayers_data()
+{
+    addThreadCountRows();
+}
+
+void KisProjectionBenchmark::benchmarkMergeLayers()
+{
+    QFETCH(int, threads);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 4096, 4096);
+
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge benchmark");
+
+    const QStringList compositeOps = {COMPOSITE_OVER, COMPOSITE_MULT, COMPOSITE_SCREEN, COMPOSITE_OVERLAY};
+    const QList<QColor> colors = {Qt::red, Qt::green, Qt::blue, Qt::yellow};
+
+    for (int i = 0; i < 8; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), 200);
+        layer->setCompositeOpId(compositeOps[i % compositeOps.size()]);
+        layer->paintDevice()->fill(imageRect.adjusted(64 * i, 64 * i, -64 * i, -64 * i),
+                                   KoColor(colors[i % colors.size()], cs));
+
+        image->addNode(layer, image->root());
+    }
+
+    image->initialRefreshGraph();
+    image->waitForDone();
+    image->setWorkingThreadsLimit(threads);
+
+    QBENCHMARK {
+        image->refreshGraph();
+        image->waitForDone();
+    }
+}
 
 QTEST_MAIN(KisProjectionBenchmark)
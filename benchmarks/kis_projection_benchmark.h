@@ -32,6 +32,12 @@ private Q_SLOTS:
 
     void benchmarkProjection();
     void benchmarkLoading();
+
+    void benchmarkRefreshGraph_data();
+    void benchmarkRefreshGraph();
+
+    void benchmarkMergeLayers_data();
+    void benchmarkMergeLayers();
 };
 
 #endif
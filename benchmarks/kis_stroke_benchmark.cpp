@@ -328,6 +328,64 @@ void KisStrokeBenchmark::colorsmudgeRL()
 }
 
 /*
+void KisStrokeBenchmark::sketchLongStroke_data()
+{
+    QTest::addColumn<int>("numSegments");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void KisStrokeBenchmark::sketchLongStroke()
+{
+    QFETCH(int, numSegments);
+
+    QString presetFileName = "sketchbrush.kpp";
+    KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
+    bool loadedOk = preset->load();
+    if (!loadedOk){
+        dbgKrita << "The preset was not loaded correctly. Done.";
+        return;
+    }
+
+    /**
+     * The sketch brush connects every new dab to the previous points of
+     * the stroke around it, so the stroke goes in rows close to each
+     * other, like hatching. The time per segment should not grow with
+     * the length of the stroke.
+     */
+    const qreal step = 5.0;
+    const qreal rowStep = 20.0;
+    const qreal margin = 0.05 * TEST_IMAGE_WIDTH;
+    const int segmentsPerRow = (TEST_IMAGE_WIDTH - 2 * margin) / step;
+
+    QBENCHMARK{
+        // the new paintop starts with an empty history of points
+        m_painter->setPaintOpPreset(preset, m_layer, m_image);
+
+        KisDistanceInformation currentDistance;
+        QPointF prev(margin, margin);
+
+        for (int i = 1; i <= numSegments; i++) {
+            const int row = i / segmentsPerRow;
+            const int col = i % segmentsPerRow;
+
+            const qreal x = row % 2 ?
+                margin + (segmentsPerRow - col) * step :
+                margin + col * step;
+
+            const QPointF pt(x, margin + row * rowStep);
+            m_painter->paintLine(prev, pt, &currentDistance);
+            prev = pt;
+        }
+    }
+
+#ifdef SAVE_OUTPUT
+    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + presetFileName + "_long" + OUTPUT_FORMAT);
+#endif
+}
+
 void KisStrokeBenchmark::predefinedBrush()
 {
     QString presetFileName = "deevad-slow-brush1.kpp";
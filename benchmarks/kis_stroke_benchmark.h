@@ -120,6 +120,9 @@ private Q_SLOTS:
 
     void colorsmudge();
     void colorsmudgeRL();
+
+    void sketchLongStroke_data();
+    void sketchLongStroke();
 /*
     void predefinedBrush();
     void predefinedBrushRL();
@@ -0,0 +1,47 @@
+# - Try to find the lz4 compression library
+# Once done this will define
+#
+#  LZ4_FOUND - system has lz4
+#  LZ4_INCLUDE_DIRS - the lz4 include directories
+#  LZ4_LIBRARIES - the libraries needed to use lz4
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+#
+if (NOT WIN32)
+    include(LibFindMacros)
+    libfind_pkg_check_modules(LZ4_PKGCONF liblz4)
+
+    find_path(LZ4_INCLUDE_DIR
+        NAMES lz4.h
+        HINTS ${LZ4_PKGCONF_INCLUDE_DIRS} ${LZ4_PKGCONF_INCLUDEDIR}
+    )
+
+    find_library(LZ4_LIBRARY
+        NAMES lz4
+        HINTS ${LZ4_PKGCONF_LIBRARY_DIRS} ${LZ4_PKGCONF_LIBDIR}
+    )
+
+    set(LZ4_PROCESS_LIBS LZ4_LIBRARY)
+    set(LZ4_PROCESS_INCLUDES LZ4_INCLUDE_DIR)
+    libfind_process(LZ4)
+
+else()
+    find_path(LZ4_INCLUDE_DIR
+        NAMES lz4.h
+    )
+
+    find_library(LZ4_LIBRARY
+        NAMES lz4 liblz4
+        DOC "Libraries to link against for LZ4 Support"
+    )
+
+    set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+    set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+
+    if(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+        set(LZ4_FOUND true)
+        message(STATUS "Correctly found LZ4")
+    else()
+        message(STATUS "Could not find LZ4")
+    endif()
+endif()
@@ -0,0 +1,47 @@
+# - Try to find the zstd compression library
+# Once done this will define
+#
+#  ZSTD_FOUND - system has zstd
+#  ZSTD_INCLUDE_DIRS - the zstd include directories
+#  ZSTD_LIBRARIES - the libraries needed to use zstd
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+#
+if (NOT WIN32)
+    include(LibFindMacros)
+    libfind_pkg_check_modules(ZSTD_PKGCONF libzstd)
+
+    find_path(ZSTD_INCLUDE_DIR
+        NAMES zstd.h
+        HINTS ${ZSTD_PKGCONF_INCLUDE_DIRS} ${ZSTD_PKGCONF_INCLUDEDIR}
+    )
+
+    find_library(ZSTD_LIBRARY
+        NAMES zstd
+        HINTS ${ZSTD_PKGCONF_LIBRARY_DIRS} ${ZSTD_PKGCONF_LIBDIR}
+    )
+
+    set(ZSTD_PROCESS_LIBS ZSTD_LIBRARY)
+    set(ZSTD_PROCESS_INCLUDES ZSTD_INCLUDE_DIR)
+    libfind_process(ZSTD)
+
+else()
+    find_path(ZSTD_INCLUDE_DIR
+        NAMES zstd.h
+    )
+
+    find_library(ZSTD_LIBRARY
+        NAMES zstd libzstd
+        DOC "Libraries to link against for ZSTD Support"
+    )
+
+    set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+    set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+
+    if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+        set(ZSTD_FOUND true)
+        message(STATUS "Correctly found ZSTD")
+    else()
+        message(STATUS "Could not find ZSTD")
+    endif()
+endif()
@@ -122,6 +122,7 @@ private:
 KisBrushServer::KisBrushServer()
 {
     m_brushServer = new BrushResourceServer();
+    m_brushServer->setConcurrentLoading(true);
     m_brushServer->loadResources(KoResourceServerProvider::blacklistFileNames(m_brushServer->fileNames(), m_brushServer->blackListedFiles()));
 
     Q_FOREACH (KisBrushSP brush, m_brushServer->resources()) {
@@ -118,6 +118,62 @@ void KoShapeManager::Private::paintGroup(KoShapeGroup *group, QPainter &painter,
     }
 }
 
+KoShape* KoShapeManager::Private::shapeToPaint(KoShape *shape) const
+{
+    // check if one of the shapes ancestors have filter effects
+    KoShapeContainer *parent = shape->parent();
+    while (parent) {
+        // parent must be part of the shape manager to be taken into account
+        if (!shapes.contains(parent))
+            break;
+        if (parent->filterEffectStack() && !parent->filterEffectStack()->isEmpty()) {
+            return parent;
+        }
+        parent = parent->parent();
+    }
+
+    return shape;
+}
+
+KoShape* KoShapeManager::Private::selfContainedRoot(KoShape *shape, KoShape *excludeRoot)
+{
+    KoShape *root = shape;
+
+    /**
+     * The clip paths of the ancestors are applied in their own coordinates,
+     * so a shape clipped by an ancestor is copied together with it
+     */
+    for (KoShape *parent = shape->parent();
+         parent && parent != excludeRoot;
+         parent = parent->parent()) {
+
+        if (parent->clipPath()) {
+            root = parent;
+        }
+    }
+
+    return root;
+}
+
+void KoShapeManager::Private::mapClonedShapes(KoShape *shape, KoShape *clone, QHash<KoShape*, KoShape*> &clonedShapes)
+{
+    clonedShapes.insert(shape, clone);
+
+    KoShapeContainer *container = dynamic_cast<KoShapeContainer*>(shape);
+    KoShapeContainer *clonedContainer = dynamic_cast<KoShapeContainer*>(clone);
+    if (!container || !clonedContainer) return;
+
+    const QList<KoShape*> children = container->shapes();
+    const QList<KoShape*> clonedChildren = clonedContainer->shapes();
+
+    // some of the children could not be copied, we cannot match them
+    if (children.size() != clonedChildren.size()) return;
+
+    for (int i = 0; i < children.size(); i++) {
+        mapClonedShapes(children[i], clonedChildren[i], clonedShapes);
+    }
+}
+
 KoShapeManager::KoShapeManager(KoCanvasBase *canvas, const QList<KoShape *> &shapes)
     : d(new Private(this, canvas))
 {
@@ -269,24 +325,7 @@ void KoShapeManager::paint(QPainter &painter, const KoViewConverter &converter,
     foreach (KoShape *shape, unsortedShapes) {
         if (!shape->isVisible())
             continue;
-        bool addShapeToList = true;
-        // check if one of the shapes ancestors have filter effects
-        KoShapeContainer *parent = shape->parent();
-        while (parent) {
-            // parent must be part of the shape manager to be taken into account
-            if (!d->shapes.contains(parent))
-                break;
-            if (parent->filterEffectStack() && !parent->filterEffectStack()->isEmpty()) {
-                addShapeToList = false;
-                break;
-            }
-            parent = parent->parent();
-        }
-        if (addShapeToList) {
-            sortedShapes.append(shape);
-        } else if (parent) {
-            sortedShapes.append(parent);
-        }
+        sortedShapes.append(d->shapeToPaint(shape));
     }
 
     std::sort(sortedShapes.begin(), sortedShapes.end(), KoShape::compareShapeZIndex);
@@ -314,6 +353,84 @@ void KoShapeManager::paint(QPainter &painter, const KoViewConverter &converter,
     }
 }
 
+void KoShapeManager::preparePaintJobs(PaintJobsOrder &jobsOrder, KoShape *excludeRoot)
+{
+    d->updateTree();
+
+    jobsOrder.paintContext = KoShapePaintingContext(d->canvas, false);
+
+    QHash<KoShape*, KoShape*> clonedShapes;
+
+    for (auto it = jobsOrder.jobs.begin(); it != jobsOrder.jobs.end(); ++it) {
+        QList<KoShape*> sortedShapes;
+        QSet<KoShape*> addedShapes;
+
+        Q_FOREACH (KoShape *shape, d->tree.intersects(it->docUpdateRect)) {
+            if (!shape->isVisible()) continue;
+
+            KoShape *paintedShape = d->shapeToPaint(shape);
+            if (addedShapes.contains(paintedShape)) continue;
+
+            addedShapes.insert(paintedShape);
+            sortedShapes.append(paintedShape);
+        }
+
+        // sort the original shapes, their copies may have lost the parent
+        std::sort(sortedShapes.begin(), sortedShapes.end(), KoShape::compareShapeZIndex);
+
+        it->shapes.clear();
+
+        Q_FOREACH (KoShape *shape, sortedShapes) {
+            if (!clonedShapes.contains(shape)) {
+                KoShape *root = Private::selfContainedRoot(shape, excludeRoot);
+
+                KoShape *clonedRoot = root->cloneShape();
+                KIS_SAFE_ASSERT_RECOVER(clonedRoot) { continue; }
+
+                /**
+                 * The copy has no parent, so bake everything it would
+                 * inherit from the ancestors into the copy itself
+                 */
+                clonedRoot->setTransformation(root->absoluteTransformation(0));
+                clonedRoot->setTransparency(root->transparency(true));
+
+                if (root->inheritBackground()) {
+                    clonedRoot->setBackground(root->background());
+                }
+
+                if (root->inheritStroke()) {
+                    clonedRoot->setStroke(root->stroke());
+                }
+
+                jobsOrder.clonedShapes.append(QSharedPointer<KoShape>(clonedRoot));
+
+                Private::mapClonedShapes(root, clonedRoot, clonedShapes);
+            }
+
+            /**
+             * The shape might have been dropped on copying, e.g. when the shape
+             * doesn't implement cloneShape()
+             */
+            KoShape *clonedShape = clonedShapes.value(shape, 0);
+            if (clonedShape) {
+                it->shapes.append(clonedShape);
+            }
+        }
+    }
+}
+
+void KoShapeManager::paintJob(QPainter &painter, const PaintJob &job, const PaintJobsOrder &jobsOrder, const KoViewConverter &converter)
+{
+    painter.setPen(Qt::NoPen);  // painters by default have a black stroke, lets turn that off.
+    painter.setBrush(Qt::NoBrush);
+
+    KoShapePaintingContext paintContext(jobsOrder.paintContext);
+
+    Q_FOREACH (KoShape *shape, job.shapes) {
+        renderSingleShape(shape, painter, converter, paintContext);
+    }
+}
+
 void KoShapeManager::renderSingleShape(KoShape *shape, QPainter &painter, const KoViewConverter &converter, KoShapePaintingContext &paintContext)
 {
     KisQPainterStateSaver saver(&painter);
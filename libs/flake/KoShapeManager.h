@@ -24,9 +24,13 @@
 
 #include <QList>
 #include <QObject>
+#include <QRect>
 #include <QSet>
+#include <QSharedPointer>
+#include <QVector>
 
 #include "KoFlake.h"
+#include "KoShapePaintingContext.h"
 #include "kritaflake_export.h"
 
 class KoShape;
@@ -34,7 +38,6 @@ class KoSelection;
 class KoViewConverter;
 class KoCanvasBase;
 class KoPointerEvent;
-class KoShapePaintingContext;
 
 class QPainter;
 class QPointF;
@@ -117,6 +120,49 @@ public:
      */
     void paint(QPainter &painter, const KoViewConverter &converter, bool forPrint);
 
+    /**
+     * A part of the canvas that can be rendered independently from the
+     * other parts, e.g. in a separate thread. The shapes of the job are
+     * copies of the shapes of the manager, sorted by their z-index, so
+     * the job can be painted while the original shapes are being edited.
+     */
+    struct PaintJob {
+        QRectF docUpdateRect;
+        QRect viewUpdateRect;
+        QList<KoShape*> shapes;
+    };
+
+    /**
+     * A set of jobs prepared by preparePaintJobs(). The order owns the
+     * copies of the shapes, the same copy may be shared by several jobs.
+     */
+    struct PaintJobsOrder {
+        QVector<PaintJob> jobs;
+        QList<QSharedPointer<KoShape>> clonedShapes;
+        KoShapePaintingContext paintContext;
+    };
+
+    /**
+     * Fills in the shapes of each job of \p jobsOrder. The shapes are
+     * looked up in the tree of the manager by the job's docUpdateRect.
+     *
+     * Only the shapes painted by the jobs are copied, each one on its own.
+     * The transformation, transparency, background and stroke the shape gets
+     * from its ancestors are baked into the copy. A shape clipped by one of
+     * its ancestors is copied together with the outermost of such ancestors.
+     * \p excludeRoot is the parent of the top-level shapes, it is never
+     * copied, but its transformation is baked into the copies.
+     *
+     * Should be called in the thread that owns the shapes.
+     */
+    void preparePaintJobs(PaintJobsOrder &jobsOrder, KoShape *excludeRoot);
+
+    /**
+     * Paints a job prepared by preparePaintJobs(). Different jobs of the same
+     * order may be painted in different threads at the same time.
+     */
+    static void paintJob(QPainter &painter, const PaintJob &job, const PaintJobsOrder &jobsOrder, const KoViewConverter &converter);
+
     /**
      * Returns the shape located at a specific point in the document.
      * If more than one shape is located at the specific point, the given selection type
@@ -28,6 +28,7 @@
 #include "KoShapeContainer.h"
 #include "KoShapeManager.h"
 #include <KoRTree.h>
+#include <QHash>
 #include "kis_thread_safe_signal_compressor.h"
 
 
@@ -78,6 +79,27 @@ public:
      */
     static void paintGroup(KoShapeGroup *group, QPainter &painter, const KoViewConverter &converter, KoShapePaintingContext &paintContext);
 
+    /**
+     * Returns the shape that should be painted to render \p shape. It is the shape
+     * itself or its ancestor with filter effects, which are applied to all its
+     * children at once.
+     */
+    KoShape* shapeToPaint(KoShape *shape) const;
+
+    /**
+     * Returns the shape that should be copied to paint \p shape without its
+     * ancestors. It is \p shape itself, unless one of its ancestors below
+     * \p excludeRoot has a clip path. Then it is the outermost of such ancestors.
+     */
+    static KoShape* selfContainedRoot(KoShape *shape, KoShape *excludeRoot);
+
+    /**
+     * Adds \p shape, its children and their copies in \p clone to \p clonedShapes.
+     * The children of the copy are expected to be in the same order as the original
+     * ones.
+     */
+    static void mapClonedShapes(KoShape *shape, KoShape *clone, QHash<KoShape*, KoShape*> &clonedShapes);
+
     class DetectCollision
     {
     public:
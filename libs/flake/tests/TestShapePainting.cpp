@@ -319,4 +319,93 @@ void TestShapePainting::testGroupUngroup()
     }
 }
 
+#include <KoPathShape.h>
+#include <KoShapeLayer.h>
+#include <KoColorBackground.h>
+
+void TestShapePainting::testPreparePaintJobs()
+{
+    QScopedPointer<KoShapeLayer> layer(new KoShapeLayer());
+    layer->setTransformation(QTransform::fromTranslate(10, 0));
+
+    QPainterPath leftPath;
+    leftPath.addRect(0, 0, 20, 20);
+    KoPathShape *leftShape = KoPathShape::createShapeFromPainterPath(leftPath);
+    leftShape->setBackground(QSharedPointer<KoShapeBackground>(new KoColorBackground(Qt::red)));
+
+    QPainterPath rightPath;
+    rightPath.addRect(60, 0, 20, 20);
+    KoPathShape *rightShape = KoPathShape::createShapeFromPainterPath(rightPath);
+    rightShape->setInheritBackground(true);
+
+    KoShapeGroup *group = new KoShapeGroup();
+    group->setBackground(QSharedPointer<KoShapeBackground>(new KoColorBackground(Qt::blue)));
+    group->addShape(leftShape);
+    group->addShape(rightShape);
+    layer->addShape(group);
+
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+    manager.addShape(layer.data());
+
+    KoShapeManager::PaintJobsOrder jobsOrder;
+
+    KoShapeManager::PaintJob leftJob;
+    leftJob.docUpdateRect = QRectF(0, 0, 50, 50);
+    leftJob.viewUpdateRect = QRect(0, 0, 50, 50);
+    jobsOrder.jobs << leftJob;
+
+    KoShapeManager::PaintJob rightJob;
+    rightJob.docUpdateRect = QRectF(50, 0, 50, 50);
+    rightJob.viewUpdateRect = QRect(50, 0, 50, 50);
+    jobsOrder.jobs << rightJob;
+
+    manager.preparePaintJobs(jobsOrder, layer.data());
+
+    // only the painted shapes are copied, not the group
+    QCOMPARE(jobsOrder.clonedShapes.size(), 2);
+
+    QCOMPARE(jobsOrder.jobs[0].shapes.size(), 1);
+    QCOMPARE(jobsOrder.jobs[1].shapes.size(), 1);
+
+    KoShape *clonedLeftShape = jobsOrder.jobs[0].shapes.first();
+    KoShape *clonedRightShape = jobsOrder.jobs[1].shapes.first();
+
+    QVERIFY(clonedLeftShape != leftShape);
+    QVERIFY(clonedRightShape != rightShape);
+    QVERIFY(!clonedLeftShape->parent());
+    QVERIFY(!clonedRightShape->parent());
+    QCOMPARE(clonedLeftShape->absoluteTransformation(0), leftShape->absoluteTransformation(0));
+    QCOMPARE(clonedRightShape->absoluteTransformation(0), rightShape->absoluteTransformation(0));
+
+    // changes to the original shapes don't affect the prepared jobs
+    leftShape->setBackground(QSharedPointer<KoShapeBackground>(new KoColorBackground(Qt::green)));
+    group->setBackground(QSharedPointer<KoShapeBackground>(new KoColorBackground(Qt::green)));
+
+    QImage image(100, 50, QImage::Format_ARGB32);
+    image.fill(0);
+
+    QPainter painter(&image);
+    painter.setClipRect(jobsOrder.jobs[0].viewUpdateRect);
+
+    KoViewConverter vc;
+    KoShapeManager::paintJob(painter, jobsOrder.jobs[0], jobsOrder, vc);
+    painter.end();
+
+    QCOMPARE(image.pixel(5, 10), qRgba(0, 0, 0, 0));
+    QCOMPARE(image.pixel(20, 10), QColor(Qt::red).rgba());
+    QCOMPARE(image.pixel(80, 10), qRgba(0, 0, 0, 0));
+
+    // the copy keeps the background inherited from the group
+    image.fill(0);
+
+    painter.begin(&image);
+    painter.setClipRect(jobsOrder.jobs[1].viewUpdateRect);
+    KoShapeManager::paintJob(painter, jobsOrder.jobs[1], jobsOrder, vc);
+    painter.end();
+
+    QCOMPARE(image.pixel(20, 10), qRgba(0, 0, 0, 0));
+    QCOMPARE(image.pixel(80, 10), QColor(Qt::blue).rgba());
+}
+
 KISTEST_MAIN(TestShapePainting)
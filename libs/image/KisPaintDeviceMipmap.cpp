@@ -0,0 +1,285 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisPaintDeviceMipmap.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+#include <QVector>
+
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_lod_transform.h"
+#include "kis_default_bounds_base.h"
+#include "kis_tile_data.h"
+#include "kis_datamanager.h"
+#include "kis_debug.h"
+
+
+struct KisPaintDeviceMipmap::Private
+{
+    Private(KisPaintDevice *_source, int _numLevels)
+        : source(_source),
+          numLevels(_numLevels),
+          levels(_numLevels),
+          pendingRegions(_numLevels),
+          fullUpdateRequested(false)
+    {
+    }
+
+    KisPaintDevice *source;
+    const int numLevels;
+
+    /**
+     * levels[0] is unused, since level 0 is the source itself
+     */
+    QVector<KisPaintDeviceSP> levels;
+
+    /**
+     * pendingRegions[i] is the region of level (i - 1) that should
+     * be downsampled into level i. pendingRegions[1] is protected by
+     * dirtyLock, all the others by syncLock.
+     */
+    QVector<QRegion> pendingRegions;
+
+    /**
+     * Set by setDirty() without arguments. The levels are only touched
+     * under syncLock, so the area covered by them is calculated in
+     * level(). Protected by dirtyLock.
+     */
+    bool fullUpdateRequested;
+
+    QMutex dirtyLock;
+    QMutex syncLock;
+
+    QRect alignedDirtyRect(const QRect &rc) const;
+    QRect sourceExtent() const;
+    void resetLevelsIfNeeded();
+    void processFullUpdateRequest();
+    void syncLevel(int index);
+    void syncLevelsUpTo(int index);
+};
+
+KisPaintDeviceMipmap::KisPaintDeviceMipmap(KisPaintDevice *source, int numLevels)
+    : m_d(new Private(source, qMax(1, numLevels)))
+{
+    setDirty();
+}
+
+KisPaintDeviceMipmap::~KisPaintDeviceMipmap()
+{
+}
+
+int KisPaintDeviceMipmap::numLevels() const
+{
+    return m_d->numLevels;
+}
+
+QRect KisPaintDeviceMipmap::Private::alignedDirtyRect(const QRect &rc) const
+{
+    /**
+     * Align the rect to the tile grid of the source device. The
+     * alignment is also a multiple of the step of the topmost level,
+     * so the rects never need to be rounded while travelling up the
+     * chain.
+     */
+    static const int tileSizeLog2 = 6;
+    KIS_SAFE_ASSERT_RECOVER_NOOP(KisTileData::WIDTH == 1 << tileSizeLog2);
+
+    return KisLodTransform::alignedRect(rc, qMax(tileSizeLog2, numLevels - 1));
+}
+
+QRect KisPaintDeviceMipmap::Private::sourceExtent() const
+{
+    /**
+     * The extent of the source device may be reported in lod
+     * coordinates, but the levels are always generated from
+     * the non-lod data
+     */
+    const int lod = source->defaultBounds()->currentLevelOfDetail();
+    return KisLodTransform::upscaledRect(source->extent(), lod);
+}
+
+void KisPaintDeviceMipmap::setDirty(const QRect &rc)
+{
+    if (rc.isEmpty() || m_d->numLevels < 2) return;
+
+    const QRect alignedRect = m_d->alignedDirtyRect(rc);
+
+    QMutexLocker l(&m_d->dirtyLock);
+    m_d->pendingRegions[1] += alignedRect;
+}
+
+void KisPaintDeviceMipmap::setDirty()
+{
+    if (m_d->numLevels < 2) return;
+
+    QMutexLocker l(&m_d->dirtyLock);
+    m_d->fullUpdateRequested = true;
+}
+
+void KisPaintDeviceMipmap::Private::processFullUpdateRequest()
+{
+    {
+        QMutexLocker l(&dirtyLock);
+        if (!fullUpdateRequested) return;
+        fullUpdateRequested = false;
+    }
+
+    /**
+     * The pixels that have disappeared from the source should be
+     * cleared in the levels as well
+     */
+    QRect rc = sourceExtent();
+
+    for (int i = 1; i < numLevels; i++) {
+        rc |= KisLodTransform::upscaledRect(levels[i]->extent(), i);
+    }
+
+    if (rc.isEmpty()) return;
+
+    QMutexLocker l(&dirtyLock);
+    pendingRegions[1] += alignedDirtyRect(rc);
+}
+
+void KisPaintDeviceMipmap::Private::resetLevelsIfNeeded()
+{
+    const KoColorSpace *cs = source->colorSpace();
+
+    if (levels[1] && *levels[1]->colorSpace() == *cs) return;
+
+    for (int i = 1; i < numLevels; i++) {
+        levels[i] = new KisPaintDevice(cs);
+        levels[i]->setDefaultPixel(source->defaultPixel());
+        pendingRegions[i] = QRegion();
+    }
+
+    QMutexLocker l(&dirtyLock);
+    pendingRegions[1] = alignedDirtyRect(sourceExtent());
+    fullUpdateRequested = false;
+}
+
+void KisPaintDeviceMipmap::Private::syncLevel(int index)
+{
+    QRegion region;
+
+    if (index == 1) {
+        QMutexLocker l(&dirtyLock);
+        region = pendingRegions[1];
+        pendingRegions[1] = QRegion();
+    } else {
+        region = pendingRegions[index];
+        pendingRegions[index] = QRegion();
+    }
+
+    if (region.isEmpty()) return;
+
+    KisPaintDevice *src = index == 1 ? source : levels[index - 1].data();
+    KisPaintDeviceSP dst = levels[index];
+
+    Q_FOREACH (const QRect &rc, region.rects()) {
+        src->generateLodCloneDevice(dst, rc, 1);
+
+        if (index + 1 < numLevels) {
+            pendingRegions[index + 1] += KisLodTransform::scaledRect(rc, 1);
+        }
+    }
+}
+
+void KisPaintDeviceMipmap::Private::syncLevelsUpTo(int index)
+{
+    resetLevelsIfNeeded();
+    processFullUpdateRequest();
+
+    for (int i = 1; i <= index; i++) {
+        syncLevel(i);
+    }
+}
+
+KisPaintDeviceSP KisPaintDeviceMipmap::level(int index)
+{
+    KIS_SAFE_ASSERT_RECOVER(index >= 0 && index < m_d->numLevels) {
+        index = qBound(0, index, m_d->numLevels - 1);
+    }
+
+    if (index == 0) {
+        return m_d->source;
+    }
+
+    QMutexLocker l(&m_d->syncLock);
+    m_d->syncLevelsUpTo(index);
+
+    /**
+     * The level itself is updated by the next call to level(), which
+     * may happen in another thread, so give the caller a snapshot.
+     * It shares the tiles with the level, so it costs only the copy
+     * of the tile hash table.
+     */
+    return new KisPaintDevice(*m_d->levels[index]);
+}
+
+bool KisPaintDeviceMipmap::copyLevelRect(int index, const QRect &levelRect, KisDataManager *dst)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(index < m_d->numLevels, false);
+    if (index <= 0) return false;
+
+    /**
+     * The level is read under syncLock, so no snapshot is needed
+     */
+    QMutexLocker l(&m_d->syncLock);
+    m_d->syncLevelsUpTo(index);
+
+    dst->bitBlt(m_d->levels[index]->dataManager().data(), levelRect);
+
+    return true;
+}
+
+int KisPaintDeviceMipmap::levelForScale(qreal scale) const
+{
+    int index = 0;
+
+    while (index + 1 < m_d->numLevels &&
+           1.0 / (1 << (index + 1)) >= scale) {
+
+        index++;
+    }
+
+    return index;
+}
+
+int KisPaintDeviceMipmap::levelForSize(const QSize &originalSize, const QSize &targetSize) const
+{
+    int index = 0;
+
+    while (index + 1 < m_d->numLevels &&
+           (originalSize.width() >> (index + 1)) >= targetSize.width() &&
+           (originalSize.height() >> (index + 1)) >= targetSize.height()) {
+
+        index++;
+    }
+
+    return index;
+}
+
+QRect KisPaintDeviceMipmap::scaledRect(const QRect &rc, int index)
+{
+    return index > 0 ?
+        KisLodTransform::scaledRect(KisLodTransform::alignedRect(rc, index), index) : rc;
+}
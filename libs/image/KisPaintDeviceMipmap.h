@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISPAINTDEVICEMIPMAP_H
+#define KISPAINTDEVICEMIPMAP_H
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class QRect;
+class QSize;
+class KisDataManager;
+
+/**
+ * A chain of downsampled copies of a paint device, each level being
+ * twice smaller than the previous one. Level 0 is the source device
+ * itself.
+ *
+ * The levels are updated lazily: setDirty() only records the changed
+ * area (aligned to the tile grid), and the downsampling happens when
+ * someone requests the level with level(). Every changed tile is
+ * downsampled only once per level, regardless of the number of
+ * consumers reading from the chain.
+ *
+ * The mipmap attached to a device with KisPaintDevice::mipmap() is
+ * notified by the device itself about all the changes made through
+ * its methods (fill(), clear(), writeBytes(), setDirty(), etc.). The
+ * pixels written through the iterators or the painters are not
+ * tracked, the writer should call KisPaintDevice::setDirty() or
+ * KisPaintDevice::invalidateMipmap() for them. For the image
+ * projection it is done by KisImage.
+ *
+ * The levels are always generated from non-lod data of the source
+ * device, so the mipmap is not affected by the level of detail mode.
+ */
+class KRITAIMAGE_EXPORT KisPaintDeviceMipmap
+{
+public:
+    KisPaintDeviceMipmap(KisPaintDevice *source, int numLevels = 6);
+    ~KisPaintDeviceMipmap();
+
+    int numLevels() const;
+
+    /**
+     * Marks \p rc of the source device as changed. Can be
+     * called from any thread.
+     */
+    void setDirty(const QRect &rc);
+
+    /**
+     * Marks the whole source device as changed
+     */
+    void setDirty();
+
+    /**
+     * Returns a copy-on-write snapshot of level \p index of the chain.
+     * All the pending changes are downsampled into the level before
+     * returning. The snapshot is not affected by the later updates of
+     * the chain, so it may be read without any locks. Level 0 is the
+     * source device itself, not a snapshot.
+     */
+    KisPaintDeviceSP level(int index);
+
+    /**
+     * Copies \p levelRect of level \p index into \p dst, which should
+     * have the color space of the source device. Unlike level(), it
+     * doesn't create a snapshot of the whole level, so it is cheap to
+     * call for every small rect of an update.
+     *
+     * \return false if \p index is 0, which is not a part of the chain
+     */
+    bool copyLevelRect(int index, const QRect &levelRect, KisDataManager *dst);
+
+    /**
+     * Returns the smallest level that has scale not less than \p scale
+     */
+    int levelForScale(qreal scale) const;
+
+    /**
+     * Returns the smallest level, where \p originalSize is still not
+     * smaller than \p targetSize
+     */
+    int levelForSize(const QSize &originalSize, const QSize &targetSize) const;
+
+    /**
+     * Maps \p rc from the source device coordinates into the
+     * coordinates of level \p index. The result covers all the pixels
+     * affected by \p rc.
+     */
+    static QRect scaledRect(const QRect &rc, int index);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPAINTDEVICEMIPMAP_H
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisWorkStealingExecutor.h"
+
+#include <atomic>
+#include <deque>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+/**
+ * The tasks of one runAndWait() call. The group lives on the stack of
+ * the owner, so the owner may leave only after taking the lock, when
+ * the last thief has already released it.
+ */
+struct TaskGroup {
+    QMutex lock;
+    QWaitCondition finished;
+    int pendingTasks = 0;
+};
+
+struct TaskItem {
+    KisWorkStealingExecutor::Task task;
+    TaskGroup *group;
+};
+
+struct WorkerDeque {
+    QMutex lock;
+    std::deque<TaskItem> tasks;
+};
+
+}
+
+struct KisWorkStealingExecutor::Private
+{
+    /**
+     * Protects the list of the deques from being resized while
+     * some thread is looking for a victim. The tasks themselves are
+     * never executed under this lock.
+     */
+    mutable QReadWriteLock dequesLock;
+    QVector<WorkerDeque*> deques;
+
+    std::atomic<int> numQueuedTasks {0};
+    std::atomic<unsigned int> nextVictim {0};
+
+    WakeUpCallback wakeUpCallback;
+
+    bool popOwnTask(int workerIndex, TaskItem *item);
+    bool stealTask(TaskItem *item);
+
+    static void runTask(const TaskItem &item);
+};
+
+KisWorkStealingExecutor::KisWorkStealingExecutor(int numWorkers)
+    : m_d(new Private)
+{
+    setNumWorkers(numWorkers);
+}
+
+KisWorkStealingExecutor::~KisWorkStealingExecutor()
+{
+    qDeleteAll(m_d->deques);
+}
+
+void KisWorkStealingExecutor::setNumWorkers(int value)
+{
+    QWriteLocker l(&m_d->dequesLock);
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->numQueuedTasks);
+
+    qDeleteAll(m_d->deques);
+    m_d->deques.resize(qMax(1, value));
+
+    for (int i = 0; i < m_d->deques.size(); i++) {
+        m_d->deques[i] = new WorkerDeque();
+    }
+}
+
+int KisWorkStealingExecutor::numWorkers() const
+{
+    QReadLocker l(&m_d->dequesLock);
+    return m_d->deques.size();
+}
+
+void KisWorkStealingExecutor::setWakeUpCallback(WakeUpCallback callback)
+{
+    m_d->wakeUpCallback = callback;
+}
+
+void KisWorkStealingExecutor::Private::runTask(const TaskItem &item)
+{
+    item.task();
+
+    QMutexLocker l(&item.group->lock);
+    if (!--item.group->pendingTasks) {
+        item.group->finished.wakeAll();
+    }
+}
+
+bool KisWorkStealingExecutor::Private::popOwnTask(int workerIndex, TaskItem *item)
+{
+    QReadLocker l(&dequesLock);
+
+    WorkerDeque *deque = deques[workerIndex];
+    QMutexLocker dequeLocker(&deque->lock);
+
+    if (deque->tasks.empty()) return false;
+
+    *item = deque->tasks.back();
+    deque->tasks.pop_back();
+    numQueuedTasks--;
+
+    return true;
+}
+
+bool KisWorkStealingExecutor::Private::stealTask(TaskItem *item)
+{
+    if (!numQueuedTasks) return false;
+
+    QReadLocker l(&dequesLock);
+
+    const int numDeques = deques.size();
+
+    /**
+     * Start from different victims every time, so that the thieves
+     * would not fight for the same deque
+     */
+    const unsigned int firstVictim = nextVictim++;
+
+    for (int i = 0; i < numDeques; i++) {
+        WorkerDeque *deque = deques[(firstVictim + i) % unsigned(numDeques)];
+        QMutexLocker dequeLocker(&deque->lock);
+
+        if (deque->tasks.empty()) continue;
+
+        *item = deque->tasks.front();
+        deque->tasks.pop_front();
+        numQueuedTasks--;
+
+        return true;
+    }
+
+    return false;
+}
+
+void KisWorkStealingExecutor::runAndWait(int workerIndex, const QVector<Task> &tasks)
+{
+    if (tasks.isEmpty()) return;
+
+    const bool canShareTasks =
+        tasks.size() > 1 &&
+        workerIndex >= 0 && workerIndex < numWorkers();
+
+    if (!canShareTasks) {
+        Q_FOREACH (const Task &task, tasks) {
+            task();
+        }
+        return;
+    }
+
+    TaskGroup group;
+    group.pendingTasks = tasks.size();
+
+    {
+        QReadLocker l(&m_d->dequesLock);
+
+        WorkerDeque *deque = m_d->deques[workerIndex];
+        QMutexLocker dequeLocker(&deque->lock);
+
+        /**
+         * The owner pops the tasks from the back of the deque, so
+         * push them in reverse order to execute them in the original
+         * order
+         */
+        for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+            deque->tasks.push_back({*it, &group});
+        }
+
+        m_d->numQueuedTasks += tasks.size();
+    }
+
+    if (m_d->wakeUpCallback) {
+        m_d->wakeUpCallback(tasks.size() - 1);
+    }
+
+    TaskItem item;
+    while (m_d->popOwnTask(workerIndex, &item)) {
+        Private::runTask(item);
+    }
+
+    /**
+     * Some of the tasks have been stolen by other threads. While they
+     * are running, help the other workers with their subtasks, and
+     * go to sleep only when there is nothing to steal.
+     */
+    while (1) {
+        if (tryStealAndRun()) continue;
+
+        QMutexLocker l(&group.lock);
+        if (!group.pendingTasks) break;
+
+        group.finished.wait(&group.lock);
+        if (!group.pendingTasks) break;
+    }
+}
+
+bool KisWorkStealingExecutor::tryStealAndRun()
+{
+    TaskItem item;
+    if (!m_d->stealTask(&item)) return false;
+
+    Private::runTask(item);
+    return true;
+}
+
+bool KisWorkStealingExecutor::hasStealableTasks() const
+{
+    return m_d->numQueuedTasks > 0;
+}
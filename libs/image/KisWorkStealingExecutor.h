@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISWORKSTEALINGEXECUTOR_H
+#define KISWORKSTEALINGEXECUTOR_H
+
+#include <functional>
+
+#include <QScopedPointer>
+#include <QVector>
+
+#include "kritaimage_export.h"
+
+/**
+ * A set of per-worker task deques used by the updater context for
+ * splitting long jobs into small subtasks.
+ *
+ * Every worker (a job slot of KisUpdaterContext) owns one deque. A
+ * worker that runs a big job pushes its subtasks into its own deque
+ * with runAndWait() and executes them from the back of the deque
+ * (LIFO order, which is good for the cache locality). Idle threads
+ * call tryStealAndRun() and take the tasks from the front of the
+ * deques of other workers.
+ *
+ * The executor doesn't own any threads. Whenever new stealable tasks
+ * appear, it calls the wake-up callback, so that the owner could
+ * start some helper threads.
+ */
+class KRITAIMAGE_EXPORT KisWorkStealingExecutor
+{
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(int)> WakeUpCallback;
+
+public:
+    KisWorkStealingExecutor(int numWorkers = 1);
+    ~KisWorkStealingExecutor();
+
+    /**
+     * Changes the number of worker deques. The executor must have no
+     * tasks queued when the number is changed.
+     */
+    void setNumWorkers(int value);
+    int numWorkers() const;
+
+    /**
+     * The callback is called with the number of tasks that became
+     * available for stealing
+     */
+    void setWakeUpCallback(WakeUpCallback callback);
+
+    /**
+     * Puts \p tasks into the deque of worker \p workerIndex and
+     * executes them. The function returns only when all the tasks
+     * are finished, including the ones stolen by other threads. While
+     * waiting for the stolen tasks, the calling thread steals the tasks
+     * of the other workers and sleeps only when there is nothing left.
+     *
+     * If \p workerIndex is not a valid index (e.g. the call comes
+     * from a helper thread), the tasks are executed in the calling
+     * thread sequentially.
+     */
+    void runAndWait(int workerIndex, const QVector<Task> &tasks);
+
+    /**
+     * Steals one task from any of the worker deques and executes it.
+     *
+     * \return false if there was nothing to steal
+     */
+    bool tryStealAndRun();
+
+    /**
+     * \return true if there are tasks that can be stolen
+     */
+    bool hasStealableTasks() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISWORKSTEALINGEXECUTOR_H
@@ -20,16 +20,52 @@
 
 #include <KoAlwaysInline.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QAtomicInt>
+#include <QBitArray>
+#include <QHash>
+#include <QSharedPointer>
 #include <QStack>
+#include <QThread>
+#include <QThreadPool>
 #include <KoColor.h>
 #include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
 #include <KoCompositeOpRegistry.h>
+#include <KisSharedRunnable.h>
+#include <KisSharedThreadPoolAdapter.h>
 #include "kis_image.h"
+#include "kis_algebra_2d.h"
 #include "kis_fill_interval_map.h"
 #include "kis_pixel_selection.h"
 #include "kis_random_accessor_ng.h"
+#include "kis_sequential_iterator.h"
 #include "kis_fill_sanity_checks.h"
 
+namespace {
+
+/**
+ * A hash key for 16-byte pixels, e.g. RGBA F32
+ */
+struct Pixel128
+{
+    quint64 lo;
+    quint64 hi;
+};
+
+inline bool operator==(const Pixel128 &lhs, const Pixel128 &rhs) {
+    return lhs.lo == rhs.lo && lhs.hi == rhs.hi;
+}
+
+inline uint qHash(const Pixel128 &key, uint seed = 0) {
+    return ::qHash(key.lo, seed) ^ ::qHash(key.hi, seed + 1);
+}
+
+}
+
 
 template <class BaseClass>
 class CopyToSelection : public BaseClass
@@ -178,6 +214,14 @@ public:
     ALWAYS_INLINE quint8 calculateDifference(quint8* pixelPtr) {
         HashKeyType key = *reinterpret_cast<HashKeyType*>(pixelPtr);
 
+        /**
+         * Most of the filled areas consist of long runs of the same
+         * color, so don't look into the hash for them
+         */
+        if (m_hasLastKey && key == m_lastKey) {
+            return m_lastResult;
+        }
+
         quint8 result;
 
         typename HashType::iterator it = m_differences.find(key);
@@ -199,12 +243,20 @@ public:
             m_differences.insert(key, result);
         }
 
+        m_hasLastKey = true;
+        m_lastKey = key;
+        m_lastResult = result;
+
         return result;
     }
 
 private:
     HashType m_differences;
 
+    bool m_hasLastKey = false;
+    HashKeyType m_lastKey;
+    quint8 m_lastResult = 0;
+
     const KoColorSpace *m_colorSpace;
     KoColor m_srcPixel;
     const quint8 *m_srcPixelPtr;
@@ -345,6 +397,296 @@ private:
 
 
 
+/**
+ * A filler that doesn't fill anything, used for building the opacity
+ * map only
+ */
+template <class BaseClass>
+class OpacityOnly : public BaseClass
+{
+public:
+    typedef KisRandomConstAccessorSP SourceAccessorType;
+
+    SourceAccessorType createSourceDeviceAccessor(KisPaintDeviceSP device) {
+        return device->createRandomConstAccessorNG(0, 0);
+    }
+
+    ALWAYS_INLINE void fillPixel(quint8 *dstPtr, quint8 opacity, int x, int y) {
+        Q_UNUSED(dstPtr);
+        Q_UNUSED(opacity);
+        Q_UNUSED(x);
+        Q_UNUSED(y);
+    }
+};
+
+class NoDifferencePolicy
+{
+};
+
+/**
+ * Reads the opacity of the pixels from the map built by
+ * buildOpacityMap() instead of calculating it
+ */
+template <template <class> class PixelFiller>
+class PrecalculatedOpacityPolicy : public PixelFiller<NoDifferencePolicy>
+{
+public:
+    typename PixelFiller<NoDifferencePolicy>::SourceAccessorType m_srcIt;
+
+public:
+    PrecalculatedOpacityPolicy(KisPaintDeviceSP opacityMap) {
+        m_srcIt = this->createSourceDeviceAccessor(opacityMap);
+    }
+
+    ALWAYS_INLINE quint8 calculateOpacity(quint8* pixelPtr) {
+        return *pixelPtr;
+    }
+};
+
+namespace {
+
+const int opacityMapCellSize = 64;
+
+class OpacityMapRunnable : public KisSharedRunnable
+{
+public:
+    OpacityMapRunnable(std::function<void()> func)
+        : m_func(func)
+    {
+    }
+
+    void runShared() override {
+        m_func();
+    }
+
+private:
+    std::function<void()> m_func;
+};
+
+inline quint64 cellKey(const QPoint &cell) {
+    return (quint64(quint32(cell.x())) << 32) | quint32(cell.y());
+}
+
+inline QPoint cellForPoint(const QPoint &pt) {
+    return QPoint(KisAlgebra2D::divideFloor(pt.x(), opacityMapCellSize),
+                  KisAlgebra2D::divideFloor(pt.y(), opacityMapCellSize));
+}
+
+/**
+ * The opacity of a cell of the map, kept between the waves, since
+ * the filled area may enter the same cell several times
+ */
+struct OpacityMapCell
+{
+    OpacityMapCell(const QRect &_rect)
+        : rect(_rect),
+          opacity(_rect.width() * _rect.height(), MIN_SELECTED),
+          calculated(_rect.width() * _rect.height())
+    {
+    }
+
+    inline int index(const QPoint &pt) const {
+        return (pt.y() - rect.y()) * rect.width() + pt.x() - rect.x();
+    }
+
+    QRect rect;
+    QVector<quint8> opacity;
+    QBitArray calculated;
+};
+
+typedef QSharedPointer<OpacityMapCell> OpacityMapCellSP;
+
+/**
+ * Calculates the opacity of all the pixels reachable from \p startPoint
+ * and writes it into an alpha8 map.
+ *
+ * The map is calculated in tile-aligned cells. Inside a cell the area is
+ * flood-filled from the seed points the area entered the cell through, so
+ * only the pixels connected to the starting point and their immediate
+ * neighbours are ever calculated. The cells are processed in waves: the
+ * first wave consists of the cell of the starting point only, every next
+ * one consists of the cells the area of the previous wave has leaked into.
+ * The cells of a wave are processed in parallel, every thread has its own
+ * \p OpacityPolicy, so the caches of the differences are not shared.
+ *
+ * The pixels that are not reachable keep zero opacity, so the scanline
+ * fill over the map gives exactly the same result as over the device.
+ */
+template <class OpacityPolicy>
+KisPaintDeviceSP buildOpacityMapImpl(KisPaintDeviceSP device,
+                                     const KoColor &srcColor,
+                                     int threshold,
+                                     const QPoint &startPoint,
+                                     const QRect &boundingRect)
+{
+    KisPaintDeviceSP opacityMap = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    if (!boundingRect.contains(startPoint)) return opacityMap;
+
+    const int maxWorkers = qMax(1, QThread::idealThreadCount());
+    std::vector<std::unique_ptr<OpacityPolicy>> policies(maxWorkers);
+    const int pixelSize = device->pixelSize();
+
+    auto processCell = [&] (OpacityMapCell *cell,
+                            const QVector<QPoint> &seeds,
+                            OpacityPolicy *policy,
+                            QVector<QPoint> *leakedPoints) {
+
+        const QRect &rect = cell->rect;
+
+        QVector<quint8> srcData(rect.width() * rect.height() * pixelSize);
+        device->readBytes(srcData.data(), rect);
+
+        QVector<QPoint> stack;
+
+        auto calculatePixel = [&] (const QPoint &pt) {
+            const int i = cell->index(pt);
+            if (cell->calculated.testBit(i)) return;
+
+            cell->calculated.setBit(i);
+
+            const quint8 opacity = policy->calculateOpacity(srcData.data() + i * pixelSize);
+            cell->opacity[i] = opacity;
+
+            if (opacity) {
+                stack.append(pt);
+            }
+        };
+
+        Q_FOREACH (const QPoint &pt, seeds) {
+            calculatePixel(pt);
+        }
+
+        const QPoint offsets[] = {QPoint(-1, 0), QPoint(1, 0), QPoint(0, -1), QPoint(0, 1)};
+
+        while (!stack.isEmpty()) {
+            const QPoint pt = stack.takeLast();
+
+            for (const QPoint &offset : offsets) {
+                const QPoint neighbour = pt + offset;
+
+                if (rect.contains(neighbour)) {
+                    calculatePixel(neighbour);
+                } else if (boundingRect.contains(neighbour)) {
+                    leakedPoints->append(neighbour);
+                }
+            }
+        }
+    };
+
+    QHash<quint64, OpacityMapCellSP> cells;
+
+    auto fetchCell = [&] (const QPoint &cellIndex) {
+        OpacityMapCellSP &cell = cells[cellKey(cellIndex)];
+
+        if (!cell) {
+            const QRect rect(cellIndex.x() * opacityMapCellSize, cellIndex.y() * opacityMapCellSize,
+                             opacityMapCellSize, opacityMapCellSize);
+            cell.reset(new OpacityMapCell(rect & boundingRect));
+        }
+
+        return cell.data();
+    };
+
+    typedef QPair<OpacityMapCell*, QVector<QPoint>> WaveItem;
+
+    QVector<WaveItem> wave;
+    wave << WaveItem(fetchCell(cellForPoint(startPoint)), QVector<QPoint>() << startPoint);
+
+    while (!wave.isEmpty()) {
+        const int numCells = wave.size();
+        const int numWorkers = qMin(numCells, maxWorkers);
+
+        QVector<QVector<QPoint>> leakedPoints(numWorkers);
+        QAtomicInt nextCell(0);
+        QAtomicInt nextWorker(0);
+
+        auto processCells = [&] () {
+            const int worker = nextWorker.fetchAndAddOrdered(1);
+            KIS_SAFE_ASSERT_RECOVER_RETURN(worker < numWorkers);
+
+            if (!policies[worker]) {
+                policies[worker].reset(new OpacityPolicy(device, srcColor, threshold));
+            }
+
+            int i;
+            while ((i = nextCell.fetchAndAddOrdered(1)) < numCells) {
+                processCell(wave[i].first, wave[i].second,
+                            policies[worker].get(), &leakedPoints[worker]);
+            }
+        };
+
+        KisSharedThreadPoolAdapter adapter(QThreadPool::globalInstance());
+
+        for (int i = 1; i < numWorkers; i++) {
+            OpacityMapRunnable *runnable = new OpacityMapRunnable(processCells);
+            if (!adapter.tryStart(runnable)) {
+                delete runnable;
+                break;
+            }
+        }
+
+        processCells();
+        adapter.waitForDone();
+
+        wave.clear();
+
+        QHash<OpacityMapCell*, int> waveIndexes;
+
+        Q_FOREACH (const QVector<QPoint> &workerPoints, leakedPoints) {
+            Q_FOREACH (const QPoint &pt, workerPoints) {
+                OpacityMapCell *cell = fetchCell(cellForPoint(pt));
+                if (cell->calculated.testBit(cell->index(pt))) continue;
+
+                auto it = waveIndexes.find(cell);
+                if (it == waveIndexes.end()) {
+                    it = waveIndexes.insert(cell, wave.size());
+                    wave << WaveItem(cell, QVector<QPoint>());
+                }
+
+                wave[*it].second.append(pt);
+            }
+        }
+    }
+
+    Q_FOREACH (OpacityMapCellSP cell, cells) {
+        opacityMap->writeBytes(cell->opacity.constData(), cell->rect);
+    }
+
+    return opacityMap;
+}
+
+template <bool useSmoothSelection>
+KisPaintDeviceSP buildOpacityMap(KisPaintDeviceSP device,
+                                 const KoColor &srcColor,
+                                 int threshold,
+                                 const QPoint &startPoint,
+                                 const QRect &boundingRect)
+{
+    const int pixelSize = device->pixelSize();
+
+    if (pixelSize == 1) {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicyOptimized<quint8>, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    } else if (pixelSize == 2) {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicyOptimized<quint16>, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    } else if (pixelSize == 4) {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicyOptimized<quint32>, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    } else if (pixelSize == 8) {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicyOptimized<quint64>, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    } else if (pixelSize == 16) {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicyOptimized<Pixel128>, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    } else {
+        return buildOpacityMapImpl<SelectionPolicy<useSmoothSelection, DifferencePolicySlow, OpacityOnly>>(
+            device, srcColor, threshold, startPoint, boundingRect);
+    }
+}
+
+}
+
 struct Q_DECL_HIDDEN KisScanlineFill::Private
 {
     KisPaintDeviceSP device;
@@ -352,6 +694,13 @@ struct Q_DECL_HIDDEN KisScanlineFill::Private
     QPoint startPoint;
     QRect boundingRect;
     int threshold;
+    bool parallelMode;
+
+    /**
+     * The pixel size of the device the scanline pass reads from. In
+     * parallel mode it is the opacity map, not the source device.
+     */
+    int scannedPixelSize;
 
     int rowIncrement;
     KisFillIntervalMap backwardMap;
@@ -381,6 +730,8 @@ KisScanlineFill::KisScanlineFill(KisPaintDeviceSP device, const QPoint &startPoi
     m_d->rowIncrement = 1;
 
     m_d->threshold = 0;
+    m_d->parallelMode = false;
+    m_d->scannedPixelSize = device->pixelSize();
 }
 
 KisScanlineFill::~KisScanlineFill()
@@ -392,6 +743,11 @@ void KisScanlineFill::setThreshold(int threshold)
     m_d->threshold = threshold;
 }
 
+void KisScanlineFill::setParallelMode(bool value)
+{
+    m_d->parallelMode = value;
+}
+
 template <class T>
 void KisScanlineFill::extendedPass(KisFillInterval *currentInterval, int srcRow, bool extendRight, T &pixelPolicy)
 {
@@ -460,7 +816,7 @@ void KisScanlineFill::processLine(KisFillInterval interval, const int rowIncreme
 
     int numPixelsLeft = 0;
     quint8 *dataPtr = 0;
-    const int pixelSize = m_d->device->pixelSize();
+    const int pixelSize = m_d->scannedPixelSize;
 
     while(x <= lastX) {
         // a bit of optimzation for not calling slow random accessor
@@ -551,6 +907,15 @@ void KisScanlineFill::runImpl(T &pixelPolicy)
 
 void KisScanlineFill::fillColor(const KoColor &fillColor)
 {
+    if (m_d->parallelMode) {
+        /**
+         * The opacity map is calculated before the filling starts, so
+         * the device can safely be used as an "external" one
+         */
+        this->fillColor(fillColor, m_d->device);
+        return;
+    }
+
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
@@ -576,6 +941,11 @@ void KisScanlineFill::fillColor(const KoColor &fillColor)
               policy(m_d->device, srcColor, m_d->threshold);
         policy.setFillColor(fillColor);
         runImpl(policy);
+    } else if (pixelSize == 16) {
+        SelectionPolicy<false, DifferencePolicyOptimized<Pixel128>, FillWithColor>
+              policy(m_d->device, srcColor, m_d->threshold);
+        policy.setFillColor(fillColor);
+        runImpl(policy);
     } else {
         SelectionPolicy<false, DifferencePolicySlow, FillWithColor>
               policy(m_d->device, srcColor, m_d->threshold);
@@ -589,6 +959,20 @@ void KisScanlineFill::fillColor(const KoColor &fillColor, KisPaintDeviceSP exter
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
+    if (m_d->parallelMode) {
+        KisPaintDeviceSP opacityMap =
+            buildOpacityMap<false>(m_d->device, srcColor, m_d->threshold,
+                                   m_d->startPoint, m_d->boundingRect);
+
+        PrecalculatedOpacityPolicy<FillWithColorExternal> policy(opacityMap);
+        policy.setDestinationDevice(externalDevice);
+        policy.setFillColor(fillColor);
+
+        m_d->scannedPixelSize = opacityMap->pixelSize();
+        runImpl(policy);
+        return;
+    }
+
     const int pixelSize = m_d->device->pixelSize();
 
     if (pixelSize == 1) {
@@ -615,6 +999,12 @@ void KisScanlineFill::fillColor(const KoColor &fillColor, KisPaintDeviceSP exter
         policy.setDestinationDevice(externalDevice);
         policy.setFillColor(fillColor);
         runImpl(policy);
+    } else if (pixelSize == 16) {
+        SelectionPolicy<false, DifferencePolicyOptimized<Pixel128>, FillWithColorExternal>
+            policy(m_d->device, srcColor, m_d->threshold);
+        policy.setDestinationDevice(externalDevice);
+        policy.setFillColor(fillColor);
+        runImpl(policy);
     } else {
         SelectionPolicy<false, DifferencePolicySlow, FillWithColorExternal>
             policy(m_d->device, srcColor, m_d->threshold);
@@ -629,6 +1019,19 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
+    if (m_d->parallelMode) {
+        KisPaintDeviceSP opacityMap =
+            buildOpacityMap<true>(m_d->device, srcColor, m_d->threshold,
+                                  m_d->startPoint, m_d->boundingRect);
+
+        PrecalculatedOpacityPolicy<CopyToSelection> policy(opacityMap);
+        policy.setDestinationSelection(pixelSelection);
+
+        m_d->scannedPixelSize = opacityMap->pixelSize();
+        runImpl(policy);
+        return;
+    }
+
     const int pixelSize = m_d->device->pixelSize();
 
     if (pixelSize == 1) {
@@ -651,6 +1054,11 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
               policy(m_d->device, srcColor, m_d->threshold);
         policy.setDestinationSelection(pixelSelection);
         runImpl(policy);
+    } else if (pixelSize == 16) {
+        SelectionPolicy<true, DifferencePolicyOptimized<Pixel128>, CopyToSelection>
+              policy(m_d->device, srcColor, m_d->threshold);
+        policy.setDestinationSelection(pixelSelection);
+        runImpl(policy);
     } else {
         SelectionPolicy<true, DifferencePolicySlow, CopyToSelection>
               policy(m_d->device, srcColor, m_d->threshold);
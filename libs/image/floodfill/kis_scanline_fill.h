@@ -74,6 +74,16 @@ public:
      */
     void setThreshold(int threshold);
 
+    /**
+     * In parallel mode the opacity of the pixels is calculated in
+     * tile-sized cells by all the threads of the global pool before
+     * the actual filling. Only the pixels connected to the starting
+     * point and their immediate neighbours are calculated.
+     *
+     * Used in fillColor() and fillSelection() only.
+     */
+    void setParallelMode(bool value);
+
 private:
     friend class KisScanlineFillTest;
     Q_DISABLE_COPY(KisScanlineFill)
@@ -46,6 +46,9 @@
 #include "kis_refresh_subtree_walker.h"
 
 #include "kis_abstract_projection_plane.h"
+#include "kis_transform_mask.h"
+#include "kis_filter_mask.h"
+#include "KisWorkStealingExecutor.h"
 
 
 //#define DEBUG_MERGER
@@ -207,6 +210,110 @@ private:
 /*                     KisAsyncMerger                                */
 /*********************************************************************/
 
+namespace {
+
+/**
+ * Stripes are aligned to the tiles of the paint devices, so that two
+ * stripes never write into the same tile
+ */
+const int stripeAlignment = 64;
+const int minStripeHeight = 2 * stripeAlignment;
+const qint64 minSplitArea = 512 * 512;
+
+/**
+ * Some filters (e.g. oilpaint or emboss) keep state between the calls
+ * or depend on the area they process as a whole, so they mark
+ * themselves as not supporting threading and cannot be split into
+ * stripes either.
+ */
+bool filterSupportsThreading(KisFilterConfigurationSP filterConfig)
+{
+    if (!filterConfig) return true;
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(filterConfig->name());
+    return !filter || filter->supportsThreading();
+}
+
+bool canProcessInStripes(KisProjectionLeafSP leaf)
+{
+    KisLayer *layer = qobject_cast<KisLayer*>(leaf->node().data());
+    if (!layer) return false;
+
+    /**
+     * Layer styles and transform masks keep internal caches shared by
+     * all the calls, and clone layers start merges of their own, so
+     * such nodes are processed as a whole. Pass-through groups have
+     * no projection of their own.
+     */
+    if (layer->projectionPlane() != layer->internalProjectionPlane()) return false;
+    if (qobject_cast<KisCloneLayer*>(layer)) return false;
+
+    KisGroupLayer *group = qobject_cast<KisGroupLayer*>(layer);
+    if (group && group->passThroughMode()) return false;
+
+    KisAdjustmentLayer *adjustmentLayer = qobject_cast<KisAdjustmentLayer*>(layer);
+    if (adjustmentLayer && !filterSupportsThreading(adjustmentLayer->filter())) return false;
+
+    Q_FOREACH (KisEffectMaskSP mask, layer->effectMasks()) {
+        if (qobject_cast<KisTransformMask*>(mask.data())) return false;
+
+        KisFilterMask *filterMask = qobject_cast<KisFilterMask*>(mask.data());
+        if (filterMask && !filterSupportsThreading(filterMask->filter())) return false;
+    }
+
+    return true;
+}
+
+}
+
+KisAsyncMerger::KisAsyncMerger()
+    : m_stripesExecutor(0),
+      m_workerIndex(-1)
+{
+}
+
+void KisAsyncMerger::setStripesExecutor(KisWorkStealingExecutor *executor, int workerIndex)
+{
+    m_stripesExecutor = executor;
+    m_workerIndex = workerIndex;
+}
+
+void KisAsyncMerger::processInStripes(const QRect &rect, bool useStripes, std::function<void(const QRect&)> func)
+{
+    const int numWorkers = m_stripesExecutor ? m_stripesExecutor->numWorkers() : 1;
+
+    if (!useStripes || numWorkers <= 1 ||
+        qint64(rect.width()) * rect.height() < minSplitArea ||
+        rect.height() < 2 * minStripeHeight) {
+
+        func(rect);
+        return;
+    }
+
+    /**
+     * Generate about two stripes per worker for better balancing. The
+     * stripes go through the full width of the rect, which keeps the
+     * overhead of the need rects of the filters at minimum.
+     */
+    int stripeHeight = qMax(minStripeHeight, rect.height() / (2 * numWorkers));
+    stripeHeight = (stripeHeight + stripeAlignment - 1) & ~(stripeAlignment - 1);
+
+    QVector<KisWorkStealingExecutor::Task> tasks;
+
+    int top = rect.top();
+    while (top <= rect.bottom()) {
+        const int alignedTop = top & ~(stripeAlignment - 1);
+        const int bottom = qMin(rect.bottom(), alignedTop + stripeHeight - 1);
+
+        const QRect stripe(rect.left(), top, rect.width(), bottom - top + 1);
+        tasks << [func, stripe] () { func(stripe); };
+
+        top = bottom + 1;
+    }
+
+    m_stripesExecutor->runAndWait(m_workerIndex, tasks);
+}
+
 void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
     KisMergeWalker::LeafStack &leafStack = walker.leafStack();
 
@@ -222,8 +329,16 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 
         QRect applyRect = item.m_applyRect;
 
+        /**
+         * Every step below reads the data prepared by the previous
+         * step only, so the stripes of one step can be processed
+         * concurrently, as long as the steps themselves are executed
+         * one after another
+         */
+        const bool useStripes = m_stripesExecutor && canProcessInStripes(currentLeaf);
+
         if (currentLeaf->isRoot()) {
-            currentLeaf->projectionPlane()->recalculate(applyRect, walker.startNode());
+            recalculateProjection(currentLeaf, applyRect, walker.startNode(), useStripes);
             continue;
         }
 
@@ -231,11 +346,8 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
             // The type of layers that will not go to projection.
 
             DEBUG_NODE_ACTION("Updating", "N_EXTRA", currentLeaf, applyRect);
-            KisUpdateOriginalVisitor originalVisitor(applyRect,
-                                                     m_currentProjection,
-                                                     walker.cropRect());
-            currentLeaf->accept(originalVisitor);
-            currentLeaf->projectionPlane()->recalculate(applyRect, currentLeaf->node());
+            updateOriginal(currentLeaf, applyRect, walker.cropRect(), useStripes);
+            recalculateProjection(currentLeaf, applyRect, currentLeaf->node(), useStripes);
 
             continue;
         }
@@ -245,30 +357,26 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
             setupProjection(currentLeaf, applyRect, useTempProjections);
         }
 
-        KisUpdateOriginalVisitor originalVisitor(applyRect,
-                                                 m_currentProjection,
-                                                 walker.cropRect());
-
         if(item.m_position & KisMergeWalker::N_FILTHY) {
             DEBUG_NODE_ACTION("Updating", "N_FILTHY", currentLeaf, applyRect);
             if (currentLeaf->visible()) {
-                currentLeaf->accept(originalVisitor);
-                currentLeaf->projectionPlane()->recalculate(applyRect, walker.startNode());
+                updateOriginal(currentLeaf, applyRect, walker.cropRect(), useStripes);
+                recalculateProjection(currentLeaf, applyRect, walker.startNode(), useStripes);
             }
         }
         else if(item.m_position & KisMergeWalker::N_ABOVE_FILTHY) {
             DEBUG_NODE_ACTION("Updating", "N_ABOVE_FILTHY", currentLeaf, applyRect);
             if(currentLeaf->dependsOnLowerNodes()) {
                 if (currentLeaf->visible()) {
-                    currentLeaf->accept(originalVisitor);
-                    currentLeaf->projectionPlane()->recalculate(applyRect, currentLeaf->node());
+                    updateOriginal(currentLeaf, applyRect, walker.cropRect(), useStripes);
+                    recalculateProjection(currentLeaf, applyRect, currentLeaf->node(), useStripes);
                 }
             }
         }
         else if(item.m_position & KisMergeWalker::N_FILTHY_PROJECTION) {
             DEBUG_NODE_ACTION("Updating", "N_FILTHY_PROJECTION", currentLeaf, applyRect);
             if (currentLeaf->visible()) {
-                currentLeaf->projectionPlane()->recalculate(applyRect, walker.startNode());
+                recalculateProjection(currentLeaf, applyRect, walker.startNode(), useStripes);
             }
         }
         else /*if(item.m_position & KisMergeWalker::N_BELOW_FILTHY)*/ {
@@ -276,7 +384,7 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
             /* nothing to do */
         }
 
-        compositeWithProjection(currentLeaf, applyRect);
+        compositeWithProjection(currentLeaf, applyRect, useStripes);
 
         if(item.m_position & KisMergeWalker::N_TOPMOST) {
             writeProjection(currentLeaf, useTempProjections, applyRect);
@@ -341,23 +449,47 @@ void KisAsyncMerger::writeProjection(KisProjectionLeafSP topmostLeaf, bool useTe
     if (!m_currentProjection) return;
 
     if(m_currentProjection != m_finalProjection) {
-        KisPainter::copyAreaOptimized(rect.topLeft(), m_currentProjection, m_finalProjection, rect);
+        KisPaintDeviceSP src = m_currentProjection;
+        KisPaintDeviceSP dst = m_finalProjection;
+
+        processInStripes(rect, true, [src, dst] (const QRect &rc) {
+            KisPainter::copyAreaOptimized(rc.topLeft(), src, dst, rc);
+        });
     }
     DEBUG_NODE_ACTION("Writing projection", "", topmostLeaf->parent(), rect);
 }
 
-bool KisAsyncMerger::compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect) {
+bool KisAsyncMerger::compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect, bool useStripes) {
 
     if (!m_currentProjection) return true;
     if (!leaf->visible()) return true;
 
-    KisPainter gc(m_currentProjection);
-    leaf->projectionPlane()->apply(&gc, rect);
+    KisPaintDeviceSP projection = m_currentProjection;
+
+    processInStripes(rect, useStripes, [leaf, projection] (const QRect &rc) {
+        KisPainter gc(projection);
+        leaf->projectionPlane()->apply(&gc, rc);
+    });
 
     DEBUG_NODE_ACTION("Compositing projection", "", leaf, rect);
     return true;
 }
 
+void KisAsyncMerger::updateOriginal(KisProjectionLeafSP leaf, const QRect &rect, const QRect &cropRect, bool useStripes) {
+    KisPaintDeviceSP projection = m_currentProjection;
+
+    processInStripes(rect, useStripes, [leaf, projection, cropRect] (const QRect &rc) {
+        KisUpdateOriginalVisitor originalVisitor(rc, projection, cropRect);
+        leaf->accept(originalVisitor);
+    });
+}
+
+void KisAsyncMerger::recalculateProjection(KisProjectionLeafSP leaf, const QRect &rect, KisNodeSP filthyNode, bool useStripes) {
+    processInStripes(rect, useStripes, [leaf, filthyNode] (const QRect &rc) {
+        leaf->projectionPlane()->recalculate(rc, filthyNode);
+    });
+}
+
 void KisAsyncMerger::doNotifyClones(KisBaseRectsWalker &walker) {
     KisBaseRectsWalker::CloneNotificationsVector &vector =
         walker.cloneNotifications();
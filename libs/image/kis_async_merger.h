@@ -19,24 +19,41 @@
 #ifndef __KIS_ASYNC_MERGER_H
 #define __KIS_ASYNC_MERGER_H
 
+#include <functional>
+
 #include "kritaimage_export.h"
 #include "kis_types.h"
 
 class QRect;
 class KisBaseRectsWalker;
+class KisWorkStealingExecutor;
 
 class KRITAIMAGE_EXPORT KisAsyncMerger
 {
 public:
+    KisAsyncMerger();
+
+    /**
+     * Lets the merger process big rects of every node in tile-aligned
+     * stripes, which are executed concurrently by \p executor. The
+     * stripes are pushed into the deque of the worker \p workerIndex.
+     * Pass null to process everything in the calling thread.
+     */
+    void setStripesExecutor(KisWorkStealingExecutor *executor, int workerIndex);
+
     void startMerge(KisBaseRectsWalker &walker, bool notifyClones = true);
 
 private:
     inline void resetProjection();
     inline void setupProjection(KisProjectionLeafSP currentLeaf, const QRect& rect, bool useTempProjection);
     inline void writeProjection(KisProjectionLeafSP topmostLeaf, bool useTempProjection, const QRect &rect);
-    inline bool compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect);
+    inline bool compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect, bool useStripes);
+    inline void updateOriginal(KisProjectionLeafSP leaf, const QRect &rect, const QRect &cropRect, bool useStripes);
+    inline void recalculateProjection(KisProjectionLeafSP leaf, const QRect &rect, KisNodeSP filthyNode, bool useStripes);
     inline void doNotifyClones(KisBaseRectsWalker &walker);
 
+    void processInStripes(const QRect &rect, bool useStripes, std::function<void(const QRect&)> func);
+
 private:
     /**
      * The place where intermediate results of layer's merge
@@ -62,6 +79,9 @@ private:
      * setupProjection()
      */
     KisPaintDeviceSP m_cachedPaintDevice;
+
+    KisWorkStealingExecutor *m_stripesExecutor;
+    int m_workerIndex;
 };
 
 
@@ -27,7 +27,11 @@
 #include "kis_convolution_worker.h"
 #include "kis_math_toolbox.h"
 
+#include <functional>
+
+#include <QAtomicInt>
 #include <QMutex>
+#include <QThreadPool>
 #include <QVector>
 #include <QTextStream>
 #include <QFile>
@@ -35,15 +39,10 @@
 
 #include <fftw3.h>
 
-template<class _IteratorFactory_> class KisConvolutionWorkerFFT;
-class KisConvolutionWorkerFFTLock
-{
-private:
-    static QMutex fftwMutex;
-    template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
-};
+#include <KisSharedRunnable.h>
+#include <KisSharedThreadPoolAdapter.h>
 
-QMutex KisConvolutionWorkerFFTLock::fftwMutex;
+#include "kis_fftw_plan_cache.h"
 
 
 template<class _IteratorFactory_>
@@ -82,15 +81,14 @@ public:
         const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
         const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
-
         /**
-         * FIXME: check whether this "optimization" is needed to
-         * be uncommented. My tests showed about 30% better performance
-         * when the line is commented out (DK).
+         * FFTW is the fastest on the sizes that factorize into small
+         * primes, so pad the transform up to such a size. The padding
+         * is filled with the source pixels, so the result in the
+         * requested area is not changed.
          */
-        //optimumDimensions(m_fftWidth, m_fftHeight);
+        m_fftWidth = KisFFTWPlanCache::optimalSize(areaSize.width() + 4 * halfKernelWidth);
+        m_fftHeight = KisFFTWPlanCache::optimalSize(areaSize.height() + 2 * halfKernelHeight);
 
         m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
         m_extraMem = (m_fftWidth % 2) ? 1 : 2;
@@ -129,34 +127,16 @@ public:
         const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
 
         // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
-
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+        KisFFTWPlanCache::PlansSP plans =
+            KisFFTWPlanCache::instance()->plans(m_fftWidth, m_fftHeight);
 
-        fftw_execute(fftwPlanForward);
+        fftw_execute_dft_r2c(plans->forward, (double*)m_kernelFFT, m_kernelFFT);
         addToProgress(progressPerFFT);
         if (isInterrupted()) return;
 
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-
-            fftMultiply(*k, m_kernelFFT);
-
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-        }
-
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+        transformChannels(*plans);
+        addToProgress(progressPerFFT * 2 * m_channelFFT.size());
+        if (isInterrupted()) return;
 
 
         writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
@@ -400,6 +380,62 @@ public:
     }
 
 private:
+    class ChannelTransformRunnable : public KisSharedRunnable
+    {
+    public:
+        ChannelTransformRunnable(std::function<void()> func)
+            : m_func(func)
+        {
+        }
+
+        void runShared() override {
+            m_func();
+        }
+
+    private:
+        std::function<void()> m_func;
+    };
+
+    /**
+     * Convolves all the channels with the kernel. The channels are
+     * independent, so they are distributed between the calling thread
+     * and the idle threads of the global thread pool. The calling thread
+     * always takes part in the work, so the convolution never waits for
+     * a busy pool.
+     */
+    void transformChannels(const KisFFTWPlanCache::Plans &plans)
+    {
+        const int numChannels = m_channelFFT.size();
+        fftw_complex * const *channels = m_channelFFT.constData();
+        QAtomicInt nextChannel(0);
+
+        auto processChannels = [&] () {
+            int k;
+            while ((k = nextChannel.fetchAndAddOrdered(1)) < numChannels) {
+                if (this->m_progress && this->m_progress->interrupted()) continue;
+
+                fftw_complex *channel = channels[k];
+
+                fftw_execute_dft_r2c(plans.forward, (double*)channel, channel);
+                fftMultiply(channel, m_kernelFFT);
+                fftw_execute_dft_c2r(plans.backward, channel, (double*)channel);
+            }
+        };
+
+        KisSharedThreadPoolAdapter adapter(QThreadPool::globalInstance());
+
+        for (int i = 1; i < numChannels; i++) {
+            ChannelTransformRunnable *runnable = new ChannelTransformRunnable(processChannels);
+            if (!adapter.tryStart(runnable)) {
+                delete runnable;
+                break;
+            }
+        }
+
+        processChannels();
+        adapter.waitForDone();
+    }
+
     void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, fftw_complex *m_kernelFFT)
     {
         // find central item
@@ -448,38 +484,17 @@ private:
         }
     }
 
-    void optimumDimensions(quint32& w, quint32& h)
-    {
-        // FFTW is most efficient when array size is a factor of 2, 3, 5 or 7
-        quint32 optW = w, optH = h;
-
-        while ((optW % 2 != 0) || (optW % 3 != 0) || (optW % 5 != 0) || (optW % 7 != 0))
-            ++optW;
-
-        while ((optH % 2 != 0) || (optH % 3 != 0) || (optH % 5 != 0) || (optH % 7 != 0))
-            ++optH;
-
-        quint32 optAreaW = optW * h;
-        quint32 optAreaH = optH * w;
-
-        if (optAreaW < optAreaH) {
-            w = optW;
-        }
-        else {
-            h = optH;
-        }
-    }
-
     void fftLogMatrix(double* channel, const QString &f)
     {
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
+        static QMutex logMutex;
+        QMutexLocker l(&logMutex);
+
         QString filename(QDir::homePath() + "/log_" + f + ".txt");
         dbgKrita << "Log File Name: " << filename;
         QFile file (filename);
         if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
         {
             dbgKrita << "Failed";
-            KisConvolutionWorkerFFTLock::fftwMutex.unlock();
             return;
         }
 
@@ -496,7 +511,6 @@ private:
             }
             in << "\n";
         }
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
     }
 
     void addToProgress(float amount)
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_fftw_plan_cache.h"
+
+#include <cstdio>
+
+#include <QCache>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QStandardPaths>
+
+#include "kis_debug.h"
+
+Q_GLOBAL_STATIC(KisFFTWPlanCache, s_instance)
+
+namespace {
+
+/**
+ * The planner of FFTW (including destruction of the plans and the
+ * wisdom functions) must never be called from two threads at once.
+ *
+ * The plans may outlive the cache itself, so the mutex should never be
+ * destroyed, which is guaranteed by QBasicMutex.
+ */
+QBasicMutex s_plannerMutex;
+
+/**
+ * The plans are small, but FFTW keeps twiddle factors for each of them,
+ * so don't let the number of the plans grow unbounded
+ */
+const int maxCachedPlans = 32;
+
+}
+
+KisFFTWPlanCache::Plans::Plans(int width, int height)
+{
+    const int realRowStride = 2 * (width / 2 + 1);
+    const size_t bufferSize = sizeof(double) * realRowStride * height;
+
+    /**
+     * FFTW_ESTIMATE doesn't touch the buffer, but the plans will be
+     * executed on other arrays, so the buffer should have the same
+     * alignment as the ones allocated by fftw_malloc() in the worker
+     */
+    double *buffer = static_cast<double*>(fftw_malloc(bufferSize));
+    fftw_complex *complexBuffer = reinterpret_cast<fftw_complex*>(buffer);
+
+    QMutexLocker l(&s_plannerMutex);
+    forward = fftw_plan_dft_r2c_2d(height, width, buffer, complexBuffer, FFTW_ESTIMATE);
+    backward = fftw_plan_dft_c2r_2d(height, width, complexBuffer, buffer, FFTW_ESTIMATE);
+
+    fftw_free(buffer);
+}
+
+KisFFTWPlanCache::Plans::~Plans()
+{
+    QMutexLocker l(&s_plannerMutex);
+    fftw_destroy_plan(forward);
+    fftw_destroy_plan(backward);
+}
+
+struct KisFFTWPlanCache::Private
+{
+    QMutex mutex;
+    QCache<QPair<int, int>, PlansSP> plans;
+};
+
+KisFFTWPlanCache::KisFFTWPlanCache()
+    : m_d(new Private)
+{
+    m_d->plans.setMaxCost(maxCachedPlans);
+
+    QMutexLocker l(&s_plannerMutex);
+
+    fftw_import_system_wisdom();
+
+    const QString wisdomFileName =
+        QStandardPaths::locate(QStandardPaths::AppDataLocation, "fftw-wisdom");
+
+    if (!wisdomFileName.isEmpty()) {
+        FILE *file = fopen(QFile::encodeName(wisdomFileName).constData(), "r");
+        if (file) {
+            if (!fftw_import_wisdom_from_file(file)) {
+                warnKrita << "Failed to import FFTW wisdom from" << wisdomFileName;
+            }
+            fclose(file);
+        }
+    }
+}
+
+KisFFTWPlanCache::~KisFFTWPlanCache()
+{
+}
+
+KisFFTWPlanCache* KisFFTWPlanCache::instance()
+{
+    return s_instance;
+}
+
+KisFFTWPlanCache::PlansSP KisFFTWPlanCache::plans(int width, int height)
+{
+    const QPair<int, int> key(width, height);
+
+    {
+        QMutexLocker l(&m_d->mutex);
+        PlansSP *cachedPlans = m_d->plans.object(key);
+        if (cachedPlans) {
+            return *cachedPlans;
+        }
+    }
+
+    /**
+     * Don't block the lookups of other sizes while planning. If two
+     * threads plan the same size at once, one of the plans is just
+     * dropped.
+     */
+    PlansSP newPlans(new Plans(width, height));
+
+    QMutexLocker l(&m_d->mutex);
+
+    PlansSP *cachedPlans = m_d->plans.object(key);
+    if (cachedPlans) {
+        return *cachedPlans;
+    }
+
+    m_d->plans.insert(key, new PlansSP(newPlans));
+
+    return newPlans;
+}
+
+int KisFFTWPlanCache::optimalSize(int size)
+{
+    for (int candidate = qMax(1, size);; candidate++) {
+        int value = candidate;
+
+        for (int factor : {2, 3, 5, 7}) {
+            while (value % factor == 0) {
+                value /= factor;
+            }
+        }
+
+        if (value == 1) {
+            return candidate;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_FFTW_PLAN_CACHE_H
+#define __KIS_FFTW_PLAN_CACHE_H
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include <fftw3.h>
+
+#include "kritaimage_export.h"
+
+/**
+ * A process-wide cache of the FFTW plans used by KisConvolutionWorkerFFT.
+ *
+ * The FFTW planner is not thread-safe, so creation and destruction of the
+ * plans is serialized, but it happens only once per transform size. The
+ * execution of a plan is thread-safe, so the same plan may be used by
+ * any number of threads at the same time via fftw_execute_dft_r2c() and
+ * fftw_execute_dft_c2r() on arrays allocated with fftw_malloc().
+ *
+ * On creation the cache imports the system wisdom and the wisdom stored
+ * in "fftw-wisdom" file in the application data location, if present.
+ */
+class KRITAIMAGE_EXPORT KisFFTWPlanCache
+{
+public:
+    /**
+     * A pair of in-place 2D real-to-complex and complex-to-real
+     * transforms for a height x width real array. The rows of the real
+     * array are padded to 2 * (width / 2 + 1) values.
+     */
+    struct Plans
+    {
+        Plans(int width, int height);
+        ~Plans();
+
+        fftw_plan forward;
+        fftw_plan backward;
+
+    private:
+        Q_DISABLE_COPY(Plans)
+    };
+
+    typedef QSharedPointer<const Plans> PlansSP;
+
+public:
+    KisFFTWPlanCache();
+    ~KisFFTWPlanCache();
+
+    static KisFFTWPlanCache* instance();
+
+    /**
+     * \return the plans for the transforms of size \p width x \p height.
+     * The plans stay valid while the returned pointer exists, even if the
+     * cache drops them.
+     */
+    PlansSP plans(int width, int height);
+
+    /**
+     * \return the smallest size not less than \p size, which has no prime
+     * factors other than 2, 3, 5 and 7. FFTW is the fastest on such sizes.
+     */
+    static int optimalSize(int size);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_FFTW_PLAN_CACHE_H */
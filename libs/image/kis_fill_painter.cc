@@ -209,6 +209,7 @@ void KisFillPainter::fillColor(int startX, int startY, KisPaintDeviceSP sourceDe
 
         KisScanlineFill gc(device(), startPoint, fillBoundsRect);
         gc.setThreshold(m_threshold);
+        gc.setParallelMode(true);
         gc.fillColor(paintColor());
 
     } else {
@@ -305,6 +306,7 @@ KisSelectionSP KisFillPainter::createFloodSelection(int startX, int startY, KisP
 
     KisScanlineFill gc(sourceDevice, startPoint, fillBoundsRect);
     gc.setThreshold(m_threshold);
+    gc.setParallelMode(true);
     gc.fillSelection(pixelSelection);
 
     if (m_sizemod > 0) {
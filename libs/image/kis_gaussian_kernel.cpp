@@ -22,6 +22,7 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include "kis_recursive_gaussian.h"
 #include <QRect>
 
 
@@ -109,27 +110,51 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
 {
     QPoint srcTopLeft = rect.topLeft();
 
+    /**
+     * For big radii the spatial kernels become too expensive, so
+     * every pass may be switched to the recursive filter, which cost
+     * doesn't depend on the radius. The recursive filter reads every
+     * block of pixels before writing it, so it never needs a transaction.
+     */
+    const bool useRecursiveHoriz = KisRecursiveGaussian::isApplicable(device, xRadius);
+    const bool useRecursiveVertical = KisRecursiveGaussian::isApplicable(device, yRadius);
+
     if (xRadius > 0.0 && yRadius > 0.0) {
         KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
 
-        KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(xRadius);
-        KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(yRadius);
-
-        qreal verticalCenter = qreal(kernelVertical->height()) / 2.0;
+        const qreal verticalCenter = qreal(kernelSizeFromRadius(yRadius)) / 2.0;
+        const QRect intermRect = rect.adjusted(0, -ceil(verticalCenter), 0, ceil(verticalCenter));
+
+        if (useRecursiveHoriz) {
+            KisRecursiveGaussian::applyPass(interm, device, intermRect, xRadius,
+                                            Qt::Horizontal, channelFlags, progressUpdater);
+        } else {
+            KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(xRadius);
+
+            KisConvolutionPainter horizPainter(interm);
+            horizPainter.setChannelFlags(channelFlags);
+            horizPainter.setProgress(progressUpdater);
+            horizPainter.applyMatrix(kernelHoriz, device,
+                                     intermRect.topLeft(),
+                                     intermRect.topLeft(),
+                                     intermRect.size(), BORDER_REPEAT);
+        }
 
-        KisConvolutionPainter horizPainter(interm);
-        horizPainter.setChannelFlags(channelFlags);
-        horizPainter.setProgress(progressUpdater);
-        horizPainter.applyMatrix(kernelHoriz, device,
-                                 srcTopLeft - QPoint(0, ceil(verticalCenter)),
-                                 srcTopLeft - QPoint(0, ceil(verticalCenter)),
-                                 rect.size() + QSize(0, 2 * ceil(verticalCenter)), BORDER_REPEAT);
+        if (useRecursiveVertical) {
+            KisRecursiveGaussian::applyPass(device, interm, rect, yRadius,
+                                            Qt::Vertical, channelFlags, progressUpdater);
+        } else {
+            KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(yRadius);
 
+            KisConvolutionPainter verticalPainter(device);
+            verticalPainter.setChannelFlags(channelFlags);
+            verticalPainter.setProgress(progressUpdater);
+            verticalPainter.applyMatrix(kernelVertical, interm, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        }
 
-        KisConvolutionPainter verticalPainter(device);
-        verticalPainter.setChannelFlags(channelFlags);
-        verticalPainter.setProgress(progressUpdater);
-        verticalPainter.applyMatrix(kernelVertical, interm, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+    } else if (xRadius > 0.0 && useRecursiveHoriz) {
+        KisRecursiveGaussian::applyPass(device, device, rect, xRadius,
+                                        Qt::Horizontal, channelFlags, progressUpdater);
 
     } else if (xRadius > 0.0) {
         KisConvolutionPainter painter(device);
@@ -145,6 +170,10 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
 
         painter.applyMatrix(kernelHoriz, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
 
+    } else if (yRadius > 0.0 && useRecursiveVertical) {
+        KisRecursiveGaussian::applyPass(device, device, rect, yRadius,
+                                        Qt::Vertical, channelFlags, progressUpdater);
+
     } else if (yRadius > 0.0) {
         KisConvolutionPainter painter(device);
         painter.setChannelFlags(channelFlags);
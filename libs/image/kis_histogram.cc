@@ -28,6 +28,17 @@
 #include "kis_debug.h"
 #include "kis_iterator_ng.h"
 
+namespace {
+
+/**
+ * The size of the cells of the incremental histogram. It is equal to the
+ * size of the tiles, so when the bounds start at the origin an update of
+ * a tile recounts a single cell
+ */
+const int cellSize = 64;
+
+}
+
 KisHistogram::KisHistogram(const KisPaintLayerSP layer,
                            KoHistogramProducer *producer,
                            const enumHistogramType type)
@@ -73,14 +84,22 @@ KisHistogram::~KisHistogram()
 
 void KisHistogram::updateHistogram()
 {
+    if (m_incremental) {
+        resetBins();
+        updateCells(m_bounds);
+        computeHistogram();
+        return;
+    }
+
     if (m_bounds.isEmpty()) {
         int numChannels = m_producer->channels().count();
 
         m_completeCalculations.clear();
         m_completeCalculations.resize(numChannels);
 
-        m_completeCalculations.clear();
-        m_completeCalculations.resize(numChannels);
+        m_selectionCalculations.clear();
+
+        resetBins();
 
         return;
     }
@@ -104,9 +123,120 @@ void KisHistogram::updateHistogram()
         m_producer->addRegionToBin(srcIt.oldRawData(), 0, numConseqPixels, cs);
     }
 
+    fetchProducerBins();
+    computeHistogram();
+}
+
+void KisHistogram::updateHistogram(const QRect &dirtyRect)
+{
+    if (!m_incremental) {
+        m_incremental = true;
+        updateHistogram();
+        return;
+    }
+
+    updateCells(dirtyRect);
     computeHistogram();
 }
 
+void KisHistogram::resetBins()
+{
+    m_numChannels = m_producer->channels().count();
+    m_numBins = m_producer->numberOfBins();
+
+    m_bins.fill(0, m_numChannels * m_numBins);
+    m_count = 0;
+
+    m_cellColumns = (m_bounds.width() + cellSize - 1) / cellSize;
+    const int cellRows = (m_bounds.height() + cellSize - 1) / cellSize;
+
+    m_cells.clear();
+    if (m_incremental) {
+        m_cells.resize(m_cellColumns * cellRows);
+    }
+}
+
+void KisHistogram::fetchProducerBins()
+{
+    resetBins();
+
+    for (int channel = 0; channel < m_numChannels; channel++) {
+        quint32 *bins = m_bins.data() + channel * m_numBins;
+
+        for (int bin = 0; bin < m_numBins; bin++) {
+            bins[bin] = m_producer->getBinAt(channel, bin);
+        }
+    }
+
+    m_count = m_producer->count();
+}
+
+void KisHistogram::updateCells(const QRect &rect)
+{
+    const QRect rc = rect & m_bounds;
+    if (rc.isEmpty()) return;
+
+    const KoColorSpace* cs = m_paintDevice->colorSpace();
+    const int binsSize = m_numChannels * m_numBins;
+
+    const int firstColumn = (rc.left() - m_bounds.left()) / cellSize;
+    const int lastColumn = (rc.right() - m_bounds.left()) / cellSize;
+    const int firstRow = (rc.top() - m_bounds.top()) / cellSize;
+    const int lastRow = (rc.bottom() - m_bounds.top()) / cellSize;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            const QRect cellRect =
+                QRect(m_bounds.left() + column * cellSize,
+                      m_bounds.top() + row * cellSize,
+                      cellSize, cellSize) & m_bounds;
+
+            m_producer->clear();
+
+            KisSequentialConstIterator srcIt(m_paintDevice, cellRect);
+
+            int numConseqPixels = srcIt.nConseqPixels();
+            while (srcIt.nextPixels(numConseqPixels)) {
+
+                numConseqPixels = srcIt.nConseqPixels();
+                m_producer->addRegionToBin(srcIt.oldRawData(), 0, numConseqPixels, cs);
+            }
+
+            Cell &cell = m_cells[row * m_cellColumns + column];
+            const quint16 newCount = m_producer->count();
+
+            if (!newCount && !cell.count) continue;
+
+            if (cell.bins.isEmpty()) {
+                cell.bins.fill(0, binsSize);
+            }
+
+            /**
+             * The totals are always the sums of the cells, so the
+             * unsigned arithmetic never actually wraps
+             */
+            for (int channel = 0; channel < m_numChannels; channel++) {
+                const int offset = channel * m_numBins;
+                quint32 *bins = m_bins.data() + offset;
+                quint16 *cellBins = cell.bins.data() + offset;
+
+                for (int bin = 0; bin < m_numBins; bin++) {
+                    const quint16 newValue = m_producer->getBinAt(channel, bin);
+                    bins[bin] += quint32(newValue) - quint32(cellBins[bin]);
+                    cellBins[bin] = newValue;
+                }
+            }
+
+            m_count += quint32(newCount) - quint32(cell.count);
+            cell.count = newCount;
+
+            if (!newCount) {
+                cell.bins = QVector<quint16>();
+            }
+        }
+    }
+}
+
 void KisHistogram::computeHistogram()
 {
     if (!m_producer) return;
@@ -157,7 +287,7 @@ KisHistogram::Calculations KisHistogram::calculateSingleRange(int channel, doubl
     double max = from, min = to, total = 0.0, mean = 0.0; //, median = 0.0, stddev = 0.0;
     quint32 high = 0, low = (quint32) - 1, count = 0;
 
-    if (m_producer->count() == 0) {
+    if (m_count == 0) {
         // We won't get anything, even if a range is specified
         // XXX make sure all initial '0' values are correct here!
         return c;
@@ -174,7 +304,7 @@ KisHistogram::Calculations KisHistogram::calculateSingleRange(int channel, doubl
 
     // Min, max, count, low, high
     for (qint32 i = fromBin; i < toBin; i++) {
-        current = m_producer->getBinAt(channel, i);
+        current = i >= 0 && i < m_numBins ? m_bins.at(channel * m_numBins + i) : 0;
         double pos = static_cast<double>(i) / factor + from;
         if (current > high)
             high = current;
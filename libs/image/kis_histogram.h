@@ -119,6 +119,23 @@ public:
     /** Updates the information in the producer */
     void updateHistogram();
 
+    /**
+     * Updates the histogram after the pixels inside \p dirtyRect have
+     * changed.
+     *
+     * On the first call the histogram of every 64x64 cell of the bounds
+     * is counted and stored. Later calls count only the cells that
+     * intersect \p dirtyRect and update the totals by subtracting the old
+     * counts of the cells and adding the new ones. After the first call
+     * updateHistogram() recounts all the cells, which is needed when the
+     * view of the producer changes.
+     *
+     * The counts of the cells take about 1/8 of the size of an 8-bit RGBA
+     * device. The producer keeps only the counts of the last cell, so use
+     * getValue() and count() to read the results.
+     */
+    void updateHistogram(const QRect &dirtyRect);
+
     /**
      * (Re)computes the mathematical information from the information currently in the producer.
      * Needs to be called when you change the selection and want to get that information
@@ -131,7 +148,12 @@ public:
     Calculations selectionCalculations();
 
     inline quint32 getValue(quint8 i) {
-        return m_producer->getBinAt(m_channel, i);
+        return m_bins.at(m_channel * m_numBins + i);
+    }
+
+    /// The number of the pixels counted in all the channels
+    inline quint32 count() const {
+        return m_count;
     }
 
     inline enumHistogramType getHistogramType() {
@@ -143,6 +165,8 @@ public:
     inline void setProducer(KoHistogramProducer *producer) {
         m_channel = 0;
         m_producer = producer;
+        m_incremental = false;
+        m_cells.clear();
     }
     inline void setChannel(qint32 channel) {
         Q_ASSERT(m_channel < m_completeCalculations.size());
@@ -179,6 +203,19 @@ private:
     QVector<Calculations> calculateForRange(double from, double to);
     Calculations calculateSingleRange(int channel, double from, double to);
 
+    void resetBins();
+    void fetchProducerBins();
+    void updateCells(const QRect &rect);
+
+    /**
+     * The counts of one cell of the incremental histogram. A cell has at
+     * most 4096 pixels, so 16 bits are enough for a bin.
+     */
+    struct Cell {
+        QVector<quint16> bins;
+        quint16 count = 0;
+    };
+
     const KisPaintDeviceSP m_paintDevice;
     QRect m_bounds;
     KoHistogramProducer *m_producer;
@@ -189,6 +226,15 @@ private:
     bool m_selection;
 
     QVector<Calculations> m_completeCalculations, m_selectionCalculations;
+
+    qint32 m_numChannels = 0;
+    qint32 m_numBins = 0;
+    QVector<quint32> m_bins;
+    quint32 m_count = 0;
+
+    bool m_incremental = false;
+    int m_cellColumns = 0;
+    QVector<Cell> m_cells;
 };
 
 
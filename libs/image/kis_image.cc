@@ -87,6 +87,7 @@
 #include "kis_layer_utils.h"
 
 #include "kis_lod_transform.h"
+#include "KisPaintDeviceMipmap.h"
 
 #include "kis_suspend_projection_updates_stroke_strategy.h"
 #include "kis_sync_lod_cache_stroke_strategy.h"
@@ -273,6 +274,30 @@ KisImage *KisImage::clone(bool exactCopy)
     return new KisImage(*this, 0, exactCopy);
 }
 
+KisImage *KisImage::cloneForRendering()
+{
+    KisImage *image = clone(true);
+
+    QQueue<KisNodeSP> linearizedNodes;
+    KisLayerUtils::recursiveApplyNodes(root(),
+        [&linearizedNodes](KisNodeSP node) {
+            linearizedNodes.enqueue(node);
+        });
+    KisLayerUtils::recursiveApplyNodes(image->root(),
+        [&linearizedNodes](KisNodeSP node) {
+            KisNodeSP refNode = linearizedNodes.dequeue();
+
+            KisPaintDeviceSP device = node->paintDevice();
+            KisPaintDeviceSP refDevice = refNode->paintDevice();
+
+            if (device && refDevice && device->keyframeChannel()) {
+                device->shareFramesLazily(refDevice);
+            }
+        });
+
+    return image;
+}
+
 KisImage::KisImage(const KisImage& rhs, KisUndoStore *undoStore, bool exactCopy)
     : KisNodeFacade(),
       KisNodeGraphListener(),
@@ -1207,12 +1232,31 @@ QImage KisImage::convertToQImage(const QSize& scaledImageSize, const KoColorProf
         return QImage();
     }
 
+    /**
+     * Start from the smallest level of the projection's mipmap that
+     * is still bigger than the requested size. It saves a lot of time
+     * on the bicubic filtering of huge images.
+     */
+    KisPaintDeviceMipmap *mipmap = projection()->mipmap();
+    const int levelIndex = mipmap->levelForSize(size(), scaledImageSize);
+    const int levelStep = 1 << levelIndex;
+
+    /**
+     * The level covers the image with (width() / levelStep) pixels, the
+     * last column (row) is only partially filled when the size is not
+     * divisible by the step. So the scale is calculated from the exact
+     * size of the image and the result is cropped to the requested size.
+     */
+    const QRect levelRect(0, 0,
+                          (width() + levelStep - 1) / levelStep,
+                          (height() + levelStep - 1) / levelStep);
+
     KisPaintDeviceSP dev = new KisPaintDevice(colorSpace());
     KisPainter gc;
-    gc.copyAreaOptimized(QPoint(0, 0), projection(), dev, bounds());
+    gc.copyAreaOptimized(QPoint(0, 0), mipmap->level(levelIndex), dev, levelRect);
     gc.end();
-    double scaleX = qreal(scaledImageSize.width()) / width();
-    double scaleY = qreal(scaledImageSize.height()) / height();
+    double scaleX = qreal(scaledImageSize.width()) * levelStep / width();
+    double scaleY = qreal(scaledImageSize.height()) * levelStep / height();
 
     QPointer<KoUpdater> updater = new KoDummyUpdater();
 
@@ -1221,6 +1265,10 @@ QImage KisImage::convertToQImage(const QSize& scaledImageSize, const KoColorProf
 
     delete updater;
 
+    if (levelIndex > 0) {
+        dev->crop(QRect(QPoint(), scaledImageSize));
+    }
+
     return dev->convertToQImage(profile);
 }
 void KisImage::notifyLayersChanged()
@@ -1652,6 +1700,14 @@ void KisImage::notifyProjectionUpdated(const QRect &rc)
 {
     KisUpdateTimeMonitor::instance()->reportUpdateFinished(rc);
 
+    /**
+     * The mipmap chain is built from the non-lod data of the
+     * projection, so the lod updates shouldn't touch it
+     */
+    if (!currentLevelOfDetail()) {
+        projection()->invalidateMipmap(rc);
+    }
+
     if (!m_d->disableUIUpdateSignals) {
         int lod = currentLevelOfDetail();
         QRect dirtyRect = !lod ? rc : KisLodTransform::upscaledRect(rc, lod);
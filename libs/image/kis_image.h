@@ -123,6 +123,19 @@ public:
      */
     KisImage *clone(bool exactCopy = false);
 
+    /**
+     * Makes an exact copy of the image for rendering of the animation
+     * frames. The keyframes of the layers of the clone are not copied
+     * until the clone accesses them (see KisPaintDevice::shareFramesLazily()),
+     * so every clone keeps only its projections and the frames it has
+     * actually rendered.
+     *
+     * WARNING: the layers of this image should not be modified while
+     *          the clone is in use, otherwise the changes of the frames
+     *          not yet accessed by the clone will appear in the clone.
+     */
+    KisImage *cloneForRendering();
+
     /**
      * Render the projection onto a QImage.
      */
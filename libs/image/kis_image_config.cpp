@@ -173,6 +173,56 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+QString KisImageConfig::swapCompression(bool requestDefault) const
+{
+    const QString defaultCompression = "LZF";
+
+    return !requestDefault ?
+        m_config.readEntry("swapCompression", defaultCompression) :
+        defaultCompression;
+}
+
+void KisImageConfig::setSwapCompression(const QString &value)
+{
+    m_config.writeEntry("swapCompression", value);
+}
+
+bool KisImageConfig::useMappedSwapFile(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("useMappedSwapFile", false) : false;
+}
+
+void KisImageConfig::setUseMappedSwapFile(bool value)
+{
+    m_config.writeEntry("useMappedSwapFile", value);
+}
+
+bool KisImageConfig::swapUncompressedTiles(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("swapUncompressedTiles", false) : false;
+}
+
+void KisImageConfig::setSwapUncompressedTiles(bool value)
+{
+    m_config.writeEntry("swapUncompressedTiles", value);
+}
+
+QString KisImageConfig::tileFileCompression(bool requestDefault) const
+{
+    const QString defaultCompression = "LZF";
+
+    return !requestDefault ?
+        m_config.readEntry("tileFileCompression", defaultCompression) :
+        defaultCompression;
+}
+
+void KisImageConfig::setTileFileCompression(const QString &value)
+{
+    m_config.writeEntry("tileFileCompression", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
@@ -538,6 +588,16 @@ void KisImageConfig::setUseOnDiskAnimationCacheSwapping(bool value)
     m_config.writeEntry("useOnDiskAnimationCacheSwapping", value);
 }
 
+bool KisImageConfig::useInMemoryAnimationCacheCompression(bool defaultValue) const
+{
+    return defaultValue ? true : m_config.readEntry("useInMemoryAnimationCacheCompression", true);
+}
+
+void KisImageConfig::setUseInMemoryAnimationCacheCompression(bool value)
+{
+    m_config.writeEntry("useInMemoryAnimationCacheCompression", value);
+}
+
 QString KisImageConfig::animationCacheDir(bool defaultValue) const
 {
     return safelyGetWritableTempLocation("animation_cache", "animationCacheDir", defaultValue);
@@ -58,6 +58,39 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    /**
+     * The algorithm used for compressing the tiles in the swap file.
+     * See KisTileCompressor2::supportedCompressions()
+     */
+    QString swapCompression(bool requestDefault = false) const;
+    void setSwapCompression(const QString &value);
+
+    /**
+     * Map the whole swap file into memory and let the kernel do the
+     * paging (see KisMappedSwapSpace) instead of sliding a small
+     * mapping window over it. Ignored on the platforms where it is
+     * not supported. Off by default, since the whole swap size has
+     * to be reserved in the address space of the process.
+     */
+    bool useMappedSwapFile(bool requestDefault = false) const;
+    void setUseMappedSwapFile(bool value);
+
+    /**
+     * Store the swapped tiles without any compression. Useful when
+     * the swap resides on a fast SSD.
+     */
+    bool swapUncompressedTiles(bool requestDefault = false) const;
+    void setSwapUncompressedTiles(bool value);
+
+    /**
+     * The algorithm used for compressing the tiles of the layers saved
+     * into .kra files. Anything but LZF makes the layers be saved with
+     * the tiles version 3, which older versions of Krita cannot read,
+     * so LZF is the default.
+     */
+    QString tileFileCompression(bool requestDefault = false) const;
+    void setTileFileCompression(const QString &value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
@@ -123,6 +156,9 @@ public:
     bool useOnDiskAnimationCacheSwapping(bool defaultValue = false) const;
     void setUseOnDiskAnimationCacheSwapping(bool value);
 
+    bool useInMemoryAnimationCacheCompression(bool defaultValue = false) const;
+    void setUseInMemoryAnimationCacheCompression(bool value);
+
     QString animationCacheDir(bool defaultValue = false) const;
     void setAnimationCacheDir(const QString &value);
 
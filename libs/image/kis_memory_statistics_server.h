@@ -46,6 +46,10 @@ public:
 
               swapSize(0),
 
+              prefetchedTiles(0),
+              prefetchHits(0),
+              prefetchMisses(0),
+
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
@@ -65,6 +69,10 @@ public:
 
         qint64 swapSize;
 
+        qint64 prefetchedTiles;
+        qint64 prefetchHits;
+        qint64 prefetchMisses;
+
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
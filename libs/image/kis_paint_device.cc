@@ -24,6 +24,7 @@
 #include <QImage>
 #include <QList>
 #include <QHash>
+#include <QAtomicInt>
 #include <QIODevice>
 #include <qmath.h>
 
@@ -63,6 +64,7 @@
 #include "kis_paint_device_cache.h"
 #include "kis_paint_device_data.h"
 #include "kis_paint_device_frames_interface.h"
+#include "KisPaintDeviceMipmap.h"
 
 #include "kis_transform_worker.h"
 #include "kis_filter_strategy.h"
@@ -105,6 +107,26 @@ public:
     QScopedPointer<KisPaintDeviceFramesInterface> framesInterface;
     bool isProjectionDevice;
 
+    QScopedPointer<KisPaintDeviceMipmap> mipmap;
+    QMutex mipmapLock;
+
+    void invalidateMipmap(const QRect &rc) {
+        // the chain is built from the non-lod data only
+        if (defaultBounds->currentLevelOfDetail()) return;
+
+        QMutexLocker l(&mipmapLock);
+        if (mipmap) {
+            mipmap->setDirty(rc);
+        }
+    }
+
+    void invalidateMipmap() {
+        QMutexLocker l(&mipmapLock);
+        if (mipmap) {
+            mipmap->setDirty();
+        }
+    }
+
     KisPaintDeviceStrategy* currentStrategy();
 
     void init(const KoColorSpace *cs, const quint8 *defaultPixel);
@@ -157,6 +179,9 @@ public:
             m_frames.clear();
         }
 
+        m_lazyFrames.clear();
+        m_hasLazyFrames.storeRelease(0);
+
         if (!copyFrames) {
             if (m_data) {
                 m_data->prepareClone(rhs->currentNonLodData(), true);
@@ -172,14 +197,9 @@ public:
                 m_data->prepareClone(rhs->m_data.data(), true);
             }
 
-            if (!rhs->m_frames.isEmpty()) {
-                FramesHash::const_iterator it = rhs->m_frames.constBegin();
-                FramesHash::const_iterator end = rhs->m_frames.constEnd();
-
-                for (; it != end; ++it) {
-                    DataSP data = toQShared(new KisPaintDeviceData(it.value().data(), true));
-                    m_frames.insert(it.key(), data);
-                }
+            Q_FOREACH (int frameId, rhs->frameIds()) {
+                DataSP data = toQShared(new KisPaintDeviceData(rhs->constFrameData(frameId).data(), true));
+                m_frames.insert(frameId, data);
             }
             m_nextFreeFrameId = rhs->m_nextFreeFrameId;
         }
@@ -212,16 +232,50 @@ public:
 
     KisDataManagerSP frameDataManager(int frameId) const
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = frameData(frameId);
         return data->dataManager();
     }
 
     void invalidateFrameCache(int frameId)
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = frameData(frameId);
         return data->cache()->invalidate();
     }
 
+    /**
+     * Returns the data of \p frameId that is going to be modified. If the
+     * frame is shared lazily with the source device, it is copied first.
+     */
+    DataSP frameData(int frameId) const
+    {
+        QMutexLocker l(m_hasLazyFrames.loadAcquire() ? &m_lazyFramesLock : 0);
+        materializeLazyFrameUnlocked(frameId);
+        return m_frames.value(frameId);
+    }
+
+    /**
+     * Returns the data of \p frameId for reading only. The frames shared
+     * lazily are not copied, the data of the source device is returned.
+     */
+    DataSP constFrameData(int frameId) const
+    {
+        QMutexLocker l(m_hasLazyFrames.loadAcquire() ? &m_lazyFramesLock : 0);
+        DataSP data = m_frames.value(frameId);
+        return data ? data : m_lazyFrames.value(frameId);
+    }
+
+    void materializeAllLazyFrames() const
+    {
+        if (!m_hasLazyFrames.loadAcquire()) return;
+
+        QMutexLocker l(&m_lazyFramesLock);
+        Q_FOREACH (int frameId, m_lazyFrames.keys()) {
+            materializeLazyFrameUnlocked(frameId);
+        }
+    }
+
+    void shareFramesLazily(Private *rhs);
+
 private:
     typedef KisPaintDeviceData Data;
     typedef QSharedPointer<Data> DataSP;
@@ -283,6 +337,8 @@ public:
             return -1;
         }
 
+        materializeAllLazyFrames();
+
         DataSP data;
         bool initialFrame = false;
 
@@ -325,6 +381,8 @@ public:
 
     void deleteFrame(int frame, KUndo2Command *parentCommand)
     {
+        materializeAllLazyFrames();
+
         KIS_ASSERT_RECOVER_RETURN(m_frames.contains(frame));
         KIS_ASSERT_RECOVER_RETURN(parentCommand);
 
@@ -340,7 +398,7 @@ public:
 
     QRect frameBounds(int frameId)
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = constFrameData(frameId);
 
         QRect extent = data->dataManager()->extent();
         extent.translate(data->x(), data->y());
@@ -350,26 +408,27 @@ public:
 
     QPoint frameOffset(int frameId) const
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = constFrameData(frameId);
         return QPoint(data->x(), data->y());
     }
 
     void setFrameOffset(int frameId, const QPoint &offset)
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = frameData(frameId);
         data->setX(offset.x());
         data->setY(offset.y());
     }
 
     const QList<int> frameIds() const
     {
-        return m_frames.keys();
+        QMutexLocker l(m_hasLazyFrames.loadAcquire() ? &m_lazyFramesLock : 0);
+        return m_frames.keys() + m_lazyFrames.keys();
     }
 
     bool readFrame(QIODevice *stream, int frameId)
     {
         bool retval = false;
-        DataSP data = m_frames[frameId];
+        DataSP data = frameData(frameId);
         retval = data->dataManager()->read(stream);
         data->cache()->invalidate();
         return retval;
@@ -377,13 +436,13 @@ public:
 
     bool writeFrame(KisPaintDeviceWriter &store, int frameId)
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = constFrameData(frameId);
         return data->dataManager()->write(store);
     }
 
     void setFrameDefaultPixel(const KoColor &defPixel, int frameId)
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = frameData(frameId);
         KoColor color(defPixel);
         color.convertTo(data->colorSpace());
         data->dataManager()->setDefaultPixel(color.data());
@@ -391,7 +450,7 @@ public:
 
     KoColor frameDefaultPixel(int frameId) const
     {
-        DataSP data = m_frames[frameId];
+        DataSP data = constFrameData(frameId);
         return KoColor(data->dataManager()->defaultPixel(),
                        data->colorSpace());
     }
@@ -412,6 +471,9 @@ public:
                               const QRect &originalRect, int lod);
 
     void generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod);
+    bool updateLodDataFromMipmap(Data *srcData, Data *lodData, const QRect &originalRect);
+
+    KisPaintDeviceSP mipmapLevelForThumbnail(QRect *imageRect, const QSize &thumbnailSize);
 
     void tesingFetchLodDevice(KisPaintDeviceSP targetDevice);
 
@@ -441,6 +503,7 @@ public:
             temporaryData += estimateDataSize(m_externalFrameData.data());
         }
 
+        // the frames shared lazily belong to the source device
         Q_FOREACH (DataSP value, m_frames.values()) {
             imageData += estimateDataSize(value.data());
         }
@@ -451,6 +514,25 @@ private:
 
     QRegion syncWholeDevice(Data *srcData);
 
+    /**
+     * Should be called with m_lazyFramesLock held
+     */
+    void materializeLazyFrameUnlocked(int frameId) const
+    {
+        FramesHash::iterator it = m_lazyFrames.find(frameId);
+        if (it == m_lazyFrames.end()) return;
+
+        DataSP data = toQShared(new Data(q));
+        data->prepareClone(it.value().data(), true);
+
+        m_frames.insert(frameId, data);
+        m_lazyFrames.erase(it);
+
+        if (m_lazyFrames.isEmpty()) {
+            m_hasLazyFrames.storeRelease(0);
+        }
+    }
+
     inline DataSP currentFrameData() const
     {
         DataSP data;
@@ -463,12 +545,15 @@ private:
             if (frameId == -1) {
                 data = m_data;
             } else {
-                KIS_ASSERT_RECOVER(m_frames.contains(frameId)) {
+                data = frameData(frameId);
+
+                KIS_ASSERT_RECOVER(data) {
+                    materializeAllLazyFrames();
                     return m_frames.begin().value();
                 }
-                data = m_frames[frameId];
             }
         } else if (numberOfFrames == 1) {
+            materializeAllLazyFrames();
             data = m_frames.begin().value();
         } else {
             data = m_data;
@@ -538,6 +623,8 @@ private:
 
     QList<Data*> allDataObjects() const
     {
+        materializeAllLazyFrames();
+
         QList<Data*> dataObjects;
 
         if (m_frames.isEmpty()) {
@@ -568,8 +655,17 @@ private:
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
-    FramesHash m_frames;
+    mutable FramesHash m_frames;
     int m_nextFreeFrameId;
+
+    /**
+     * The frames of the source device that have not been accessed yet,
+     * see KisPaintDevice::shareFramesLazily(). They are moved into
+     * m_frames when accessed for the first time.
+     */
+    mutable FramesHash m_lazyFrames;
+    mutable QMutex m_lazyFramesLock;
+    mutable QAtomicInt m_hasLazyFrames;
 };
 
 const KisDefaultBoundsSP KisPaintDevice::Private::transitionalDefaultBounds = new KisDefaultBounds();
@@ -796,6 +892,8 @@ void KisPaintDevice::Private::updateLodDataStruct(LodDataStruct *_dst, const QRe
 
     const int lod = lodData->levelOfDetail();
 
+    if (updateLodDataFromMipmap(srcData, lodData, originalRect)) return;
+
     updateLodDataManager(srcData->dataManager().data(), lodData->dataManager().data(),
                          QPoint(srcData->x(), srcData->y()),
                          QPoint(lodData->x(), lodData->y()),
@@ -813,6 +911,48 @@ void KisPaintDevice::Private::generateLodCloneDevice(KisPaintDeviceSP dst, const
                          originalRect, lod);
 }
 
+bool KisPaintDevice::Private::updateLodDataFromMipmap(Data *srcData, Data *lodData, const QRect &originalRect)
+{
+    /**
+     * If the device has a mipmap chain (the image projection usually
+     * has one), the downsampled data is already present there, so we
+     * can just copy it instead of downsampling everything once again.
+     * The chain knows nothing about the frames and offsets, so use
+     * it only for the simplest case.
+     */
+    const int lod = lodData->levelOfDetail();
+
+    if (!mipmap ||
+        lod >= mipmap->numLevels() ||
+        srcData != m_data.data() ||
+        srcData->x() || srcData->y() ||
+        lodData->x() || lodData->y()) {
+
+        return false;
+    }
+
+    if (*srcData->colorSpace() != *lodData->colorSpace()) return false;
+
+    const QRect lodRect = KisPaintDeviceMipmap::scaledRect(originalRect, lod);
+    return mipmap->copyLevelRect(lod, lodRect, lodData->dataManager().data());
+}
+
+KisPaintDeviceSP KisPaintDevice::Private::mipmapLevelForThumbnail(QRect *imageRect, const QSize &thumbnailSize)
+{
+    if (!mipmap ||
+        currentData() != m_data.data() ||
+        m_data->x() || m_data->y()) {
+
+        return 0;
+    }
+
+    const int index = mipmap->levelForSize(imageRect->size(), thumbnailSize);
+    if (!index) return 0;
+
+    *imageRect = KisPaintDeviceMipmap::scaledRect(*imageRect, index);
+    return mipmap->level(index);
+}
+
 void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 {
     LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
@@ -836,18 +976,40 @@ void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targ
     targetDevice->m_d->currentStrategy()->fastBitBltRough(data->dataManager(), extent);
 }
 
+void KisPaintDevice::Private::shareFramesLazily(Private *rhs)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(contentChannel && rhs->contentChannel);
+
+    // the current frame is needed right away anyway
+    const int currentId = currentFrameId();
+
+    QMutexLocker l(&m_lazyFramesLock);
+
+    Q_FOREACH (int frameId, m_frames.keys()) {
+        if (frameId == currentId) continue;
+
+        DataSP srcData = rhs->constFrameData(frameId);
+        if (!srcData) continue;
+
+        m_frames.remove(frameId);
+        m_lazyFrames.insert(frameId, srcData);
+    }
+
+    m_hasLazyFrames.storeRelease(!m_lazyFrames.isEmpty());
+}
+
 void KisPaintDevice::Private::fetchFrame(int frameId, KisPaintDeviceSP targetDevice)
 {
-    DataSP data = m_frames[frameId];
+    DataSP data = constFrameData(frameId);
     transferFromData(data.data(), targetDevice);
 }
 
 void KisPaintDevice::Private::uploadFrame(int srcFrameId, int dstFrameId, KisPaintDeviceSP srcDevice)
 {
-    DataSP dstData = m_frames[dstFrameId];
+    DataSP dstData = frameData(dstFrameId);
     KIS_ASSERT_RECOVER_RETURN(dstData);
 
-    DataSP srcData = srcDevice->m_d->m_frames[srcFrameId];
+    DataSP srcData = srcDevice->m_d->constFrameData(srcFrameId);
     KIS_ASSERT_RECOVER_RETURN(srcData);
 
     uploadFrameData(srcData, dstData);
@@ -855,7 +1017,7 @@ void KisPaintDevice::Private::uploadFrame(int srcFrameId, int dstFrameId, KisPai
 
 void KisPaintDevice::Private::uploadFrame(int dstFrameId, KisPaintDeviceSP srcDevice)
 {
-    DataSP dstData = m_frames[dstFrameId];
+    DataSP dstData = frameData(dstFrameId);
     KIS_ASSERT_RECOVER_RETURN(dstData);
 
     DataSP srcData = srcDevice->m_d->m_data;
@@ -1065,9 +1227,17 @@ void KisPaintDevice::setProjectionDevice(bool value)
 void KisPaintDevice::prepareClone(KisPaintDeviceSP src)
 {
     m_d->prepareClone(src);
+    m_d->invalidateMipmap();
     Q_ASSERT(fastBitBltPossible(src));
 }
 
+void KisPaintDevice::shareFramesLazily(KisPaintDeviceSP src)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(src && src != this);
+
+    m_d->shareFramesLazily(src->m_d);
+}
+
 void KisPaintDevice::makeCloneFrom(KisPaintDeviceSP src, const QRect &rect)
 {
     prepareClone(src);
@@ -1093,6 +1263,7 @@ void KisPaintDevice::makeCloneFromRough(KisPaintDeviceSP src, const QRect &minim
 void KisPaintDevice::setDirty()
 {
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap();
     if (m_d->parent.isValid())
         m_d->parent->setDirty();
 }
@@ -1100,6 +1271,7 @@ void KisPaintDevice::setDirty()
 void KisPaintDevice::setDirty(const QRect & rc)
 {
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap(rc);
     if (m_d->parent.isValid())
         m_d->parent->setDirty(rc);
 }
@@ -1107,6 +1279,7 @@ void KisPaintDevice::setDirty(const QRect & rc)
 void KisPaintDevice::setDirty(const QRegion & region)
 {
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap(region.boundingRect());
     if (m_d->parent.isValid())
         m_d->parent->setDirty(region);
 }
@@ -1114,6 +1287,9 @@ void KisPaintDevice::setDirty(const QRegion & region)
 void KisPaintDevice::setDirty(const QVector<QRect> rects)
 {
     m_d->cache()->invalidate();
+    Q_FOREACH (const QRect &rc, rects) {
+        m_d->invalidateMipmap(rc);
+    }
     if (m_d->parent.isValid())
         m_d->parent->setDirty(rects);
 }
@@ -1161,6 +1337,7 @@ void KisPaintDevice::moveTo(const QPoint &pt)
 {
     m_d->currentStrategy()->move(pt);
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap();
 }
 
 QPoint KisPaintDevice::offset() const
@@ -1441,6 +1618,7 @@ void KisPaintDevice::crop(qint32 x, qint32 y, qint32 w, qint32 h)
 void KisPaintDevice::crop(const QRect &rect)
 {
     m_d->currentStrategy()->crop(rect);
+    m_d->invalidateMipmap();
 }
 
 void KisPaintDevice::purgeDefaultPixels()
@@ -1449,6 +1627,38 @@ void KisPaintDevice::purgeDefaultPixels()
     dm->purge(dm->extent());
 }
 
+void KisPaintDevice::prefetchTiles(const QRect &rc) const
+{
+    m_d->dataManager()->prefetchTiles(rc.translated(-m_d->x(), -m_d->y()));
+}
+
+KisPaintDeviceMipmap* KisPaintDevice::mipmap() const
+{
+    QMutexLocker l(&m_d->mipmapLock);
+
+    if (!m_d->mipmap) {
+        m_d->mipmap.reset(new KisPaintDeviceMipmap(const_cast<KisPaintDevice*>(this)));
+    }
+
+    return m_d->mipmap.data();
+}
+
+bool KisPaintDevice::hasMipmap() const
+{
+    QMutexLocker l(&m_d->mipmapLock);
+    return !m_d->mipmap.isNull();
+}
+
+void KisPaintDevice::invalidateMipmap(const QRect &rc)
+{
+    m_d->invalidateMipmap(rc);
+}
+
+void KisPaintDevice::invalidateCache()
+{
+    m_d->cache()->invalidate();
+}
+
 void KisPaintDevice::setDefaultPixel(const KoColor &defPixel)
 {
     KoColor color(defPixel);
@@ -1456,6 +1666,7 @@ void KisPaintDevice::setDefaultPixel(const KoColor &defPixel)
 
     m_d->dataManager()->setDefaultPixel(color.data());
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap();
 }
 
 KoColor KisPaintDevice::defaultPixel() const
@@ -1467,22 +1678,26 @@ void KisPaintDevice::clear()
 {
     m_d->dataManager()->clear();
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap();
 }
 
 void KisPaintDevice::clear(const QRect & rc)
 {
     m_d->currentStrategy()->clear(rc);
+    m_d->invalidateMipmap(rc);
 }
 
 void KisPaintDevice::fill(const QRect & rc, const KoColor &color)
 {
     KIS_ASSERT_RECOVER_RETURN(*color.colorSpace() == *colorSpace());
     m_d->currentStrategy()->fill(rc, color.data());
+    m_d->invalidateMipmap(rc);
 }
 
 void KisPaintDevice::fill(qint32 x, qint32 y, qint32 w, qint32 h, const quint8 *fillPixel)
 {
     m_d->currentStrategy()->fill(QRect(x, y, w, h), fillPixel);
+    m_d->invalidateMipmap(QRect(x, y, w, h));
 }
 
 
@@ -1497,6 +1712,7 @@ bool KisPaintDevice::read(QIODevice *stream)
 
     retval = m_d->dataManager()->read(stream);
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap();
 
     return retval;
 }
@@ -1514,6 +1730,7 @@ void KisPaintDevice::emitProfileChanged()
 KUndo2Command* KisPaintDevice::convertTo(const KoColorSpace * dstColorSpace, KoColorConversionTransformation::Intent renderingIntent, KoColorConversionTransformation::ConversionFlags conversionFlags)
 {
     KUndo2Command *command = m_d->convertColorSpace(dstColorSpace, renderingIntent, conversionFlags);
+    m_d->invalidateMipmap();
     return command;
 }
 
@@ -1681,7 +1898,13 @@ KisPaintDeviceSP KisPaintDevice::createThumbnailDevice(qint32 w, qint32 h, QRect
         outputRect = QRect(0, 0, w, h);
     }
 
-    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(this, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
+    const KisPaintDevice *srcDevice = this;
+    KisPaintDeviceSP mipmapLevel = m_d->mipmapLevelForThumbnail(&imageRect, thumbnailSize);
+    if (mipmapLevel) {
+        srcDevice = mipmapLevel.data();
+    }
+
+    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(srcDevice, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
                                  thumbnailSize.width(), thumbnailSize.height(), outputRect);
 
     return thumbnail;
@@ -1719,7 +1942,13 @@ KisPaintDeviceSP KisPaintDevice::createThumbnailDeviceOversampled(qint32 w, qint
         outputRect = outputRect.intersected(outputTileRect);
     }
 
-    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(this, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
+    const KisPaintDevice *srcDevice = this;
+    KisPaintDeviceSP mipmapLevel = m_d->mipmapLevelForThumbnail(&imageRect, thumbnailOversampledSize);
+    if (mipmapLevel) {
+        srcDevice = mipmapLevel.data();
+    }
+
+    KisPaintDeviceSP thumbnail = createThumbnailDeviceInternal(srcDevice, imageRect.x(), imageRect.y(), imageRect.width(), imageRect.height(),
                                  thumbnailOversampledSize.width(), thumbnailOversampledSize.height(), outputRect);
 
     if (oversample != 1. && oversampleAdjusted != 1.) {
@@ -1858,6 +2087,7 @@ bool KisPaintDevice::setPixel(qint32 x, qint32 y, const QColor& c)
 
     colorSpace()->fromQColor(c, iter->rawData());
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap(QRect(x, y, 1, 1));
     return true;
 }
 
@@ -1874,6 +2104,7 @@ bool KisPaintDevice::setPixel(qint32 x, qint32 y, const KoColor& kc)
         memcpy(iter->rawData(), pix, m_d->colorSpace()->pixelSize());
     }
     m_d->cache()->invalidate();
+    m_d->invalidateMipmap(QRect(x, y, 1, 1));
     return true;
 }
 
@@ -1885,21 +2116,25 @@ bool KisPaintDevice::fastBitBltPossible(KisPaintDeviceSP src)
 void KisPaintDevice::fastBitBlt(KisPaintDeviceSP src, const QRect &rect)
 {
     m_d->currentStrategy()->fastBitBlt(src, rect);
+    m_d->invalidateMipmap(rect);
 }
 
 void KisPaintDevice::fastBitBltOldData(KisPaintDeviceSP src, const QRect &rect)
 {
     m_d->currentStrategy()->fastBitBltOldData(src, rect);
+    m_d->invalidateMipmap(rect);
 }
 
 void KisPaintDevice::fastBitBltRough(KisPaintDeviceSP src, const QRect &rect)
 {
     m_d->currentStrategy()->fastBitBltRough(src, rect);
+    m_d->invalidateMipmap(rect);
 }
 
 void KisPaintDevice::fastBitBltRoughOldData(KisPaintDeviceSP src, const QRect &rect)
 {
     m_d->currentStrategy()->fastBitBltRoughOldData(src, rect);
+    m_d->invalidateMipmap(rect);
 }
 
 void KisPaintDevice::readBytes(quint8 * data, qint32 x, qint32 y, qint32 w, qint32 h) const
@@ -1920,6 +2155,7 @@ void KisPaintDevice::writeBytes(const quint8 *data, qint32 x, qint32 y, qint32 w
 void KisPaintDevice::writeBytes(const quint8 *data, const QRect &rect)
 {
     m_d->currentStrategy()->writeBytes(data, rect);
+    m_d->invalidateMipmap(rect);
 }
 
 QVector<quint8*> KisPaintDevice::readPlanarBytes(qint32 x, qint32 y, qint32 w, qint32 h) const
@@ -1930,6 +2166,7 @@ QVector<quint8*> KisPaintDevice::readPlanarBytes(qint32 x, qint32 y, qint32 w, q
 void KisPaintDevice::writePlanarBytes(QVector<quint8*> planes, qint32 x, qint32 y, qint32 w, qint32 h)
 {
     m_d->currentStrategy()->writePlanarBytes(planes, x, y, w, h);
+    m_d->invalidateMipmap(QRect(x, y, w, h));
 }
 
 
@@ -51,6 +51,7 @@ class KisKeyframe;
 class KisRasterKeyframeChannel;
 
 class KisPaintDeviceFramesInterface;
+class KisPaintDeviceMipmap;
 
 typedef KisSharedPtr<KisDataManager> KisDataManagerSP;
 
@@ -288,6 +289,48 @@ public:
      */
     void purgeDefaultPixels();
 
+    /**
+     * Starts asynchronous loading of the tiles in \p rc from swap. It
+     * is a hint for the tiles engine, that the area is going to be
+     * accessed soon, e.g. by the brush moving in that direction. The
+     * call is cheap when nothing is swapped out.
+     */
+    void prefetchTiles(const QRect &rc) const;
+
+    /**
+     * Returns the chain of downsampled copies of the device. The chain
+     * is created on the first call and then stays attached to the
+     * device. The changes made through the methods of the device are
+     * passed to the chain automatically. The pixels written through
+     * the iterators and painters should be reported with setDirty()
+     * or invalidateMipmap().
+     *
+     * Thumbnail generation automatically starts from the smallest
+     * suitable level of the chain, if the chain is present.
+     */
+    KisPaintDeviceMipmap* mipmap() const;
+
+    /**
+     * \return true if the mipmap chain has already been created for
+     * the device
+     */
+    bool hasMipmap() const;
+
+    /**
+     * Marks \p rc of the mipmap chain as dirty. Does nothing if the
+     * device has no mipmap attached. Unlike setDirty(), doesn't notify
+     * the parent node, so it can be used for the projections.
+     */
+    void invalidateMipmap(const QRect &rc);
+
+    /**
+     * Drops the cached exact bounds, thumbnails and the like. Unlike
+     * setDirty(), doesn't notify the parent node, so it can be used when
+     * the pixels are written with writeBytes() and the owner reports the
+     * change to the node itself.
+     */
+    void invalidateCache();
+
     /**
      * Sets the default pixel. New data will be initialised with this pixel. The pixel is copied: the
      * caller still owns the pointer and needs to delete it to avoid memory leaks.
@@ -354,6 +397,24 @@ public:
      */
     void makeCloneFromRough(KisPaintDeviceSP src, const QRect &minimalRect);
 
+    /**
+     * Makes the animation frames of the device, except the current one,
+     * refer to the corresponding frames of \a src instead of keeping
+     * their own copies. Such a frame is copied (with the tiles shared
+     * copy-on-write, like in the copy constructor) only when it is
+     * accessed for the first time, so the frames which are never
+     * accessed through this device cost nothing.
+     *
+     * The device should be a copy of \a src made with
+     * KritaUtils::CopyAllFrames, so that the frame ids match. Writing
+     * into the device never changes \a src.
+     *
+     * WARNING: the changes made to the frames of \a src before they are
+     *          copied will appear in this device as well, so \a src
+     *          should not be modified while the device is in use.
+     */
+    void shareFramesLazily(KisPaintDeviceSP src);
+
 
 protected:
     friend class KisPaintDeviceTest;
@@ -21,14 +21,25 @@
 
 #include "kis_perspectivetransform_worker.h"
 
+#include <functional>
+
+#include <QAtomicInt>
 #include <QMatrix4x4>
+#include <QThreadPool>
+#include <QtMath>
 #include <QTransform>
 #include <QVector3D>
 #include <QPolygonF>
 
 #include <KoUpdater.h>
 #include <KoColor.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceMaths.h>
 #include <KoCompositeOpRegistry.h>
+#include <KoMixColorsOp.h>
+
+#include <KisSharedRunnable.h>
+#include <KisSharedThreadPoolAdapter.h>
 
 #include "kis_paint_device.h"
 #include "kis_perspective_math.h"
@@ -40,6 +51,320 @@
 #include "kis_progress_update_helper.h"
 #include "kis_painter.h"
 #include "kis_image.h"
+#include "kis_algebra_2d.h"
+
+namespace {
+
+/**
+ * The destination is processed in square cells aligned to the tiles of
+ * the device, so two threads never write into the same tile
+ */
+const int cellSize = 256;
+
+/**
+ * Same as Q_NEAR_CLIP in QTransform::map()
+ */
+const qreal nearClip = 0.000001;
+
+/**
+ * Maps a row of the destination pixels into the source space. The result
+ * is bit-exact with QTransform::map(), but the transform type is checked
+ * once per row, not once per pixel.
+ */
+void mapRow(const QTransform &t, int x0, int y, int width, QPointF *points)
+{
+    const qreal fy = y;
+
+    if (t.type() < QTransform::TxProject) {
+        for (int i = 0; i < width; i++) {
+            const qreal fx = x0 + i;
+            points[i] = QPointF(t.m11() * fx + t.m21() * fy + t.dx(),
+                                t.m12() * fx + t.m22() * fy + t.dy());
+        }
+    } else {
+        for (int i = 0; i < width; i++) {
+            const qreal fx = x0 + i;
+            const qreal nx = t.m11() * fx + t.m21() * fy + t.dx();
+            const qreal ny = t.m12() * fx + t.m22() * fy + t.dy();
+
+            qreal w = t.m13() * fx + t.m23() * fy + t.m33();
+            if (w < nearClip) w = nearClip;
+            w = 1.0 / w;
+
+            points[i] = QPointF(nx * w, ny * w);
+        }
+    }
+}
+
+/**
+ * Mixes the four neighbours of the sampled point using the generic
+ * KoMixColorsOp of the color space
+ */
+struct GenericMixPolicy
+{
+    GenericMixPolicy(const KoColorSpace *cs)
+        : m_mixOp(cs->mixColorsOp())
+    {
+    }
+
+    inline void mix(const quint8 * const *pixels, const qint16 *weights, quint8 *dst) const {
+        m_mixOp->mixColors(pixels, weights, 4, dst);
+    }
+
+private:
+    const KoMixColorsOp *m_mixOp;
+};
+
+/**
+ * An inlined version of KoMixColorsOpImpl for four-channel integer RGBA
+ * color spaces. It gives exactly the same result as the generic version,
+ * but avoids a virtual call per pixel and lets the compiler unroll and
+ * vectorize the per-channel loops.
+ */
+template <typename channels_type>
+struct RgbaMixPolicy
+{
+    typedef typename KoColorSpaceMathsTraits<channels_type>::compositetype composite_type;
+
+    RgbaMixPolicy(const KoColorSpace *)
+    {
+    }
+
+    inline void mix(const quint8 * const *pixels, const qint16 *weights, quint8 *dst) const {
+        const composite_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
+        const composite_type maxValue = KoColorSpaceMathsTraits<channels_type>::max;
+        const composite_type minValue = KoColorSpaceMathsTraits<channels_type>::min;
+        const int alphaPos = 3;
+
+        composite_type totals[4] = {0, 0, 0, 0};
+        composite_type totalAlpha = 0;
+
+        for (int i = 0; i < 4; i++) {
+            const channels_type *color = reinterpret_cast<const channels_type*>(pixels[i]);
+            const composite_type alphaTimesWeight = composite_type(color[alphaPos]) * weights[i];
+
+            for (int ch = 0; ch < alphaPos; ch++) {
+                totals[ch] += color[ch] * alphaTimesWeight;
+            }
+
+            totalAlpha += alphaTimesWeight;
+        }
+
+        const int sumOfWeights = 255;
+        totalAlpha = qMin(totalAlpha, unitValue * sumOfWeights);
+
+        channels_type *dstColor = reinterpret_cast<channels_type*>(dst);
+
+        if (totalAlpha > 0) {
+            for (int ch = 0; ch < alphaPos; ch++) {
+                dstColor[ch] = qBound(minValue, totals[ch] / totalAlpha, maxValue);
+            }
+            dstColor[alphaPos] = totalAlpha / sumOfWeights;
+        } else {
+            memset(dst, 0, 4 * sizeof(channels_type));
+        }
+    }
+};
+
+/**
+ * Resamples \p region of \p dstDev from \p srcDev. The sampling is the
+ * same as KisRandomSubAccessor::sampledOldRawData() does, but the
+ * destination pixels are written in contiguous runs and the source
+ * coordinates are calculated for a row at once.
+ */
+template <class MixPolicy>
+void transformRegion(KisPaintDeviceSP srcDev,
+                     KisPaintDeviceSP dstDev,
+                     const QRectF &srcClipRect,
+                     const QTransform &backwardTransform,
+                     const QRegion &region)
+{
+    const MixPolicy mixPolicy(srcDev->colorSpace());
+    const int pixelSize = dstDev->pixelSize();
+
+    KisRandomConstAccessorSP srcAcc = srcDev->createRandomConstAccessorNG(0, 0);
+    KisRandomAccessorSP dstAcc = dstDev->createRandomAccessorNG(0, 0);
+
+    QVector<QPointF> points;
+
+    const quint8 *pixels[4];
+    qint16 weights[4];
+
+    Q_FOREACH (const QRect &rect, region.rects()) {
+        points.resize(rect.width());
+
+        for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
+            mapRow(backwardTransform, rect.x(), y, rect.width(), points.data());
+
+            quint8 *dstRunPtr = 0;
+            int dstRunStart = rect.x();
+            int dstRunEnd = rect.x();
+
+            for (int i = 0; i < rect.width(); i++) {
+                const QPointF &srcPoint = points[i];
+                if (!srcClipRect.contains(srcPoint)) continue;
+
+                const int x = rect.x() + i;
+
+                if (x >= dstRunEnd) {
+                    dstAcc->moveTo(x, y);
+                    dstRunPtr = dstAcc->rawData();
+                    dstRunStart = x;
+                    dstRunEnd = x + dstAcc->numContiguousColumns(x);
+                }
+
+                quint8 *dstPtr = dstRunPtr + (x - dstRunStart) * pixelSize;
+
+                const int srcX = qFloor(srcPoint.x());
+                const int srcY = qFloor(srcPoint.y());
+                const qreal hsub = srcPoint.x() - srcX;
+                const qreal vsub = srcPoint.y() - srcY;
+
+                weights[0] = qRound((1.0 - hsub) * (1.0 - vsub) * 255);
+                weights[1] = qRound((1.0 - vsub) * hsub * 255);
+                weights[2] = qRound(vsub * (1.0 - hsub) * 255);
+                weights[3] = qRound(hsub * vsub * 255);
+
+                const bool rightNeighbourIsContiguous = srcAcc->numContiguousColumns(srcX) > 1;
+
+                srcAcc->moveTo(srcX, srcY);
+                pixels[0] = srcAcc->oldRawData();
+
+                if (rightNeighbourIsContiguous) {
+                    pixels[1] = pixels[0] + pixelSize;
+                } else {
+                    srcAcc->moveTo(srcX + 1, srcY);
+                    pixels[1] = srcAcc->oldRawData();
+                }
+
+                srcAcc->moveTo(srcX, srcY + 1);
+                pixels[2] = srcAcc->oldRawData();
+
+                if (rightNeighbourIsContiguous) {
+                    pixels[3] = pixels[2] + pixelSize;
+                } else {
+                    srcAcc->moveTo(srcX + 1, srcY + 1);
+                    pixels[3] = srcAcc->oldRawData();
+                }
+
+                mixPolicy.mix(pixels, weights, dstPtr);
+            }
+        }
+    }
+}
+
+typedef void (*TransformRegionFunc)(KisPaintDeviceSP,
+                                    KisPaintDeviceSP,
+                                    const QRectF&,
+                                    const QTransform&,
+                                    const QRegion&);
+
+TransformRegionFunc transformRegionFunc(const KoColorSpace *cs)
+{
+    if (cs->colorModelId() == RGBAColorModelID) {
+        if (cs->colorDepthId() == Integer8BitsColorDepthID) {
+            return &transformRegion<RgbaMixPolicy<quint8>>;
+        } else if (cs->colorDepthId() == Integer16BitsColorDepthID) {
+            return &transformRegion<RgbaMixPolicy<quint16>>;
+        }
+    }
+
+    return &transformRegion<GenericMixPolicy>;
+}
+
+class TransformCellsRunnable : public KisSharedRunnable
+{
+public:
+    TransformCellsRunnable(std::function<void()> func)
+        : m_func(func)
+    {
+    }
+
+    void runShared() override {
+        m_func();
+    }
+
+private:
+    std::function<void()> m_func;
+};
+
+/**
+ * Splits \p region into tile-aligned cells and transforms them in
+ * parallel. The calling thread always takes part in the work and only
+ * the idle threads of the global pool help it, so the transformation
+ * never waits for a busy pool (e.g. when called from a stroke job).
+ */
+void transformRegionInParallel(KisPaintDeviceSP srcDev,
+                               KisPaintDeviceSP dstDev,
+                               const QRectF &srcClipRect,
+                               const QTransform &backwardTransform,
+                               const QRegion &region,
+                               KoUpdaterPtr progressUpdater)
+{
+    QVector<QRegion> cells;
+
+    const QRect bounds = region.boundingRect();
+    const int firstCol = KisAlgebra2D::divideFloor(bounds.left(), cellSize);
+    const int lastCol = KisAlgebra2D::divideFloor(bounds.right(), cellSize);
+    const int firstRow = KisAlgebra2D::divideFloor(bounds.top(), cellSize);
+    const int lastRow = KisAlgebra2D::divideFloor(bounds.bottom(), cellSize);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            const QRegion cell = region & QRect(col * cellSize, row * cellSize, cellSize, cellSize);
+            if (!cell.isEmpty()) {
+                cells.append(cell);
+            }
+        }
+    }
+
+    const int numCells = cells.size();
+    if (!numCells) return;
+
+    const TransformRegionFunc func = transformRegionFunc(srcDev->colorSpace());
+
+    QAtomicInt nextCell(0);
+    QAtomicInt numDoneCells(0);
+
+    auto processCells = [&] () {
+        int i;
+        while ((i = nextCell.fetchAndAddOrdered(1)) < numCells) {
+            func(srcDev, dstDev, srcClipRect, backwardTransform, cells[i]);
+            numDoneCells.ref();
+        }
+    };
+
+    KisSharedThreadPoolAdapter adapter(QThreadPool::globalInstance());
+
+    for (int i = 1; i < numCells; i++) {
+        TransformCellsRunnable *runnable = new TransformCellsRunnable(processCells);
+        if (!adapter.tryStart(runnable)) {
+            delete runnable;
+            break;
+        }
+    }
+
+    /**
+     * The progress updater is not thread-safe, so only the calling
+     * thread reports the progress
+     */
+    KisProgressUpdateHelper progressHelper(progressUpdater, 100, numCells);
+    int numReportedCells = 0;
+
+    int i;
+    while ((i = nextCell.fetchAndAddOrdered(1)) < numCells) {
+        func(srcDev, dstDev, srcClipRect, backwardTransform, cells[i]);
+        numDoneCells.ref();
+
+        for (const int numDone = numDoneCells.load(); numReportedCells < numDone; numReportedCells++) {
+            progressHelper.step();
+        }
+    }
+
+    adapter.waitForDone();
+}
+
+}
 
 
 KisPerspectiveTransformWorker::KisPerspectiveTransformWorker(KisPaintDeviceSP dev, QPointF center, double aX, double aY, double distance, KoUpdaterPtr progress)
@@ -122,27 +447,8 @@ void KisPerspectiveTransformWorker::run()
 
     KIS_ASSERT_RECOVER_NOOP(!m_isIdentity);
 
-    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, m_dstRegion.rectCount());
-
-    KisRandomSubAccessorSP srcAcc = cloneDevice->createRandomSubAccessor();
-    KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG(0, 0);
-
-    Q_FOREACH (const QRect &rect, m_dstRegion.rects()) {
-        for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
-            for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
-
-                QPointF dstPoint(x, y);
-                QPointF srcPoint = m_backwardTransform.map(dstPoint);
-
-                if (m_srcRect.contains(srcPoint)) {
-                    accessor->moveTo(dstPoint.x(), dstPoint.y());
-                    srcAcc->moveTo(srcPoint.x(), srcPoint.y());
-                    srcAcc->sampledOldRawData(accessor->rawData());
-                }
-            }
-        }
-        progressHelper.step();
-    }
+    transformRegionInParallel(cloneDevice, m_dev, m_srcRect, m_backwardTransform,
+                              m_dstRegion, m_progressUpdater);
 }
 
 void KisPerspectiveTransformWorker::runPartialDst(KisPaintDeviceSP srcDev,
@@ -157,26 +463,8 @@ void KisPerspectiveTransformWorker::runPartialDst(KisPaintDeviceSP srcDev,
     QRectF srcClipRect = srcDev->exactBounds();
     if (srcClipRect.isEmpty()) return;
 
-    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, dstRect.height());
-
-    KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
-    KisRandomAccessorSP accessor = dstDev->createRandomAccessorNG(dstRect.x(), dstRect.y());
-
-    for (int y = dstRect.y(); y < dstRect.y() + dstRect.height(); ++y) {
-        for (int x = dstRect.x(); x < dstRect.x() + dstRect.width(); ++x) {
-
-            QPointF dstPoint(x, y);
-            QPointF srcPoint = m_backwardTransform.map(dstPoint);
-
-            if (srcClipRect.contains(srcPoint)) {
-                accessor->moveTo(dstPoint.x(), dstPoint.y());
-                srcAcc->moveTo(srcPoint.x(), srcPoint.y());
-                srcAcc->sampledOldRawData(accessor->rawData());
-            }
-        }
-        progressHelper.step();
-    }
-
+    transformRegionInParallel(srcDev, dstDev, srcClipRect, m_backwardTransform,
+                              QRegion(dstRect), m_progressUpdater);
 }
 
 QTransform KisPerspectiveTransformWorker::forwardTransform() const
@@ -49,6 +49,12 @@ struct Q_DECL_HIDDEN KisPixelSelection::Private {
     bool outlineCacheValid;
     QMutex outlineCacheMutex;
 
+    /**
+     * Incremented on every invalidation of the outline cache, so that
+     * the outline generated from outdated pixels is not marked as valid
+     */
+    int outlineCacheSeqNo = 0;
+
     bool thumbnailImageValid;
     QImage thumbnailImage;
     QTransform thumbnailImageTransform;
@@ -120,6 +126,7 @@ bool KisPixelSelection::read(QIODevice *stream)
 {
     bool retval = KisPaintDevice::read(stream);
     m_d->outlineCacheValid = false;
+    m_d->outlineCacheSeqNo++;
     m_d->invalidateThumbnailImage();
     return retval;
 }
@@ -185,6 +192,7 @@ void KisPixelSelection::copyAlphaFrom(KisPaintDeviceSP src, const QRect &process
     }
 
     m_d->outlineCacheValid = false;
+    m_d->outlineCacheSeqNo++;
     m_d->outlineCache = QPainterPath();
     m_d->invalidateThumbnailImage();
 }
@@ -462,17 +470,29 @@ void KisPixelSelection::invalidateOutlineCache()
 {
     QMutexLocker locker(&m_d->outlineCacheMutex);
     m_d->outlineCacheValid = false;
+    m_d->outlineCacheSeqNo++;
     m_d->thumbnailImageValid = false;
 }
 
 void KisPixelSelection::recalculateOutlineCache()
 {
-    QMutexLocker locker(&m_d->outlineCacheMutex);
+    /**
+     * The generation of the outline of a complex selection may take
+     * hundreds of milliseconds, so don't hold the lock while doing
+     * that, otherwise the GUI thread would be blocked on checking
+     * outlineCacheValid().
+     */
+    int seqNo = 0;
 
-    m_d->outlineCache = QPainterPath();
+    {
+        QMutexLocker locker(&m_d->outlineCacheMutex);
+        seqNo = m_d->outlineCacheSeqNo;
+    }
+
+    QPainterPath outlineCache;
 
     Q_FOREACH (const QPolygon &polygon, outline()) {
-        m_d->outlineCache.addPolygon(polygon);
+        outlineCache.addPolygon(polygon);
 
         /**
          * The outline generation algorithm has a small bug, which
@@ -483,10 +503,18 @@ void KisPixelSelection::recalculateOutlineCache()
          *
          * \see KisSelectionTest::testOutlineGeneration()
          */
-        m_d->outlineCache.closeSubpath();
+        outlineCache.closeSubpath();
     }
 
-    m_d->outlineCacheValid = true;
+    QMutexLocker locker(&m_d->outlineCacheMutex);
+
+    m_d->outlineCache = outlineCache;
+
+    /**
+     * If the selection has changed while we were generating the outline,
+     * the cache stays invalid and will be regenerated by the next job
+     */
+    m_d->outlineCacheValid = seqNo == m_d->outlineCacheSeqNo;
 }
 
 bool KisPixelSelection::thumbnailImageValid() const
@@ -0,0 +1,423 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_recursive_gaussian.h"
+
+#include <cmath>
+#include <limits>
+
+#include <QBitArray>
+#include <QRect>
+#include <QVector>
+
+#include <KoChannelInfo.h>
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_default_bounds_base.h"
+#include "kis_gaussian_kernel.h"
+#include "kis_iterator_ng.h"
+#include "kis_math_toolbox.h"
+#include "kis_paint_device.h"
+#include "kis_repeat_iterators_pixel.h"
+
+
+const qreal KisRecursiveGaussian::thresholdRadius = 16.0;
+
+namespace {
+
+/**
+ * The coefficients of the fourth-order recursive filter by Deriche
+ * (R. Deriche, "Recursively implementing the Gaussian and its
+ * derivatives", 1993). The gaussian is split into a causal and an
+ * anti-causal part, which are run in opposite directions over the
+ * same input and summed.
+ *
+ * Unlike the cascaded filters (e.g. Young-van Vliet) the boundary
+ * conditions for the constant extension of the line are exact: both
+ * filters simply start in their steady state.
+ */
+struct DericheCoefficients
+{
+    DericheCoefficients(qreal sigma)
+    {
+        const double a0 = 1.680;
+        const double a1 = 3.735;
+        const double b0 = 1.783;
+        const double w0 = 0.6318;
+        const double c0 = -0.6803;
+        const double c1 = -0.2598;
+        const double b1 = 1.723;
+        const double w1 = 1.997;
+
+        const double eb0 = std::exp(-b0 / sigma);
+        const double eb1 = std::exp(-b1 / sigma);
+        const double cw0 = std::cos(w0 / sigma);
+        const double sw0 = std::sin(w0 / sigma);
+        const double cw1 = std::cos(w1 / sigma);
+        const double sw1 = std::sin(w1 / sigma);
+
+        causal[0] = a0 + c0;
+        causal[1] = eb1 * (c1 * sw1 - (c0 + 2 * a0) * cw1) +
+                    eb0 * (a1 * sw0 - (2 * c0 + a0) * cw0);
+        causal[2] = 2 * eb0 * eb1 * ((a0 + c0) * cw1 * cw0 - a1 * cw1 * sw0 - c1 * cw0 * sw1) +
+                    c0 * eb0 * eb0 + a0 * eb1 * eb1;
+        causal[3] = eb1 * eb0 * eb0 * (c1 * sw1 - c0 * cw1) +
+                    eb0 * eb1 * eb1 * (a1 * sw0 - a0 * cw0);
+
+        feedback[0] = 1.0;
+        feedback[1] = -2 * eb1 * cw1 - 2 * eb0 * cw0;
+        feedback[2] = 4 * cw1 * cw0 * eb0 * eb1 + eb1 * eb1 + eb0 * eb0;
+        feedback[3] = -2 * cw0 * eb0 * eb1 * eb1 - 2 * cw1 * eb1 * eb0 * eb0;
+        feedback[4] = eb0 * eb0 * eb1 * eb1;
+
+        antiCausal[0] = 0.0;
+        for (int i = 1; i < 4; i++) {
+            antiCausal[i] = causal[i] - feedback[i] * causal[0];
+        }
+        antiCausal[4] = -feedback[4] * causal[0];
+
+        double feedbackSum = 0.0;
+        double causalSum = 0.0;
+        double antiCausalSum = 0.0;
+
+        for (int i = 0; i < 5; i++) {
+            feedbackSum += feedback[i];
+            antiCausalSum += antiCausal[i];
+            if (i < 4) {
+                causalSum += causal[i];
+            }
+        }
+
+        // normalize the filter to have unit gain
+        const double gain = (causalSum + antiCausalSum) / feedbackSum;
+
+        for (int i = 0; i < 5; i++) {
+            antiCausal[i] /= gain;
+            if (i < 4) {
+                causal[i] /= gain;
+            }
+        }
+
+        causalSteadyGain = causalSum / gain / feedbackSum;
+        antiCausalSteadyGain = antiCausalSum / gain / feedbackSum;
+    }
+
+    double causal[4];
+    double antiCausal[5];
+    double feedback[5];
+
+    double causalSteadyGain;
+    double antiCausalSteadyGain;
+};
+
+/**
+ * Filters \p size values of \p data placed \p stride values apart.
+ * \p scratch should have space for \p size values.
+ */
+void filterLine(double *data, int size, int stride,
+                const DericheCoefficients &c,
+                double *scratch)
+{
+    for (int i = 0; i < size; i++) {
+        scratch[i] = data[i * stride];
+    }
+
+    const double *x = scratch;
+    const double *n = c.causal;
+    const double *m = c.antiCausal;
+    const double *d = c.feedback;
+
+    double x1, x2, x3, x4;
+    double y1, y2, y3, y4;
+
+    x1 = x2 = x3 = x[0];
+    y1 = y2 = y3 = y4 = c.causalSteadyGain * x[0];
+
+    for (int i = 0; i < size; i++) {
+        const double x0 = x[i];
+        const double y0 =
+            n[0] * x0 + n[1] * x1 + n[2] * x2 + n[3] * x3 -
+            d[1] * y1 - d[2] * y2 - d[3] * y3 - d[4] * y4;
+
+        x3 = x2; x2 = x1; x1 = x0;
+        y4 = y3; y3 = y2; y2 = y1; y1 = y0;
+
+        data[i * stride] = y0;
+    }
+
+    x1 = x2 = x3 = x4 = x[size - 1];
+    y1 = y2 = y3 = y4 = c.antiCausalSteadyGain * x[size - 1];
+
+    for (int i = size - 1; i >= 0; i--) {
+        const double y0 =
+            m[1] * x1 + m[2] * x2 + m[3] * x3 + m[4] * x4 -
+            d[1] * y1 - d[2] * y2 - d[3] * y3 - d[4] * y4;
+
+        x4 = x3; x3 = x2; x2 = x1; x1 = x[i];
+        y4 = y3; y3 = y2; y2 = y1; y1 = y0;
+
+        data[i * stride] += y0;
+    }
+}
+
+struct ChannelsInfo
+{
+    ChannelsInfo(const KoColorSpace *colorSpace, const QBitArray &channelFlags)
+    {
+        const QList<KoChannelInfo *> channels = colorSpace->channels();
+
+        for (int i = 0; i < channels.size(); i++) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+                convChannelList.append(channels[i]);
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < convChannelList.size(); i++) {
+            minClamp.append(mathToolbox.minChannelValue(convChannelList[i]));
+            maxClamp.append(mathToolbox.maxChannelValue(convChannelList[i]));
+
+            if (convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaCachePos = i;
+                alphaRealPos = convChannelList[i]->pos();
+            }
+        }
+
+        toDoubleFuncPtr.resize(convChannelList.size());
+        fromDoubleFuncPtr.resize(convChannelList.size());
+
+        bool result = mathToolbox.getToDoubleChannelPtr(convChannelList, toDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleChannelPtr(convChannelList, fromDoubleFuncPtr);
+
+        KIS_ASSERT(result);
+    }
+
+    int numChannels() const {
+        return convChannelList.size();
+    }
+
+    QList<KoChannelInfo*> convChannelList;
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+
+    QVector<PtrToDouble> toDoubleFuncPtr;
+    QVector<PtrFromDouble> fromDoubleFuncPtr;
+
+    int alphaCachePos = -1;
+    int alphaRealPos = -1;
+};
+
+/**
+ * Reads \p rect of \p src into \p buffer. Every channel is stored in
+ * its own plane, the color channels are premultiplied by alpha, the
+ * same way as KisConvolutionWorkerFFT does.
+ */
+void readBlock(KisPaintDeviceSP src, const QRect &rect, const QRect &dataRect,
+               const ChannelsInfo &info, double *buffer)
+{
+    KisRepeatHLineConstIteratorSP it =
+        src->createRepeatHLineConstIterator(rect.x(), rect.y(), rect.width(), dataRect);
+
+    const int planeSize = rect.width() * rect.height();
+    const int numChannels = info.numChannels();
+
+    double *pixelPtr = buffer;
+
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            const quint8 *data = it->oldRawData();
+
+            const double alphaValue = info.alphaRealPos >= 0 ?
+                info.toDoubleFuncPtr[info.alphaCachePos](data, info.alphaRealPos) : 1.0;
+
+            for (int k = 0; k < numChannels; k++) {
+                pixelPtr[k * planeSize] =
+                    k != info.alphaCachePos ?
+                    info.toDoubleFuncPtr[k](data, info.convChannelList[k]->pos()) * alphaValue :
+                    alphaValue;
+            }
+
+            pixelPtr++;
+            it->nextPixel();
+        }
+        it->nextRow();
+    }
+}
+
+inline double limitValue(double value, double lowBound, double highBound)
+{
+    if (value > highBound) {
+        value = highBound;
+    } else if (!(value >= lowBound)) {  // value < lowBound or value == NaN
+        value = lowBound;
+    }
+    return value;
+}
+
+/**
+ * Writes \p rect of \p dst from \p buffer, which stores the block read
+ * by readBlock() with the top-left corner at \p bufferOffset
+ */
+void writeBlock(KisPaintDeviceSP dst, const QRect &rect,
+                const QPoint &bufferOffset, int bufferRowStride, int bufferPlaneSize,
+                const ChannelsInfo &info, const double *buffer)
+{
+    KisHLineIteratorSP it = dst->createHLineIteratorNG(rect.x(), rect.y(), rect.width());
+
+    const int numChannels = info.numChannels();
+
+    for (int y = 0; y < rect.height(); y++) {
+        const double *pixelPtr = buffer + (bufferOffset.y() + y) * bufferRowStride + bufferOffset.x();
+
+        for (int x = 0; x < rect.width(); x++) {
+            quint8 *data = it->rawData();
+
+            double alphaInv = 1.0;
+            bool isTransparent = false;
+
+            if (info.alphaCachePos >= 0) {
+                const int k = info.alphaCachePos;
+                const double alphaValue =
+                    limitValue(pixelPtr[k * bufferPlaneSize], info.minClamp[k], info.maxClamp[k]);
+
+                info.fromDoubleFuncPtr[k](data, info.alphaRealPos, alphaValue);
+
+                if (alphaValue > std::numeric_limits<qreal>::epsilon()) {
+                    alphaInv = 1.0 / alphaValue;
+                } else {
+                    isTransparent = true;
+                }
+            }
+
+            for (int k = 0; k < numChannels; k++) {
+                if (k == info.alphaCachePos) continue;
+
+                const double value = isTransparent ? 0.0 :
+                    limitValue(pixelPtr[k * bufferPlaneSize] * alphaInv, info.minClamp[k], info.maxClamp[k]);
+
+                info.fromDoubleFuncPtr[k](data, info.convChannelList[k]->pos(), value);
+            }
+
+            pixelPtr++;
+            it->nextPixel();
+        }
+        it->nextRow();
+    }
+}
+
+}
+
+bool KisRecursiveGaussian::isApplicable(KisPaintDeviceSP device, qreal radius)
+{
+    /**
+     * In the wrap-around mode the convolution painter uses the special
+     * iterators of the device, which the recursive filter doesn't support
+     */
+    return radius >= thresholdRadius &&
+        !device->defaultBounds()->wrapAroundMode();
+}
+
+void KisRecursiveGaussian::applyPass(KisPaintDeviceSP dst,
+                                     KisPaintDeviceSP src,
+                                     const QRect &rect,
+                                     qreal radius,
+                                     Qt::Orientation orientation,
+                                     const QBitArray &channelFlags,
+                                     KoUpdater *progressUpdater)
+{
+    if (rect.isEmpty()) return;
+
+    const ChannelsInfo info(src->colorSpace(), channelFlags);
+    if (!info.numChannels()) return;
+
+    const DericheCoefficients coeffs(KisGaussianKernel::sigmaFromRadius(radius));
+
+    /**
+     * Read the same margin as the spatial kernel would, the pixels
+     * outside of it are considered to be the repetition of the border
+     * ones. The data rect is the same as KisConvolutionPainter uses
+     * for BORDER_REPEAT.
+     */
+    const int margin = KisGaussianKernel::kernelSizeFromRadius(radius) / 2;
+    const QRect dataRect = rect | src->exactBounds();
+
+    /**
+     * The image is processed in tile-aligned blocks of lines, so
+     * that every block touches as few tiles as possible and the
+     * buffer stays small even for huge images.
+     */
+    const int blockSize = 64;
+    const bool isHorizontal = orientation == Qt::Horizontal;
+
+    const int firstLine = isHorizontal ? rect.top() : rect.left();
+    const int lastLine = isHorizontal ? rect.bottom() : rect.right();
+    const int numLines = lastLine - firstLine + 1;
+
+    QVector<double> buffer;
+    QVector<double> scratch;
+
+    for (int line = firstLine; line <= lastLine;) {
+        const int blockEnd = qMin(lastLine + 1, (line & ~(blockSize - 1)) + blockSize);
+
+        QRect readRect;
+        QRect writeRect;
+        QPoint bufferOffset;
+
+        if (isHorizontal) {
+            writeRect = QRect(rect.left(), line, rect.width(), blockEnd - line);
+            readRect = writeRect.adjusted(-margin, 0, margin, 0);
+            bufferOffset = QPoint(margin, 0);
+        } else {
+            writeRect = QRect(line, rect.top(), blockEnd - line, rect.height());
+            readRect = writeRect.adjusted(0, -margin, 0, margin);
+            bufferOffset = QPoint(0, margin);
+        }
+
+        const int planeSize = readRect.width() * readRect.height();
+        buffer.resize(planeSize * info.numChannels());
+
+        readBlock(src, readRect, dataRect, info, buffer.data());
+
+        const int lineLength = isHorizontal ? readRect.width() : readRect.height();
+        const int linesInBlock = isHorizontal ? readRect.height() : readRect.width();
+        const int valueStride = isHorizontal ? 1 : readRect.width();
+        const int lineStride = isHorizontal ? readRect.width() : 1;
+
+        scratch.resize(lineLength);
+
+        for (int k = 0; k < info.numChannels(); k++) {
+            double *plane = buffer.data() + k * planeSize;
+
+            for (int i = 0; i < linesInBlock; i++) {
+                filterLine(plane + i * lineStride, lineLength, valueStride, coeffs, scratch.data());
+            }
+        }
+
+        writeBlock(dst, writeRect, bufferOffset, readRect.width(), planeSize, info, buffer.data());
+
+        line = blockEnd;
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(100 * (line - firstLine) / numLines);
+            if (progressUpdater->interrupted()) break;
+        }
+    }
+}
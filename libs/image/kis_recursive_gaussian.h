@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_RECURSIVE_GAUSSIAN_H
+#define __KIS_RECURSIVE_GAUSSIAN_H
+
+#include <Qt>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+/**
+ * A recursive (IIR) approximation of the gaussian blur: the fourth-order
+ * filter by Deriche, split into a causal and an anti-causal part. Both
+ * parts start in the steady state of the repeated border pixel. The cost
+ * doesn't depend on the radius of the blur: every pass takes 16
+ * multiply-adds per channel per pixel (8 in each direction), while the
+ * spatial convolution needs about 6 * sigma of them.
+ *
+ * The filter is slightly less precise than the convolution with
+ * KisGaussianKernel's kernels, so KisGaussianKernel::applyGaussian()
+ * uses it only for the radii higher than thresholdRadius.
+ */
+class KRITAIMAGE_EXPORT KisRecursiveGaussian
+{
+public:
+    /**
+     * The radius, starting from which the recursive filter is faster
+     * than the spatial convolution and its error is below the
+     * precision of 8-bit channels.
+     */
+    static const qreal thresholdRadius;
+
+    /**
+     * \return true if the blur of \p device with \p radius should be
+     * done by the recursive filter
+     */
+    static bool isApplicable(KisPaintDeviceSP device, qreal radius);
+
+    /**
+     * Blurs \p src along one axis and writes the result into \p rect
+     * of \p dst. \p src and \p dst may be the same device.
+     *
+     * The pixels outside \p src's exact bounds are repeated the same way
+     * as KisConvolutionPainter does for BORDER_REPEAT.
+     */
+    static void applyPass(KisPaintDeviceSP dst,
+                          KisPaintDeviceSP src,
+                          const QRect &rect,
+                          qreal radius,
+                          Qt::Orientation orientation,
+                          const QBitArray &channelFlags,
+                          KoUpdater *progressUpdater);
+};
+
+#endif /* __KIS_RECURSIVE_GAUSSIAN_H */
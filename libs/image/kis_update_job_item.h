@@ -44,8 +44,9 @@ public:
     };
 
 public:
-    KisUpdateJobItem(KisUpdaterContext *updaterContext)
+    KisUpdateJobItem(KisUpdaterContext *updaterContext, int workerIndex = -1)
         : m_updaterContext(updaterContext),
+          m_workerIndex(workerIndex),
           m_atomicType(Type::EMPTY),
           m_runnableJob(0)
     {
@@ -115,7 +116,7 @@ public:
         KIS_SAFE_ASSERT_RECOVER_RETURN(m_walker);
         // dbgKrita << "Executing merge job" << m_walker->changeRect()
         //          << "on thread" << QThread::currentThreadId();
-        m_merger.startMerge(*m_walker);
+        m_updaterContext->runMergeJob(m_walker, m_merger, m_workerIndex);
 
         QRect changeRect = m_walker->changeRect();
         m_updaterContext->continueUpdate(changeRect);
@@ -221,6 +222,11 @@ private:
 private:
     KisUpdaterContext *m_updaterContext;
 
+    /**
+     * The index of the deque in the context's work stealing executor
+     */
+    int m_workerIndex;
+
     bool m_exclusive;
 
     std::atomic<Type> m_atomicType;
@@ -23,12 +23,126 @@
 
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
+#include "kis_merge_walker.h"
+#include "kis_full_refresh_walker.h"
+#include "krita_utils.h"
 
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
+namespace {
+
+/**
+ * The size of the subtasks the merge jobs are split into. It is
+ * aligned to the tile size to avoid two subtasks writing into the
+ * same tile of the projection.
+ */
+const int mergeSubtaskSize = 256;
+
+KisBaseRectsWalkerSP createSubtaskWalker(KisBaseRectsWalkerSP walker)
+{
+    KisBaseRectsWalkerSP subtaskWalker;
+
+    switch (walker->type()) {
+    case KisBaseRectsWalker::UPDATE:
+        subtaskWalker = new KisMergeWalker(walker->cropRect(), KisMergeWalker::DEFAULT);
+        break;
+    case KisBaseRectsWalker::UPDATE_NO_FILTHY:
+        subtaskWalker = new KisMergeWalker(walker->cropRect(), KisMergeWalker::NO_FILTHY);
+        break;
+    case KisBaseRectsWalker::FULL_REFRESH:
+        subtaskWalker = new KisFullRefreshWalker(walker->cropRect());
+        break;
+    case KisBaseRectsWalker::UNSUPPORTED:
+        break;
+    }
+
+    return subtaskWalker;
+}
+
+bool canSplitMergeJob(KisBaseRectsWalkerSP walker)
+{
+    /**
+     * We can split only the walkers, whose need and change rects are
+     * equal to the requested rect for every node of the graph. In such
+     * a case the subtasks neither read nor write the pixels of each
+     * other. Everything else (filters, layer styles, transform masks
+     * and so on) is merged as a whole.
+     */
+    const QRect rc = walker->requestedRect();
+
+    return walker->type() != KisBaseRectsWalker::UNSUPPORTED &&
+        !walker->needRectVaries() &&
+        !walker->changeRectVaries() &&
+        walker->accessRect() == rc &&
+        walker->changeRect() == rc &&
+        qint64(rc.width()) * rc.height() > 2 * mergeSubtaskSize * mergeSubtaskSize;
+}
+
+}
+
+/**
+ * A runnable that is started in the idle threads of the pool when
+ * some job splits itself into subtasks. It steals the subtasks until
+ * there is nothing left or until the pool needs the thread for a
+ * usual job.
+ */
+class KisUpdaterContext::StealingHelper : public QRunnable
+{
+public:
+    StealingHelper(KisUpdaterContext *context)
+        : m_context(context)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        // the helper doesn't count its own thread as taken
+        while (!m_context->helpersShouldYield(1) &&
+               m_context->m_executor.tryStealAndRun());
+
+        m_context->m_numRunningHelpers.deref();
+    }
+
+private:
+    KisUpdaterContext *m_context;
+};
+
+/**
+ * Runs the job item in the pool and keeps m_numRunningJobItems in
+ * sync with it. The counter is incremented when the item is queued,
+ * not when it gets a thread, so that the helpers could see that some
+ * job is waiting for their thread.
+ */
+class KisUpdaterContext::JobItemRunner : public QRunnable
+{
+public:
+    JobItemRunner(KisUpdaterContext *context, KisUpdateJobItem *item)
+        : m_context(context),
+          m_item(item)
+    {
+        setAutoDelete(true);
+        m_context->m_numRunningJobItems.ref();
+    }
+
+    ~JobItemRunner() override {
+        m_context->m_numRunningJobItems.deref();
+    }
+
+    void run() override {
+        m_item->run();
+    }
+
+private:
+    KisUpdaterContext *m_context;
+    KisUpdateJobItem *m_item;
+};
+
 KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
     : QObject(parent), m_scheduler(qobject_cast<KisUpdateScheduler *>(parent))
 {
+    m_executor.setWakeUpCallback(
+        [this] (int numTasks) { wakeUpHelpers(numTasks); });
+
     if(threadCount <= 0) {
         threadCount = QThread::idealThreadCount();
         threadCount = threadCount > 0 ? threadCount : 1;
@@ -144,7 +258,7 @@ void KisUpdaterContext::addMergeJob(KisBaseRectsWalkerSP walker)
     // it might happen that we call this function from within
     // the thread itself, right when it finished its work
     if (shouldStartThread) {
-        m_threadPool.start(m_jobs[jobIndex]);
+        startJobItem(m_jobs[jobIndex]);
     }
 }
 
@@ -174,7 +288,7 @@ void KisUpdaterContext::addStrokeJob(KisStrokeJob *strokeJob)
     // it might happen that we call this function from within
     // the thread itself, right when it finished its work
     if (shouldStartThread) {
-        m_threadPool.start(m_jobs[jobIndex]);
+        startJobItem(m_jobs[jobIndex]);
     }
 }
 
@@ -204,7 +318,7 @@ void KisUpdaterContext::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
     // it might happen that we call this function from within
     // the thread itself, right when it finished its work
     if (shouldStartThread) {
-        m_threadPool.start(m_jobs[jobIndex]);
+        startJobItem(m_jobs[jobIndex]);
     }
 }
 
@@ -235,6 +349,72 @@ bool KisUpdaterContext::walkerIntersectsJob(KisBaseRectsWalkerSP walker,
         (job->accessRect().intersects(walker->changeRect()));
 }
 
+void KisUpdaterContext::startJobItem(KisUpdateJobItem *item)
+{
+    m_threadPool.start(new JobItemRunner(this, item));
+}
+
+void KisUpdaterContext::runMergeJob(KisBaseRectsWalkerSP walker, KisAsyncMerger &merger, int workerIndex)
+{
+    if (m_executor.numWorkers() <= 1 || !canSplitMergeJob(walker)) {
+        /**
+         * The walker cannot be split as a whole, but the merger can
+         * still process every node in stripes
+         */
+        merger.setStripesExecutor(&m_executor, workerIndex);
+        merger.startMerge(*walker);
+        return;
+    }
+
+    /**
+     * The job slot keeps the access and change rects of the whole
+     * walker, so the scheduler will not start any intersecting job
+     * until all the subtasks are finished.
+     */
+    const QVector<QRect> rects =
+        KritaUtils::splitRectIntoPatches(walker->requestedRect(),
+                                         QSize(mergeSubtaskSize, mergeSubtaskSize));
+
+    QVector<KisWorkStealingExecutor::Task> tasks;
+    Q_FOREACH (const QRect &rc, rects) {
+        tasks << [walker, rc] () {
+            KisBaseRectsWalkerSP subtaskWalker = createSubtaskWalker(walker);
+            subtaskWalker->collectRects(walker->startNode(), rc);
+
+            KisAsyncMerger subtaskMerger;
+            subtaskMerger.startMerge(*subtaskWalker);
+        };
+    }
+
+    m_executor.runAndWait(workerIndex, tasks);
+}
+
+void KisUpdaterContext::wakeUpHelpers(int numTasks)
+{
+    for (int i = 0; i < numTasks; i++) {
+        if (helpersShouldYield()) break;
+
+        m_numRunningHelpers.ref();
+
+        StealingHelper *helper = new StealingHelper(this);
+        if (!m_threadPool.tryStart(helper)) {
+            m_numRunningHelpers.deref();
+            delete helper;
+            break;
+        }
+    }
+}
+
+bool KisUpdaterContext::helpersShouldYield(int ownThreads) const
+{
+    /**
+     * The helpers must not occupy the threads needed for the usual
+     * jobs, otherwise the strokes would be delayed
+     */
+    return m_numRunningJobItems.loadAcquire() + m_numRunningHelpers.loadAcquire() - ownThreads >=
+        m_threadPool.maxThreadCount();
+}
+
 qint32 KisUpdaterContext::findSpareThread()
 {
     for(qint32 i=0; i < m_jobs.size(); i++)
@@ -268,9 +448,10 @@ void KisUpdaterContext::setThreadsLimit(int value)
     }
 
     m_jobs.resize(value);
+    m_executor.setNumWorkers(value);
 
     for(qint32 i = 0; i < m_jobs.size(); i++) {
-        m_jobs[i] = new KisUpdateJobItem(this);
+        m_jobs[i] = new KisUpdateJobItem(this, i);
     }
 }
 
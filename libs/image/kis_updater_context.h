@@ -27,6 +27,7 @@
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_lock_free_lod_counter.h"
+#include "KisWorkStealingExecutor.h"
 
 #include "KisUpdaterContextSnapshotEx.h"
 #include "kis_update_scheduler.h"
@@ -148,6 +149,13 @@ protected:
                                     const KisUpdateJobItem* job);
     qint32 findSpareThread();
 
+    /**
+     * Executes the merge job of the walker. Big walkers are split
+     * into tile-aligned subtasks, which are put into the deque of
+     * the job slot \p workerIndex and can be stolen by idle threads.
+     */
+    void runMergeJob(KisBaseRectsWalkerSP walker, KisAsyncMerger &merger, int workerIndex);
+
 protected:
     /**
      * The lock is shared by all the child update job items.
@@ -160,10 +168,24 @@ protected:
     QMutex m_lock;
     QVector<KisUpdateJobItem*> m_jobs;
     QThreadPool m_threadPool;
+
+    /**
+     * Subtasks of the running jobs. Idle threads of m_threadPool
+     * steal them with the help of StealingHelper runnables.
+     */
+    KisWorkStealingExecutor m_executor;
+    QAtomicInt m_numRunningJobItems;
+    QAtomicInt m_numRunningHelpers;
     KisLockFreeLodCounter m_lodCounter;
     KisUpdateScheduler *m_scheduler;
 
 private:
+    class StealingHelper;
+    class JobItemRunner;
+
+    void wakeUpHelpers(int numTasks);
+    bool helpersShouldYield(int ownThreads = 0) const;
+    void startJobItem(KisUpdateJobItem *item);
 
     friend class KisUpdaterContextTest;
     friend class KisUpdateSchedulerTest;
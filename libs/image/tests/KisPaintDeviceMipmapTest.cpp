@@ -0,0 +1,266 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisPaintDeviceMipmapTest.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "KisPaintDeviceMipmap.h"
+
+
+bool compareDevices(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rc)
+{
+    const int numBytes = rc.width() * rc.height() * dev1->pixelSize();
+
+    QByteArray bytes1(numBytes, 0);
+    QByteArray bytes2(numBytes, 0);
+
+    dev1->readBytes((quint8*)bytes1.data(), rc);
+    dev2->readBytes((quint8*)bytes2.data(), rc);
+
+    return bytes1 == bytes2;
+}
+
+KisPaintDeviceSP createReferenceLevel(KisPaintDeviceSP src, const QRect &srcRect, int index)
+{
+    KisPaintDeviceSP dev = src;
+    QRect rc = srcRect;
+
+    for (int i = 0; i < index; i++) {
+        KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+        dev->generateLodCloneDevice(dst, rc, 1);
+
+        rc = KisPaintDeviceMipmap::scaledRect(rc, 1);
+        dev = dst;
+    }
+
+    return dev;
+}
+
+void fillTestDevice(KisPaintDeviceSP dev)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+
+    dev->fill(QRect(0, 0, 300, 200), KoColor(Qt::red, cs));
+    dev->fill(QRect(37, 11, 100, 150), KoColor(Qt::green, cs));
+    dev->fill(QRect(201, 93, 17, 71), KoColor(Qt::blue, cs));
+}
+
+void KisPaintDeviceMipmapTest::testLevelsMatchLodClone()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 4);
+    QCOMPARE(mipmap.numLevels(), 4);
+    QCOMPARE(mipmap.level(0).data(), dev.data());
+
+    const QRect alignedRect(0, 0, 320, 256);
+
+    for (int i = 1; i < mipmap.numLevels(); i++) {
+        KisPaintDeviceSP ref = createReferenceLevel(dev, alignedRect, i);
+        const QRect levelRect = KisPaintDeviceMipmap::scaledRect(alignedRect, i);
+
+        QVERIFY(compareDevices(mipmap.level(i), ref, levelRect));
+    }
+}
+
+void KisPaintDeviceMipmapTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 4);
+
+    // fetch the levels to flush the initial update
+    mipmap.level(3);
+
+    const QRect changeRect(150, 50, 30, 30);
+    dev->fill(changeRect, KoColor(Qt::white, cs));
+
+    // not notified yet, so the level should be unchanged
+    KisPaintDeviceSP ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), 2);
+    QVERIFY(!compareDevices(mipmap.level(2), ref, QRect(0, 0, 80, 64)));
+
+    mipmap.setDirty(changeRect);
+
+    for (int i = 1; i < mipmap.numLevels(); i++) {
+        KisPaintDeviceSP ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), i);
+        const QRect levelRect = KisPaintDeviceMipmap::scaledRect(QRect(0, 0, 320, 256), i);
+
+        QVERIFY(compareDevices(mipmap.level(i), ref, levelRect));
+    }
+}
+
+void KisPaintDeviceMipmapTest::testColorSpaceChange()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 3);
+    QCOMPARE(*mipmap.level(2)->colorSpace(), *cs);
+
+    const KoColorSpace *newCs = KoColorSpaceRegistry::instance()->rgb16();
+    dev->convertTo(newCs);
+
+    KisPaintDeviceSP level = mipmap.level(2);
+    QCOMPARE(*level->colorSpace(), *newCs);
+
+    KisPaintDeviceSP ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), 2);
+    QVERIFY(compareDevices(level, ref, QRect(0, 0, 80, 64)));
+}
+
+void KisPaintDeviceMipmapTest::testLevelSelection()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 4);
+
+    QCOMPARE(mipmap.levelForScale(1.0), 0);
+    QCOMPARE(mipmap.levelForScale(0.6), 0);
+    QCOMPARE(mipmap.levelForScale(0.5), 1);
+    QCOMPARE(mipmap.levelForScale(0.2), 2);
+    QCOMPARE(mipmap.levelForScale(0.01), 3);
+
+    QCOMPARE(mipmap.levelForSize(QSize(1000, 800), QSize(1000, 800)), 0);
+    QCOMPARE(mipmap.levelForSize(QSize(1000, 800), QSize(500, 400)), 1);
+    QCOMPARE(mipmap.levelForSize(QSize(1000, 800), QSize(300, 100)), 1);
+    QCOMPARE(mipmap.levelForSize(QSize(1000, 800), QSize(10, 10)), 3);
+
+    QCOMPARE(KisPaintDeviceMipmap::scaledRect(QRect(3, 5, 10, 10), 0), QRect(3, 5, 10, 10));
+    QCOMPARE(KisPaintDeviceMipmap::scaledRect(QRect(3, 5, 10, 10), 1), QRect(1, 2, 6, 6));
+    QCOMPARE(KisPaintDeviceMipmap::scaledRect(QRect(0, 0, 256, 256), 2), QRect(0, 0, 64, 64));
+}
+
+void KisPaintDeviceMipmapTest::testThumbnailFromMipmap()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(QRect(0, 0, 512, 512), KoColor(Qt::red, cs));
+
+    KisPaintDeviceSP refThumbnail = dev->createThumbnailDevice(64, 64);
+
+    QVERIFY(!dev->hasMipmap());
+    dev->mipmap();
+    QVERIFY(dev->hasMipmap());
+
+    KisPaintDeviceSP thumbnail = dev->createThumbnailDevice(64, 64);
+    QVERIFY(compareDevices(thumbnail, refThumbnail, QRect(0, 0, 64, 64)));
+
+    const QRect changeRect(0, 0, 256, 512);
+    dev->fill(changeRect, KoColor(Qt::blue, cs));
+    dev->invalidateMipmap(changeRect);
+
+    refThumbnail = new KisPaintDevice(cs);
+    refThumbnail->fill(QRect(0, 0, 32, 64), KoColor(Qt::blue, cs));
+    refThumbnail->fill(QRect(32, 0, 32, 64), KoColor(Qt::red, cs));
+
+    thumbnail = dev->createThumbnailDevice(64, 64);
+    QVERIFY(compareDevices(thumbnail, refThumbnail, QRect(0, 0, 64, 64)));
+}
+
+void KisPaintDeviceMipmapTest::testLevelSnapshot()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 3);
+
+    KisPaintDeviceSP snapshot = mipmap.level(2);
+    KisPaintDeviceSP ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), 2);
+    QVERIFY(compareDevices(snapshot, ref, QRect(0, 0, 80, 64)));
+
+    // the next update of the chain should not touch the snapshot
+    const QRect changeRect(0, 0, 300, 200);
+    dev->fill(changeRect, KoColor(Qt::white, cs));
+    mipmap.setDirty(changeRect);
+
+    KisPaintDeviceSP newSnapshot = mipmap.level(2);
+
+    QVERIFY(compareDevices(snapshot, ref, QRect(0, 0, 80, 64)));
+    QVERIFY(!compareDevices(newSnapshot, ref, QRect(0, 0, 80, 64)));
+}
+
+void KisPaintDeviceMipmapTest::testDeviceInvalidatesMipmap()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap *mipmap = dev->mipmap();
+    mipmap->level(2);
+
+    const QRect alignedRect(0, 0, 320, 256);
+
+    // no explicit invalidation, the device reports its changes itself
+    dev->fill(QRect(150, 50, 30, 30), KoColor(Qt::white, cs));
+
+    KisPaintDeviceSP ref = createReferenceLevel(dev, alignedRect, 2);
+    QVERIFY(compareDevices(mipmap->level(2), ref, KisPaintDeviceMipmap::scaledRect(alignedRect, 2)));
+
+    dev->clear(QRect(0, 0, 100, 100));
+
+    ref = createReferenceLevel(dev, alignedRect, 2);
+    QVERIFY(compareDevices(mipmap->level(2), ref, KisPaintDeviceMipmap::scaledRect(alignedRect, 2)));
+
+    dev->moveTo(QPoint(64, 64));
+
+    const QRect movedRect(0, 0, 384, 320);
+    ref = createReferenceLevel(dev, movedRect, 2);
+    QVERIFY(compareDevices(mipmap->level(2), ref, KisPaintDeviceMipmap::scaledRect(movedRect, 2)));
+}
+
+void KisPaintDeviceMipmapTest::testCopyLevelRect()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillTestDevice(dev);
+
+    KisPaintDeviceMipmap mipmap(dev.data(), 4);
+
+    const QRect levelRect(16, 8, 32, 32);
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    QVERIFY(!mipmap.copyLevelRect(0, levelRect, dst->dataManager().data()));
+    QVERIFY(mipmap.copyLevelRect(2, levelRect, dst->dataManager().data()));
+
+    KisPaintDeviceSP ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), 2);
+    QVERIFY(compareDevices(dst, ref, levelRect));
+
+    // the pending changes are synced before copying
+    const QRect changeRect(64, 32, 64, 64);
+    dev->fill(changeRect, KoColor(Qt::white, cs));
+    mipmap.setDirty(changeRect);
+
+    QVERIFY(mipmap.copyLevelRect(2, levelRect, dst->dataManager().data()));
+
+    ref = createReferenceLevel(dev, QRect(0, 0, 320, 256), 2);
+    QVERIFY(compareDevices(dst, ref, levelRect));
+}
+
+QTEST_MAIN(KisPaintDeviceMipmapTest)
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisWorkStealingExecutorTest.h"
+
+#include <thread>
+
+#include <QTest>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "KisWorkStealingExecutor.h"
+
+
+void KisWorkStealingExecutorTest::testRunInline()
+{
+    KisWorkStealingExecutor executor(2);
+    QCOMPARE(executor.numWorkers(), 2);
+
+    int wakeUps = 0;
+    executor.setWakeUpCallback([&wakeUps] (int) { wakeUps++; });
+
+    QVector<int> order;
+    QVector<KisWorkStealingExecutor::Task> tasks;
+
+    for (int i = 0; i < 5; i++) {
+        tasks << [&order, i] () { order << i; };
+    }
+
+    // invalid worker index, the tasks are run sequentially
+    executor.runAndWait(-1, tasks);
+
+    QCOMPARE(order, QVector<int>({0, 1, 2, 3, 4}));
+    QCOMPARE(wakeUps, 0);
+    QVERIFY(!executor.hasStealableTasks());
+}
+
+void KisWorkStealingExecutorTest::testRunAndWait()
+{
+    KisWorkStealingExecutor executor(2);
+
+    int numStealableTasks = 0;
+    executor.setWakeUpCallback([&numStealableTasks] (int numTasks) { numStealableTasks = numTasks; });
+
+    QVector<int> order;
+    QVector<KisWorkStealingExecutor::Task> tasks;
+
+    for (int i = 0; i < 5; i++) {
+        tasks << [&order, i] () { order << i; };
+    }
+
+    // nobody steals, so the owner executes the tasks in the original order
+    executor.runAndWait(1, tasks);
+
+    QCOMPARE(order, QVector<int>({0, 1, 2, 3, 4}));
+    QCOMPARE(numStealableTasks, 4);
+    QVERIFY(!executor.hasStealableTasks());
+    QVERIFY(!executor.tryStealAndRun());
+}
+
+void KisWorkStealingExecutorTest::testStealing()
+{
+    KisWorkStealingExecutor executor(4);
+
+    QAtomicInt numExecutedTasks;
+    QAtomicInt numStolenTasks;
+    QAtomicInt stopThieves;
+
+    auto thief = [&] () {
+        while (!stopThieves.loadAcquire()) {
+            if (executor.tryStealAndRun()) {
+                numStolenTasks.ref();
+            } else {
+                QThread::yieldCurrentThread();
+            }
+        }
+    };
+
+    std::thread thief1(thief);
+    std::thread thief2(thief);
+
+    QVector<KisWorkStealingExecutor::Task> tasks;
+    for (int i = 0; i < 100; i++) {
+        tasks << [&numExecutedTasks] () {
+            QThread::usleep(100);
+            numExecutedTasks.ref();
+        };
+    }
+
+    executor.runAndWait(0, tasks);
+
+    // runAndWait() returns only when the stolen tasks are finished as well
+    QCOMPARE(numExecutedTasks.loadAcquire(), 100);
+
+    stopThieves.storeRelease(1);
+    thief1.join();
+    thief2.join();
+
+    QVERIFY(!executor.hasStealableTasks());
+    qDebug() << "Tasks stolen by other threads:" << numStolenTasks.loadAcquire();
+}
+
+namespace {
+void waitForFlag(const QAtomicInt &flag)
+{
+    while (!flag.loadAcquire()) {
+        QThread::yieldCurrentThread();
+    }
+}
+}
+
+void KisWorkStealingExecutorTest::testOwnerHelpsWhileWaiting()
+{
+    KisWorkStealingExecutor executor(2);
+
+    QAtomicInt thiefStarted;
+    QAtomicInt thiefStole;
+    QAtomicInt otherOwnerStarted;
+    QAtomicInt otherTaskDone;
+    QAtomicInt otherTaskRunOnOwner;
+
+    const std::thread::id ownerId = std::this_thread::get_id();
+
+    std::thread thief;
+    std::thread otherOwner;
+
+    /**
+     * The second worker runs one of its tasks and keeps the other one
+     * in the deque until someone steals it
+     */
+    QVector<KisWorkStealingExecutor::Task> otherTasks;
+    otherTasks << [&] () {
+        otherOwnerStarted.storeRelease(1);
+        waitForFlag(otherTaskDone);
+    };
+    otherTasks << [&] () {
+        otherTaskRunOnOwner.storeRelease(std::this_thread::get_id() == ownerId);
+        otherTaskDone.storeRelease(1);
+    };
+
+    /**
+     * The owner's second task is stolen by a thief, which is blocked
+     * until the owner helps the second worker
+     */
+    QVector<KisWorkStealingExecutor::Task> tasks;
+    tasks << [&] () {
+        thief = std::thread([&] () { thiefStole.storeRelease(executor.tryStealAndRun()); });
+        waitForFlag(thiefStarted);
+
+        otherOwner = std::thread([&] () { executor.runAndWait(1, otherTasks); });
+        waitForFlag(otherOwnerStarted);
+    };
+    tasks << [&] () {
+        thiefStarted.storeRelease(1);
+        waitForFlag(otherTaskDone);
+    };
+
+    executor.runAndWait(0, tasks);
+
+    thief.join();
+    otherOwner.join();
+
+    QVERIFY(otherTaskDone.loadAcquire());
+    QVERIFY(otherTaskRunOnOwner.loadAcquire());
+    QVERIFY(thiefStole.loadAcquire());
+    QVERIFY(!executor.hasStealableTasks());
+}
+
+QTEST_MAIN(KisWorkStealingExecutorTest)
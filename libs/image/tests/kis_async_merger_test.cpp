@@ -21,6 +21,12 @@
 #include "kis_merge_walker.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_async_merger.h"
+#include "KisWorkStealingExecutor.h"
+
+#include <atomic>
+#include <thread>
+
+#include <QThread>
 
 #include <QTest>
 #include <KoColorSpaceRegistry.h>
@@ -122,6 +128,70 @@ void KisAsyncMergerTest::testMerger()
     QVERIFY(TestUtil::compareQImages(pt, resultProjection, referenceProjection, 5, 0, 0));
 }
 
+void KisAsyncMergerTest::testMergerInStripes()
+{
+    const KoColorSpace * colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 640, 441, colorSpace, "merger test");
+
+    QImage sourceImage1(QString(FILES_DATA_DIR) + QDir::separator() + "hakonepa.png");
+    QImage sourceImage2(QString(FILES_DATA_DIR) + QDir::separator() + "inverted_hakonepa.png");
+    QImage referenceProjection(QString(FILES_DATA_DIR) + QDir::separator() + "merged_hakonepa.png");
+
+    KisPaintDeviceSP device1 = new KisPaintDevice(colorSpace);
+    KisPaintDeviceSP device2 = new KisPaintDevice(colorSpace);
+    device1->convertFromQImage(sourceImage1, 0, 0, 0);
+    device2->convertFromQImage(sourceImage2, 0, 0, 0);
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    Q_ASSERT(filter);
+    KisFilterConfigurationSP configuration = filter->defaultConfiguration();
+    Q_ASSERT(configuration);
+
+    KisLayerSP paintLayer1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8, device1);
+    KisLayerSP paintLayer2 = new KisPaintLayer(image, "paint2", OPACITY_OPAQUE_U8, device2);
+    KisLayerSP groupLayer = new KisGroupLayer(image, "group", 200/*OPACITY_OPAQUE*/);
+    KisLayerSP blur1 = new KisAdjustmentLayer(image, "blur1", configuration, 0);
+
+    image->addNode(paintLayer1, image->rootLayer());
+    image->addNode(groupLayer, image->rootLayer());
+
+    image->addNode(paintLayer2, groupLayer);
+    image->addNode(blur1, groupLayer);
+
+    KisWorkStealingExecutor executor(4);
+    std::atomic<bool> stopThief(false);
+
+    std::thread thief([&executor, &stopThief] () {
+        while (!stopThief) {
+            if (!executor.tryStealAndRun()) {
+                QThread::yieldCurrentThread();
+            }
+        }
+    });
+
+    /**
+     * The whole image is merged in one go, so the blur is
+     * processed in stripes, each of them needing the pixels of
+     * its neighbours
+     */
+    KisFullRefreshWalker walker(image->bounds());
+    KisAsyncMerger merger;
+    merger.setStripesExecutor(&executor, 0);
+
+    walker.collectRects(image->rootLayer(), image->bounds());
+    merger.startMerge(walker);
+
+    stopThief = true;
+    thief.join();
+
+    KisLayerSP rootLayer = image->rootLayer();
+    QVERIFY(rootLayer->exactBounds() == image->bounds());
+
+    QImage resultProjection = rootLayer->projection()->convertToQImage(0);
+    resultProjection.save(QString(FILES_OUTPUT_DIR) + QDir::separator() + "actual_merge_result_stripes.png");
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt, resultProjection, referenceProjection, 5, 0, 0));
+}
 
 /**
  * This in not fully automated test for child obliging in KisAsyncMerger.
@@ -27,6 +27,7 @@ class KisAsyncMergerTest : public QObject
 
 private Q_SLOTS:
     void testMerger();
+    void testMergerInStripes();
     void debugObligeChild();
     void testFullRefreshWithClones();
     void testSubgraphingWithoutUpdatingParent();
@@ -32,9 +32,16 @@
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
 #include <kis_gaussian_kernel.h>
+#include <kis_recursive_gaussian.h>
 #include <kis_mask_generator.h>
 #include "testutil.h"
 
+#include "config_convolution.h"
+
+#ifdef HAVE_FFTW3
+#include <kis_fftw_plan_cache.h>
+#endif
+
 KisPaintDeviceSP initAsymTestDevice(QRect &imageRect, int &pixelSize, QByteArray &initialData)
 {
     KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
@@ -437,6 +444,108 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
     testGaussianDetails(true);
 }
 
+void KisConvolutionPainterTest::testFFTWPlanCache()
+{
+#ifdef HAVE_FFTW3
+    QCOMPARE(KisFFTWPlanCache::optimalSize(1), 1);
+    QCOMPARE(KisFFTWPlanCache::optimalSize(64), 64);
+    QCOMPARE(KisFFTWPlanCache::optimalSize(210), 210);
+    QCOMPARE(KisFFTWPlanCache::optimalSize(211), 216);
+    QCOMPARE(KisFFTWPlanCache::optimalSize(1021), 1024);
+
+    KisFFTWPlanCache *cache = KisFFTWPlanCache::instance();
+
+    KisFFTWPlanCache::PlansSP plans1 = cache->plans(120, 64);
+    KisFFTWPlanCache::PlansSP plans2 = cache->plans(120, 64);
+    KisFFTWPlanCache::PlansSP plans3 = cache->plans(64, 120);
+
+    QVERIFY(plans1->forward);
+    QVERIFY(plans1->backward);
+    QCOMPARE(plans1, plans2);
+    QVERIFY(plans1 != plans3);
+#else
+    QSKIP("FFTW is not available");
+#endif
+}
+
+void KisConvolutionPainterTest::testGaussianRecursiveBase(qreal xRadius, qreal yRadius)
+{
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+
+    KisPaintDeviceSP spatialDev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    spatialDev->convertFromQImage(referenceImage, 0, 0, 0);
+    KisPaintDeviceSP recursiveDev = new KisPaintDevice(*spatialDev);
+
+    const QRect applyRect = spatialDev->exactBounds();
+    const QBitArray channelFlags =
+        KoColorSpaceRegistry::instance()->rgb8()->channelFlags(true, true);
+
+    const int verticalMargin = yRadius > 0 ? KisGaussianKernel::kernelSizeFromRadius(yRadius) / 2 + 1 : 0;
+    const QRect intermRect = applyRect.adjusted(0, -verticalMargin, 0, verticalMargin);
+
+    KisPaintDeviceSP spatialInterm = new KisPaintDevice(spatialDev->colorSpace());
+    KisPaintDeviceSP recursiveInterm = new KisPaintDevice(recursiveDev->colorSpace());
+
+    if (xRadius > 0) {
+        KisConvolutionPainter horizPainter(spatialInterm, KisConvolutionPainter::SPATIAL);
+        horizPainter.setChannelFlags(channelFlags);
+        horizPainter.applyMatrix(KisGaussianKernel::createHorizontalKernel(xRadius), spatialDev,
+                                 intermRect.topLeft(), intermRect.topLeft(),
+                                 intermRect.size(), BORDER_REPEAT);
+
+        KisRecursiveGaussian::applyPass(recursiveInterm, recursiveDev, intermRect, xRadius,
+                                        Qt::Horizontal, channelFlags, 0);
+    } else {
+        spatialInterm = new KisPaintDevice(*spatialDev);
+        recursiveInterm = new KisPaintDevice(*recursiveDev);
+    }
+
+    if (yRadius > 0) {
+        KisConvolutionPainter verticalPainter(spatialDev, KisConvolutionPainter::SPATIAL);
+        verticalPainter.setChannelFlags(channelFlags);
+        verticalPainter.applyMatrix(KisGaussianKernel::createVerticalKernel(yRadius), spatialInterm,
+                                    applyRect.topLeft(), applyRect.topLeft(),
+                                    applyRect.size(), BORDER_REPEAT);
+
+        KisRecursiveGaussian::applyPass(recursiveDev, recursiveInterm, applyRect, yRadius,
+                                        Qt::Vertical, channelFlags, 0);
+    } else {
+        spatialDev = spatialInterm;
+        recursiveDev = recursiveInterm;
+    }
+
+    const QImage spatialResult = spatialDev->convertToQImage(0, applyRect);
+    const QImage recursiveResult = recursiveDev->convertToQImage(0, applyRect);
+
+    /**
+     * The recursive filter is an approximation, so allow a small
+     * difference in the channels and a few failing pixels, which are
+     * usually almost transparent and have unstable color channels
+     */
+    const int maxNumFailingPixels = applyRect.width() * applyRect.height() / 200;
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, spatialResult, recursiveResult, 2, 2, maxNumFailingPixels)) {
+        spatialResult.save(QString("recursive_gaussian_%1_%2_spatial.png").arg(xRadius).arg(yRadius));
+        recursiveResult.save(QString("recursive_gaussian_%1_%2_recursive.png").arg(xRadius).arg(yRadius));
+        QFAIL(QString("Recursive gaussian differs from the spatial one, first at %1,%2")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
+void KisConvolutionPainterTest::testGaussianRecursive()
+{
+    testGaussianRecursiveBase(16, 16);
+    testGaussianRecursiveBase(30, 30);
+    testGaussianRecursiveBase(60, 20);
+}
+
+void KisConvolutionPainterTest::testGaussianRecursiveSingleAxis()
+{
+    testGaussianRecursiveBase(40, 0);
+    testGaussianRecursiveBase(0, 40);
+}
+
 #include "kis_transaction.h"
 
 void KisConvolutionPainterTest::testDilate()
@@ -35,6 +35,7 @@ private:
     void testGaussian(bool useFftw);
     void testGaussianSmall(bool useFftw);
     void testGaussianDetails(bool useFftw);
+    void testGaussianRecursiveBase(qreal xRadius, qreal yRadius);
 
 private Q_SLOTS:
 
@@ -57,6 +58,11 @@ private Q_SLOTS:
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
 
+    void testFFTWPlanCache();
+
+    void testGaussianRecursive();
+    void testGaussianRecursiveSingleAxis();
+
     void testDilate();
     void testErode();
 };
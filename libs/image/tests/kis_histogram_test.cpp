@@ -22,6 +22,7 @@
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoHistogramProducer.h>
+#include <KoColor.h>
 #include "kis_paint_device.h"
 #include "kis_histogram.h"
 #include "kis_paint_layer.h"
@@ -46,5 +47,51 @@ void KisHistogramTest::testCreation()
     }
 }
 
+void KisHistogramTest::testIncrementalUpdate()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect bounds(0, 0, 300, 200);
+
+    QList<QString> keys = KoHistogramProducerFactoryRegistry::instance()->keysCompatibleWith(cs);
+    QVERIFY(!keys.isEmpty());
+    KoHistogramProducerFactory *factory = KoHistogramProducerFactoryRegistry::instance()->get(keys.first());
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(QRect(10, 10, 200, 150), KoColor(Qt::red, cs));
+
+    KisHistogram histogram(dev, bounds, factory->generate(), LINEAR);
+    histogram.updateHistogram(bounds);
+
+    const quint32 initialCount = histogram.count();
+    QCOMPARE(initialCount, quint32(200 * 150));
+
+    const QRect dirtyRect1(100, 50, 150, 100);
+    dev->fill(dirtyRect1, KoColor(Qt::blue, cs));
+    histogram.updateHistogram(dirtyRect1);
+
+    const QRect dirtyRect2(20, 20, 50, 30);
+    dev->clear(dirtyRect2);
+    histogram.updateHistogram(dirtyRect2);
+
+    KisHistogram reference(dev, bounds, factory->generate(), LINEAR);
+
+    QCOMPARE(histogram.count(), reference.count());
+    QVERIFY(histogram.count() != initialCount);
+
+    const int numChannels = reference.producer()->channels().count();
+    const int numBins = reference.producer()->numberOfBins();
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        histogram.setChannel(channel);
+        reference.setChannel(channel);
+
+        for (int bin = 0; bin < numBins; bin++) {
+            QCOMPARE(histogram.getValue(bin), reference.getValue(bin));
+        }
+
+        QCOMPARE(histogram.calculations().getCount(), reference.calculations().getCount());
+        QCOMPARE(histogram.calculations().getMean(), reference.calculations().getMean());
+    }
+}
 
 KISTEST_MAIN(KisHistogramTest)
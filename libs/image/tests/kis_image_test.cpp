@@ -311,6 +311,111 @@ void KisImageTest::testCloneImage()
     }
 }
 
+void KisImageTest::testCloneImageCopyOnWrite()
+{
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_WIDTH, 0, "layer tests");
+    const KoColorSpace *cs = image->colorSpace();
+    KisImageAnimationInterface *interface = image->animationInterface();
+
+    KisPaintLayerSP layer1 = new KisPaintLayer(image, "layer1", OPACITY_OPAQUE_U8);
+    layer1->paintDevice()->fill(QRect(10, 10, 50, 50), KoColor(Qt::red, cs));
+    image->addNode(layer1);
+
+    KisPaintLayerSP layer2 = new KisPaintLayer(image, "layer2", OPACITY_OPAQUE_U8);
+    layer2->enableAnimation();
+    KisKeyframeChannel *channel = layer2->getKeyframeChannel(KisKeyframeChannel::Content.id(), true);
+    channel->addKeyframe(10);
+    image->addNode(layer2);
+
+    int savedSwitchedTime = 0;
+    interface->saveAndResetCurrentTime(10, &savedSwitchedTime);
+    layer2->paintDevice()->fill(QRect(100, 100, 20, 20), KoColor(Qt::green, cs));
+    interface->restoreCurrentTime(&savedSwitchedTime);
+
+    image->initialRefreshGraph();
+
+    KisImageSP newImage = image->clone(true);
+    KisImageAnimationInterface *newInterface = newImage->animationInterface();
+
+    KisNodeSP newLayer1 = TestUtil::findNode(newImage->root(), "layer1");
+    KisNodeSP newLayer2 = TestUtil::findNode(newImage->root(), "layer2");
+
+    QVERIFY(newLayer1);
+    QVERIFY(newLayer2);
+    QVERIFY(newLayer2->isAnimated());
+
+    // the devices of the clone are independent...
+    QVERIFY(newLayer1->paintDevice()->dataManager() != layer1->paintDevice()->dataManager());
+    QCOMPARE(newLayer1->paintDevice()->exactBounds(), QRect(10, 10, 50, 50));
+
+    int newSavedSwitchedTime = 0;
+    newInterface->saveAndResetCurrentTime(10, &newSavedSwitchedTime);
+    QCOMPARE(newLayer2->paintDevice()->exactBounds(), QRect(100, 100, 20, 20));
+
+    // ...so writing into them doesn't change the source image
+    newLayer2->paintDevice()->fill(QRect(0, 0, 20, 20), KoColor(Qt::blue, cs));
+    newInterface->restoreCurrentTime(&newSavedSwitchedTime);
+
+    newLayer1->paintDevice()->clear();
+
+    QCOMPARE(layer1->paintDevice()->exactBounds(), QRect(10, 10, 50, 50));
+
+    interface->saveAndResetCurrentTime(10, &savedSwitchedTime);
+    QCOMPARE(layer2->paintDevice()->exactBounds(), QRect(100, 100, 20, 20));
+    interface->restoreCurrentTime(&savedSwitchedTime);
+
+    QVERIFY(newImage->projection()->dataManager() != image->projection()->dataManager());
+}
+
+void KisImageTest::testCloneImageForRendering()
+{
+    KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_WIDTH, 0, "layer tests");
+    const KoColorSpace *cs = image->colorSpace();
+    KisImageAnimationInterface *interface = image->animationInterface();
+
+    KisPaintLayerSP layer1 = new KisPaintLayer(image, "layer1", OPACITY_OPAQUE_U8);
+    layer1->enableAnimation();
+    KisKeyframeChannel *channel = layer1->getKeyframeChannel(KisKeyframeChannel::Content.id(), true);
+    channel->addKeyframe(10);
+    image->addNode(layer1);
+
+    int savedSwitchedTime = 0;
+    interface->saveAndResetCurrentTime(10, &savedSwitchedTime);
+    layer1->paintDevice()->fill(QRect(100, 100, 20, 20), KoColor(Qt::green, cs));
+    interface->restoreCurrentTime(&savedSwitchedTime);
+
+    image->initialRefreshGraph();
+
+    KisImageSP newImage = image->cloneForRendering();
+    KisImageAnimationInterface *newInterface = newImage->animationInterface();
+
+    KisNodeSP newLayer1 = TestUtil::findNode(newImage->root(), "layer1");
+    QVERIFY(newLayer1);
+    QVERIFY(newLayer1->isAnimated());
+
+    KisPaintDeviceSP newDevice = newLayer1->paintDevice();
+
+    // only the current frame is copied right away...
+    QCOMPARE(newDevice->framesInterface()->frames().size(), 2);
+    QCOMPARE(newDevice->framesInterface()->testingGetDataObjects().m_frames.size(), 1);
+
+    // ...the other ones are copied when the clone switches to them
+    int newSavedSwitchedTime = 0;
+    newInterface->saveAndResetCurrentTime(10, &newSavedSwitchedTime);
+    QCOMPARE(newDevice->framesInterface()->testingGetDataObjects().m_frames.size(), 2);
+    QCOMPARE(newDevice->exactBounds(), QRect(100, 100, 20, 20));
+
+    newDevice->fill(QRect(0, 0, 20, 20), KoColor(Qt::blue, cs));
+    QCOMPARE(newDevice->exactBounds(), QRect(0, 0, 120, 120));
+    newInterface->restoreCurrentTime(&newSavedSwitchedTime);
+
+    interface->saveAndResetCurrentTime(10, &savedSwitchedTime);
+    QCOMPARE(layer1->paintDevice()->exactBounds(), QRect(100, 100, 20, 20));
+    interface->restoreCurrentTime(&savedSwitchedTime);
+
+    QVERIFY(newImage->projection()->dataManager() != image->projection()->dataManager());
+}
+
 void KisImageTest::testLayerComposition()
 {
     KisImageSP image = new KisImage(0, IMAGE_WIDTH, IMAGE_WIDTH, 0, "layer tests");
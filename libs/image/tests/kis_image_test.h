@@ -34,6 +34,8 @@ private Q_SLOTS:
     void testConvertImageColorSpace();
     void testGlobalSelection();
     void testCloneImage();
+    void testCloneImageCopyOnWrite();
+    void testCloneImageForRendering();
     void testLayerComposition();
 
     void testFlattenLayer();
@@ -19,6 +19,7 @@
 #include "kis_perspective_transform_worker_test.h"
 
 #include <QTest>
+#include <QPainter>
 
 #include "testutil.h"
 
@@ -27,6 +28,11 @@
 
 #include "kis_perspectivetransform_worker.h"
 #include "kis_transaction.h"
+#include "kis_random_accessor_ng.h"
+#include "kis_random_sub_accessor.h"
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 
 
 class PerspectiveWorkerTester : public TestUtil::QImageBasedTest
@@ -72,4 +78,100 @@ void KisPerspectiveTransformWorkerTest::testSimpleTransform()
     t.checkLayer("simple_transform");
 }
 
+void KisPerspectiveTransformWorkerTest::testMatchesSubAccessor_data()
+{
+    QTest::addColumn<QString>("colorModelId");
+    QTest::addColumn<QString>("colorDepthId");
+
+    QTest::newRow("rgba8") << RGBAColorModelID.id() << Integer8BitsColorDepthID.id();
+    QTest::newRow("rgba16") << RGBAColorModelID.id() << Integer16BitsColorDepthID.id();
+
+    // uses the generic mixing of the color space
+    QTest::newRow("laba16") << LABAColorModelID.id() << Integer16BitsColorDepthID.id();
+}
+
+void KisPerspectiveTransformWorkerTest::testMatchesSubAccessor()
+{
+    QFETCH(QString, colorModelId);
+    QFETCH(QString, colorDepthId);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(colorModelId, colorDepthId, 0);
+    QVERIFY(cs);
+
+    /**
+     * The device is big enough to be split into several cells,
+     * which are processed by different threads
+     */
+    const QRect imageRect(0, 0, 800, 600);
+
+    QImage image(imageRect.size(), QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    {
+        QPainter gc(&image);
+        QLinearGradient gradient(0, 0, 800, 600);
+        gradient.setColorAt(0.0, Qt::red);
+        gradient.setColorAt(0.5, QColor(0, 255, 0, 128));
+        gradient.setColorAt(1.0, Qt::blue);
+        gc.fillRect(QRect(20, 30, 700, 500), gradient);
+    }
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->convertFromQImage(image, 0);
+
+    KisPaintDeviceSP srcDev = new KisPaintDevice(*dev);
+
+    QPointF dx(326, 214);
+    qreal aX = 1.32;
+    qreal aY = 0.8;
+    qreal z = 1024;
+
+    KisPerspectiveTransformWorker worker(dev, dx, aX, aY, z, 0);
+    worker.run();
+
+    /**
+     * The parallel implementation should give exactly the same result as
+     * the naive per-pixel sampling
+     */
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+
+    const QRectF srcRect = srcDev->exactBounds();
+    const QTransform backwardTransform = worker.backwardTransform();
+    const QRect dstRect = worker.forwardTransform().mapRect(srcRect).toAlignedRect() & imageRect;
+
+    KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
+    KisRandomAccessorSP refAcc = refDev->createRandomAccessorNG(0, 0);
+
+    for (int y = dstRect.top(); y <= dstRect.bottom(); y++) {
+        for (int x = dstRect.left(); x <= dstRect.right(); x++) {
+            const QPointF srcPoint = backwardTransform.map(QPointF(x, y));
+
+            if (srcRect.contains(srcPoint)) {
+                refAcc->moveTo(x, y);
+                srcAcc->moveTo(srcPoint);
+                srcAcc->sampledOldRawData(refAcc->rawData());
+            }
+        }
+    }
+
+    QCOMPARE(dev->exactBounds(), refDev->exactBounds());
+
+    const QRect rc = refDev->exactBounds();
+    const int pixelSize = cs->pixelSize();
+
+    KisRandomConstAccessorSP devIt = dev->createRandomConstAccessorNG(0, 0);
+    KisRandomConstAccessorSP refIt = refDev->createRandomConstAccessorNG(0, 0);
+
+    for (int y = rc.top(); y <= rc.bottom(); y++) {
+        for (int x = rc.left(); x <= rc.right(); x++) {
+            devIt->moveTo(x, y);
+            refIt->moveTo(x, y);
+
+            if (memcmp(devIt->rawDataConst(), refIt->rawDataConst(), pixelSize) != 0) {
+                QFAIL(QString("Pixels differ at (%1, %2)").arg(x).arg(y).toLatin1());
+            }
+        }
+    }
+}
+
 QTEST_MAIN(KisPerspectiveTransformWorkerTest)
@@ -28,8 +28,10 @@
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 #include "kis_types.h"
 #include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
 
 
 void KisScanlineFillTest::testFillGeneral(const QVector<KisFillInterval> &initialBackwardIntervals,
@@ -295,4 +297,94 @@ void KisScanlineFillTest::testExternalFill()
     QCOMPARE(c, QColor(Qt::blue));
 }
 
+void KisScanlineFillTest::testParallelFill_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<int>("threshold");
+
+    QTest::newRow("u8-exact") << Integer8BitsColorDepthID.id() << 1;
+    QTest::newRow("u8") << Integer8BitsColorDepthID.id() << 30;
+    QTest::newRow("u16") << Integer16BitsColorDepthID.id() << 30;
+    QTest::newRow("f32") << Float32BitsColorDepthID.id() << 30;
+}
+
+bool compareDevicePixels(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect)
+{
+    const int numBytes = rect.width() * rect.height() * dev1->pixelSize();
+
+    QByteArray data1(numBytes, 0);
+    QByteArray data2(numBytes, 0);
+
+    dev1->readBytes(reinterpret_cast<quint8*>(data1.data()), rect);
+    dev2->readBytes(reinterpret_cast<quint8*>(data2.data()), rect);
+
+    return data1 == data2;
+}
+
+void KisScanlineFillTest::testParallelFill()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(int, threshold);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+
+    const QRect boundingRect(0, 0, 300, 300);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(boundingRect, KoColor(Qt::white, cs));
+
+    // a maze of walls spanning over several tiles...
+    for (int i = 0; i < 5; i++) {
+        dev->fill(QRect(20 + i * 60, 0, 3, 250 - i * 30), KoColor(Qt::black, cs));
+        dev->fill(QRect(0, 40 + i * 50, 280 - i * 20, 2), KoColor(Qt::black, cs));
+    }
+
+    // ...and the areas that differ from the background a bit
+    for (int i = 0; i < 10; i++) {
+        dev->fill(QRect(5 + i * 29, 100 + i * 7, 40, 15), KoColor(QColor(255 - 2 * i, 250, 255), cs));
+    }
+
+    // a small closed area on the uniform background, which spans two tiles
+    dev->fill(QRect(140, 250, 20, 20), KoColor(Qt::black, cs));
+    dev->fill(QRect(142, 252, 16, 16), KoColor(Qt::white, cs));
+
+    Q_FOREACH (const QPoint &startPoint, QVector<QPoint>() << QPoint(70, 70) << QPoint(150, 260)) {
+        {
+            KisPixelSelectionSP sequentialSelection = new KisPixelSelection();
+            KisPixelSelectionSP parallelSelection = new KisPixelSelection();
+
+            KisScanlineFill sequentialFill(dev, startPoint, boundingRect);
+            sequentialFill.setThreshold(threshold);
+            sequentialFill.fillSelection(sequentialSelection);
+
+            KisScanlineFill parallelFill(dev, startPoint, boundingRect);
+            parallelFill.setThreshold(threshold);
+            parallelFill.setParallelMode(true);
+            parallelFill.fillSelection(parallelSelection);
+
+            QVERIFY(!sequentialSelection->selectedExactRect().isEmpty());
+            QCOMPARE(parallelSelection->selectedExactRect(), sequentialSelection->selectedExactRect());
+            QVERIFY(compareDevicePixels(sequentialSelection, parallelSelection, boundingRect));
+        }
+
+        {
+            KisPaintDeviceSP sequentialDev = new KisPaintDevice(*dev);
+            KisPaintDeviceSP parallelDev = new KisPaintDevice(*dev);
+
+            KisScanlineFill sequentialFill(sequentialDev, startPoint, boundingRect);
+            sequentialFill.setThreshold(threshold);
+            sequentialFill.fillColor(KoColor(Qt::blue, cs));
+
+            KisScanlineFill parallelFill(parallelDev, startPoint, boundingRect);
+            parallelFill.setThreshold(threshold);
+            parallelFill.setParallelMode(true);
+            parallelFill.fillColor(KoColor(Qt::blue, cs));
+
+            QVERIFY(!compareDevicePixels(dev, sequentialDev, boundingRect));
+            QVERIFY(compareDevicePixels(sequentialDev, parallelDev, boundingRect));
+        }
+    }
+}
+
 QTEST_MAIN(KisScanlineFillTest)
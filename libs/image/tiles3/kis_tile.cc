@@ -208,6 +208,16 @@ void KisTile::unlock() const
     DEBUG_LOG_ACTION("unlock");
 }
 
+void KisTile::requestPrefetch()
+{
+    /**
+     * The tile data can be substituted only under m_COWMutex,
+     * so the pointer stays valid until the prefetcher refs it
+     */
+    QMutexLocker locker(&m_COWMutex);
+    m_tileData->m_store->requestPrefetch(m_tileData);
+}
+
 
 #include <stdio.h>
 void KisTile::debugPrintInfo()
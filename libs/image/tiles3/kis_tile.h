@@ -75,6 +75,13 @@ public:
     void lockForWrite();
     void unlock() const;
 
+    /**
+     * Asks the tile data store to load the data of this tile from
+     * swap in the background, so that the following lockForRead()
+     * or lockForWrite() would not block on reading the swap file
+     */
+    void requestPrefetch();
+
     /* this allows us work directly on tile's data */
     inline quint8 *data() const {
         return m_tileData->data();
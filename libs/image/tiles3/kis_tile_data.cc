@@ -66,6 +66,7 @@ KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataSt
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_prefetched(0),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(pixelSize),
@@ -95,6 +96,7 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_prefetched(0),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(rhs.m_pixelSize),
@@ -93,6 +93,10 @@ inline void KisTileData::blockSwapping() {
     if(!m_data) {
         m_swapLock.unlock();
         m_store->ensureTileDataLoaded(this);
+    } else if (m_prefetched.loadAcquire() &&
+               m_prefetched.testAndSetOrdered(1, 0)) {
+
+        m_store->notifyPrefetchHit();
     }
     resetAge();
 }
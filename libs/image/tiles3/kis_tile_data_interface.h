@@ -282,6 +282,13 @@ private:
     //FIXME: make memory aligned
     int m_age;
 
+    /**
+     * Set by KisTileDataStore::prefetchTileData() when the data
+     * has been paged in by the prefetcher thread. It is reset on
+     * the first access and used for counting prefetch hits.
+     */
+    QAtomicInt m_prefetched;
+
 
     /**
      * The primitive for controlling swapping of the tile.
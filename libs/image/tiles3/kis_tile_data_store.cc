@@ -70,19 +70,25 @@ qint64 __preclone_miss_age = 0;
 KisTileDataStore::KisTileDataStore()
     : m_pooler(this),
       m_swapper(this),
+      m_prefetcher(this),
       m_numTiles(0),
       m_memoryMetric(0),
       m_counter(1),
-      m_clockIndex(1)
+      m_clockIndex(1),
+      m_prefetchedTiles(0),
+      m_prefetchHits(0),
+      m_prefetchMisses(0)
 {
     m_pooler.start();
     m_swapper.start();
+    m_prefetcher.start();
 }
 
 KisTileDataStore::~KisTileDataStore()
 {
     m_pooler.terminatePooler();
     m_swapper.terminateSwapper();
+    m_prefetcher.terminatePrefetcher();
 
     if (numTiles() > 0) {
         errKrita << "Warning: some tiles have leaked:";
@@ -118,6 +124,10 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
 
     stats.swapSize = m_swappedStore.totalMemoryMetric() * metricCoeff;
 
+    stats.prefetchedTiles = m_prefetchedTiles.loadAcquire();
+    stats.prefetchHits = m_prefetchHits.loadAcquire();
+    stats.prefetchMisses = m_prefetchMisses.loadAcquire();
+
     return stats;
 }
 
@@ -239,6 +249,10 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
             m_swappedStore.swapInTileData(td);
             registerTileDataImp(td);
 
+            // the prefetcher didn't manage to load it in time
+            td->m_prefetched = 0;
+            m_prefetchMisses.ref();
+
             td->m_swapLock.unlock();
         }
 
@@ -252,6 +266,55 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
     }
 }
 
+void KisTileDataStore::prefetchTileData(KisTileData *td)
+{
+    td->m_swapLock.lockForRead();
+    const bool isLoaded = td->data();
+    td->m_swapLock.unlock();
+
+    if (isLoaded) return;
+
+    /**
+     * Use the same lock ordering as ensureTileDataLoaded() does
+     */
+    m_iteratorLock.lockForWrite();
+
+    if (!td->data()) {
+        td->m_swapLock.lockForWrite();
+
+        m_swappedStore.swapInTileData(td);
+        registerTileDataImp(td);
+
+        /**
+         * Don't let the swapper throw the tile out right away
+         */
+        td->resetAge();
+
+        td->m_prefetched = 1;
+        m_prefetchedTiles.ref();
+
+        td->m_swapLock.unlock();
+    }
+
+    m_iteratorLock.unlock();
+}
+
+void KisTileDataStore::adviseWillNeed(KisTileData *td)
+{
+    td->m_swapLock.lockForRead();
+
+    if (!td->data()) {
+        m_swappedStore.adviseWillNeed(td);
+    }
+
+    td->m_swapLock.unlock();
+}
+
+void KisTileDataStore::releaseSwappedPages()
+{
+    m_swappedStore.releaseWrittenPages();
+}
+
 bool KisTileDataStore::trySwapTileData(KisTileData *td)
 {
     /**
@@ -363,6 +426,12 @@ void KisTileDataStore::testingRereadConfig()
 {
     m_pooler.testingRereadConfig();
     m_swapper.testingRereadConfig();
+    m_prefetcher.testingRereadConfig();
+
+    if (!m_swappedStore.numTiles()) {
+        m_swappedStore.testingRereadConfig();
+    }
+
     kickPooler();
 }
 
@@ -27,6 +27,7 @@
 
 #include "kis_tile_data_pooler.h"
 #include "swap/kis_tile_data_swapper.h"
+#include "swap/kis_tile_data_prefetcher.h"
 #include "swap/kis_swapped_data_store.h"
 #include "3rdparty/lock_free_map/concurrent_map.h"
 
@@ -54,6 +55,16 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+
+        /**
+         * Tiles paged in from swap by the prefetcher and how many
+         * of them were actually accessed afterwards (hits). Misses
+         * count the tiles that had to be synchronously loaded from
+         * swap by the thread accessing them.
+         */
+        qint64 prefetchedTiles;
+        qint64 prefetchHits;
+        qint64 prefetchMisses;
     };
 
     MemoryStatistics memoryStatistics();
@@ -143,6 +154,44 @@ public:
     void registerTileData(KisTileData *td);
     void unregisterTileData(KisTileData *td);
 
+    /**
+     * Asynchronously loads \p td from swap, if it is swapped out.
+     * The call is cheap and does nothing if the swap is empty.
+     */
+    inline void requestPrefetch(KisTileData *td)
+    {
+        if (m_swappedStore.numTiles() > 0) {
+            m_prefetcher.prefetch(td);
+        }
+    }
+
+    /**
+     * Loads the tile data from swap without blocking its swapping
+     * afterwards. Should be called by KisTileDataPrefetcher only.
+     * PRECONDITIONS: td->m_swapLock is *unlocked*
+     *                m_listRWLock is *unlocked*
+     */
+    void prefetchTileData(KisTileData *td);
+
+    /**
+     * Hints the swap that \p td will be prefetched soon, so the disk
+     * could start reading it while the prefetcher is busy with the
+     * other tiles. Should be called by KisTileDataPrefetcher only.
+     * PRECONDITIONS: td->m_swapLock is *unlocked*
+     */
+    void adviseWillNeed(KisTileData *td);
+
+    /**
+     * Lets the system drop the memory of the tiles swapped out during
+     * the last swapping cycle. Should be called by KisTileDataSwapper only.
+     */
+    void releaseSwappedPages();
+
+    inline void notifyPrefetchHit()
+    {
+        m_prefetchHits.ref();
+    }
+
 private:
     KisTileData *allocTileData(qint32 pixelSize, const quint8 *defPixel);
 
@@ -164,6 +213,7 @@ private:
 private:
     KisTileDataPooler m_pooler;
     KisTileDataSwapper m_swapper;
+    KisTileDataPrefetcher m_prefetcher;
 
     friend class KisTileDataStoreTest;
     friend class KisTileDataPoolerTest;
@@ -178,6 +228,10 @@ private:
     QAtomicInt m_memoryMetric;
     QAtomicInt m_counter;
     QAtomicInt m_clockIndex;
+
+    QAtomicInt m_prefetchedTiles;
+    QAtomicInt m_prefetchHits;
+    QAtomicInt m_prefetchMisses;
     ConcurrentMap<int, KisTileData*> m_tileDataMap;
     QReadWriteLock m_iteratorLock;
 };
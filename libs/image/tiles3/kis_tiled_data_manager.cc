@@ -20,6 +20,9 @@
 
 #include <QRect>
 #include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QGlobalStatic>
 
 #include "kis_tile.h"
 #include "kis_tiled_data_manager.h"
@@ -30,9 +33,61 @@
 #include "swap/kis_tile_compressor_factory.h"
 
 #include "kis_paint_device_writer.h"
+#include "kis_image_config.h"
+#include "KisImageConfigNotifier.h"
+#include "swap/kis_tile_compressor_2.h"
 
 #include "kis_global.h"
 
+namespace {
+
+/**
+ * Reading KisImageConfig means a lookup in KConfig, which is too
+ * expensive to do for every device being saved, so the setting is read
+ * once and then only when the config is changed
+ */
+struct TileFileCompressionCache
+{
+    TileFileCompressionCache()
+    {
+        QObject::connect(KisImageConfigNotifier::instance(), &KisImageConfigNotifier::configChanged,
+                         [this] () {
+                             QMutexLocker l(&lock);
+                             isValid = false;
+                         });
+    }
+
+    /**
+     * \p needsNewVersion is set to true when the compression cannot be
+     * read by the older versions of Krita, that is, it is supported and
+     * is not LZF
+     */
+    QString compressionName(bool *needsNewVersion)
+    {
+        QMutexLocker l(&lock);
+
+        if (!isValid) {
+            name = KisImageConfig(true).tileFileCompression();
+            isNewCompression =
+                name != "LZF" &&
+                KisTileCompressor2::supportedCompressions().contains(name);
+            isValid = true;
+        }
+
+        *needsNewVersion = isNewCompression;
+        return name;
+    }
+
+    QMutex lock;
+    QString name;
+    bool isNewCompression = false;
+    bool isValid = false;
+};
+
+Q_GLOBAL_STATIC(TileFileCompressionCache, s_tileFileCompression)
+
+}
+
 
 /* The data area is divided into tiles each say 64x64 pixels (defined at compiletime)
  * The tiles are laid out in a matrix that can have negative indexes.
@@ -111,13 +166,22 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
 
     bool retval = true;
 
-    if(CURRENT_VERSION == LEGACY_VERSION) {
+    /**
+     * Only the tiles compressed with something other than LZF need
+     * the new version. Everything else is still saved in a way the
+     * older versions of Krita can read.
+     */
+    bool needsNewVersion = false;
+    const QString compressionName = s_tileFileCompression->compressionName(&needsNewVersion);
+    const qint32 version = needsNewVersion ? CURRENT_VERSION : LZF_VERSION;
+
+    if(version == LEGACY_VERSION) {
         char str[80];
         sprintf(str, "%d\n", m_hashTable->numTiles());
         retval = store.write(str, strlen(str));
     }
     else {
-        retval = writeTilesHeader(store, m_hashTable->numTiles());
+        retval = writeTilesHeader(store, m_hashTable->numTiles(), version);
     }
 
 
@@ -125,7 +189,7 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
     KisTileSP tile;
 
     KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
+        KisTileCompressorFactory::create(version, compressionName);
 
     while ((tile = iter.tile())) {
         retval = compressor->writeTile(tile, store);
@@ -186,7 +250,7 @@ bool KisTiledDataManager::read(QIODevice *stream)
     return readSuccess;
 }
 
-bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles)
+bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles, qint32 version)
 {
     QString buffer;
 
@@ -195,7 +259,7 @@ bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32
                      "TILEHEIGHT %3\n"
                      "PIXELSIZE %4\n"
                      "DATA %5\n")
-        .arg(CURRENT_VERSION)
+        .arg(version)
         .arg(KisTileData::WIDTH)
         .arg(KisTileData::HEIGHT)
         .arg(pixelSize())
@@ -680,6 +744,28 @@ QRegion KisTiledDataManager::region() const
     return region;
 }
 
+void KisTiledDataManager::prefetchTiles(const QRect &rect) const
+{
+    KisTileDataStore *store = KisTileDataStore::instance();
+
+    // nothing is swapped out, so nothing to prefetch
+    if (rect.isEmpty() || store->numTiles() == store->numTilesInMemory()) return;
+
+    const qint32 firstColumn = xToCol(rect.left());
+    const qint32 firstRow = yToRow(rect.top());
+    const qint32 lastColumn = xToCol(rect.right());
+    const qint32 lastRow = yToRow(rect.bottom());
+
+    for (qint32 row = firstRow; row <= lastRow; ++row) {
+        for (qint32 column = firstColumn; column <= lastColumn; ++column) {
+            KisTileSP tile = m_hashTable->getExistingTile(column, row);
+            if (tile) {
+                tile->requestPrefetch();
+            }
+        }
+    }
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
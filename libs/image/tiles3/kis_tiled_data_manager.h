@@ -68,7 +68,8 @@ class KRITAIMAGE_EXPORT KisTiledDataManager : public KisShared
 {
 private:
     static const qint32 LEGACY_VERSION = 1;
-    static const qint32 CURRENT_VERSION = 2;
+    static const qint32 LZF_VERSION = 2;
+    static const qint32 CURRENT_VERSION = 3;
 
 protected:
     /*FIXME:*/
@@ -228,6 +229,12 @@ public:
 
     QRegion region() const;
 
+    /**
+     * Asynchronously loads all the existing tiles in \p rect from
+     * swap, if they were swapped out. Does nothing otherwise.
+     */
+    void prefetchTiles(const QRect &rect) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -363,7 +370,7 @@ private:
 private:
     void setDefaultPixelImpl(const quint8 *defPixel);
 
-    bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles);
+    bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles, qint32 version);
     bool processTilesHeader(QIODevice *stream, quint32 &numTiles);
 
     qint32 divideRoundDown(qint32 x, const qint32 y) const;
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_ABSTRACT_SWAP_SPACE_H
+#define __KIS_ABSTRACT_SWAP_SPACE_H
+
+#include "kis_chunk_allocator.h"
+
+
+/**
+ * The backing storage of KisSwappedDataStore. It translates the
+ * chunks given out by KisChunkAllocator into pointers the data
+ * can be read from or written to.
+ *
+ * A pointer returned by get{Read,Write}ChunkPtr() is valid only
+ * until the next call to any of these functions.
+ */
+class KRITAIMAGE_EXPORT KisAbstractSwapSpace
+{
+public:
+    virtual ~KisAbstractSwapSpace() {}
+
+    inline quint8* getReadChunkPtr(KisChunk readChunk) {
+        return getReadChunkPtr(readChunk.data());
+    }
+
+    inline quint8* getWriteChunkPtr(KisChunk writeChunk) {
+        return getWriteChunkPtr(writeChunk.data());
+    }
+
+    virtual quint8* getReadChunkPtr(const KisChunkData &readChunk) = 0;
+    virtual quint8* getWriteChunkPtr(const KisChunkData &writeChunk) = 0;
+
+    /**
+     * Hints the backend that \p chunk is going to be read soon, so
+     * that it could start reading it from the disk in advance.
+     */
+    virtual void adviseWillNeed(const KisChunkData &chunk) {
+        Q_UNUSED(chunk);
+    }
+
+    /**
+     * Hints the backend that the data written since the last call
+     * will not be needed for some time and the memory it occupies
+     * may be given back to the system.
+     */
+    virtual void releaseWrittenPages() {
+    }
+};
+
+#endif /* __KIS_ABSTRACT_SWAP_SPACE_H */
@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_debug.h"
+#include "kis_mapped_swap_space.h"
+
+#include <QDir>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#define SWP_PREFIX "KRITA_SWAP_FILE_XXXXXX"
+
+#if defined(Q_OS_UNIX) && QT_POINTER_SIZE >= 8
+#define HAVE_MAPPED_SWAP_SPACE
+#endif
+
+namespace {
+
+#ifdef HAVE_MAPPED_SWAP_SPACE
+
+inline quint64 pageSize()
+{
+    static const quint64 size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+inline quint64 alignDown(quint64 value)
+{
+    return value & ~(pageSize() - 1);
+}
+
+inline quint64 alignUp(quint64 value)
+{
+    return alignDown(value + pageSize() - 1);
+}
+
+#endif
+
+}
+
+KisMappedSwapSpace::KisMappedSwapSpace(const QString &swapDir, quint64 maxSwapSize, quint64 growStep)
+    : m_valid(false),
+      m_mapping(0),
+      m_mappingSize(0),
+      m_fileSize(0),
+      m_growStep(qMax(growStep, quint64(MiB)))
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!swapDir.isEmpty());
+
+    QDir d(swapDir);
+    if (!d.exists() && !d.mkpath(swapDir)) {
+        qWarning() << "Could not create the swap directory" << swapDir;
+        return;
+    }
+
+    const QString swapFileTemplate = swapDir + QDir::separator() + SWP_PREFIX;
+    m_file.setFileTemplate(swapFileTemplate);
+
+    if (!m_file.open() || m_file.fileName().isEmpty()) {
+        qWarning() << "Could not create or open swapfile" << swapFileTemplate;
+        return;
+    }
+
+    m_mappingSize = alignUp(maxSwapSize);
+
+    int flags = MAP_SHARED;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+
+    /**
+     * Reserve the address space for the whole swap at once. The
+     * pages past the end of the file are never touched, since the
+     * file is grown before any chunk is written there.
+     */
+    void *mapping = mmap(0, m_mappingSize, PROT_READ | PROT_WRITE, flags, m_file.handle(), 0);
+
+    if (mapping == MAP_FAILED) {
+        qWarning() << "Could not map the swapfile of size" << m_mappingSize;
+        m_mappingSize = 0;
+        return;
+    }
+
+    m_mapping = static_cast<quint8*>(mapping);
+    m_valid = true;
+#else
+    Q_UNUSED(swapDir);
+    Q_UNUSED(maxSwapSize);
+#endif
+}
+
+KisMappedSwapSpace::~KisMappedSwapSpace()
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    if (m_mapping) {
+        munmap(m_mapping, m_mappingSize);
+    }
+#endif
+}
+
+bool KisMappedSwapSpace::isSupported()
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool KisMappedSwapSpace::isValid() const
+{
+    return m_valid;
+}
+
+bool KisMappedSwapSpace::ensureFileSize(quint64 size)
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    if (size <= m_fileSize) return true;
+
+    const quint64 newSize =
+        qMin(m_mappingSize, (size + m_growStep - 1) / m_growStep * m_growStep);
+
+    if (newSize < size || ftruncate(m_file.handle(), newSize) != 0) {
+        return false;
+    }
+
+    m_fileSize = newSize;
+    return true;
+#else
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+quint8* KisMappedSwapSpace::getReadChunkPtr(const KisChunkData &readChunk)
+{
+    if (!m_valid || readChunk.m_end >= m_fileSize) {
+        return 0;
+    }
+
+    return m_mapping + readChunk.m_begin;
+}
+
+quint8* KisMappedSwapSpace::getWriteChunkPtr(const KisChunkData &writeChunk)
+{
+    if (!m_valid || !ensureFileSize(writeChunk.m_end + 1)) {
+        return 0;
+    }
+
+    /**
+     * The allocator usually gives out the chunks one after another,
+     * so most of the writes just extend the last range
+     */
+    if (!m_writtenRanges.isEmpty() &&
+        m_writtenRanges.last().second == writeChunk.m_begin) {
+
+        m_writtenRanges.last().second = writeChunk.m_end + 1;
+    } else {
+        m_writtenRanges.append(qMakePair(writeChunk.m_begin, writeChunk.m_end + 1));
+    }
+
+    return m_mapping + writeChunk.m_begin;
+}
+
+void KisMappedSwapSpace::adviseWillNeed(const KisChunkData &chunk)
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    if (!m_valid || chunk.m_end >= m_fileSize) return;
+
+    const quint64 begin = alignDown(chunk.m_begin);
+    const quint64 end = alignUp(chunk.m_end + 1);
+
+    madvise(m_mapping + begin, end - begin, MADV_WILLNEED);
+#else
+    Q_UNUSED(chunk);
+#endif
+}
+
+void KisMappedSwapSpace::releaseWrittenPages()
+{
+#ifdef HAVE_MAPPED_SWAP_SPACE
+    if (!m_valid || m_writtenRanges.isEmpty()) return;
+
+    std::sort(m_writtenRanges.begin(), m_writtenRanges.end());
+
+    quint64 rangeBegin = m_writtenRanges.first().first;
+    quint64 rangeEnd = m_writtenRanges.first().second;
+
+    for (int i = 1; i <= m_writtenRanges.size(); i++) {
+        if (i < m_writtenRanges.size() &&
+            m_writtenRanges[i].first <= rangeEnd) {
+
+            rangeEnd = qMax(rangeEnd, m_writtenRanges[i].second);
+            continue;
+        }
+
+        /**
+         * Only the pages fully covered by the written range are released,
+         * the boundary ones may still be shared with the chunks that have
+         * not been written in this cycle and are going to be read soon.
+         */
+        const quint64 begin = alignUp(rangeBegin);
+        const quint64 end = alignDown(rangeEnd);
+
+        if (begin < end) {
+            /**
+             * Start the write-back right now, so that the kernel could
+             * drop the pages as soon as it needs the memory
+             */
+#ifdef SYNC_FILE_RANGE_WRITE
+            sync_file_range(m_file.handle(), begin, end - begin, SYNC_FILE_RANGE_WRITE);
+#else
+            msync(m_mapping + begin, end - begin, MS_ASYNC);
+#endif
+            madvise(m_mapping + begin, end - begin, MADV_DONTNEED);
+        }
+
+        if (i < m_writtenRanges.size()) {
+            rangeBegin = m_writtenRanges[i].first;
+            rangeEnd = m_writtenRanges[i].second;
+        }
+    }
+
+    m_writtenRanges.clear();
+#endif
+}
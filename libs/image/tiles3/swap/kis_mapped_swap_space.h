@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_MAPPED_SWAP_SPACE_H
+#define __KIS_MAPPED_SWAP_SPACE_H
+
+#include <QTemporaryFile>
+#include <QVector>
+#include <QPair>
+
+#include "kis_abstract_swap_space.h"
+
+
+/**
+ * A swap space that maps the whole swap file into the address space
+ * of the process at once.
+ *
+ * The mapping reserves \p maxSwapSize bytes of the address space
+ * right in the constructor, and the file itself is grown lazily (with
+ * ftruncate(), so it stays sparse) whenever a chunk is written past
+ * its end. Therefore, unlike KisMemoryWindow, no remapping ever
+ * happens and the pointers to the chunks are never invalidated. The
+ * paging is done by the kernel, and the swapper and the prefetcher
+ * steer it with madvise() hints.
+ *
+ * The space needs a 64-bit address space and POSIX mmap(). Check
+ * isValid() after construction and fall back to KisMemoryWindow if
+ * the mapping could not be created.
+ */
+class KRITAIMAGE_EXPORT KisMappedSwapSpace : public KisAbstractSwapSpace
+{
+public:
+    /**
+     * @param swapDir the directory for the swap file, created if it
+     *                doesn't exist
+     * @param maxSwapSize the size of the reserved mapping, should be
+     *                    equal to the size limit of the chunk allocator
+     * @param growStep the file is grown by the chunks of this size
+     */
+    KisMappedSwapSpace(const QString &swapDir, quint64 maxSwapSize, quint64 growStep = DEFAULT_SLAB_SIZE);
+    ~KisMappedSwapSpace() override;
+
+    /**
+     * \return true if the platform can map the swap file as a whole
+     */
+    static bool isSupported();
+
+    bool isValid() const;
+
+    using KisAbstractSwapSpace::getReadChunkPtr;
+    using KisAbstractSwapSpace::getWriteChunkPtr;
+
+    quint8* getReadChunkPtr(const KisChunkData &readChunk) override;
+    quint8* getWriteChunkPtr(const KisChunkData &writeChunk) override;
+
+    void adviseWillNeed(const KisChunkData &chunk) override;
+    void releaseWrittenPages() override;
+
+private:
+    bool ensureFileSize(quint64 size);
+
+private:
+    QTemporaryFile m_file;
+
+    bool m_valid;
+    quint8 *m_mapping;
+    quint64 m_mappingSize;
+    quint64 m_fileSize;
+    const quint64 m_growStep;
+
+    /**
+     * The ranges [begin, end) written since the last call to
+     * releaseWrittenPages(). The adjacent chunks are merged into
+     * a single range.
+     */
+    QVector<QPair<quint64, quint64>> m_writtenRanges;
+};
+
+#endif /* __KIS_MAPPED_SWAP_SPACE_H */
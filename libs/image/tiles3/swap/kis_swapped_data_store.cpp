@@ -16,9 +16,10 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
-//#include "kis_debug.h"
+#include "kis_debug.h"
 #include "kis_swapped_data_store.h"
 #include "kis_memory_window.h"
+#include "kis_mapped_swap_space.h"
 #include "kis_image_config.h"
 
 #include "kis_tile_compressor_2.h"
@@ -27,6 +28,18 @@
 
 KisSwappedDataStore::KisSwappedDataStore()
     : m_memoryMetric(0)
+{
+    createSwapSpace();
+}
+
+KisSwappedDataStore::~KisSwappedDataStore()
+{
+    delete m_compressor;
+    delete m_swapSpace;
+    delete m_allocator;
+}
+
+void KisSwappedDataStore::createSwapSpace()
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
@@ -34,17 +47,41 @@ KisSwappedDataStore::KisSwappedDataStore()
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
     m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
-    m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
+    m_swapSpace = 0;
+
+    if (config.useMappedSwapFile() && KisMappedSwapSpace::isSupported()) {
+        KisMappedSwapSpace *mappedSpace =
+            new KisMappedSwapSpace(config.swapDir(), maxSwapSize, swapSlabSize);
+
+        if (mappedSpace->isValid()) {
+            m_swapSpace = mappedSpace;
+        } else {
+            warnKrita << "Failed to map the swap file, falling back to the memory window";
+            delete mappedSpace;
+        }
+    }
+
+    if (!m_swapSpace) {
+        m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
+    }
+
+    m_storeUncompressed = config.swapUncompressedTiles();
 
-    // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    // the swap never leaves the process, so we can use a trained dictionary
+    m_compressor = new KisTileCompressor2(m_storeUncompressed ? "None" : config.swapCompression(), true);
 }
 
-KisSwappedDataStore::~KisSwappedDataStore()
+void KisSwappedDataStore::testingRereadConfig()
 {
+    QMutexLocker locker(&m_lock);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!m_allocator->numChunks());
+
     delete m_compressor;
     delete m_swapSpace;
     delete m_allocator;
+
+    createSwapSpace();
 }
 
 quint64 KisSwappedDataStore::numTiles() const
@@ -66,20 +103,40 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
      * So we can modify the tile data freely.
      */
 
-    const qint32 expectedBufferSize = m_compressor->tileDataBufferSize(td);
-    if(m_buffer.size() < expectedBufferSize)
-        m_buffer.resize(expectedBufferSize);
-
-    qint32 bytesWritten;
-    m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
-
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
-    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
-    if (!ptr) {
-        qWarning() << "swap out of tile failed";
-        return false;
+    KisChunk chunk;
+
+    if (m_storeUncompressed) {
+        /**
+         * The size of an uncompressed tile is known in advance, so
+         * we can write it directly into the swap
+         */
+        chunk = m_allocator->getChunk(m_compressor->tileDataBufferSize(td));
+        quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+        if (!ptr) {
+            qWarning() << "swap out of tile failed";
+            m_allocator->freeChunk(chunk);
+            return false;
+        }
+
+        qint32 bytesWritten;
+        m_compressor->compressTileData(td, ptr, chunk.size(), bytesWritten);
+    } else {
+        const qint32 expectedBufferSize = m_compressor->tileDataBufferSize(td);
+        if(m_buffer.size() < expectedBufferSize)
+            m_buffer.resize(expectedBufferSize);
+
+        qint32 bytesWritten;
+        m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
+
+        chunk = m_allocator->getChunk(bytesWritten);
+        quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+        if (!ptr) {
+            qWarning() << "swap out of tile failed";
+            m_allocator->freeChunk(chunk);
+            return false;
+        }
+        memcpy(ptr, m_buffer.data(), bytesWritten);
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
@@ -119,6 +176,20 @@ void KisSwappedDataStore::forgetTileData(KisTileData *td)
     m_memoryMetric -= td->pixelSize();
 }
 
+void KisSwappedDataStore::adviseWillNeed(KisTileData *td)
+{
+    QMutexLocker locker(&m_lock);
+
+    KisChunk chunk = td->swapChunk();
+    m_swapSpace->adviseWillNeed(chunk.data());
+}
+
+void KisSwappedDataStore::releaseWrittenPages()
+{
+    QMutexLocker locker(&m_lock);
+    m_swapSpace->releaseWrittenPages();
+}
+
 qint64 KisSwappedDataStore::totalMemoryMetric() const
 {
     return m_memoryMetric;
@@ -29,7 +29,7 @@ class QMutex;
 class KisTileData;
 class KisAbstractTileCompressor;
 class KisChunkAllocator;
-class KisMemoryWindow;
+class KisAbstractSwapSpace;
 
 class KRITAIMAGE_EXPORT KisSwappedDataStore
 {
@@ -65,6 +65,21 @@ public:
      */
     void forgetTileData(KisTileData *td);
 
+    /**
+     * Hint the swap backend that the data of \a td is going to be
+     * swapped in soon, so it could start reading it from the disk.
+     * LOCKING: the caller should hold at least a read lock on the
+     *          swap state of the tile data
+     */
+    void adviseWillNeed(KisTileData *td);
+
+    /**
+     * Let the system drop the memory occupied by the tiles swapped
+     * out since the last call. Called by the swapper at the end of
+     * every swapping cycle.
+     */
+    void releaseWrittenPages();
+
     /**
      * Retorns the metric of the total memory stored in the swap
      * in *uncompressed* form!
@@ -76,12 +91,22 @@ public:
      */
     void debugStatistics();
 
+    /**
+     * Recreates the swap backend according to the current config.
+     * Works only when nothing has been swapped out yet.
+     */
+    void testingRereadConfig();
+
+private:
+    void createSwapSpace();
+
 private:
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
 
     KisChunkAllocator *m_allocator;
-    KisMemoryWindow *m_swapSpace;
+    KisAbstractSwapSpace *m_swapSpace;
+    bool m_storeUncompressed;
 
     QMutex m_lock;
 
@@ -20,19 +20,130 @@
 #include "kis_lzf_compression.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
+
+#include "config-tile-compression.h"
+
+#ifdef HAVE_LZ4
+#include "kis_lz4_compression.h"
+#endif
+
+#ifdef HAVE_ZSTD
+#include "kis_zstd_compression.h"
+#endif
+
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
-const QString KisTileCompressor2::m_compressionName = "LZF";
+/**
+ * The number of tiles used for training the zstd dictionary and
+ * the maximum size of the resulting dictionary
+ */
+static const int DICTIONARY_SAMPLES_COUNT = 128;
+static const int DICTIONARY_MAX_SIZE = 64 * 1024;
 
 
-KisTileCompressor2::KisTileCompressor2()
+KisTileCompressor2::KisTileCompressor2(const QString &compressionName, bool trainDictionary)
+    : m_compressions(NUM_DATA_FLAGS, 0),
+      m_trainDictionary(false)
 {
-    m_compression = new KisLzfCompression();
+    m_compressionFlag = flagForCompressionName(compressionName);
+
+    if (m_compressionFlag < 0) {
+        warnTiles << "Tile compression" << compressionName << "is not supported, falling back to LZF";
+        m_compressionFlag = COMPRESSED_DATA_FLAG;
+    }
+
+    m_compressionName =
+        m_compressionFlag == RAW_DATA_FLAG ? "None" :
+        m_compressionFlag == LZ4_DATA_FLAG ? "LZ4" :
+        m_compressionFlag == ZSTD_DATA_FLAG ? "ZSTD" :
+        "LZF";
+
+#ifdef HAVE_ZSTD
+    m_trainDictionary = trainDictionary && m_compressionFlag == ZSTD_DATA_FLAG;
+#else
+    Q_UNUSED(trainDictionary);
+#endif
 }
 
 KisTileCompressor2::~KisTileCompressor2()
 {
-    delete m_compression;
+    qDeleteAll(m_compressions);
+}
+
+QString KisTileCompressor2::compressionName() const
+{
+    return m_compressionName;
+}
+
+QStringList KisTileCompressor2::supportedCompressions()
+{
+    QStringList result;
+    result << "LZF";
+#ifdef HAVE_LZ4
+    result << "LZ4";
+#endif
+#ifdef HAVE_ZSTD
+    result << "ZSTD";
+#endif
+    return result;
+}
+
+qint8 KisTileCompressor2::flagForCompressionName(const QString &name)
+{
+    if (name == "LZF") {
+        return COMPRESSED_DATA_FLAG;
+    }
+    else if (name == "None") {
+        return RAW_DATA_FLAG;
+    }
+#ifdef HAVE_LZ4
+    else if (name == "LZ4") {
+        return LZ4_DATA_FLAG;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    else if (name == "ZSTD") {
+        return ZSTD_DATA_FLAG;
+    }
+#endif
+    return -1;
+}
+
+KisAbstractCompression* KisTileCompressor2::compressionForFlag(qint8 flag)
+{
+    if (flag <= RAW_DATA_FLAG || flag >= NUM_DATA_FLAGS) return 0;
+
+    KisAbstractCompression *compression = m_compressions[flag];
+
+    if (!compression) {
+        switch (flag) {
+        case COMPRESSED_DATA_FLAG:
+            compression = new KisLzfCompression();
+            break;
+#ifdef HAVE_LZ4
+        case LZ4_DATA_FLAG:
+            compression = new KisLz4Compression();
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case ZSTD_DATA_FLAG:
+            compression = new KisZstdCompression();
+            break;
+        case ZSTD_DICTIONARY_DATA_FLAG:
+            /**
+             * The dictionary compression is created only after the
+             * dictionary has been trained, see collectDictionarySample()
+             */
+            break;
+#endif
+        default:
+            break;
+        }
+
+        m_compressions[flag] = compression;
+    }
+
+    return compression;
 }
 
 bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
@@ -75,7 +186,16 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+
+        /**
+         * The header contains the algorithm used by the writer,
+         * but the actual algorithm of every tile is defined by its
+         * own data flag, so we only check that we can read it.
+         */
+        if (flagForCompressionName(compressionName) < 0) {
+            warnFile << "Unsupported tile compression:" << compressionName;
+            return false;
+        }
 
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
@@ -103,12 +223,43 @@ void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 
 void KisTileCompressor2::prepareWorkBuffers(qint32 tileDataSize)
 {
-    const qint32 bufferSize = m_compression->outputBufferSize(tileDataSize);
+    KisAbstractCompression *compression = compressionForFlag(m_compressionFlag);
+    const qint32 bufferSize = compression->outputBufferSize(tileDataSize);
 
     m_linearizationBuffer.resize(tileDataSize);
     m_compressionBuffer.resize(bufferSize);
 }
 
+void KisTileCompressor2::collectDictionarySample(qint32 tileDataSize)
+{
+#ifdef HAVE_ZSTD
+    m_dictionarySamples.append(QByteArray(m_linearizationBuffer.constData(), tileDataSize));
+
+    if (m_dictionarySamples.size() >= DICTIONARY_SAMPLES_COUNT) {
+        const QByteArray dictionary =
+            KisZstdCompression::trainDictionary(m_dictionarySamples, DICTIONARY_MAX_SIZE);
+
+        if (!dictionary.isEmpty()) {
+            KisZstdCompression *compression = new KisZstdCompression();
+            compression->setDictionary(dictionary);
+
+            delete m_compressions[ZSTD_DICTIONARY_DATA_FLAG];
+            m_compressions[ZSTD_DICTIONARY_DATA_FLAG] = compression;
+            m_compressionFlag = ZSTD_DICTIONARY_DATA_FLAG;
+        }
+
+        /**
+         * Train the dictionary only once. If the training failed, the
+         * data is too uniform to benefit from it anyway.
+         */
+        m_trainDictionary = false;
+        m_dictionarySamples.clear();
+    }
+#else
+    Q_UNUSED(tileDataSize);
+#endif
+}
+
 void KisTileCompressor2::compressTileData(KisTileData *tileData,
                                           quint8 *buffer,
                                           qint32 bufferSize,
@@ -121,16 +272,28 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     Q_UNUSED(bufferSize);
     Q_ASSERT(bufferSize >= tileDataSize + 1);
 
+    if (m_compressionFlag == RAW_DATA_FLAG) {
+        buffer[0] = RAW_DATA_FLAG;
+        memcpy(buffer + 1, tileData->data(), tileDataSize);
+        bytesWritten = tileDataSize + 1;
+        return;
+    }
+
     prepareWorkBuffers(tileDataSize);
 
     KisAbstractCompression::linearizeColors(tileData->data(), (quint8*)m_linearizationBuffer.data(),
                                             tileDataSize, pixelSize);
 
-    compressedBytes = m_compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
-                                              (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
+    if (m_trainDictionary) {
+        collectDictionarySample(tileDataSize);
+    }
+
+    KisAbstractCompression *compression = compressionForFlag(m_compressionFlag);
+    compressedBytes = compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
+                                            (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
 
-    if(compressedBytes < tileDataSize) {
-        buffer[0] = COMPRESSED_DATA_FLAG;
+    if(compressedBytes > 0 && compressedBytes < tileDataSize) {
+        buffer[0] = m_compressionFlag;
         memcpy(buffer + 1, m_compressionBuffer.data(), compressedBytes);
         bytesWritten = compressedBytes + 1;
     }
@@ -148,12 +311,18 @@ bool KisTileCompressor2::decompressTileData(quint8 *buffer,
     const qint32 pixelSize = tileData->pixelSize();
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize);
 
-    if(buffer[0] == COMPRESSED_DATA_FLAG) {
-        prepareWorkBuffers(tileDataSize);
+    if(buffer[0] != RAW_DATA_FLAG) {
+        KisAbstractCompression *compression = compressionForFlag(buffer[0]);
+        if (!compression) {
+            warnTiles << "Unsupported tile data flag:" << buffer[0];
+            return false;
+        }
+
+        m_linearizationBuffer.resize(tileDataSize);
 
         qint32 bytesWritten;
-        bytesWritten = m_compression->decompress(buffer + 1, bufferSize - 1,
-                                                 (quint8*)m_linearizationBuffer.data(), tileDataSize);
+        bytesWritten = compression->decompress(buffer + 1, bufferSize - 1,
+                                               (quint8*)m_linearizationBuffer.data(), tileDataSize);
         if (bytesWritten == tileDataSize) {
             KisAbstractCompression::delinearizeColors((quint8*)m_linearizationBuffer.data(),
                                                       tileData->data(),
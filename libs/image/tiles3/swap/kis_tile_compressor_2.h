@@ -21,12 +21,38 @@
 
 #include "kis_abstract_tile_compressor.h"
 
+#include <QVector>
+#include <QStringList>
+
 class KisAbstractCompression;
 
+/**
+ * Tiles compressor used for storing the tiles both in the swap and
+ * in the .kra files. Every tile is prepended with a one-byte flag
+ * describing the algorithm used for compressing it, so the decompressor
+ * can read the tiles written with any of the supported algorithms,
+ * regardless of the one selected for writing. The tiles version 2
+ * allows LZF only, the other algorithms need version 3 (see
+ * KisTileCompressorFactory).
+ */
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
-    KisTileCompressor2();
+    /**
+     * \p compressionName is one of supportedCompressions(). If the
+     * algorithm is not available in this build, the compressor falls
+     * back to LZF.
+     *
+     * A special name "None" makes the compressor store the tiles
+     * as is. It is meant for the swap on fast drives, where the
+     * compression costs more than the I/O it saves.
+     *
+     * When \p trainDictionary is true and zstd is selected, the first
+     * tiles are used to train a compression dictionary, which is used
+     * for all the subsequent tiles. The dictionary is never saved, so
+     * this mode may be used for the swap only.
+     */
+    KisTileCompressor2(const QString &compressionName = "LZF", bool trainDictionary = false);
     ~KisTileCompressor2() override;
 
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
@@ -38,6 +64,13 @@ public:
     bool decompressTileData(quint8 *buffer, qint32 bufferSize, KisTileData *tileData) override;
     qint32 tileDataBufferSize(KisTileData *tileData) override;
 
+    QString compressionName() const;
+
+    /**
+     * The list of the algorithms available in this build
+     */
+    static QStringList supportedCompressions();
+
 private:
     /**
      * Quite self describing
@@ -49,16 +82,33 @@ private:
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
+    static qint8 flagForCompressionName(const QString &name);
+    KisAbstractCompression* compressionForFlag(qint8 flag);
+
+    void collectDictionarySample(qint32 tileDataSize);
+
 private:
     static const qint8 RAW_DATA_FLAG = 0;
-    static const qint8 COMPRESSED_DATA_FLAG = 1;
+    static const qint8 COMPRESSED_DATA_FLAG = 1; // LZF, kept for compatibility
+    static const qint8 LZ4_DATA_FLAG = 2;
+    static const qint8 ZSTD_DATA_FLAG = 3;
+    static const qint8 ZSTD_DICTIONARY_DATA_FLAG = 4;
+    static const qint8 NUM_DATA_FLAGS = 5;
 
 private:
     QByteArray m_linearizationBuffer;
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
-    KisAbstractCompression *m_compression;
-    static const QString m_compressionName;
+
+    /**
+     * Compressions are created lazily, indexed by the data flag
+     */
+    QVector<KisAbstractCompression*> m_compressions;
+    qint8 m_compressionFlag;
+    QString m_compressionName;
+
+    bool m_trainDictionary;
+    QVector<QByteArray> m_dictionarySamples;
 };
 
 #endif /* __KIS_TILE_COMPRESSOR_2_H */
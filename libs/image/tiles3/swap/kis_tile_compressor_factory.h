@@ -25,13 +25,21 @@
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
 public:
-    static KisAbstractTileCompressorSP create(qint32 version) {
+    /**
+     * \p compressionName is used by the writers of version 3 only, the
+     * readers detect the algorithm of every tile automatically. Version 2
+     * knows about LZF only, so its writers always use it.
+     */
+    static KisAbstractTileCompressorSP create(qint32 version, const QString &compressionName = "LZF") {
         switch(version) {
         case 1:
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
             break;
         case 2:
-            return KisAbstractTileCompressorSP(new KisTileCompressor2());
+            return KisAbstractTileCompressorSP(new KisTileCompressor2("LZF"));
+            break;
+        case 3:
+            return KisAbstractTileCompressorSP(new KisTileCompressor2(compressionName));
             break;
         default:
             qFatal("Unknown version of the tiles");
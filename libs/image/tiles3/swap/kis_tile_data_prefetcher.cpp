@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "tiles3/swap/kis_tile_data_prefetcher.h"
+
+#include <QSemaphore>
+#include <QMutex>
+#include <QQueue>
+#include <QVector>
+
+#include "tiles3/swap/kis_tile_data_swapper_p.h"
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "kis_debug.h"
+
+/**
+ * The queue is limited to approximately the area of a 4K canvas
+ * in a few layers, older requests are not worth keeping anyway
+ */
+const int KisTileDataPrefetcher::MAX_QUEUE_SIZE = 4096;
+
+/**
+ * The number of queued tiles the swap is told about in advance
+ */
+const int KisTileDataPrefetcher::READ_AHEAD_DEPTH = 32;
+
+
+struct Q_DECL_HIDDEN KisTileDataPrefetcher::Private
+{
+public:
+    QSemaphore semaphore;
+    QAtomicInt shouldExitFlag;
+    KisTileDataStore *store;
+    KisStoreLimits limits;
+
+    QMutex queueLock;
+    QQueue<KisTileData*> queue;
+
+    /**
+     * The number of tiles at the head of the queue that have
+     * already been passed to adviseWillNeed()
+     */
+    int numAdvised;
+};
+
+KisTileDataPrefetcher::KisTileDataPrefetcher(KisTileDataStore *store)
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->shouldExitFlag = 0;
+    m_d->store = store;
+    m_d->numAdvised = 0;
+}
+
+KisTileDataPrefetcher::~KisTileDataPrefetcher()
+{
+    clearQueue();
+    delete m_d;
+}
+
+void KisTileDataPrefetcher::prefetch(KisTileData *td)
+{
+    QMutexLocker l(&m_d->queueLock);
+
+    if (m_d->queue.size() >= MAX_QUEUE_SIZE) return;
+
+    td->ref();
+    m_d->queue.enqueue(td);
+    m_d->semaphore.release();
+}
+
+void KisTileDataPrefetcher::terminatePrefetcher()
+{
+    unsigned long exitTimeout = 100;
+    do {
+        m_d->shouldExitFlag = true;
+        m_d->semaphore.release();
+    } while(!wait(exitTimeout));
+
+    clearQueue();
+}
+
+void KisTileDataPrefetcher::clearQueue()
+{
+    QMutexLocker l(&m_d->queueLock);
+
+    while (!m_d->queue.isEmpty()) {
+        m_d->queue.dequeue()->deref();
+    }
+
+    m_d->numAdvised = 0;
+}
+
+void KisTileDataPrefetcher::testingRereadConfig()
+{
+    m_d->limits = KisStoreLimits();
+}
+
+void KisTileDataPrefetcher::run()
+{
+    while (1) {
+        m_d->semaphore.acquire();
+
+        if (m_d->shouldExitFlag)
+            return;
+
+        KisTileData *td = 0;
+        QVector<KisTileData*> readAhead;
+
+        {
+            QMutexLocker l(&m_d->queueLock);
+            if (m_d->queue.isEmpty()) continue;
+            td = m_d->queue.dequeue();
+
+            m_d->numAdvised = qMax(0, m_d->numAdvised - 1);
+            const int readAheadEnd = qMin(m_d->queue.size(), READ_AHEAD_DEPTH);
+
+            for (int i = m_d->numAdvised; i < readAheadEnd; i++) {
+                KisTileData *item = m_d->queue[i];
+                item->ref();
+                readAhead.append(item);
+            }
+
+            m_d->numAdvised = qMax(m_d->numAdvised, readAheadEnd);
+        }
+
+        Q_FOREACH (KisTileData *item, readAhead) {
+            m_d->store->adviseWillNeed(item);
+            item->deref();
+        }
+
+        if (m_d->store->memoryMetric() < m_d->limits.hardLimit()) {
+            m_d->store->prefetchTileData(td);
+        }
+
+        td->deref();
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KIS_TILE_DATA_PREFETCHER_H_
+#define KIS_TILE_DATA_PREFETCHER_H_
+
+#include <QObject>
+#include <QThread>
+
+#include "kritaimage_export.h"
+
+
+class KisTileDataStore;
+class KisTileData;
+
+/**
+ * A thread that pages the tile data in from swap ahead of the moment
+ * it is actually accessed. The requests are generated by the painting
+ * code (the predicted position of the brush) and by the canvas (the
+ * visible area of the image), see KisPaintDevice::prefetchTiles().
+ *
+ * The prefetcher never loads tiles above the hard memory limit, since
+ * the swapper would evict them right away.
+ *
+ * While a tile is being loaded, the next few tiles of the queue are
+ * announced to the swap with KisTileDataStore::adviseWillNeed(), so
+ * the disk reads overlap with the decompression.
+ */
+class KRITAIMAGE_EXPORT KisTileDataPrefetcher : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    KisTileDataPrefetcher(KisTileDataStore *store);
+    ~KisTileDataPrefetcher() override;
+
+    /**
+     * Adds \p td to the queue of tiles to be loaded. The
+     * prefetcher holds a reference to the tile data until it
+     * processes it. If the queue is full, the request is dropped.
+     */
+    void prefetch(KisTileData *td);
+
+    void terminatePrefetcher();
+
+    void testingRereadConfig();
+
+private:
+    void run() override;
+    void clearQueue();
+
+private:
+    static const int MAX_QUEUE_SIZE;
+    static const int READ_AHEAD_DEPTH;
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* KIS_TILE_DATA_PREFETCHER_H_ */
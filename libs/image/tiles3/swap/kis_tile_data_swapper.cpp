@@ -140,6 +140,13 @@ void KisTileDataSwapper::doJob()
             memoryMetric -= pass<AggressiveSwapStrategy>(hardFree);
             DEBUG_VALUE(memoryMetric);
         }
+
+        /**
+         * The swapped out tiles are not going to be accessed in the
+         * nearest future (that is why they have been chosen by the
+         * clock), so let the system drop their pages right away
+         */
+        m_d->store->releaseSwappedPages();
     }
 }
 
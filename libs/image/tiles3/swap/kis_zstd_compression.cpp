@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "kis_zstd_compression.h"
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include "kis_debug.h"
+
+
+struct KisZstdCompression::Private
+{
+    Private(int _compressionLevel)
+        : compressionLevel(_compressionLevel),
+          cctx(ZSTD_createCCtx()),
+          dctx(ZSTD_createDCtx())
+    {
+    }
+
+    ~Private() {
+        resetDictionary();
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+
+    void resetDictionary() {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+        cdict = 0;
+        ddict = 0;
+    }
+
+    int compressionLevel;
+    ZSTD_CCtx *cctx;
+    ZSTD_DCtx *dctx;
+    ZSTD_CDict *cdict = 0;
+    ZSTD_DDict *ddict = 0;
+};
+
+KisZstdCompression::KisZstdCompression(int compressionLevel)
+    : m_d(new Private(compressionLevel))
+{
+}
+
+KisZstdCompression::~KisZstdCompression()
+{
+}
+
+qint32 KisZstdCompression::compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const size_t result = m_d->cdict ?
+        ZSTD_compress_usingCDict(m_d->cctx, output, outputLength, input, inputLength, m_d->cdict) :
+        ZSTD_compressCCtx(m_d->cctx, output, outputLength, input, inputLength, m_d->compressionLevel);
+
+    if (ZSTD_isError(result)) {
+        warnTiles << "Failed to compress data with zstd:" << ZSTD_getErrorName(result);
+        return 0;
+    }
+
+    return result;
+}
+
+qint32 KisZstdCompression::decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const size_t result = m_d->ddict ?
+        ZSTD_decompress_usingDDict(m_d->dctx, output, outputLength, input, inputLength, m_d->ddict) :
+        ZSTD_decompressDCtx(m_d->dctx, output, outputLength, input, inputLength);
+
+    if (ZSTD_isError(result)) {
+        warnTiles << "Failed to decompress data with zstd:" << ZSTD_getErrorName(result);
+        return 0;
+    }
+
+    return result;
+}
+
+qint32 KisZstdCompression::outputBufferSize(qint32 dataSize)
+{
+    return ZSTD_compressBound(dataSize);
+}
+
+void KisZstdCompression::setDictionary(const QByteArray &dictionary)
+{
+    m_d->resetDictionary();
+
+    if (!dictionary.isEmpty()) {
+        m_d->cdict = ZSTD_createCDict(dictionary.constData(), dictionary.size(), m_d->compressionLevel);
+        m_d->ddict = ZSTD_createDDict(dictionary.constData(), dictionary.size());
+    }
+}
+
+bool KisZstdCompression::hasDictionary() const
+{
+    return m_d->cdict;
+}
+
+QByteArray KisZstdCompression::trainDictionary(const QVector<QByteArray> &samples, int maxDictionarySize)
+{
+    QByteArray samplesBuffer;
+    QVector<size_t> samplesSizes;
+
+    Q_FOREACH (const QByteArray &sample, samples) {
+        samplesBuffer.append(sample);
+        samplesSizes.append(sample.size());
+    }
+
+    QByteArray dictionary(maxDictionarySize, Qt::Uninitialized);
+
+    const size_t result =
+        ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                              samplesBuffer.constData(),
+                              samplesSizes.constData(), samplesSizes.size());
+
+    if (ZDICT_isError(result)) {
+        dbgTiles << "Failed to train zstd dictionary:" << ZDICT_getErrorName(result);
+        return QByteArray();
+    }
+
+    dictionary.resize(result);
+    return dictionary;
+}
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_ZSTD_COMPRESSION_H
+#define __KIS_ZSTD_COMPRESSION_H
+
+#include "kis_abstract_compression.h"
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QByteArray>
+
+/**
+ * Wrapper around zstd library. It gives much better compression
+ * ratio than LZF on 16-bit and floating point data, while still
+ * being fast to decompress.
+ *
+ * The compression may optionally use a dictionary trained on the
+ * typical data (see trainDictionary()). Since the dictionary is not
+ * stored alongside the data, it can be used only for the data that
+ * never leaves the process, that is, for the swap.
+ */
+class KRITAIMAGE_EXPORT KisZstdCompression : public KisAbstractCompression
+{
+public:
+    KisZstdCompression(int compressionLevel = 3);
+    ~KisZstdCompression() override;
+
+    qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+    qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+
+    qint32 outputBufferSize(qint32 dataSize) override;
+
+    /**
+     * Makes all the subsequent compress() and decompress() calls use
+     * \p dictionary. Passing an empty array resets the dictionary.
+     */
+    void setDictionary(const QByteArray &dictionary);
+    bool hasDictionary() const;
+
+    /**
+     * Trains a dictionary of at most \p maxDictionarySize bytes on
+     * the given \p samples. Returns an empty array on failure, e.g. when
+     * the samples are too small or too uniform.
+     */
+    static QByteArray trainDictionary(const QVector<QByteArray> &samples, int maxDictionarySize);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_ZSTD_COMPRESSION_H */
@@ -23,6 +23,7 @@
 #include <QTemporaryDir>
 
 #include "../swap/kis_memory_window.h"
+#include "../swap/kis_mapped_swap_space.h"
 
 void KisMemoryWindowTest::testWindow()
 {
@@ -54,6 +55,57 @@ void KisMemoryWindowTest::testWindow()
     QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
 }
 
+void KisMemoryWindowTest::testMappedSpace()
+{
+    if (!KisMappedSwapSpace::isSupported()) {
+        QSKIP("Mapped swap space is not supported on this platform");
+    }
+
+    QTemporaryDir swapDir;
+    KisMappedSwapSpace memory(swapDir.path(), 64 * MiB, 1 * MiB);
+    QVERIFY(memory.isValid());
+
+    quint8 oddValue = 0xee;
+    const quint64 chunkLength = 10;
+
+    quint8 oddBuf[chunkLength];
+    memset(oddBuf, oddValue, chunkLength);
+
+    // the second chunk crosses the first growth step of the file
+    KisChunkData chunk1(0, chunkLength);
+    KisChunkData chunk2(MiB - 5, chunkLength);
+    KisChunkData chunk3(32 * MiB, chunkLength);
+
+    quint8 *ptr;
+
+    // nothing has been written there yet
+    QVERIFY(!memory.getReadChunkPtr(chunk3));
+
+    ptr = memory.getWriteChunkPtr(chunk1);
+    memcpy(ptr, oddBuf, chunkLength);
+
+    ptr = memory.getWriteChunkPtr(chunk2);
+    memcpy(ptr, oddBuf, chunkLength);
+
+    ptr = memory.getWriteChunkPtr(chunk3);
+    memcpy(ptr, oddBuf, chunkLength);
+
+    memory.releaseWrittenPages();
+    memory.adviseWillNeed(chunk2);
+
+    ptr = memory.getReadChunkPtr(chunk2);
+    QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
+
+    ptr = memory.getReadChunkPtr(chunk1);
+    QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
+
+    ptr = memory.getReadChunkPtr(chunk3);
+    QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
+
+    // the chunks beyond the reserved space are rejected
+    QVERIFY(!memory.getWriteChunkPtr(KisChunkData(64 * MiB, chunkLength)));
+}
+
 void KisMemoryWindowTest::testTopReports()
 {
 
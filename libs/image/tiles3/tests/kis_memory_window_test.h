@@ -27,6 +27,7 @@ class KisMemoryWindowTest : public QObject
 
 private Q_SLOTS:
     void testWindow();
+    void testMappedSpace();
 
 private:
     // disabled since long-running
@@ -31,16 +31,33 @@
 
 #define COLUMN2COLOR(col) (col%255)
 
+void KisSwappedDataStoreTest::testRoundTrip_data()
+{
+    QTest::addColumn<bool>("useMappedSwapFile");
+    QTest::addColumn<bool>("uncompressed");
+
+    QTest::newRow("window") << false << false;
+    QTest::newRow("window-uncompressed") << false << true;
+    QTest::newRow("mapped") << true << false;
+    QTest::newRow("mapped-uncompressed") << true << true;
+}
+
 void KisSwappedDataStoreTest::testRoundTrip()
 {
+    QFETCH(bool, useMappedSwapFile);
+    QFETCH(bool, uncompressed);
+
     const qint32 pixelSize = 1;
     const quint8 defaultPixel = 128;
     const qint32 NUM_TILES = 10000;
 
     KisImageConfig config(false);
-    config.setMaxSwapSize(4);
+    // uncompressed tiles take 40 MiB in total
+    config.setMaxSwapSize(uncompressed ? 64 : 4);
     config.setSwapSlabSize(1);
     config.setSwapWindowSize(1);
+    config.setUseMappedSwapFile(useMappedSwapFile);
+    config.setSwapUncompressedTiles(uncompressed);
 
 
     KisSwappedDataStore store;
@@ -76,6 +93,9 @@ void KisSwappedDataStoreTest::testRoundTrip()
 
     for(qint32 i = 0; i < NUM_TILES; i++)
         delete tileDataList[i];
+
+    config.setUseMappedSwapFile(config.useMappedSwapFile(true));
+    config.setSwapUncompressedTiles(config.swapUncompressedTiles(true));
 }
 
 void KisSwappedDataStoreTest::processTileData(qint32 column, KisTileData *td, KisSwappedDataStore &store)
@@ -31,6 +31,7 @@ private:
     void processTileData(qint32 column, KisTileData *td, KisSwappedDataStore &store);
 
 private Q_SLOTS:
+    void testRoundTrip_data();
     void testRoundTrip();
     void testRandomAccess();
 
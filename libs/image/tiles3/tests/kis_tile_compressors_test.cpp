@@ -179,6 +179,103 @@ void KisTileCompressorsTest::testLowLevelRoundTripIncompressible2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testRoundTripAllCompressions_data()
+{
+    QTest::addColumn<QString>("compressionName");
+
+    Q_FOREACH (const QString &name, KisTileCompressor2::supportedCompressions()) {
+        QTest::newRow(name.toLatin1()) << name;
+    }
+}
+
+void KisTileCompressorsTest::testRoundTripAllCompressions()
+{
+    QFETCH(QString, compressionName);
+
+    KisTileCompressor2 compressor(compressionName);
+    QCOMPARE(compressor.compressionName(), compressionName);
+
+    doRoundTrip(&compressor);
+    doLowLevelRoundTrip(&compressor);
+    doLowLevelRoundTripIncompressible(&compressor);
+}
+
+void KisTileCompressorsTest::testDecompressForeignCompression_data()
+{
+    testRoundTripAllCompressions_data();
+}
+
+void KisTileCompressorsTest::testDecompressForeignCompression()
+{
+    QFETCH(QString, compressionName);
+
+    const qint32 pixelSize = 1;
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    KisTiledDataManager dm(pixelSize, &oddPixel1);
+    KisTileSP tile = dm.getTile(0, 0, true);
+    tile->lockForWrite();
+
+    KisTileData *td = tile->tileData();
+
+    KisTileCompressor2 writer(compressionName);
+    KisTileCompressor2 reader;
+
+    qint32 bufferSize = writer.tileDataBufferSize(td);
+    quint8 *buffer = new quint8[bufferSize];
+    qint32 bytesWritten;
+    writer.compressTileData(td, buffer, bufferSize, bytesWritten);
+
+    memset(td->data(), oddPixel2, TILESIZE);
+
+    QVERIFY(reader.decompressTileData(buffer, bytesWritten, td));
+    QVERIFY(memoryIsFilled(oddPixel1, td->data(), TILESIZE));
+
+    delete[] buffer;
+    tile->unlock();
+}
+
+void KisTileCompressorsTest::testZstdDictionary()
+{
+    if (!KisTileCompressor2::supportedCompressions().contains("ZSTD")) {
+        QSKIP("zstd is not available");
+    }
+
+    const qint32 pixelSize = 4;
+    quint8 defaultPixel[pixelSize] = {0, 0, 0, 0};
+
+    KisTiledDataManager dm(pixelSize, defaultPixel);
+    KisTileSP tile = dm.getTile(0, 0, true);
+    tile->lockForWrite();
+
+    KisTileData *td = tile->tileData();
+    const qint32 tileDataSize = pixelSize * TILESIZE;
+
+    KisTileCompressor2 compressor("ZSTD", true);
+
+    qint32 bufferSize = compressor.tileDataBufferSize(td);
+    QByteArray buffer(bufferSize, 0);
+    QByteArray reference(tileDataSize, 0);
+
+    // pass enough tiles through the compressor to train the dictionary
+    for (int i = 0; i < 200; i++) {
+        for (int j = 0; j < tileDataSize; j++) {
+            td->data()[j] = quint8((j / pixelSize) % 64 + (j % pixelSize) * 16 + i % 7);
+        }
+        memcpy(reference.data(), td->data(), tileDataSize);
+
+        qint32 bytesWritten;
+        compressor.compressTileData(td, (quint8*)buffer.data(), bufferSize, bytesWritten);
+
+        memset(td->data(), 0, tileDataSize);
+        QVERIFY(compressor.decompressTileData((quint8*)buffer.data(), bytesWritten, td));
+        QVERIFY(!memcmp(td->data(), reference.constData(), tileDataSize));
+    }
+
+    tile->unlock();
+}
+
 
 QTEST_MAIN(KisTileCompressorsTest)
 
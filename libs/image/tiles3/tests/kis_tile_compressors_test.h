@@ -38,6 +38,12 @@ private Q_SLOTS:
     void testRoundTrip2();
     void testLowLevelRoundTrip2();
     void testLowLevelRoundTripIncompressible2();
+
+    void testRoundTripAllCompressions_data();
+    void testRoundTripAllCompressions();
+    void testDecompressForeignCompression_data();
+    void testDecompressForeignCompression();
+    void testZstdDictionary();
 };
 
 #endif /* KIS_TILE_COMPRESSORS_TEST_H */
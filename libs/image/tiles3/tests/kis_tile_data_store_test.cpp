@@ -149,6 +149,61 @@ void KisTileDataStoreTest::testLeaks()
 
 #define COLUMN2COLOR(col) (col%255)
 
+void KisTileDataStoreTest::testPrefetching()
+{
+    KisImageConfig config(false);
+    config.setMemoryHardLimitPercent(50.0);
+    config.setMemorySoftLimitPercent(2.0);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+    KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+    const int numColumns = 20;
+
+    for(qint32 col = 0; col < numColumns; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), COLUMN2COLOR(col), TILESIZE);
+        tile->unlock();
+    }
+
+    store->debugSwapAll();
+    QVERIFY(store->numTilesInMemory() < store->numTiles());
+
+    KisTileDataStore::MemoryStatistics stats = store->memoryStatistics();
+    const qint64 initialPrefetched = stats.prefetchedTiles;
+    const qint64 initialHits = stats.prefetchHits;
+    const qint64 initialMisses = stats.prefetchMisses;
+
+    // prefetch the first half of the tiles
+    const int numPrefetched = numColumns / 2;
+    dm.prefetchTiles(QRect(0, 0, numPrefetched * KisTileData::WIDTH, KisTileData::HEIGHT));
+
+    for (int i = 0; i < 100; i++) {
+        if (store->memoryStatistics().prefetchedTiles - initialPrefetched >= numPrefetched) break;
+        QTest::qWait(10);
+    }
+
+    stats = store->memoryStatistics();
+    QCOMPARE(stats.prefetchedTiles - initialPrefetched, qint64(numPrefetched));
+
+    for(qint32 col = 0; col < numColumns; col++) {
+        KisTileSP tile = dm.getTile(col, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(col), tile->data(), TILESIZE));
+        tile->unlock();
+    }
+
+    stats = store->memoryStatistics();
+    QCOMPARE(stats.prefetchHits - initialHits, qint64(numPrefetched));
+    QCOMPARE(stats.prefetchMisses - initialMisses, qint64(numColumns - numPrefetched));
+}
+
 void KisTileDataStoreTest::testSwapping()
 {
     KisImageConfig config(false);
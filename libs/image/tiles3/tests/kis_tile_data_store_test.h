@@ -29,6 +29,7 @@ private:
 private Q_SLOTS:
     void testClockIterator();
     void testLeaks();
+    void testPrefetching();
     void testSwapping();
 };
 
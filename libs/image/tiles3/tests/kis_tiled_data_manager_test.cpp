@@ -20,6 +20,9 @@
 #include <QTest>
 
 #include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
+#include "kis_image_config.h"
+#include "KisImageConfigNotifier.h"
 
 #include "tiles_test_utils.h"
 #include "config-limit-long-tests.h"
@@ -540,6 +543,61 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testTileFileCompression_data()
+{
+    QTest::addColumn<QString>("compressionName");
+    QTest::addColumn<int>("expectedVersion");
+
+    QTest::newRow("LZF") << QString("LZF") << 2;
+    QTest::newRow("unsupported") << QString("Unsupported") << 2;
+
+    Q_FOREACH (const QString &name, KisTileCompressor2::supportedCompressions()) {
+        if (name == "LZF") continue;
+        QTest::newRow(name.toLatin1().constData()) << name << 3;
+    }
+}
+
+void KisTiledDataManagerTest::testTileFileCompression()
+{
+    QFETCH(QString, compressionName);
+    QFETCH(int, expectedVersion);
+
+    quint8 defaultPixel = 0;
+    quint8 oddPixel = 128;
+
+    KisTiledDataManager srcDM(1, &defaultPixel);
+    srcDM.clear(QRect(0,0,100,100), &oddPixel);
+
+    KoStoreFake fakeStore;
+    KisFakePaintDeviceWriter writer(&fakeStore);
+
+    KisImageConfig config(false);
+    config.setTileFileCompression(compressionName);
+    KisImageConfigNotifier::instance()->notifyConfigChanged();
+
+    const bool writeResult = srcDM.write(writer);
+
+    config.setTileFileCompression(config.tileFileCompression(true));
+    KisImageConfigNotifier::instance()->notifyConfigChanged();
+
+    QVERIFY(writeResult);
+
+    // anything but LZF should not be readable by the older versions
+    fakeStore.startReading();
+    QCOMPARE(fakeStore.device()->readLine().trimmed(),
+             QByteArray("VERSION ") + QByteArray::number(expectedVersion));
+
+    fakeStore.startReading();
+
+    KisTiledDataManager dstDM(1, &defaultPixel);
+    QVERIFY(dstDM.read(fakeStore.device()));
+
+    QCOMPARE(dstDM.extent(), QRect(0,0,128,128));
+
+    KisTileSP tile00 = dstDM.getTile(0, 0, false);
+    QVERIFY(memoryIsFilled(oddPixel, tile00->data(), TILESIZE));
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
@@ -52,6 +52,8 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testTileFileCompression_data();
+    void testTileFileCompression();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
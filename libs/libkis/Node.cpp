@@ -49,6 +49,7 @@
 #include <kis_filter_strategy.h>
 
 #include <kis_raster_keyframe_channel.h>
+#include <kis_random_accessor_ng.h>
 #include <kis_keyframe.h>
 #include "kis_selection.h"
 
@@ -56,6 +57,7 @@
 #include "Krita.h"
 #include "Node.h"
 #include "Channel.h"
+#include "PixelTile.h"
 #include "Filter.h"
 #include "Selection.h"
 
@@ -502,6 +504,44 @@ void Node::setPixelData(QByteArray value, int x, int y, int w, int h)
     dev->writeBytes((const quint8*)value.constData(), x, y, w, h);
 }
 
+QList<QRect> Node::tileRects(int x, int y, int w, int h) const
+{
+    QList<QRect> rects;
+
+    if (!d->node) return rects;
+    KisPaintDeviceSP dev = d->node->paintDevice();
+    if (!dev) return rects;
+
+    const QRect rc(x, y, w, h);
+    if (rc.isEmpty()) return rects;
+
+    KisRandomConstAccessorSP accessor = dev->createRandomConstAccessorNG(x, y);
+
+    for (int row = rc.top(); row <= rc.bottom();) {
+        const int rowHeight = qMin(accessor->numContiguousRows(row), rc.bottom() - row + 1);
+
+        for (int column = rc.left(); column <= rc.right();) {
+            const int columnWidth = qMin(accessor->numContiguousColumns(column), rc.right() - column + 1);
+
+            rects.append(QRect(column, row, columnWidth, rowHeight));
+            column += columnWidth;
+        }
+
+        row += rowHeight;
+    }
+
+    return rects;
+}
+
+PixelTile *Node::pixelTile(int x, int y, int w, int h, bool writable) const
+{
+    if (!d->node) return 0;
+    KisPaintDeviceSP dev = d->node->paintDevice();
+    if (!dev) return 0;
+
+    return new PixelTile(d->node, dev, QRect(x, y, w, h), writable);
+}
+
 QRect Node::bounds() const
 {
     if (!d->node) return QRect();
@@ -445,6 +445,37 @@ public Q_SLOTS:
      */
     void setPixelData(QByteArray value, int x, int y, int w, int h);
 
+    /**
+     * @brief tileRects splits the given rectangle into the parts that lie
+     * inside single tiles of the Node's pixel data. Every part can be
+     * accessed with pixelTile() without copying.
+     *
+     * @return the list of rectangles in image coordinates, or an empty list
+     * if the Node has no pixel data.
+     */
+    QList<QRect> tileRects(int x, int y, int w, int h) const;
+
+    /**
+     * @brief pixelTile gives direct access to the pixels of the Node
+     * without copying them, see PixelTile.
+     *
+     * The returned tile starts at the given position and covers as much of
+     * the requested rectangle as fits into a single tile of the Node's pixel
+     * data, check PixelTile::bounds() for the actual size. Use tileRects() to
+     * get rectangles that are covered completely.
+     *
+     * File layers, Group layers, Clone layers cannot be written to, just
+     * like with setPixelData().
+     *
+     * @param x the x position of the top left pixel
+     * @param y the y position of the top left pixel
+     * @param w the requested width
+     * @param h the requested height
+     * @param writable if true, the pixels can be changed through the tile
+     * @return a new PixelTile, the caller owns it
+     */
+    PixelTile *pixelTile(int x, int y, int w, int h, bool writable = false) const;
+
     /**
      * @brief bounds return the exact bounds of the node's paint device
      * @return the bounds, or an empty QRect if the node has no paint device or is empty.
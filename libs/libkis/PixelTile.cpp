@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "PixelTile.h"
+
+#include <kis_node.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+struct PixelTile::Private {
+    KisNodeSP node;
+    KisPaintDeviceSP device;
+
+    /**
+     * The accessors keep the tile locked for as long as they exist
+     */
+    KisRandomAccessorSP accessor;
+    KisRandomConstAccessorSP constAccessor;
+
+    QRect bounds;
+    quint8 *data = 0;
+    int rowStride = 0;
+
+    int numBuffers = 0;
+    bool closeRequested = false;
+};
+
+PixelTile::PixelTile(KisNodeSP node, KisPaintDeviceSP device, const QRect &rect, bool writable, QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+    d->node = node;
+    d->device = device;
+
+    if (!device || rect.isEmpty()) return;
+
+    const int x = rect.x();
+    const int y = rect.y();
+
+    if (writable) {
+        d->accessor = device->createRandomAccessorNG(x, y);
+        d->accessor->moveTo(x, y);
+        d->data = d->accessor->rawData();
+        d->rowStride = d->accessor->rowStride(x, y);
+        d->bounds = QRect(x, y,
+                          qMin(rect.width(), d->accessor->numContiguousColumns(x)),
+                          qMin(rect.height(), d->accessor->numContiguousRows(y)));
+    } else {
+        d->constAccessor = device->createRandomConstAccessorNG(x, y);
+        d->constAccessor->moveTo(x, y);
+        d->data = const_cast<quint8*>(d->constAccessor->rawDataConst());
+        d->rowStride = d->constAccessor->rowStride(x, y);
+        d->bounds = QRect(x, y,
+                          qMin(rect.width(), d->constAccessor->numContiguousColumns(x)),
+                          qMin(rect.height(), d->constAccessor->numContiguousRows(y)));
+    }
+}
+
+PixelTile::~PixelTile()
+{
+    release();
+    delete d;
+}
+
+bool PixelTile::isValid() const
+{
+    return d->data && !d->closeRequested;
+}
+
+bool PixelTile::isWritable() const
+{
+    return !d->accessor.isNull();
+}
+
+QRect PixelTile::bounds() const
+{
+    return d->bounds;
+}
+
+int PixelTile::pixelSize() const
+{
+    return d->device ? d->device->pixelSize() : 0;
+}
+
+int PixelTile::rowStride() const
+{
+    return d->rowStride;
+}
+
+void PixelTile::close()
+{
+    d->closeRequested = true;
+
+    if (!d->numBuffers) {
+        release();
+    }
+}
+
+quint8* PixelTile::data() const
+{
+    return isValid() ? d->data : 0;
+}
+
+void PixelTile::attachBuffer()
+{
+    d->numBuffers++;
+}
+
+void PixelTile::detachBuffer()
+{
+    d->numBuffers--;
+
+    if (!d->numBuffers && d->closeRequested) {
+        release();
+    }
+}
+
+void PixelTile::release()
+{
+    if (!d->data) return;
+
+    const bool wasWritable = !d->accessor.isNull();
+
+    d->data = 0;
+    d->accessor = 0;
+    d->constAccessor = 0;
+
+    if (wasWritable && d->node) {
+        d->node->setDirty(d->bounds);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#ifndef LIBKIS_PIXELTILE_H
+#define LIBKIS_PIXELTILE_H
+
+#include <QObject>
+#include <QRect>
+
+#include "kritalibkis_export.h"
+#include "libkis.h"
+
+#include <kis_types.h>
+
+/**
+ * A PixelTile gives direct access to the pixels of a Node without
+ * copying them. It covers a rectangle that lies entirely inside one
+ * tile of Krita's tiled storage (64x64 pixels), and its memory is the
+ * memory of that tile. Use Node.tileRects() to split a big area into
+ * such rectangles and Node.pixelTile() to create the tiles.
+ *
+ * In Python the tile supports the buffer protocol, so it can be
+ * wrapped into a numpy array without any copying:
+ *
+ * @code
+ * for rect in node.tileRects(0, 0, width, height):
+ *     tile = node.pixelTile(rect.x(), rect.y(), rect.width(), rect.height(), True)
+ *     pixels = numpy.asarray(tile)  # shape: (height, width, pixelSize), dtype uint8
+ *     pixels[..., 3] = 255
+ *     del pixels
+ *     tile.close()
+ * @endcode
+ *
+ * Use pixels.view(numpy.float32) or similar to work with the channels
+ * of the deeper color spaces. The order of the channels is the same as
+ * in Node.pixelData().
+ *
+ * While the tile is open, it keeps the tile locked: a writable tile
+ * blocks all the other access to it, including the updates of the
+ * canvas. Therefore, close the tiles as soon as you are done with them.
+ * If there are any Python buffers (e.g. numpy arrays) still referring to
+ * the tile, the lock is released only when the last of them is gone.
+ */
+class KRITALIBKIS_EXPORT PixelTile : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PixelTile)
+
+public:
+    explicit PixelTile(KisNodeSP node, KisPaintDeviceSP device, const QRect &rect, bool writable, QObject *parent = 0);
+    ~PixelTile() override;
+
+public Q_SLOTS:
+
+    /**
+     * @return true if the tile has not been closed yet
+     */
+    bool isValid() const;
+
+    /**
+     * @return true if the pixels may be changed through the tile
+     */
+    bool isWritable() const;
+
+    /**
+     * @return the rectangle covered by the tile in image coordinates. It may
+     * be smaller than the rectangle requested in Node.pixelTile().
+     */
+    QRect bounds() const;
+
+    /**
+     * @return the number of bytes of one pixel
+     */
+    int pixelSize() const;
+
+    /**
+     * @return the distance between the beginnings of two rows in bytes
+     */
+    int rowStride() const;
+
+    /**
+     * @brief close releases the tile. If the tile is writable, the node
+     * is updated in the covered area.
+     */
+    void close();
+
+public:
+
+    /**
+     * @return the pointer to the first pixel of the tile, or null if the
+     * tile has been closed. Only for the bindings.
+     */
+    quint8* data() const;
+
+    /**
+     * The bindings register every buffer that points to the memory of
+     * the tile, so that the tile stays locked until they are released.
+     */
+    void attachBuffer();
+    void detachBuffer();
+
+private:
+    void release();
+
+private:
+    struct Private;
+    Private *const d;
+};
+
+#endif // LIBKIS_PIXELTILE_H
@@ -19,6 +19,7 @@ class InfoObject;
 class Krita;
 class Node;
 class Notifier;
+class PixelTile;
 class Resource;
 class Selection;
 class View;
@@ -19,9 +19,11 @@
 #include <QTest>
 #include <QColor>
 #include <QDataStream>
+#include <QRegion>
 
 #include <KritaVersionWrapper.h>
 #include <Node.h>
+#include <PixelTile.h>
 #include <Krita.h>
 
 #include <KoColorSpaceRegistry.h>
@@ -117,6 +119,68 @@ void TestNode::testProjectionPixelData()
     }
 }
 
+void TestNode::testPixelTile()
+{
+    KisImageSP image = new KisImage(0, 100, 100, KoColorSpaceRegistry::instance()->rgb8(), "test");
+    KisNodeSP layer = new KisPaintLayer(image, "test1", 255);
+    KisFillPainter gc(layer->paintDevice());
+    gc.fillRect(0, 0, 100, 100, KoColor(Qt::red, layer->colorSpace()));
+    Node node(image, layer);
+
+    const QList<QRect> rects = node.tileRects(10, 10, 80, 80);
+    QCOMPARE(rects.size(), 4);
+
+    QRegion coveredArea;
+    Q_FOREACH (const QRect &rc, rects) {
+        QVERIFY(!coveredArea.intersects(rc));
+        coveredArea += rc;
+    }
+    QCOMPARE(coveredArea, QRegion(10, 10, 80, 80));
+
+    Q_FOREACH (const QRect &rc, rects) {
+        QScopedPointer<PixelTile> tile(node.pixelTile(rc.x(), rc.y(), rc.width(), rc.height(), true));
+        QVERIFY(tile->isValid());
+        QVERIFY(tile->isWritable());
+        QCOMPARE(tile->bounds(), rc);
+        QCOMPARE(tile->pixelSize(), 4);
+
+        for (int y = 0; y < rc.height(); y++) {
+            quint8 *row = tile->data() + y * tile->rowStride();
+            QCOMPARE(row[2], quint8(255));
+
+            for (int x = 0; x < rc.width(); x++) {
+                quint8 *pixel = row + x * tile->pixelSize();
+                pixel[0] = 255;
+                pixel[1] = 0;
+                pixel[2] = 0;
+            }
+        }
+
+        tile->close();
+        QVERIFY(!tile->isValid());
+        QVERIFY(!tile->data());
+    }
+
+    for (int i = 0; i < 100 ; i++) {
+        for (int j = 0; j < 100 ; j++) {
+            QColor pixel;
+            layer->paintDevice()->pixel(i, j, &pixel);
+            QCOMPARE(pixel, QRect(10, 10, 80, 80).contains(i, j) ? QColor(Qt::blue) : QColor(Qt::red));
+        }
+    }
+
+    // a tile is clipped at the tile boundary
+    QScopedPointer<PixelTile> tile(node.pixelTile(60, 0, 20, 20));
+    QVERIFY(!tile->isWritable());
+    QCOMPARE(tile->bounds(), QRect(60, 0, 4, 20));
+
+    // the memory is kept until the last buffer is released
+    tile->attachBuffer();
+    tile->close();
+    QVERIFY(!tile->isValid());
+    tile->detachBuffer();
+}
+
 void TestNode::testThumbnail()
 {
     KisImageSP image = new KisImage(0, 100, 100, KoColorSpaceRegistry::instance()->rgb8(), "test");
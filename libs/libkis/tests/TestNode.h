@@ -29,6 +29,7 @@ private Q_SLOTS:
     void testSetColorProfile();
     void testPixelData();
     void testProjectionPixelData();
+    void testPixelTile();
     void testThumbnail();
     void testMergeDown();
 };
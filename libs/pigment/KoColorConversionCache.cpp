@@ -19,6 +19,7 @@
 
 #include "KoColorConversionCache.h"
 
+#include <QAtomicInt>
 #include <QHash>
 #include <QList>
 #include <QMutex>
@@ -56,10 +57,17 @@ uint qHash(const KoColorConversionCacheKey& key)
     return qHash(key.src) + qHash(key.dst) + qHash(key.renderingIntent) + qHash(key.conversionFlags);
 }
 
+/**
+ * The transformation is shared between the cache and the threads using
+ * it. The cache holds one reference itself, so the transformation is
+ * available when the cache is the only holder. A transformation removed
+ * from the cache while still used by some thread is deleted by the last
+ * user.
+ */
 struct KoColorConversionCache::CachedTransformation {
 
     CachedTransformation(KoColorConversionTransformation* _transfo)
-        : transfo(_transfo), use(0)
+        : transfo(_transfo), ref(1)
     {}
 
     ~CachedTransformation() {
@@ -67,20 +75,57 @@ struct KoColorConversionCache::CachedTransformation {
     }
 
     bool available() {
-        return use == 0;
+        return ref.loadAcquire() == 1;
     }
 
     KoColorConversionTransformation* transfo;
-    int use;
+    QAtomicInt ref;
 };
 
 typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
 
+namespace {
+
+/**
+ * The number of the transformations each thread keeps for itself. A
+ * stroke thread usually converts between a couple of spaces only, but
+ * the GUI thread also converts for the display and the color selectors.
+ */
+const int maxThreadLocalItems = 8;
+
+}
+
+/**
+ * The transformations used recently by one thread, the most recent goes
+ * first. The lookups in the pool need no locking, the shared cache is
+ * locked only when the thread needs a transformation it has not used
+ * recently.
+ */
+struct ThreadLocalPool {
+    ~ThreadLocalPool() {
+        clear();
+    }
+
+    void clear() {
+        qDeleteAll(items);
+        items.clear();
+    }
+
+    int generation = 0;
+    QList<FastPathCacheItem*> items;
+};
+
 struct KoColorConversionCache::Private {
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
     QMutex cacheMutex;
 
-    QThreadStorage<FastPathCacheItem*> fastStorage;
+    /**
+     * Incremented when a color space is destroyed, the threads drop their
+     * pools on the next lookup then
+     */
+    QAtomicInt generation;
+
+    QThreadStorage<ThreadLocalPool*> threadPools;
 };
 
 
@@ -90,8 +135,12 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
+    d->threadPools.setLocalData(0);
+
     Q_FOREACH (CachedTransformation* transfo, d->cache) {
-        delete transfo;
+        if (!transfo->ref.deref()) {
+            delete transfo;
+        }
     }
     delete d;
 }
@@ -103,20 +152,33 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
 {
     KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
 
-    FastPathCacheItem *cacheItem =
-        d->fastStorage.localData();
+    ThreadLocalPool *pool = d->threadPools.localData();
+    if (!pool) {
+        pool = new ThreadLocalPool;
+        pool->generation = d->generation.loadAcquire();
+        d->threadPools.setLocalData(pool);
+    }
 
-    if (cacheItem) {
-        if (cacheItem->first == key) {
-            return cacheItem->second;
+    const int generation = d->generation.loadAcquire();
+    if (pool->generation != generation) {
+        pool->clear();
+        pool->generation = generation;
+    }
+
+    for (int i = 0; i < pool->items.size(); i++) {
+        if (pool->items[i]->first == key) {
+            if (i > 0) {
+                pool->items.move(i, 0);
+            }
+            return pool->items.first()->second;
         }
     }
 
-    cacheItem = 0;
+    FastPathCacheItem *cacheItem = 0;
 
-    QMutexLocker lock(&d->cacheMutex);
-    QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
+    {
+        QMutexLocker lock(&d->cacheMutex);
+        QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
         Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
             if (ct->available()) {
                 ct->transfo->setSrcColorSpace(src);
@@ -127,27 +189,46 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
             }
         }
     }
+
     if (!cacheItem) {
+        /**
+         * Creation of an LCMS transformation may take a while, so don't
+         * block the other threads while doing that
+         */
         KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
         CachedTransformation* ct = new CachedTransformation(transfo);
-        d->cache.insert(key, ct);
         cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+
+        QMutexLocker lock(&d->cacheMutex);
+        d->cache.insert(key, ct);
+    }
+
+    pool->items.prepend(cacheItem);
+
+    while (pool->items.size() > maxThreadLocalItems) {
+        delete pool->items.takeLast();
     }
 
-    d->fastStorage.setLocalData(cacheItem);
     return cacheItem->second;
 }
 
 void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
-    d->fastStorage.setLocalData(0);
+    d->threadPools.setLocalData(0);
+    d->generation.ref();
 
     QMutexLocker lock(&d->cacheMutex);
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
     for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
         if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
+            /**
+             * The pools of the other threads may still keep the
+             * transformation, it will be deleted when they drop it on
+             * their next lookup
+             */
+            if (!it.value()->ref.deref()) {
+                delete it.value();
+            }
             it = d->cache.erase(it);
         } else {
             ++it;
@@ -168,18 +249,19 @@ KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(KoC
     Q_ASSERT(transfo->available());
     d->cache = cache;
     d->transfo = transfo;
-    d->transfo->use++;
+    d->transfo->ref.ref();
 }
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(const KoCachedColorConversionTransformation& rhs) : d(new Private(*rhs.d))
 {
-    d->transfo->use++;
+    d->transfo->ref.ref();
 }
 
 KoCachedColorConversionTransformation::~KoCachedColorConversionTransformation()
 {
-    d->transfo->use--;
-    Q_ASSERT(d->transfo->use >= 0);
+    if (!d->transfo->ref.deref()) {
+        delete d->transfo;
+    }
     delete d;
 }
 
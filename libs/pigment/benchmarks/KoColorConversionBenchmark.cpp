@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoColorConversionBenchmark.h"
+
+#include <QTest>
+#include <QPair>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpace.h>
+#include <KoColorModelStandardIds.h>
+
+/**
+ * The conversions are done in small chunks, like the ones of the dabs
+ * and the color pickers, so the cost of fetching the transformation from
+ * the cache is visible
+ */
+#define NB_PIXELS_IN_CHUNK 64
+#define NB_CHUNKS_PER_THREAD 100000
+
+typedef QPair<const KoColorSpace*, const KoColorSpace*> Conversion;
+
+namespace {
+
+class ConversionRunnable : public QRunnable
+{
+public:
+    ConversionRunnable(const QVector<Conversion> &conversions)
+        : m_conversions(conversions)
+    {
+    }
+
+    void run() override {
+        const int bufferSize = NB_PIXELS_IN_CHUNK * 16;
+        QVector<quint8> src(bufferSize);
+        QVector<quint8> dst(bufferSize);
+
+        for (int i = 0; i < NB_CHUNKS_PER_THREAD; i++) {
+            const Conversion &conversion = m_conversions[i % m_conversions.size()];
+
+            conversion.first->convertPixelsTo(src.constData(), dst.data(),
+                                              conversion.second, NB_PIXELS_IN_CHUNK,
+                                              KoColorConversionTransformation::internalRenderingIntent(),
+                                              KoColorConversionTransformation::internalConversionFlags());
+        }
+    }
+
+private:
+    QVector<Conversion> m_conversions;
+};
+
+}
+
+void KoColorConversionBenchmark::benchmarkMultiThreadedConversion_data()
+{
+    QTest::addColumn<int>("numThreads");
+    QTest::addColumn<bool>("alternateSpaces");
+
+    for (int numThreads : {1, 2, 4, 8}) {
+        QTest::newRow(QString("%1 threads, single").arg(numThreads).toLatin1().data())
+            << numThreads << false;
+        QTest::newRow(QString("%1 threads, alternating").arg(numThreads).toLatin1().data())
+            << numThreads << true;
+    }
+}
+
+void KoColorConversionBenchmark::benchmarkMultiThreadedConversion()
+{
+    QFETCH(int, numThreads);
+    QFETCH(bool, alternateSpaces);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    const KoColorSpace *rgb8 = registry->rgb8();
+    const KoColorSpace *rgb16 = registry->rgb16();
+    const KoColorSpace *lab16 = registry->lab16();
+
+    QVector<Conversion> conversions;
+    conversions << Conversion(rgb8, lab16);
+
+    /**
+     * A stroke usually converts between several spaces at once, e.g.
+     * the color of the brush, the dab and the display
+     */
+    if (alternateSpaces) {
+        conversions << Conversion(lab16, rgb8);
+        conversions << Conversion(rgb16, rgb8);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+
+    QBENCHMARK {
+        for (int i = 0; i < numThreads; i++) {
+            pool.start(new ConversionRunnable(conversions));
+        }
+        pool.waitForDone();
+    }
+}
+
+QTEST_MAIN(KoColorConversionBenchmark)
@@ -93,6 +93,89 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     }
 };
 
+/**
+ * Maps a separable blending function to its vectorized version. The
+ * functions based on pow() or atan() have no such version, so they are
+ * mapped to -1.
+ */
+template<float compositeFunc(float, float)>
+struct OptimizedGenericSCFunction
+{
+    static const int value = -1;
+};
+
+#define DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(func) \
+    template<> \
+    struct OptimizedGenericSCFunction<&cf##func<float> > \
+    { \
+        static const int value = KoOptimizedCompositeOpFactory::GenericSC##func; \
+    }
+
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Multiply);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Screen);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Overlay);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(HardLight);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(SoftLight);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(SoftLightSvg);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(ColorDodge);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(ColorBurn);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Addition);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(LinearBurn);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Subtract);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(InverseSubtract);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(DarkenOnly);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(LightenOnly);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Difference);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Exclusion);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Divide);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(LinearLight);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(PinLight);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(VividLight);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(HardMix);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(HardMixPhotoshop);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(GrainMerge);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(GrainExtract);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Allanon);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Parallel);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Equivalence);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(AdditiveSubtractive);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(GeometricMean);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(HardOverlay);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Glow);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Reflect);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Heat);
+DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION(Freeze);
+
+#undef DECLARE_OPTIMIZED_GENERIC_SC_FUNCTION
+
+/**
+ * The integer separable ops are not vectorized: the legacy ops round every
+ * intermediate value to the channel type and a float implementation cannot
+ * reproduce that exactly for the semi-transparent pixels.
+ */
+template<class Traits>
+struct GenericSCOpSelector
+{
+    template<typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+    static KoCompositeOp* create(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, description, category);
+    }
+};
+
+template<>
+struct GenericSCOpSelector<KoRgbF32Traits>
+{
+    template<float compositeFunc(float, float)>
+    static KoCompositeOp* create(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        const int function = OptimizedGenericSCFunction<compositeFunc>::value;
+
+        KoCompositeOp *op = function >= 0 ?
+            KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, KoOptimizedCompositeOpFactory::GenericSCFunction(function), id, description, category) : 0;
+
+        return op ? op : new KoCompositeOpGenericSC<KoRgbF32Traits, compositeFunc>(cs, id, description, category);
+    }
+};
+
 template<class Traits>
 struct AddGeneralOps<Traits, true>
 {
@@ -102,7 +185,7 @@ struct AddGeneralOps<Traits, true>
 
      template<CompositeFunc func>
      static void add(KoColorSpace* cs, const QString& id, const QString& description, const QString& category) {
-         cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category));
+         cs->addCompositeOp(GenericSCOpSelector<Traits>::template create<func>(cs, id, description, category));
      }
 
      static void add(KoColorSpace* cs) {
@@ -44,3 +44,9 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOp128(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp128(const KoColorSpace *cs, GenericSCFunction function, const QString &id, const QString &description, const QString &category)
+{
+    const KoGenericSCCompositeOpInfo info = {cs, function, id, description, category};
+    return createOptimizedClass<KoOptimizedGenericSCCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128> >(info);
+}
@@ -24,6 +24,7 @@
 
 class KoCompositeOp;
 class KoColorSpace;
+class QString;
 
 /**
  * The creation of the optimized composite ops is moved into a separate
@@ -44,6 +45,56 @@ public:
     static KoCompositeOp* createOverOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOp128(const KoColorSpace *cs);
     static KoCompositeOp* createOverOp128(const KoColorSpace *cs);
+
+    /**
+     * The separable blending functions (see KoCompositeOpFunctions.h)
+     * that have a vectorized version
+     */
+    enum GenericSCFunction {
+        GenericSCMultiply,
+        GenericSCScreen,
+        GenericSCOverlay,
+        GenericSCHardLight,
+        GenericSCSoftLight,
+        GenericSCSoftLightSvg,
+        GenericSCColorDodge,
+        GenericSCColorBurn,
+        GenericSCAddition,
+        GenericSCLinearBurn,
+        GenericSCSubtract,
+        GenericSCInverseSubtract,
+        GenericSCDarkenOnly,
+        GenericSCLightenOnly,
+        GenericSCDifference,
+        GenericSCExclusion,
+        GenericSCDivide,
+        GenericSCLinearLight,
+        GenericSCPinLight,
+        GenericSCVividLight,
+        GenericSCHardMix,
+        GenericSCHardMixPhotoshop,
+        GenericSCGrainMerge,
+        GenericSCGrainExtract,
+        GenericSCAllanon,
+        GenericSCParallel,
+        GenericSCEquivalence,
+        GenericSCAdditiveSubtractive,
+        GenericSCGeometricMean,
+        GenericSCHardOverlay,
+        GenericSCGlow,
+        GenericSCReflect,
+        GenericSCHeat,
+        GenericSCFreeze
+    };
+
+    /**
+     * Create a vectorized version of the separable blending function
+     * \p function for the RGBA F32 (128-bit) color spaces.
+     *
+     * \return null if the CPU doesn't support vector instructions. In
+     *         this case KoCompositeOpGenericSC should be used.
+     */
+    static KoCompositeOp* createGenericSCOp128(const KoColorSpace *cs, GenericSCFunction function, const QString &id, const QString &description, const QString &category);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
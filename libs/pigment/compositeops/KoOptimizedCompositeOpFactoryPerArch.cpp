@@ -26,6 +26,7 @@
 #include "KoOptimizedCompositeOpAlphaDarken128.h"
 #include "KoOptimizedCompositeOpOver32.h"
 #include "KoOptimizedCompositeOpOver128.h"
+#include "KoOptimizedCompositeOpGenericSC.h"
 
 #include <QString>
 #include "DebugPigment.h"
@@ -67,3 +68,11 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoOptimizedCompositeOpOver128<Vc::CurrentImplementation::current()>(param);
 }
+
+template<>
+template<>
+KoOptimizedGenericSCCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedGenericSCCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return createOptimizedGenericSCOp<KoOptimizedCompositeOpGenericSC128, Vc::CurrentImplementation::current()>(param);
+}
@@ -23,6 +23,10 @@
 
 #include <compositeops/KoVcMultiArchBuildSupport.h>
 
+#include <QString>
+
+#include "KoOptimizedCompositeOpFactory.h"
+
 
 class KoCompositeOp;
 class KoColorSpace;
@@ -40,6 +44,9 @@ class KoOptimizedCompositeOpAlphaDarken128;
 template<Vc::Implementation _impl>
 class KoOptimizedCompositeOpOver128;
 
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC128;
+
 template<template<Vc::Implementation I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch
 {
@@ -50,5 +57,28 @@ struct KoOptimizedCompositeOpFactoryPerArch
     static ReturnType create(ParamType param);
 };
 
+struct KoGenericSCCompositeOpInfo
+{
+    const KoColorSpace *colorSpace;
+    KoOptimizedCompositeOpFactory::GenericSCFunction function;
+    QString id;
+    QString description;
+    QString category;
+};
+
+/**
+ * The separable composite ops are templated by the blending function,
+ * which is passed to the factory in KoGenericSCCompositeOpInfo::function
+ */
+template<template<Vc::Implementation I, class BlendFunc> class CompositeOp>
+struct KoOptimizedGenericSCCompositeOpFactoryPerArch
+{
+    typedef const KoGenericSCCompositeOpInfo& ParamType;
+    typedef KoCompositeOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H */
@@ -55,3 +55,17 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoCompositeOpOver<KoRgbF32Traits>(param);
 }
+
+/**
+ * There is no point in creating a scalar version of the separable
+ * composite ops, KoCompositeOpGenericSC is used instead
+ */
+
+template<>
+template<>
+KoOptimizedGenericSCCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedGenericSCCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return 0;
+}
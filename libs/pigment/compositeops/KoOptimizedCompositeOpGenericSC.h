@@ -0,0 +1,308 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctions.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+/**
+ * Scalar part of the optimized separable composite op. It follows the
+ * math of KoCompositeOpGenericSC for floating point channels, so the
+ * results of the scalar and vector versions are the same.
+ *
+ * NOTE: there is no version for the integer channels, because the legacy
+ *       ops round every intermediate value and a float implementation
+ *       cannot reproduce them exactly for the semi-transparent pixels
+ */
+template<class BlendFunc, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositorBase {
+    typedef KoStreamedBlend::NoClamp Clamp;
+
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        const qint32 alpha_pos = 3;
+
+        const float *s = reinterpret_cast<const float*>(src);
+        float *d = reinterpret_cast<float*>(dst);
+
+        float srcAlpha = s[alpha_pos] * opacity;
+
+        if (haveMask) {
+            srcAlpha *= float(*mask) * (1.0f / 255.0f);
+        }
+
+        const float dstAlpha = d[alpha_pos];
+
+        if (!allChannelsFlag && dstAlpha == 0.0f) {
+            KoStreamedMathFunctions::clearPixel<4 * sizeof(float)>(dst);
+        }
+
+        if (alphaLocked) {
+            if (dstAlpha != 0.0f) {
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || oparams.channelFlags.testBit(i)) {
+                        const float dc = d[i];
+                        const float result = BlendFunc::template blend<Clamp>(s[i], dc);
+                        d[i] = dc + srcAlpha * (result - dc);
+                    }
+                }
+            }
+        } else {
+            const float newDstAlpha = srcAlpha + dstAlpha - srcAlpha * dstAlpha;
+
+            if (newDstAlpha != 0.0f) {
+                const float srcOnly = srcAlpha * (1.0f - dstAlpha);
+                const float dstOnly = dstAlpha * (1.0f - srcAlpha);
+                const float both = srcAlpha * dstAlpha;
+                const float norm = 1.0f / newDstAlpha;
+
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || oparams.channelFlags.testBit(i)) {
+                        const float sc = s[i];
+                        const float dc = d[i];
+                        const float result = BlendFunc::template blend<Clamp>(sc, dc);
+                        d[i] = (dstOnly * dc + srcOnly * sc + both * result) * norm;
+                    }
+                }
+            }
+
+            d[alpha_pos] = newDstAlpha;
+        }
+    }
+
+    /**
+     * Composes a single color channel of Vc::float_v::size() pixels. All the
+     * values are expected to be normalized.
+     */
+    static ALWAYS_INLINE Vc::float_v blendChannelVector(Vc::float_v::AsArg src,
+                                                        Vc::float_v::AsArg dst,
+                                                        Vc::float_v::AsArg srcOnly,
+                                                        Vc::float_v::AsArg dstOnly,
+                                                        Vc::float_v::AsArg both)
+    {
+        return dstOnly * dst + srcOnly * src + both * BlendFunc::template blend<Clamp>(src, dst);
+    }
+};
+
+/**
+ * Vectorized separable composite op for the use in 16 byte
+ * colorspaces with alpha channel placed at the last float of
+ * the pixel: C1_C2_C3_A.
+ */
+template<class BlendFunc, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor128 : public GenericSCCompositorBase<BlendFunc, alphaLocked, allChannelsFlag>
+{
+    typedef GenericSCCompositorBase<BlendFunc, alphaLocked, allChannelsFlag> base_class;
+    typedef typename base_class::OptionalParams OptionalParams;
+
+    struct Pixel {
+        float c1;
+        float c2;
+        float c3;
+        float alpha;
+    };
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+
+        const Pixel *sp = reinterpret_cast<const Pixel*>(src);
+        Pixel *dp = reinterpret_cast<Pixel*>(dst);
+
+        Vc::float_v src_alpha;
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        const Vc::float_v::IndexType indexes(Vc::IndexesFromZero);
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> data(const_cast<Pixel*>(sp));
+        tie(src_c1, src_c2, src_c3, src_alpha) = data[indexes];
+
+        src_alpha *= Vc::float_v(opacity);
+
+        if (haveMask) {
+            const Vc::float_v uint8MaxRec1((float)1.0 / 255);
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            src_alpha *= mask_vec * uint8MaxRec1;
+        }
+
+        const Vc::float_v zeroValue(Vc::Zero);
+        const Vc::float_v oneValue(Vc::One);
+
+        // The source cannot change the colors in the destination,
+        // since its fully transparent
+        if ((src_alpha == zeroValue).isFull()) {
+            return;
+        }
+
+        Vc::float_v dst_alpha;
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> dataDest(dp);
+        tie(dst_c1, dst_c2, dst_c3, dst_alpha) = dataDest[indexes];
+
+        Vc::float_v new_alpha;
+
+        if ((dst_alpha == oneValue).isFull()) {
+            new_alpha = oneValue;
+
+            dst_c1 += src_alpha * (BlendFunc::template blend<typename base_class::Clamp>(src_c1, dst_c1) - dst_c1);
+            dst_c2 += src_alpha * (BlendFunc::template blend<typename base_class::Clamp>(src_c2, dst_c2) - dst_c2);
+            dst_c3 += src_alpha * (BlendFunc::template blend<typename base_class::Clamp>(src_c3, dst_c3) - dst_c3);
+        } else {
+            new_alpha = src_alpha + dst_alpha - src_alpha * dst_alpha;
+
+            const Vc::float_v srcOnly = src_alpha * (oneValue - dst_alpha);
+            const Vc::float_v dstOnly = dst_alpha * (oneValue - src_alpha);
+            const Vc::float_v both = src_alpha * dst_alpha;
+
+            const Vc::float_m emptyPixels = new_alpha == zeroValue;
+            const Vc::float_v norm = oneValue / new_alpha;
+
+            dst_c1 = Vc::iif(emptyPixels, dst_c1, base_class::blendChannelVector(src_c1, dst_c1, srcOnly, dstOnly, both) * norm);
+            dst_c2 = Vc::iif(emptyPixels, dst_c2, base_class::blendChannelVector(src_c2, dst_c2, srcOnly, dstOnly, both) * norm);
+            dst_c3 = Vc::iif(emptyPixels, dst_c3, base_class::blendChannelVector(src_c3, dst_c3, srcOnly, dstOnly, both) * norm);
+        }
+
+        dataDest[indexes] = tie(dst_c1, dst_c2, dst_c3, new_alpha);
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpGenericSC for the use in 16 byte
+ * colorspaces with alpha channel placed at the last float of
+ * the pixel: C1_C2_C3_A.
+ */
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC128 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpGenericSC128(const KoColorSpace* cs, const QString& id, const QString& description, const QString& category)
+        : KoCompositeOp(cs, id, description, category) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite128<haveMask, false, GenericSCCompositor128<BlendFunc, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunc, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunc, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunc, true, false> >(params);
+            }
+        }
+    }
+};
+
+/**
+ * Creates a vectorized version of the separable composite op for the
+ * blending function \p info.function
+ */
+template<template<Vc::Implementation I, class BlendFunc> class CompositeOp, Vc::Implementation _impl>
+KoCompositeOp* createOptimizedGenericSCOp(const KoGenericSCCompositeOpInfo &info)
+{
+#define CREATE_GENERIC_SC_OP(func) \
+    case KoOptimizedCompositeOpFactory::GenericSC##func: \
+        return new CompositeOp<_impl, KoStreamedBlend::func>(info.colorSpace, info.id, info.description, info.category)
+
+    switch (info.function) {
+    CREATE_GENERIC_SC_OP(Multiply);
+    CREATE_GENERIC_SC_OP(Screen);
+    CREATE_GENERIC_SC_OP(Overlay);
+    CREATE_GENERIC_SC_OP(HardLight);
+    CREATE_GENERIC_SC_OP(SoftLight);
+    CREATE_GENERIC_SC_OP(SoftLightSvg);
+    CREATE_GENERIC_SC_OP(ColorDodge);
+    CREATE_GENERIC_SC_OP(ColorBurn);
+    CREATE_GENERIC_SC_OP(Addition);
+    CREATE_GENERIC_SC_OP(LinearBurn);
+    CREATE_GENERIC_SC_OP(Subtract);
+    CREATE_GENERIC_SC_OP(InverseSubtract);
+    CREATE_GENERIC_SC_OP(DarkenOnly);
+    CREATE_GENERIC_SC_OP(LightenOnly);
+    CREATE_GENERIC_SC_OP(Difference);
+    CREATE_GENERIC_SC_OP(Exclusion);
+    CREATE_GENERIC_SC_OP(Divide);
+    CREATE_GENERIC_SC_OP(LinearLight);
+    CREATE_GENERIC_SC_OP(PinLight);
+    CREATE_GENERIC_SC_OP(VividLight);
+    CREATE_GENERIC_SC_OP(HardMix);
+    CREATE_GENERIC_SC_OP(HardMixPhotoshop);
+    CREATE_GENERIC_SC_OP(GrainMerge);
+    CREATE_GENERIC_SC_OP(GrainExtract);
+    CREATE_GENERIC_SC_OP(Allanon);
+    CREATE_GENERIC_SC_OP(Parallel);
+    CREATE_GENERIC_SC_OP(Equivalence);
+    CREATE_GENERIC_SC_OP(AdditiveSubtractive);
+    CREATE_GENERIC_SC_OP(GeometricMean);
+    CREATE_GENERIC_SC_OP(HardOverlay);
+    CREATE_GENERIC_SC_OP(Glow);
+    CREATE_GENERIC_SC_OP(Reflect);
+    CREATE_GENERIC_SC_OP(Heat);
+    CREATE_GENERIC_SC_OP(Freeze);
+    }
+
+#undef CREATE_GENERIC_SC_OP
+
+    return 0;
+}
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
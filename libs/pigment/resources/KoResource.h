@@ -101,14 +101,15 @@ public:
     bool permanent() const;
     void setPermanent(bool permanent);
 
+    /// call this when the contents of the resource change so the md5 needs to be recalculated,
+    /// the resource servers also use it to restore the md5 cached from the previous session
+    void setMD5(const QByteArray &md5);
+
 protected:
 
     /// override generateMD5 and in your resource subclass
     virtual QByteArray generateMD5() const;
 
-    /// call this when the contents of the resource change so the md5 needs to be recalculated
-    void setMD5(const QByteArray &md5);
-
 protected:
     KoResource(const KoResource &rhs);
 
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisAnimationFrameStream.h"
+
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include "kis_assert.h"
+#include "kis_time_range.h"
+
+
+struct KisAnimationFrameStream::Private
+{
+    Private(const KisTimeRange &range, int _capacity)
+        : nextFrame(range.start()),
+          lastFrame(range.end()),
+          capacity(_capacity)
+    {
+    }
+
+    mutable QMutex mutex;
+    QWaitCondition frameAdded;
+
+    QMap<int, QImage> pendingFrames;
+    int nextFrame;
+    const int lastFrame;
+    const int capacity;
+    bool isAborted = false;
+};
+
+KisAnimationFrameStream::KisAnimationFrameStream(const KisTimeRange &range, int capacity, QObject *parent)
+    : QObject(parent),
+      m_d(new Private(range, qMax(1, capacity)))
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(range.isValid() && !range.isInfinite());
+}
+
+KisAnimationFrameStream::~KisAnimationFrameStream()
+{
+}
+
+int KisAnimationFrameStream::capacity() const
+{
+    return m_d->capacity;
+}
+
+bool KisAnimationFrameStream::canAcceptFrame(int frame) const
+{
+    QMutexLocker l(&m_d->mutex);
+    return !m_d->isAborted && frame < m_d->nextFrame + m_d->capacity;
+}
+
+bool KisAnimationFrameStream::pushFrame(int frame, const QImage &image)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->isAborted) return false;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frame >= m_d->nextFrame && frame <= m_d->lastFrame, false);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->pendingFrames.contains(frame));
+
+    m_d->pendingFrames.insert(frame, image);
+    m_d->frameAdded.wakeAll();
+
+    return true;
+}
+
+bool KisAnimationFrameStream::popFrame(QImage *image)
+{
+    int frame = -1;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        while (!m_d->isAborted &&
+               m_d->nextFrame <= m_d->lastFrame &&
+               !m_d->pendingFrames.contains(m_d->nextFrame)) {
+
+            m_d->frameAdded.wait(&m_d->mutex);
+        }
+
+        if (m_d->isAborted || m_d->nextFrame > m_d->lastFrame) {
+            return false;
+        }
+
+        frame = m_d->nextFrame++;
+        *image = m_d->pendingFrames.take(frame);
+    }
+
+    emit sigFrameConsumed(frame);
+    return true;
+}
+
+void KisAnimationFrameStream::abort()
+{
+    {
+        QMutexLocker l(&m_d->mutex);
+        if (m_d->isAborted) return;
+
+        m_d->isAborted = true;
+        m_d->pendingFrames.clear();
+        m_d->frameAdded.wakeAll();
+    }
+
+    emit sigAborted();
+}
+
+bool KisAnimationFrameStream::isAborted() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->isAborted;
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISANIMATIONFRAMESTREAM_H
+#define KISANIMATIONFRAMESTREAM_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include "kritaui_export.h"
+
+class QImage;
+class KisTimeRange;
+
+/**
+ * KisAnimationFrameStream connects the asynchronous renderers of the
+ * animation frames to a single consumer, which needs the frames strictly
+ * in order, e.g. an encoder reading raw frames from a pipe.
+ *
+ * The renderers push the frames in any order from any thread and the
+ * consumer pops them one by one in order of their time. To keep the memory
+ * usage bounded, the renderers are expected to start a frame only when
+ * canAcceptFrame() returns true for it, that is, when the frame is not
+ * further than capacity() frames ahead of the consumer. Every time the
+ * consumer takes a frame sigFrameConsumed() is emitted.
+ *
+ * Any side may abort() the stream, after which all the pushes fail and
+ * the consumer stops receiving the frames.
+ */
+class KRITAUI_EXPORT KisAnimationFrameStream : public QObject
+{
+    Q_OBJECT
+public:
+    KisAnimationFrameStream(const KisTimeRange &range, int capacity, QObject *parent = 0);
+    ~KisAnimationFrameStream() override;
+
+    int capacity() const;
+
+    /**
+     * @return true if \p frame is close enough to the consumer and the
+     * stream is not aborted
+     */
+    bool canAcceptFrame(int frame) const;
+
+    /**
+     * Adds a rendered \p frame into the stream. Never blocks.
+     *
+     * @return false if the stream has been aborted
+     */
+    bool pushFrame(int frame, const QImage &image);
+
+    /**
+     * Waits for the next frame of the range and moves it into \p image.
+     *
+     * @return false if the stream has been aborted or all the frames of
+     * the range have already been consumed
+     */
+    bool popFrame(QImage *image);
+
+    /**
+     * Drops all the pending frames and wakes up the consumer
+     */
+    void abort();
+
+    bool isAborted() const;
+
+Q_SIGNALS:
+    void sigFrameConsumed(int frame);
+    void sigAborted();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISANIMATIONFRAMESTREAM_H
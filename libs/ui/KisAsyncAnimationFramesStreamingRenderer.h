@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+#define KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+
+#include <KisAsyncAnimationRendererBase.h>
+
+class KisAnimationFrameStream;
+
+/**
+ * Renders the frames into 8-bit sRGB QImage's in QImage::Format_RGBA8888
+ * and pushes them into a KisAnimationFrameStream. Unlike
+ * KisAsyncAnimationFramesSavingRenderer it doesn't encode the frames into
+ * files, so the consumer of the stream can feed them to an encoder directly.
+ */
+class KisAsyncAnimationFramesStreamingRenderer : public KisAsyncAnimationRendererBase
+{
+    Q_OBJECT
+public:
+    KisAsyncAnimationFramesStreamingRenderer(KisAnimationFrameStream *stream);
+    ~KisAsyncAnimationFramesStreamingRenderer();
+
+protected:
+    void frameCompletedCallback(int frame, const QRegion &requestedRegion) override;
+    void frameCancelledCallback(int frame) override;
+
+Q_SIGNALS:
+    void sigCompleteRegenerationInternal(int frame);
+    void sigCancelRegenerationInternal(int frame);
+
+private:
+    KisAnimationFrameStream *m_stream;
+};
+
+#endif // KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
@@ -1184,7 +1184,10 @@ bool KisDocument::openFile()
 {
     //dbgUI <<"for" << localFilePath();
     if (!QFile::exists(localFilePath())) {
-        QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("File %1 does not exist.", localFilePath()));
+        d->lastErrorMessage = i18n("File %1 does not exist.", localFilePath());
+        if (!fileBatchMode()) {
+            QMessageBox::critical(0, i18nc("@title:window", "Krita"), d->lastErrorMessage);
+        }
         return false;
     }
 
@@ -1224,7 +1227,7 @@ bool KisDocument::openFile()
 
     if (status != KisImportExportFilter::OK) {
         QString msg = KisImportExportFilter::conversionStatusString(status);
-        if (!msg.isEmpty()) {
+        if (!msg.isEmpty() && !fileBatchMode()) {
             DlgLoadMessages dlg(i18nc("@title:window", "Krita"),
                                 i18n("Could not open %2.\nReason: %1.", msg, prettyPathOrUrl()),
                                 errorMessage().split("\n") + warningMessage().split("\n"));
@@ -1233,10 +1236,12 @@ bool KisDocument::openFile()
         return false;
     }
     else if (!warningMessage().isEmpty()) {
-        DlgLoadMessages dlg(i18nc("@title:window", "Krita"),
-                            i18n("There were problems opening %1.", prettyPathOrUrl()),
-                            warningMessage().split("\n"));
-        dlg.exec();
+        if (!fileBatchMode()) {
+            DlgLoadMessages dlg(i18nc("@title:window", "Krita"),
+                                i18n("There were problems opening %1.", prettyPathOrUrl()),
+                                warningMessage().split("\n"));
+            dlg.exec();
+        }
         setUrl(QUrl());
     }
 
@@ -127,8 +127,8 @@ FrameInfo::~FrameInfo()
 
 struct KRITAUI_NO_EXPORT KisFrameCacheStore::Private
 {
-    Private(const QString &frameCachePath)
-        : serializer(frameCachePath)
+    Private(KisFrameDataSerializer::StorageType storageType, const QString &frameCachePath)
+        : serializer(storageType, frameCachePath)
     {
     }
 
@@ -151,7 +151,12 @@ KisFrameCacheStore::KisFrameCacheStore()
 }
 
 KisFrameCacheStore::KisFrameCacheStore(const QString &frameCachePath)
-    : m_d(new Private(frameCachePath))
+    : KisFrameCacheStore(KisFrameDataSerializer::OnDiskStorage, frameCachePath)
+{
+}
+
+KisFrameCacheStore::KisFrameCacheStore(KisFrameDataSerializer::StorageType storageType, const QString &frameCachePath)
+    : m_d(new Private(storageType, frameCachePath))
 {
 }
 
@@ -367,3 +372,8 @@ QRect KisFrameCacheStore::frameDirtyRect(int frameId) const
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->savedFrames.contains(frameId), QRect());
     return m_d->savedFrames[frameId]->dirtyImageRect();
 }
+
+qint64 KisFrameCacheStore::storedDataSize() const
+{
+    return m_d->serializer.storedDataSize();
+}
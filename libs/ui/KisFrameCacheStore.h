@@ -23,6 +23,7 @@
 #include "kis_types.h"
 
 #include "opengl/kis_texture_tile_info_pool.h"
+#include "KisFrameDataSerializer.h"
 
 class KisOpenGLUpdateInfoBuilder;
 
@@ -45,6 +46,10 @@ typedef KisSharedPtr<KisOpenGLUpdateInfo> KisOpenGLUpdateInfoSP;
  *
  * 4) The in-memory cache of the keyframes is stored in serializable
  *    KisFrameDataSerializer::Frame format.
+ *
+ * With KisFrameDataSerializer::InMemoryStorage the frames are not
+ * swapped to disk, but kept in RAM in the same compressed form, which
+ * lets the cache hold much longer animations than the raw textures do.
  */
 
 class KRITAUI_EXPORT KisFrameCacheStore
@@ -52,6 +57,7 @@ class KRITAUI_EXPORT KisFrameCacheStore
 public:
     KisFrameCacheStore();
     KisFrameCacheStore(const QString &frameCachePath);
+    KisFrameCacheStore(KisFrameDataSerializer::StorageType storageType, const QString &frameCachePath = QString());
 
     ~KisFrameCacheStore();
 
@@ -67,6 +73,11 @@ public:
     int frameLevelOfDetail(int frameId) const;
     QRect frameDirtyRect(int frameId) const;
 
+    /**
+     * \return the total size of the stored compressed frame data in bytes
+     */
+    qint64 storedDataSize() const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
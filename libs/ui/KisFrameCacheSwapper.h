@@ -21,6 +21,7 @@
 #include <QScopedPointer>
 
 #include "KisAbstractFrameCacheSwapper.h"
+#include "KisFrameDataSerializer.h"
 
 class KisOpenGLUpdateInfoBuilder;
 
@@ -42,6 +43,9 @@ class KRITAUI_EXPORT KisFrameCacheSwapper : public KisAbstractFrameCacheSwapper
 public:
     KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder);
     KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder, const QString &frameCachePath);
+    KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder,
+                         KisFrameDataSerializer::StorageType storageType,
+                         const QString &frameCachePath = QString());
     ~KisFrameCacheSwapper();
 
     // WARNING: after transferring \p info to saveFrame() the object becomes invalid
@@ -19,21 +19,64 @@
 
 #include <cstring>
 
+#include <QBuffer>
+#include <QDirIterator>
+#include <QHash>
 #include <QTemporaryDir>
-#include <QElapsedTimer>
 
 #include "tiles3/swap/kis_lzf_compression.h"
 
+namespace {
+
+/**
+ * The way the data of a tile is stored in the frame file
+ */
+enum TileStorageType {
+    TileRaw = 0,
+    TileCompressed,
+
+    /**
+     * The tile data is filled with zeros and is not stored at all. It
+     * happens for the transparent areas of the full frames and, which
+     * is more important, for the tiles of the difference frames that
+     * didn't change since the keyframe.
+     */
+    TileZero
+};
+
+bool isZeroData(const quint8 *data, int numBytes)
+{
+    const int numQWords = numBytes / 8;
+    const quint64 *qwordPtr = reinterpret_cast<const quint64*>(data);
+
+    for (int i = 0; i < numQWords; i++) {
+        if (qwordPtr[i]) return false;
+    }
+
+    for (int i = numQWords * 8; i < numBytes; i++) {
+        if (data[i]) return false;
+    }
+
+    return true;
+}
+
+}
+
 struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
 {
-    Private(const QString &frameCachePath)
-        : framesDir(
-              (!frameCachePath.isEmpty() ? frameCachePath : QDir::tempPath()) +
-              QDir::separator() + "KritaFrameCacheXXXXXX")
+    Private(StorageType _storageType, const QString &frameCachePath)
+        : storageType(_storageType)
     {
-        KIS_SAFE_ASSERT_RECOVER_NOOP(framesDir.isValid());
-        framesDirObject = QDir(framesDir.path());
-        framesDirObject.makeAbsolute();
+        if (storageType == OnDiskStorage) {
+            framesDir.reset(
+                new QTemporaryDir(
+                    (!frameCachePath.isEmpty() ? frameCachePath : QDir::tempPath()) +
+                    QDir::separator() + "KritaFrameCacheXXXXXX"));
+
+            KIS_SAFE_ASSERT_RECOVER_NOOP(framesDir->isValid());
+            framesDirObject = QDir(framesDir->path());
+            framesDirObject.makeAbsolute();
+        }
     }
 
     QString subfolderNameForFrame(int frameId)
@@ -65,52 +108,30 @@ struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
         return reinterpret_cast<quint8*>(compressionBuffer.data());
     }
 
-    QTemporaryDir framesDir;
+    void writeFrame(QIODevice *device, int frameId, const Frame &frame);
+    Frame readFrame(QIODevice *device, int frameId, KisTextureTileInfoPoolSP pool);
+
+    StorageType storageType = OnDiskStorage;
+
+    QScopedPointer<QTemporaryDir> framesDir;
     QDir framesDirObject;
+
+    /**
+     * The frames of InMemoryStorage are kept in the same serialized
+     * (compressed) form as the files of OnDiskStorage
+     */
+    QHash<int, QByteArray> memoryFrames;
+
     int nextFrameId = 0;
 
     QByteArray compressionBuffer;
 };
 
-KisFrameDataSerializer::KisFrameDataSerializer()
-    : KisFrameDataSerializer(QString())
-{
-}
-
-KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath)
-    : m_d(new Private(frameCachePath))
-{
-}
-
-KisFrameDataSerializer::~KisFrameDataSerializer()
-{
-}
-
-int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+void KisFrameDataSerializer::Private::writeFrame(QIODevice *device, int frameId, const Frame &frame)
 {
     KisLzfCompression compression;
 
-    const int frameId = m_d->generateFrameId();
-
-    const QString frameSubfolder = m_d->subfolderNameForFrame(frameId);
-
-    if (!m_d->framesDirObject.exists(frameSubfolder)) {
-        m_d->framesDirObject.mkpath(frameSubfolder);
-    }
-
-    const QString frameRelativePath = frameSubfolder + QDir::separator() + m_d->fileNameForFrame(frameId);
-
-    if (m_d->framesDirObject.exists(frameRelativePath)) {
-        qWarning() << "WARNING: overwriting existing frame file!" << frameRelativePath;
-        forgetFrame(frameId);
-    }
-
-    const QString frameFilePath = m_d->framesDirObject.filePath(frameRelativePath);
-
-    QFile file(frameFilePath);
-    file.open(QFile::WriteOnly);
-
-    QDataStream stream(&file);
+    QDataStream stream(device);
     stream << frameId;
     stream << frame.pixelSize;
 
@@ -124,8 +145,14 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
         stream << tile.rect;
 
         const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
+
+        if (isZeroData(tile.data.data(), frameByteSize)) {
+            stream << quint8(TileZero);
+            continue;
+        }
+
         const int maxBufferSize = compression.outputBufferSize(frameByteSize);
-        quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
+        quint8 *buffer = getCompressionBuffer(maxBufferSize);
 
         const int compressedSize =
             compression.compress(tile.data.data(), frameByteSize, buffer, maxBufferSize);
@@ -133,41 +160,27 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
         //ENTER_FUNCTION() << ppVar(compressedSize) << ppVar(frameByteSize);
 
         const bool isCompressed = compressedSize < frameByteSize;
-        stream << isCompressed;
 
         if (isCompressed) {
+            stream << quint8(TileCompressed);
             stream << compressedSize;
             stream.writeRawData((char*)buffer, compressedSize);
         } else {
+            stream << quint8(TileRaw);
             stream << frameByteSize;
             stream.writeRawData((char*)tile.data.data(), frameByteSize);
         }
     }
-
-    file.close();
-
-    return frameId;
 }
 
-KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+KisFrameDataSerializer::Frame KisFrameDataSerializer::Private::readFrame(QIODevice *device, int frameId, KisTextureTileInfoPoolSP pool)
 {
     KisLzfCompression compression;
 
-    QElapsedTimer loadingTime;
-    loadingTime.start();
-
     int loadedFrameId = -1;
     KisFrameDataSerializer::Frame frame;
 
-    qint64 compressionTime = 0;
-
-    const QString framePath = m_d->filePathForFrame(frameId);
-
-    QFile file(framePath);
-    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
-    if (!file.open(QFile::ReadOnly)) return frame;
-
-    QDataStream stream(&file);
+    QDataStream stream(device);
 
     int numTiles = 0;
 
@@ -176,8 +189,6 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
     stream >> numTiles;
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(loadedFrameId == frameId, KisFrameDataSerializer::Frame());
 
-
-
     for (int i = 0; i < numTiles; i++) {
         FrameTile tile(pool);
         stream >> tile.col;
@@ -188,41 +199,130 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
         KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize <= pool->chunkSize(frame.pixelSize),
                                              KisFrameDataSerializer::Frame());
 
-        bool isCompressed = false;
-        int inputSize = -1;
+        quint8 storageType = TileRaw;
+        stream >> storageType;
+
+        tile.data.allocate(frame.pixelSize);
+
+        if (storageType == TileZero) {
+            memset(tile.data.data(), 0, frameByteSize);
+            frame.frameTiles.push_back(std::move(tile));
+            continue;
+        }
 
-        stream >> isCompressed;
+        int inputSize = -1;
         stream >> inputSize;
 
-        if (isCompressed) {
+        if (storageType == TileCompressed) {
             const int maxBufferSize = compression.outputBufferSize(inputSize);
-            quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
+            quint8 *buffer = getCompressionBuffer(maxBufferSize);
             stream.readRawData((char*)buffer, inputSize);
 
-            tile.data.allocate(frame.pixelSize);
-
-            QElapsedTimer compTime;
-            compTime.start();
-
             const int decompressedSize =
                 compression.decompress(buffer, inputSize, tile.data.data(), frameByteSize);
 
-            compressionTime += compTime.nsecsElapsed();
-
             KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize == decompressedSize,
                                                  KisFrameDataSerializer::Frame());
 
         } else {
+            KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(storageType == TileRaw,
+                                                 KisFrameDataSerializer::Frame());
             KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize == inputSize,
                                                  KisFrameDataSerializer::Frame());
 
-            tile.data.allocate(frame.pixelSize);
             stream.readRawData((char*)tile.data.data(), inputSize);
         }
 
         frame.frameTiles.push_back(std::move(tile));
     }
 
+    return frame;
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer()
+    : KisFrameDataSerializer(QString())
+{
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath)
+    : KisFrameDataSerializer(OnDiskStorage, frameCachePath)
+{
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer(StorageType storageType, const QString &frameCachePath)
+    : m_d(new Private(storageType, frameCachePath))
+{
+}
+
+KisFrameDataSerializer::~KisFrameDataSerializer()
+{
+}
+
+int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+{
+    const int frameId = m_d->generateFrameId();
+
+    if (m_d->storageType == InMemoryStorage) {
+        if (m_d->memoryFrames.contains(frameId)) {
+            qWarning() << "WARNING: overwriting existing in-memory frame!" << frameId;
+        }
+
+        QByteArray &frameData = m_d->memoryFrames[frameId];
+        frameData.clear();
+
+        QBuffer buffer(&frameData);
+        buffer.open(QIODevice::WriteOnly);
+        m_d->writeFrame(&buffer, frameId, frame);
+        buffer.close();
+
+        // QBuffer grows the array geometrically, don't keep the slack
+        frameData.squeeze();
+
+        return frameId;
+    }
+
+    const QString frameSubfolder = m_d->subfolderNameForFrame(frameId);
+
+    if (!m_d->framesDirObject.exists(frameSubfolder)) {
+        m_d->framesDirObject.mkpath(frameSubfolder);
+    }
+
+    const QString frameRelativePath = frameSubfolder + QDir::separator() + m_d->fileNameForFrame(frameId);
+
+    if (m_d->framesDirObject.exists(frameRelativePath)) {
+        qWarning() << "WARNING: overwriting existing frame file!" << frameRelativePath;
+        forgetFrame(frameId);
+    }
+
+    const QString frameFilePath = m_d->framesDirObject.filePath(frameRelativePath);
+
+    QFile file(frameFilePath);
+    file.open(QFile::WriteOnly);
+    m_d->writeFrame(&file, frameId, frame);
+    file.close();
+
+    return frameId;
+}
+
+KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+{
+    if (m_d->storageType == InMemoryStorage) {
+        auto it = m_d->memoryFrames.constFind(frameId);
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(it != m_d->memoryFrames.constEnd(), Frame());
+
+        QByteArray frameData = *it;
+        QBuffer buffer(&frameData);
+        buffer.open(QIODevice::ReadOnly);
+        return m_d->readFrame(&buffer, frameId, pool);
+    }
+
+    const QString framePath = m_d->filePathForFrame(frameId);
+
+    QFile file(framePath);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
+    if (!file.open(QFile::ReadOnly)) return Frame();
+
+    Frame frame = m_d->readFrame(&file, frameId, pool);
     file.close();
 
     return frame;
@@ -230,6 +330,14 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
 
 void KisFrameDataSerializer::moveFrame(int srcFrameId, int dstFrameId)
 {
+    if (m_d->storageType == InMemoryStorage) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->memoryFrames.contains(srcFrameId));
+        KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->memoryFrames.contains(dstFrameId));
+
+        m_d->memoryFrames.insert(dstFrameId, m_d->memoryFrames.take(srcFrameId));
+        return;
+    }
+
     const QString srcFramePath = m_d->filePathForFrame(srcFrameId);
     const QString dstFramePath = m_d->filePathForFrame(dstFrameId);
     KIS_SAFE_ASSERT_RECOVER_RETURN(QFileInfo(srcFramePath).exists());
@@ -243,16 +351,44 @@ void KisFrameDataSerializer::moveFrame(int srcFrameId, int dstFrameId)
 
 bool KisFrameDataSerializer::hasFrame(int frameId) const
 {
+    if (m_d->storageType == InMemoryStorage) {
+        return m_d->memoryFrames.contains(frameId);
+    }
+
     const QString framePath = m_d->filePathForFrame(frameId);
     return QFileInfo(framePath).exists();
 }
 
 void KisFrameDataSerializer::forgetFrame(int frameId)
 {
+    if (m_d->storageType == InMemoryStorage) {
+        m_d->memoryFrames.remove(frameId);
+        return;
+    }
+
     const QString framePath = m_d->filePathForFrame(frameId);
     QFile::remove(framePath);
 }
 
+qint64 KisFrameDataSerializer::storedDataSize() const
+{
+    qint64 size = 0;
+
+    if (m_d->storageType == InMemoryStorage) {
+        Q_FOREACH (const QByteArray &frameData, m_d->memoryFrames) {
+            size += frameData.size();
+        }
+    } else {
+        QDirIterator it(m_d->framesDirObject.absolutePath(), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            size += it.fileInfo().size();
+        }
+    }
+
+    return size;
+}
+
 boost::optional<qreal> KisFrameDataSerializer::estimateFrameUniqueness(const KisFrameDataSerializer::Frame &lhs, const KisFrameDataSerializer::Frame &rhs, qreal portion)
 {
     if (lhs.pixelSize != rhs.pixelSize) return boost::none;
@@ -28,7 +28,7 @@
 #include <vector>
 #include <boost/optional.hpp>
 
-class QString;
+#include <QString>
 
 
 /**
@@ -39,7 +39,12 @@ class QString;
  *    which contains raw data in it (the data may be not a pixel data,
  *    but a preprocessed pixel differences)
  *
- * 2) Compress this data and save it on disk
+ * 2) Compress this data and save it on disk or, for InMemoryStorage,
+ *    in a compact in-memory buffer
+ *
+ * The tiles consisting of zeros only (e.g. the unchanged tiles of a
+ * difference frame) are not stored at all, all the other tiles are
+ * compressed with LZF.
  */
 
 class KRITAUI_EXPORT KisFrameDataSerializer
@@ -106,9 +111,19 @@ public:
         }
     };
 
+    enum StorageType {
+        OnDiskStorage,
+        InMemoryStorage
+    };
+
 public:
     KisFrameDataSerializer();
     KisFrameDataSerializer(const QString &frameCachePath);
+
+    /**
+     * \p frameCachePath is used for OnDiskStorage only
+     */
+    KisFrameDataSerializer(StorageType storageType, const QString &frameCachePath = QString());
     ~KisFrameDataSerializer();
 
     int saveFrame(const Frame &frame);
@@ -119,6 +134,11 @@ public:
     bool hasFrame(int frameId) const;
     void forgetFrame(int frameId);
 
+    /**
+     * \return the total size of the serialized frames in bytes
+     */
+    qint64 storedDataSize() const;
+
     static boost::optional<qreal> estimateFrameUniqueness(const Frame &lhs, const Frame &rhs, qreal portion);
     static bool subtractFrames(Frame &dst, const Frame &src);
     static void addFrames(Frame &dst, const Frame &src);
@@ -48,6 +48,7 @@
 #include "kis_coordinates_converter.h"
 #include "kis_prescaled_projection.h"
 #include "kis_image.h"
+#include "kis_paint_device.h"
 #include "kis_image_barrier_locker.h"
 #include "kis_undo_adapter.h"
 #include "flake/kis_shape_layer.h"
@@ -950,6 +951,26 @@ void KisCanvas2::slotUpdateRegionOfInterest()
 
     if (m_d->regionOfInterest != oldRegionOfInterest) {
         emit sigRegionOfInterestChanged(m_d->regionOfInterest);
+        prefetchVisibleTiles();
+    }
+}
+
+void KisCanvas2::prefetchVisibleTiles()
+{
+    /**
+     * The user has just scrolled or zoomed the canvas, so the tiles
+     * in the new area will be needed soon, both for the canvas
+     * projection and for painting on the active layer
+     */
+    KisImageSP image = this->image();
+    if (!image) return;
+
+    image->projection()->prefetchTiles(m_d->regionOfInterest);
+
+    KisNodeSP node = m_d->view->currentNode();
+    KisPaintDeviceSP device = node ? node->paintDevice() : 0;
+    if (device) {
+        device->prefetchTiles(m_d->regionOfInterest);
     }
 }
 
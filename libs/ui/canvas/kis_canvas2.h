@@ -336,6 +336,7 @@ private:
     void resetCanvas(bool useOpenGL);
 
     void notifyLevelOfDetailChange();
+    void prefetchVisibleTiles();
 
     // Completes construction of canvas.
     // To be called by KisView in its constructor, once it has been setup enough
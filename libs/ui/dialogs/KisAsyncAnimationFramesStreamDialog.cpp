@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisAsyncAnimationFramesStreamDialog.h"
+
+#include <klocalizedstring.h>
+
+#include <kis_time_range.h>
+
+#include <KisAnimationFrameStream.h>
+#include <KisAsyncAnimationFramesStreamingRenderer.h>
+
+struct KisAsyncAnimationFramesStreamDialog::Private
+{
+    Private(const KisTimeRange &_range, KisAnimationFrameStream *_stream)
+        : range(_range),
+          stream(_stream)
+    {
+    }
+
+    KisTimeRange range;
+    KisAnimationFrameStream *stream;
+};
+
+KisAsyncAnimationFramesStreamDialog::KisAsyncAnimationFramesStreamDialog(KisImageSP image,
+                                                                         const KisTimeRange &range,
+                                                                         KisAnimationFrameStream *stream)
+    : KisAsyncAnimationRenderDialogBase(i18n("Rendering frames..."), image, 0),
+      m_d(new Private(range, stream))
+{
+    /**
+     * The stream may be aborted by the consumer thread at any moment, even
+     * before the rendering has started. The queued connection delivers the
+     * signal only when the rendering loop is already running, and the slot
+     * checks the state of the stream itself, so the abort is never lost.
+     */
+    connect(stream, SIGNAL(sigFrameConsumed(int)), SLOT(slotStreamChanged()), Qt::QueuedConnection);
+    connect(stream, SIGNAL(sigAborted()), SLOT(slotStreamChanged()), Qt::QueuedConnection);
+
+    if (stream->isAborted()) {
+        QMetaObject::invokeMethod(this, "slotStreamChanged", Qt::QueuedConnection);
+    }
+}
+
+KisAsyncAnimationFramesStreamDialog::~KisAsyncAnimationFramesStreamDialog()
+{
+}
+
+QList<int> KisAsyncAnimationFramesStreamDialog::calcDirtyFrames() const
+{
+    QList<int> result;
+    for (int i = m_d->range.start(); i <= m_d->range.end(); i++) {
+        result.append(i);
+    }
+    return result;
+}
+
+KisAsyncAnimationRendererBase *KisAsyncAnimationFramesStreamDialog::createRenderer(KisImageSP image)
+{
+    Q_UNUSED(image);
+    return new KisAsyncAnimationFramesStreamingRenderer(m_d->stream);
+}
+
+void KisAsyncAnimationFramesStreamDialog::initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer, KisImageSP image, int frame)
+{
+    Q_UNUSED(renderer);
+    Q_UNUSED(image);
+    Q_UNUSED(frame);
+}
+
+bool KisAsyncAnimationFramesStreamDialog::canStartFrameRegeneration(int frame) const
+{
+    return m_d->stream->canAcceptFrame(frame);
+}
+
+void KisAsyncAnimationFramesStreamDialog::slotStreamChanged()
+{
+    if (m_d->stream->isAborted()) {
+        cancelProcessingImpl(false);
+    } else {
+        tryInitiateFrameRegeneration();
+    }
+}
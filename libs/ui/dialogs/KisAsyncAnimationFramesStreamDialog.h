@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
+#define KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
+
+#include "KisAsyncAnimationRenderDialogBase.h"
+#include "kis_types.h"
+
+class KisAnimationFrameStream;
+
+/**
+ * Renders a range of frames into a KisAnimationFrameStream. The dialog
+ * starts a frame only when the stream can accept it, so the number of the
+ * rendered frames waiting for the consumer never exceeds the capacity of
+ * the stream. If the stream is aborted, even before the rendering has
+ * started, the rendering fails.
+ */
+class KRITAUI_EXPORT KisAsyncAnimationFramesStreamDialog : public KisAsyncAnimationRenderDialogBase
+{
+    Q_OBJECT
+public:
+    KisAsyncAnimationFramesStreamDialog(KisImageSP image,
+                                        const KisTimeRange &range,
+                                        KisAnimationFrameStream *stream);
+
+    ~KisAsyncAnimationFramesStreamDialog();
+
+protected:
+    QList<int> calcDirtyFrames() const override;
+    KisAsyncAnimationRendererBase* createRenderer(KisImageSP image) override;
+    void initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer,
+                                    KisImageSP image, int frame) override;
+    bool canStartFrameRegeneration(int frame) const override;
+
+private Q_SLOTS:
+    void slotStreamChanged();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISASYNCANIMATIONFRAMESSTREAMDIALOG_H
@@ -64,6 +64,13 @@ int calculateNumberMemoryAllowedClones(KisImageSP image)
         ->fetchMemoryStatistics(image);
 
     const qint64 allowedMemory = 0.8 * stats.tilesHardLimit - stats.realMemorySize;
+
+    /**
+     * The clones share the tile data of the layers with the source image
+     * copy-on-write and copy the keyframes only when they render them
+     * (see KisImage::cloneForRendering()), so only the projections are
+     * counted.
+     */
     const qint64 cloneSize = stats.projectionsSize;
 
     return cloneSize > 0 ? allowedMemory / cloneSize : 0;
@@ -176,7 +183,7 @@ KisAsyncAnimationRenderDialogBase::regenerateRange(KisViewManager *viewManager)
 
     for (int i = 0; i < numWorkers; i++) {
         // reuse the image for one of the workers
-        KisImageSP image = i == numWorkers - 1 ? m_d->image : m_d->image->clone(true);
+        KisImageSP image = i == numWorkers - 1 ? m_d->image : m_d->image->cloneForRendering();
 
         image->setWorkingThreadsLimit(numThreadsPerWorker);
         KisAsyncAnimationRendererBase *renderer = createRenderer(image);
@@ -279,6 +286,9 @@ void KisAsyncAnimationRenderDialogBase::tryInitiateFrameRegeneration()
     while (!m_d->stillDirtyFrames.isEmpty()) {
         for (auto &pair : m_d->asyncRenderers) {
             if (!pair.renderer->isActive()) {
+                // the throttling is checked right before every frame we start
+                if (!canStartFrameRegeneration(m_d->stillDirtyFrames.first())) return;
+
                 const int currentDirtyFrame = m_d->stillDirtyFrames.takeFirst();
 
                 initializeRendererForFrame(pair.renderer.get(), pair.image, currentDirtyFrame);
@@ -294,6 +304,12 @@ void KisAsyncAnimationRenderDialogBase::tryInitiateFrameRegeneration()
     }
 }
 
+bool KisAsyncAnimationRenderDialogBase::canStartFrameRegeneration(int frame) const
+{
+    Q_UNUSED(frame);
+    return true;
+}
+
 void KisAsyncAnimationRenderDialogBase::updateProgressLabel()
 {
     const int processedFramesCount = m_d->dirtyFramesCount - m_d->numDirtyFramesLeft();
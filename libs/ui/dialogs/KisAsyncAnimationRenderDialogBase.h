@@ -117,12 +117,34 @@ private Q_SLOTS:
 
     void slotCancelRegeneration();
 
-private:
+protected Q_SLOTS:
+    /**
+     * Starts the regeneration of the next dirty frames on all idle
+     * renderers. Should be called by the derived class when
+     * canStartFrameRegeneration() may have changed its mind.
+     */
     void tryInitiateFrameRegeneration();
+
+private:
     void updateProgressLabel();
-    void cancelProcessingImpl(bool isUserCancelled);
 
 protected:
+    /**
+     * Stops all the renderers and finishes the rendering with
+     * RenderCancelled or RenderFailed result
+     */
+    void cancelProcessingImpl(bool isUserCancelled);
+
+    /**
+     * @brief lets the derived class throttle the rendering
+     *
+     * The frames are started in order of calcDirtyFrames(). If the method
+     * returns false for the next dirty frame, the dialog waits until
+     * tryInitiateFrameRegeneration() is called again. The default
+     * implementation always returns true.
+     */
+    virtual bool canStartFrameRegeneration(int frame) const;
+
     /**
      * @brief returns a list of frames that should be regenerated by the dialog
      *
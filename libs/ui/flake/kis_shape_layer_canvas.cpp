@@ -18,13 +18,18 @@
 
 #include "kis_shape_layer_canvas.h"
 
+#include <functional>
+
+#include <QAtomicInt>
 #include <QPainter>
 #include <QMutexLocker>
+#include <QThreadPool>
 
 #include <KoShapeManager.h>
 #include <KoSelectedShapesProxySimple.h>
 #include <KoViewConverter.h>
 #include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
 
 #include <kis_paint_device.h>
 #include <kis_image.h>
@@ -41,11 +46,66 @@
 #include <QThread>
 #include <QApplication>
 
+#include <KisSharedRunnable.h>
+#include <KisSharedThreadPoolAdapter.h>
+
 #include <kis_spontaneous_job.h>
 #include "kis_global.h"
+#include "kis_algebra_2d.h"
 
 //#define DEBUG_REPAINT
 
+namespace {
+
+/**
+ * The dirty region is rasterized in cells of this size. The cells are
+ * aligned to the tiles of the projection, so two threads never write
+ * into the same tile.
+ */
+const int rasterizationCellSize = 256;
+
+class RasterizeCellsRunnable : public KisSharedRunnable
+{
+public:
+    RasterizeCellsRunnable(std::function<void()> func)
+        : m_func(func)
+    {
+    }
+
+    void runShared() override {
+        m_func();
+    }
+
+private:
+    std::function<void()> m_func;
+};
+
+/**
+ * Writes \p image into \p dst at \p offset the same way
+ * KisPaintDevice::convertFromQImage() does, but without
+ * touching the cache of the device, which is not thread-safe
+ */
+void writeCellImage(const QImage &image, const QPoint &offset, KisPaintDeviceSP dst)
+{
+    const QRect rc(offset, image.size());
+
+    // Don't convert if both the paint device and the image are RGBA
+    if (dst->colorSpace()->id() == "RGBA") {
+        dst->writeBytes(image.constBits(), rc);
+    } else {
+        QVector<quint8> dstData(image.width() * image.height() * dst->pixelSize());
+
+        KoColorSpaceRegistry::instance()->rgb8()->
+            convertPixelsTo(image.constBits(), dstData.data(), dst->colorSpace(), image.width() * image.height(),
+                            KoColorConversionTransformation::internalRenderingIntent(),
+                            KoColorConversionTransformation::internalConversionFlags());
+
+        dst->writeBytes(dstData.constData(), rc);
+    }
+}
+
+}
+
 KisShapeLayerCanvasBase::KisShapeLayerCanvasBase(KisShapeLayer *parent, KisImageWSP image)
     : KoCanvasBase(0)
     , m_viewConverter(new KisImageViewConverter(image))
@@ -204,6 +264,43 @@ private:
 };
 
 
+class KisRasterizeShapeLayerJob : public KisSpontaneousJob
+{
+public:
+    KisRasterizeShapeLayerJob(KisShapeLayerSP layer, KisShapeLayerCanvas *canvas,
+                              const KoShapeManager::PaintJobsOrder &jobsOrder)
+        : m_layer(layer),
+          m_canvas(canvas),
+          m_jobsOrder(jobsOrder)
+    {
+    }
+
+    bool overrides(const KisSpontaneousJob *otherJob) override {
+        Q_UNUSED(otherJob);
+
+        // every job carries its own part of the dirty region
+        return false;
+    }
+
+    void run() override {
+        m_canvas->rasterizeJobs(m_jobsOrder);
+    }
+
+    int levelOfDetail() const override {
+        return 0;
+    }
+
+private:
+
+    // we store a pointer to the layer just
+    // to keep the lifetime of the canvas!
+    KisShapeLayerSP m_layer;
+
+    KisShapeLayerCanvas *m_canvas;
+    KoShapeManager::PaintJobsOrder m_jobsOrder;
+};
+
+
 void KisShapeLayerCanvas::updateCanvas(const QVector<QRectF> &region)
 {
     if (!m_parentLayer->image() || m_isDestroying) {
@@ -275,44 +372,128 @@ void KisShapeLayerCanvas::slotImageSizeChanged()
 
 void KisShapeLayerCanvas::repaint()
 {
-    QRect repaintRect;
+    QRegion repaintRegion;
 
     {
         QMutexLocker locker(&m_dirtyRegionMutex);
-        repaintRect = m_dirtyRegion.boundingRect();
+        repaintRegion = m_dirtyRegion;
         m_dirtyRegion = QRegion();
     }
 
-    if (repaintRect.isEmpty()) {
+    if (repaintRegion.isEmpty()) {
         return;
     }
 
-    // Crop the update rect by the image bounds. We keep the cache consistent
+    // Crop the update region by the image bounds. We keep the cache consistent
     // by tracking the size of the image in slotImageSizeChanged()
-    repaintRect = repaintRect.intersected(m_parentLayer->image()->bounds());
+    repaintRegion &= m_parentLayer->image()->bounds();
 
-    QImage image(repaintRect.width(), repaintRect.height(), QImage::Format_ARGB32);
-    image.fill(0);
-    QPainter tempPainter(&image);
+    /**
+     * Split the region into tile-aligned cells. Only the dirty parts of
+     * the cells are rasterized and each cell gets only the shapes it
+     * intersects with.
+     */
+    KoShapeManager::PaintJobsOrder jobsOrder;
+
+    using KisAlgebra2D::divideFloor;
+
+    const QRect bounds = repaintRegion.boundingRect();
+    const int firstCol = divideFloor(bounds.left(), rasterizationCellSize);
+    const int lastCol = divideFloor(bounds.right(), rasterizationCellSize);
+    const int firstRow = divideFloor(bounds.top(), rasterizationCellSize);
+    const int lastRow = divideFloor(bounds.bottom(), rasterizationCellSize);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            const QRect cellRect(col * rasterizationCellSize, row * rasterizationCellSize,
+                                 rasterizationCellSize, rasterizationCellSize);
+
+            const QRect dirtyRect = (repaintRegion & cellRect).boundingRect();
+            if (dirtyRect.isEmpty()) continue;
 
-    tempPainter.setRenderHint(QPainter::Antialiasing);
-    tempPainter.setRenderHint(QPainter::TextAntialiasing);
-    tempPainter.translate(-repaintRect.x(), -repaintRect.y());
-    tempPainter.setClipRect(repaintRect);
+            KoShapeManager::PaintJob job;
+            job.viewUpdateRect = dirtyRect;
+            job.docUpdateRect = m_viewConverter->viewToDocument(QRectF(dirtyRect));
+            jobsOrder.jobs.append(job);
+        }
+    }
+
+    if (jobsOrder.jobs.isEmpty()) {
+        return;
+    }
+
+    m_shapeManager->preparePaintJobs(jobsOrder, m_parentLayer);
+
+    /**
+     * The jobs paint copies of the shapes, so the GUI thread may continue
+     * editing them while the layer is being rasterized. In a worker thread
+     * we are already inside a spontaneous job.
+     */
+    if (qApp->thread() == QThread::currentThread()) {
+        m_image->addSpontaneousJob(new KisRasterizeShapeLayerJob(m_parentLayer, this, jobsOrder));
+    } else {
+        rasterizeJobs(jobsOrder);
+    }
+}
+
+void KisShapeLayerCanvas::rasterizeJobs(const KoShapeManager::PaintJobsOrder &jobsOrder)
+{
+    const int numJobs = jobsOrder.jobs.size();
+    QAtomicInt nextJob(0);
+
+    auto processJobs = [&] () {
+        int i;
+        while ((i = nextJob.fetchAndAddOrdered(1)) < numJobs) {
+            const KoShapeManager::PaintJob &job = jobsOrder.jobs[i];
+            const QRect &rc = job.viewUpdateRect;
+
+            QImage image(rc.width(), rc.height(), QImage::Format_ARGB32);
+            image.fill(0);
+            QPainter tempPainter(&image);
+
+            tempPainter.setRenderHint(QPainter::Antialiasing);
+            tempPainter.setRenderHint(QPainter::TextAntialiasing);
+            tempPainter.translate(-rc.x(), -rc.y());
+            tempPainter.setClipRect(rc);
 #ifdef DEBUG_REPAINT
-    QColor color = QColor(random() % 255, random() % 255, random() % 255);
-    tempPainter.fillRect(r, color);
+            QColor color = QColor(random() % 255, random() % 255, random() % 255);
+            tempPainter.fillRect(rc, color);
 #endif
 
-    m_shapeManager->paint(tempPainter, *m_viewConverter, false);
-    tempPainter.end();
+            KoShapeManager::paintJob(tempPainter, job, jobsOrder, *m_viewConverter);
+            tempPainter.end();
 
-    KisPaintDeviceSP dev = new KisPaintDevice(m_projection->colorSpace());
-    dev->convertFromQImage(image, 0);
+            writeCellImage(image, rc.topLeft(), m_projection);
+        }
+    };
+
+    KisSharedThreadPoolAdapter adapter(QThreadPool::globalInstance());
+
+    for (int i = 1; i < numJobs; i++) {
+        RasterizeCellsRunnable *runnable = new RasterizeCellsRunnable(processJobs);
+        if (!adapter.tryStart(runnable)) {
+            delete runnable;
+            break;
+        }
+    }
 
-    KisPainter::copyAreaOptimized(repaintRect.topLeft(), dev, m_projection, QRect(QPoint(), repaintRect.size()));
+    processJobs();
+    adapter.waitForDone();
+
+    QVector<QRect> dirtyRects;
+    Q_FOREACH (const KoShapeManager::PaintJob &job, jobsOrder.jobs) {
+        dirtyRects.append(job.viewUpdateRect);
+    }
+
+    /**
+     * The cells are written with writeBytes(), which doesn't invalidate
+     * the cache of the device. Don't use setDirty() of the device for that,
+     * it would notify the layer, which is usually its parent node, and
+     * the layer would be merged twice.
+     */
+    m_projection->invalidateCache();
 
-    m_parentLayer->setDirty(repaintRect);
+    m_parentLayer->setDirty(dirtyRects);
 
     m_hasChangedWhileBeingInvisible |= !m_parentLayer->visible(true);
 }
@@ -104,6 +104,7 @@ public:
 
 private Q_SLOTS:
     friend class KisRepaintShapeLayerLayerJob;
+    friend class KisRasterizeShapeLayerJob;
     void repaint();
     void slotStartAsyncRepaint();
     void slotImageSizeChanged();
@@ -111,6 +112,13 @@ private Q_SLOTS:
 Q_SIGNALS:
     void forwardRepaint();
 
+private:
+    /**
+     * Renders the jobs of \p jobsOrder into the projection in parallel
+     * and notifies the layer about the change
+     */
+    void rasterizeJobs(const KoShapeManager::PaintJobsOrder &jobsOrder);
+
 private:
     KisPaintDeviceSP m_projection;
     KisShapeLayer *m_parentLayer;
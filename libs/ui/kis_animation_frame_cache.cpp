@@ -285,6 +285,9 @@ void KisAnimationFrameCache::slotConfigChanged()
 
     if (cfg.useOnDiskAnimationCacheSwapping()) {
         m_d->swapper.reset(new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir()));
+    } else if (cfg.useInMemoryAnimationCacheCompression()) {
+        m_d->swapper.reset(new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(),
+                                                    KisFrameDataSerializer::InMemoryStorage));
     } else {
         m_d->swapper.reset(new KisInMemoryFrameCacheSwapper());
     }
@@ -41,12 +41,63 @@
 #include "kis_painting_tweaks.h"
 #include "KisView.h"
 #include "kis_selection_mask.h"
+#include "kis_lod_transform.h"
 #include <KisPart.h>
 
 static const unsigned int ANT_LENGTH = 4;
 static const unsigned int ANT_SPACE = 4;
 static const unsigned int ANT_ADVANCE_WIDTH = ANT_LENGTH + ANT_SPACE;
 
+/**
+ * The maximum level of detail the outline is simplified for, lower
+ * zooms reuse the outline of this level
+ */
+static const int MAX_OUTLINE_LOD = 5;
+
+namespace {
+
+/**
+ * Drops the vertices of \p path closer than \p threshold to the previous
+ * kept vertex. The subpaths smaller than \p threshold are replaced with
+ * boxes of that size, so that tiny selected areas are still visible. The outline
+ * of a magic wand selection consists of pixel-sized steps, which are not
+ * visible on zoomed out views, but cost a lot to stroke with the dashed
+ * pen every time the ants move.
+ */
+QPainterPath simplifyOutline(const QPainterPath &path, qreal threshold)
+{
+    QPainterPath result;
+
+    Q_FOREACH (const QPolygonF &polygon, path.toSubpathPolygons()) {
+        const QRectF bounds = polygon.boundingRect();
+        if (bounds.width() < threshold && bounds.height() < threshold) {
+            QRectF box(0, 0, threshold, threshold);
+            box.moveCenter(bounds.center());
+            result.addRect(box);
+            continue;
+        }
+
+        QPolygonF simplified;
+        simplified.reserve(polygon.size());
+        simplified << polygon.first();
+
+        for (int i = 1; i < polygon.size() - 1; i++) {
+            if ((polygon[i] - simplified.last()).manhattanLength() >= threshold) {
+                simplified << polygon[i];
+            }
+        }
+
+        simplified << polygon.last();
+
+        result.addPolygon(simplified);
+        result.closeSubpath();
+    }
+
+    return result;
+}
+
+}
+
 KisSelectionDecoration::KisSelectionDecoration(QPointer<KisView>view)
     : KisCanvasDecoration("selection", view),
       m_signalCompressor(500 /*ms*/, KisSignalCompressor::FIRST_INACTIVE),
@@ -120,6 +171,7 @@ void KisSelectionDecoration::selectionChanged()
 
             if (m_mode == Ants) {
                 m_outlinePath = selection->outlineCache();
+                m_simplifiedOutlinePaths.clear();
                 m_antsTimer->start();
             } else {
                 m_thumbnailImage = selection->thumbnailImage();
@@ -135,6 +187,7 @@ void KisSelectionDecoration::selectionChanged()
     } else {
         m_signalCompressor.stop();
         m_outlinePath = QPainterPath();
+        m_simplifiedOutlinePaths.clear();
         m_thumbnailImage = QImage();
         m_thumbnailImageTransform = QTransform();
         view()->canvasBase()->updateCanvas();
@@ -208,17 +261,42 @@ void KisSelectionDecoration::drawDecoration(QPainter& gc, const QRectF& updateRe
     } else /* if (m_mode == Ants) */ {
         gc.setRenderHints(QPainter::Antialiasing | QPainter::HighQualityAntialiasing, m_antialiasSelectionOutline);
 
+        const int lod = KisLodTransform::scaleToLod(converter->effectiveZoom(), MAX_OUTLINE_LOD);
+        const QPainterPath &outlinePath = outlinePathForLod(lod);
+
         // render selection outline in white
         gc.setPen(m_outlinePen);
-        gc.drawPath(m_outlinePath);
+        gc.drawPath(outlinePath);
 
         // render marching ants in black (above the white outline)
         gc.setPen(m_antsPen);
-        gc.drawPath(m_outlinePath);
+        gc.drawPath(outlinePath);
     }
     gc.restore();
 }
 
+const QPainterPath& KisSelectionDecoration::outlinePathForLod(int lod)
+{
+    if (lod <= 0) return m_outlinePath;
+
+    if (m_simplifiedOutlinePaths.size() < lod) {
+        m_simplifiedOutlinePaths.resize(lod);
+    }
+
+    SimplifiedOutline &outline = m_simplifiedOutlinePaths[lod - 1];
+
+    /**
+     * The simplification is done once per zoom level, while the ants
+     * are redrawn several times a second
+     */
+    if (!outline.isValid) {
+        outline.path = simplifyOutline(m_outlinePath, KisLodTransform::lodToInvScale(lod));
+        outline.isValid = true;
+    }
+
+    return outline.path;
+}
+
 void KisSelectionDecoration::setVisible(bool v)
 {
     KisCanvasDecoration::setVisible(v);
@@ -21,6 +21,7 @@
 #include <QTimer>
 #include <QPolygon>
 #include <QPen>
+#include <QVector>
 
 #include <kis_signal_compressor.h>
 #include "canvas/kis_canvas_decoration.h"
@@ -56,9 +57,25 @@ public Q_SLOTS:
 private:
     bool selectionIsActive();
 
+    /**
+     * \return the outline simplified for drawing on the zoom level
+     * \p lod, the vertices closer than a screen pixel are dropped
+     */
+    const QPainterPath& outlinePathForLod(int lod);
+
 private:
     KisSignalCompressor m_signalCompressor;
     QPainterPath m_outlinePath;
+
+    struct SimplifiedOutline {
+        SimplifiedOutline() : isValid(false) {}
+
+        /// the simplified outline may be empty, so it needs a separate flag
+        bool isValid;
+        QPainterPath path;
+    };
+
+    QVector<SimplifiedOutline> m_simplifiedOutlinePaths;
     QImage m_thumbnailImage;
     QTransform m_thumbnailImageTransform;
     QTimer* m_antsTimer;
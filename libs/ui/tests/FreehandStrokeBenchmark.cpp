@@ -152,4 +152,9 @@ void FreehandStrokeBenchmark::testColorsmudgeDefaultTip()
     benchmarkBrush("testing_200px_colorsmudge_default.kpp");
 }
 
+void FreehandStrokeBenchmark::testColorsmudgeDullingTip()
+{
+    benchmarkBrush("Mix_dull.kpp");
+}
+
 QTEST_MAIN(FreehandStrokeBenchmark)
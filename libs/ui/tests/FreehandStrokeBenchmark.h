@@ -38,6 +38,7 @@ private Q_SLOTS:
     void testStampTip();
 
     void testColorsmudgeDefaultTip();
+    void testColorsmudgeDullingTip();
 };
 
 #endif // FREEHANDSTROKEBENCHMARK_H
@@ -219,4 +219,71 @@ void KisFrameSerializerTest::testFrameArithmetics()
     }
 }
 
+void KisFrameSerializerTest::testInMemorySerialization()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer serializer(KisFrameDataSerializer::InMemoryStorage);
+
+    KisFrameDataSerializer::Frame testFrame1 = generateTestFrame(2, pool);
+    KisFrameDataSerializer::Frame testFrame2 = generateTestFrame(503, pool);
+
+    const int testFrameId1 = serializer.saveFrame(testFrame1);
+    const int testFrameId2 = serializer.saveFrame(testFrame2);
+    QCOMPARE(serializer.hasFrame(testFrameId1), true);
+    QCOMPARE(serializer.hasFrame(testFrameId2), true);
+    QVERIFY(serializer.storedDataSize() > 0);
+
+    QVERIFY(verifyTestFrame(2, serializer.loadFrame(testFrameId1, pool)));
+    QVERIFY(verifyTestFrame(503, serializer.loadFrame(testFrameId2, pool)));
+
+    const int movedFrameId = 1000;
+    serializer.moveFrame(testFrameId2, movedFrameId);
+    QCOMPARE(serializer.hasFrame(testFrameId2), false);
+    QCOMPARE(serializer.hasFrame(movedFrameId), true);
+
+    serializer.forgetFrame(testFrameId1);
+    serializer.forgetFrame(movedFrameId);
+    QCOMPARE(serializer.hasFrame(testFrameId1), false);
+    QCOMPARE(serializer.hasFrame(movedFrameId), false);
+    QCOMPARE(serializer.storedDataSize(), qint64(0));
+}
+
+void KisFrameSerializerTest::testDiffFrameCompression()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer::Frame baseFrame = generateTestFrame(20, pool);
+
+    // change a single pixel of the last tile only
+    KisFrameDataSerializer::Frame changedFrame = generateTestFrame(20, pool);
+    *reinterpret_cast<qint32*>(changedFrame.frameTiles.back().data.data()) = 0;
+
+    const bool framesAreSame = KisFrameDataSerializer::subtractFrames(changedFrame, baseFrame);
+    QVERIFY(!framesAreSame);
+
+    KisFrameDataSerializer fullSerializer(KisFrameDataSerializer::InMemoryStorage);
+    fullSerializer.saveFrame(baseFrame);
+
+    KisFrameDataSerializer diffSerializer(KisFrameDataSerializer::InMemoryStorage);
+    const int diffFrameId = diffSerializer.saveFrame(changedFrame);
+
+    // the unchanged tiles of the difference frame are not stored at all
+    QVERIFY(diffSerializer.storedDataSize() * 10 < fullSerializer.storedDataSize());
+
+    KisFrameDataSerializer::Frame loadedFrame = diffSerializer.loadFrame(diffFrameId, pool);
+    QVERIFY(loadedFrame.isValid());
+    QCOMPARE(int(loadedFrame.frameTiles.size()), int(baseFrame.frameTiles.size()));
+
+    KisFrameDataSerializer::addFrames(loadedFrame, baseFrame);
+
+    const qint32 *dataPtr = reinterpret_cast<const qint32*>(loadedFrame.frameTiles.back().data.data());
+    QCOMPARE(*dataPtr, 0);
+
+    *reinterpret_cast<qint32*>(loadedFrame.frameTiles.back().data.data()) = 20;
+    QVERIFY(verifyTestFrame(20, loadedFrame));
+}
+
 QTEST_MAIN(KisFrameSerializerTest)
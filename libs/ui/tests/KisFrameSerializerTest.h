@@ -29,6 +29,8 @@ private Q_SLOTS:
     void testFrameDataSerialization();
     void testFrameUniquenessEstimation();
     void testFrameArithmetics();
+    void testInMemorySerialization();
+    void testDiffFrameCompression();
 
 };
 
@@ -19,6 +19,7 @@
 #include "freehand_stroke_test.h"
 
 #include <QTest>
+#include <QElapsedTimer>
 #include <KoCompositeOpRegistry.h>
 #include <KoColor.h>
 #include "stroke_testing_utils.h"
@@ -28,8 +29,13 @@
 #include "kis_image.h"
 #include "kis_painter.h"
 #include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
+#include "kis_canvas_resource_provider.h"
+#include "kis_image_config.h"
 
 #include "kistest.h"
+#include "testutil.h"
 
 class FreehandStrokeTester : public utils::StrokeTester
 {
@@ -171,6 +177,117 @@ void FreehandStrokeTest::testMixDullCompositioning()
     tester.test();
 }
 
+namespace {
+
+/**
+ * Paints a line with a color smudge preset over a two-colored layer. The
+ * dabs are blended by the asynchronous updates of the stroke.
+ */
+KisImageSP paintColorSmudgeLine(const QString &presetFileName, bool overlayMode, bool cancelStroke)
+{
+    KisImageSP image = utils::createImage(0, QSize(500, 500));
+    QScopedPointer<KoCanvasResourceProvider> manager(
+        utils::createResourceManager(image, 0, presetFileName));
+
+    KisPaintOpPresetSP preset =
+        manager->resource(KisCanvasResourceProvider::CurrentPaintOpPreset).value<KisPaintOpPresetSP>();
+    preset->settings()->setProperty("MergedPaint", overlayMode);
+
+    KisNodeSP node = image->root()->firstChild();
+    const KoColorSpace *cs = node->paintDevice()->colorSpace();
+    node->paintDevice()->fill(QRect(0, 0, 250, 500), KoColor(Qt::red, cs));
+    node->paintDevice()->fill(QRect(250, 0, 250, 500), KoColor(Qt::blue, cs));
+    image->initialRefreshGraph();
+
+    KisResourcesSnapshotSP resources =
+        new KisResourcesSnapshot(image, node, manager.data());
+
+    KisStrokeId strokeId =
+        image->startStroke(new FreehandStrokeStrategy(resources, new KisFreehandStrokeInfo(),
+                                                      kundo2_noi18n("Freehand Stroke")));
+
+    image->addJob(strokeId,
+                  new FreehandStrokeStrategy::Data(0,
+                                                   KisPaintInformation(QPointF(50, 250)),
+                                                   KisPaintInformation(QPointF(450, 250))));
+    image->addJob(strokeId, new FreehandStrokeStrategy::UpdateData(true));
+
+    if (cancelStroke) {
+        image->cancelStroke(strokeId);
+    } else {
+        image->endStroke(strokeId);
+    }
+
+    image->waitForDone();
+
+    return image;
+}
+
+QImage paintColorSmudgeLineWithThreads(const QString &presetFileName, bool overlayMode, int numThreads)
+{
+    KisImageConfig cfg(false);
+    const int oldNumThreads = cfg.maxNumberOfThreads();
+    cfg.setMaxNumberOfThreads(numThreads);
+
+    KisImageSP image = paintColorSmudgeLine(presetFileName, overlayMode, false);
+
+    cfg.setMaxNumberOfThreads(oldNumThreads);
+
+    return image->root()->firstChild()->paintDevice()->convertToQImage(0, image->bounds());
+}
+
+}
+
+void FreehandStrokeTest::testColorSmudgeStripes()
+{
+    /**
+     * With one thread every dab is blended in one job, otherwise big dabs
+     * are sampled and blended in stripes. The result should be the same.
+     */
+    Q_FOREACH (const QString &preset, QStringList() << "testing_200px_colorsmudge_default.kpp" << "Mix_dull.kpp") {
+        Q_FOREACH (bool overlayMode, QList<bool>() << false << true) {
+            const QImage singleJobImage = paintColorSmudgeLineWithThreads(preset, overlayMode, 1);
+            const QImage stripedImage = paintColorSmudgeLineWithThreads(preset, overlayMode, 4);
+
+            QPoint pt;
+            if (!TestUtil::compareQImages(pt, singleJobImage, stripedImage)) {
+                QFAIL(QString("Striped smudging differs at (%1, %2), preset %3, overlay %4")
+                      .arg(pt.x()).arg(pt.y()).arg(preset).arg(overlayMode)
+                      .toLatin1());
+            }
+        }
+    }
+}
+
+void FreehandStrokeTest::testColorSmudgeOverlayCancelled()
+{
+    KisImageSP image = paintColorSmudgeLine("testing_200px_colorsmudge_default.kpp", true, true);
+
+    /**
+     * The overlay mode blocks the updates of the projection while
+     * reading it. A cancelled stroke must not leave them blocked.
+     */
+    KisNodeSP node = image->root()->firstChild();
+    const QRect changedRect(0, 0, 10, 10);
+    const KoColor green(Qt::green, node->paintDevice()->colorSpace());
+
+    node->paintDevice()->fill(changedRect, green);
+    node->setDirty(changedRect);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!image->isIdle() && timer.elapsed() < 5000) {
+        QTest::qWait(10);
+    }
+
+    QVERIFY(image->isIdle());
+
+    QColor projectionColor;
+    image->projection()->pixel(5, 5, &projectionColor);
+    QCOMPARE(projectionColor, QColor(Qt::green));
+}
+
 void FreehandStrokeTest::testAutoBrushStrokeLod()
 {
     FreehandStrokeTester tester("Basic_tip_default.kpp", true);
@@ -34,6 +34,9 @@ private Q_SLOTS:
     void testAutoTextured38();
     void testMixDullCompositioning();
 
+    void testColorSmudgeStripes();
+    void testColorSmudgeOverlayCancelled();
+
     void testAutoBrushStrokeLod();
     void testPredefinedBrushStrokeLod();
 };
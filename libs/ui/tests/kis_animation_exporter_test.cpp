@@ -19,8 +19,11 @@
 #include "kis_animation_exporter_test.h"
 
 #include "dialogs/KisAsyncAnimationFramesSaveDialog.h"
+#include "dialogs/KisAsyncAnimationFramesStreamDialog.h"
+#include "KisAnimationFrameStream.h"
 
 #include <QTest>
+#include <QtConcurrent>
 #include <testutil.h>
 #include "KisPart.h"
 #include "kis_image.h"
@@ -98,4 +101,140 @@ void KisAnimationExporterTest::testAnimationExport()
     }
 }
 
+void KisAnimationExporterTest::testAnimationStreaming()
+{
+    KisDocument *document = KisPart::instance()->createDocument();
+    QRect rect(0,0,512,512);
+    QRect fillRect(10,0,502,512);
+    TestUtil::MaskParent p(rect);
+    document->setCurrentImage(p.image);
+    const KoColorSpace *cs = p.image->colorSpace();
+
+    KUndo2Command parentCommand;
+
+    p.layer->enableAnimation();
+    KisKeyframeChannel *rasterChannel = p.layer->getKeyframeChannel(KisKeyframeChannel::Content.id(), true);
+
+    rasterChannel->addKeyframe(1, &parentCommand);
+    rasterChannel->addKeyframe(2, &parentCommand);
+    p.image->animationInterface()->setFullClipRange(KisTimeRange::fromTime(0, 2));
+
+    KisPaintDeviceSP dev = p.layer->paintDevice();
+
+    QVector<QImage> frames;
+
+    dev->fill(fillRect, KoColor(Qt::red, cs));
+    frames << dev->convertToQImage(0, rect);
+
+    p.image->animationInterface()->switchCurrentTimeAsync(1);
+    p.image->waitForDone();
+    dev->fill(fillRect, KoColor(Qt::green, cs));
+    frames << dev->convertToQImage(0, rect);
+
+    p.image->animationInterface()->switchCurrentTimeAsync(2);
+    p.image->waitForDone();
+    dev->fill(fillRect, KoColor(Qt::blue, cs));
+    frames << dev->convertToQImage(0, rect);
+
+    const KisTimeRange range = KisTimeRange::fromTime(0, 2);
+
+    // the smallest capacity checks that the renderers wait for the consumer
+    KisAnimationFrameStream stream(range, 1);
+
+    QFuture<QVector<QImage>> streamedFrames = QtConcurrent::run([&stream] () {
+        QVector<QImage> result;
+        QImage frame;
+        while (stream.popFrame(&frame)) {
+            result << frame;
+        }
+        return result;
+    });
+
+    KisAsyncAnimationFramesStreamDialog exporter(document->image(), range, &stream);
+    exporter.setBatchMode(true);
+
+    QCOMPARE(exporter.regenerateRange(0), KisAsyncAnimationRenderDialogBase::RenderComplete);
+
+    const QVector<QImage> streamed = streamedFrames.result();
+    QCOMPARE(streamed.size(), frames.size());
+
+    for (int i = 0; i < frames.size(); i++) {
+        QCOMPARE(streamed[i].format(), QImage::Format_RGBA8888);
+
+        QPoint errpoint;
+        if (!TestUtil::compareQImages(errpoint, streamed[i].convertToFormat(QImage::Format_ARGB32), frames[i])) {
+            QFAIL(QString("Failed to stream identical frame%1, first different pixel: %2,%3 \n").arg(i).arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+        }
+    }
+}
+
+void KisAnimationExporterTest::testFrameStreamOrder()
+{
+    KisAnimationFrameStream stream(KisTimeRange::fromTime(10, 13), 2);
+
+    QVERIFY(stream.canAcceptFrame(10));
+    QVERIFY(stream.canAcceptFrame(11));
+    QVERIFY(!stream.canAcceptFrame(12));
+
+    QImage frame10(1, 1, QImage::Format_RGBA8888);
+    frame10.fill(Qt::red);
+    QImage frame11(1, 1, QImage::Format_RGBA8888);
+    frame11.fill(Qt::green);
+
+    // the frames may come out of order
+    QVERIFY(stream.pushFrame(11, frame11));
+    QVERIFY(stream.pushFrame(10, frame10));
+
+    QImage frame;
+    QVERIFY(stream.popFrame(&frame));
+    QCOMPARE(frame, frame10);
+
+    QVERIFY(stream.canAcceptFrame(12));
+    QVERIFY(!stream.canAcceptFrame(13));
+
+    QVERIFY(stream.popFrame(&frame));
+    QCOMPARE(frame, frame11);
+
+    stream.abort();
+
+    QVERIFY(stream.isAborted());
+    QVERIFY(!stream.canAcceptFrame(12));
+    QVERIFY(!stream.pushFrame(12, frame10));
+    QVERIFY(!stream.popFrame(&frame));
+}
+
+void KisAnimationExporterTest::testAbortedStreaming()
+{
+    QRect rect(0,0,64,64);
+    TestUtil::MaskParent p(rect);
+
+    p.layer->enableAnimation();
+    p.image->animationInterface()->setFullClipRange(KisTimeRange::fromTime(0, 2));
+
+    const KisTimeRange range = KisTimeRange::fromTime(0, 2);
+
+    {
+        // the consumer has failed before the renderer was created
+        KisAnimationFrameStream stream(range, 1);
+        stream.abort();
+
+        KisAsyncAnimationFramesStreamDialog exporter(p.image, range, &stream);
+        exporter.setBatchMode(true);
+
+        QCOMPARE(exporter.regenerateRange(0), KisAsyncAnimationRenderDialogBase::RenderFailed);
+    }
+
+    {
+        // the consumer has failed before the rendering was started
+        KisAnimationFrameStream stream(range, 1);
+
+        KisAsyncAnimationFramesStreamDialog exporter(p.image, range, &stream);
+        exporter.setBatchMode(true);
+
+        stream.abort();
+
+        QCOMPARE(exporter.regenerateRange(0), KisAsyncAnimationRenderDialogBase::RenderFailed);
+    }
+}
+
 KISTEST_MAIN(KisAnimationExporterTest)
@@ -27,6 +27,9 @@ class KisAnimationExporterTest : public QObject
 
 private Q_SLOTS:
     void testAnimationExport();
+    void testAnimationStreaming();
+    void testFrameStreamOrder();
+    void testAbortedStreaming();
 
 };
 #endif
@@ -31,7 +31,10 @@
 #include "kis_painting_information_builder.h"
 #include "kis_image.h"
 #include "kis_painter.h"
+#include "kis_node.h"
+#include "kis_paint_device.h"
 #include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
 #include <brushengine/kis_paintop_utils.h>
 
 #include "kis_update_time_monitor.h"
@@ -62,6 +65,10 @@ const qreal SPACING_UPDATE_INTERVAL = 50.0;
 // used when airbrushing.
 const qreal TIMING_UPDATE_INTERVAL = 50.0;
 
+// How far ahead in time, in milliseconds, we extrapolate the movement of the brush for
+// requesting the tiles to be loaded from swap.
+const qreal PREFETCH_LOOKAHEAD_INTERVAL = 150.0;
+
 struct KisToolFreehandHelper::Private
 {
     KisPaintingInformationBuilder *infoBuilder;
@@ -445,9 +452,39 @@ void KisToolFreehandHelper::paintEvent(KoPointerEvent *event)
 
     KisUpdateTimeMonitor::instance()->reportMouseMove(info.pos());
 
+    prefetchTilesAhead(info);
+
     paint(info);
 }
 
+void KisToolFreehandHelper::prefetchTilesAhead(const KisPaintInformation &info)
+{
+    KisNodeSP node = m_d->resources->currentNode();
+    KisPaintDeviceSP device = node ? node->paintDevice() : 0;
+    if (!device) return;
+
+    /**
+     * Extrapolate the trajectory of the brush linearly and ask the
+     * tiles engine to page the tiles we are going to paint on soon
+     * in from swap, so the stroke would not stall on them.
+     */
+    const KisPaintInformation &prevInfo = m_d->previousPaintInformation;
+    const qreal timeDiff = info.currentTime() - prevInfo.currentTime();
+    if (timeDiff <= 0) return;
+
+    const QPointF velocity = (info.pos() - prevInfo.pos()) / timeDiff;
+    const QPointF predictedPos = info.pos() + velocity * PREFETCH_LOOKAHEAD_INTERVAL;
+
+    const qreal radius = 0.5 * m_d->resources->currentPaintOpPreset()->settings()->paintOpSize();
+
+    const QRect prefetchRect =
+        QRectF(info.pos(), predictedPos).normalized()
+            .adjusted(-radius, -radius, radius, radius)
+            .toAlignedRect();
+
+    device->prefetchTiles(prefetchRect);
+}
+
 void KisToolFreehandHelper::paint(KisPaintInformation &info)
 {
     /**
@@ -150,6 +150,7 @@ private:
     KisPaintInformation getStabilizedPaintInfo(const QQueue<KisPaintInformation> &queue,
                                                const KisPaintInformation &lastPaintInfo);
     int computeAirbrushTimerInterval() const;
+    void prefetchTilesAhead(const KisPaintInformation &info);
 
 private Q_SLOTS:
     void finishStroke();
@@ -0,0 +1,162 @@
+/*  This file is part of the KDE project
+
+    Copyright (c) 2026 agent <agent@local>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "KoResourceMd5Cache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+
+#include "WidgetsDebug.h"
+
+namespace {
+
+const quint32 CACHE_MAGIC = 0x4b524d43; // "KRMC"
+const quint32 CACHE_VERSION = 1;
+
+struct CacheEntry
+{
+    qint64 modificationTime = 0;
+    qint64 size = 0;
+    QByteArray md5;
+};
+
+QDataStream &operator<<(QDataStream &stream, const CacheEntry &entry)
+{
+    return stream << entry.modificationTime << entry.size << entry.md5;
+}
+
+QDataStream &operator>>(QDataStream &stream, CacheEntry &entry)
+{
+    return stream >> entry.modificationTime >> entry.size >> entry.md5;
+}
+
+bool entryMatchesFile(const CacheEntry &entry, const QFileInfo &info)
+{
+    return entry.modificationTime == info.lastModified().toMSecsSinceEpoch() &&
+        entry.size == info.size();
+}
+
+}
+
+struct KoResourceMd5Cache::Private
+{
+    QString cacheFileName;
+    QHash<QString, CacheEntry> entries;
+
+    /**
+     * The files that still exist on disk, only they are saved
+     */
+    QSet<QString> usedFiles;
+    bool isDirty = false;
+};
+
+KoResourceMd5Cache::KoResourceMd5Cache(const QString &cacheFileName)
+    : m_d(new Private)
+{
+    m_d->cacheFileName = cacheFileName;
+
+    QFile file(cacheFileName);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        m_d->isDirty = true;
+        return;
+    }
+
+    stream >> m_d->entries;
+
+    if (stream.status() != QDataStream::Ok) {
+        warnWidgets << "Resource md5 cache is broken, ignoring it:" << cacheFileName;
+        m_d->entries.clear();
+        m_d->isDirty = true;
+    }
+}
+
+KoResourceMd5Cache::~KoResourceMd5Cache()
+{
+}
+
+QByteArray KoResourceMd5Cache::md5(const QString &fileName) const
+{
+    auto it = m_d->entries.constFind(fileName);
+    if (it == m_d->entries.constEnd()) return QByteArray();
+
+    m_d->usedFiles.insert(fileName);
+
+    if (!entryMatchesFile(*it, QFileInfo(fileName))) {
+        return QByteArray();
+    }
+
+    return it->md5;
+}
+
+void KoResourceMd5Cache::setMd5(const QString &fileName, const QByteArray &md5)
+{
+    const QFileInfo info(fileName);
+
+    CacheEntry entry;
+    entry.modificationTime = info.lastModified().toMSecsSinceEpoch();
+    entry.size = info.size();
+    entry.md5 = md5;
+
+    m_d->entries.insert(fileName, entry);
+    m_d->usedFiles.insert(fileName);
+    m_d->isDirty = true;
+}
+
+void KoResourceMd5Cache::save()
+{
+    if (m_d->usedFiles.size() != m_d->entries.size()) {
+        for (auto it = m_d->entries.begin(); it != m_d->entries.end();) {
+            if (!m_d->usedFiles.contains(it.key())) {
+                it = m_d->entries.erase(it);
+                m_d->isDirty = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (!m_d->isDirty) return;
+
+    QSaveFile file(m_d->cacheFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnWidgets << "Could not write the resource md5 cache:" << m_d->cacheFileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << CACHE_MAGIC << CACHE_VERSION << m_d->entries;
+
+    if (file.commit()) {
+        m_d->isDirty = false;
+    }
+}
@@ -0,0 +1,71 @@
+/*  This file is part of the KDE project
+
+    Copyright (c) 2026 agent <agent@local>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef KORESOURCEMD5CACHE_H
+#define KORESOURCEMD5CACHE_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+
+#include "kritawidgets_export.h"
+
+/**
+ * A persistent cache of the md5 sums of the resource files, used by
+ * KoResourceServer::loadResources() to avoid re-hashing the files
+ * that have not changed since the previous start. The resources are
+ * still loaded on every start, only the hashing is skipped.
+ *
+ * The entries are keyed by the file name and are valid only while
+ * the modification time and the size of the file stay the same.
+ *
+ * The cache is not thread-safe, it is read and updated only from the
+ * thread that loads the resources.
+ */
+class KRITAWIDGETS_EXPORT KoResourceMd5Cache
+{
+public:
+    /**
+     * Reads the cache from \p cacheFileName. The file is silently
+     * ignored if it doesn't exist or is broken.
+     */
+    KoResourceMd5Cache(const QString &cacheFileName);
+    ~KoResourceMd5Cache();
+
+    /**
+     * \return the md5 of \p fileName if the file has not changed since
+     * it was cached, an empty array otherwise
+     */
+    QByteArray md5(const QString &fileName) const;
+
+    void setMd5(const QString &fileName, const QByteArray &md5);
+
+    /**
+     * Writes the cache to the disk. Only the files that have been
+     * either looked up or updated since the cache has been read are
+     * saved, so the entries of the removed files are dropped.
+     */
+    void save();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KORESOURCEMD5CACHE_H
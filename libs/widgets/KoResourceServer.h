@@ -26,11 +26,16 @@
 #define KORESOURCESERVER_H
 
 #include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QVector>
 #include <QString>
 #include <QStringList>
 #include <QList>
 #include <QFileInfo>
+#include <QDateTime>
 #include <QDir>
+#include <QtConcurrentMap>
 
 #include <QTemporaryFile>
 #include <QDomDocument>
@@ -38,6 +43,7 @@
 #include "KoResourceServerPolicies.h"
 #include "KoResourceServerObserver.h"
 #include "KoResourceTagStore.h"
+#include "KoResourceMd5Cache.h"
 #include "KoResourcePaths.h"
 
 
@@ -91,9 +97,17 @@ public:
         return fileNames;
     }
 
+    /**
+     * Allows the server to decode the resources in several threads in
+     * loadResources(). Enable it only for the resources which load()
+     * doesn't touch anything but the resource itself.
+     */
+    void setConcurrentLoading(bool value) { m_concurrentLoading = value; }
+
 protected:
 
     QStringList m_blackListFileNames;
+    bool m_concurrentLoading = false;
 
     friend class KoResourceTagStore;
     virtual KoResource *byMd5(const QByteArray &md5) const = 0;
@@ -141,6 +155,7 @@ public:
     {
         m_blackListFile = KoResourcePaths::locateLocal("data", type + ".blacklist");
         m_blackListFileNames = readBlackListFile();
+        m_md5CacheFile = KoResourcePaths::locateLocal("data", type + ".md5cache");
         m_tagStore = new KoResourceTagStore(this);
     }
 
@@ -174,7 +189,23 @@ public:
      */
     void loadResources(QStringList filenames) override {
 
-        QStringList uniqueFiles;
+        struct LoadingItem {
+            QString fileName;
+            QString shortName;
+            PointerType resource;
+            QByteArray cachedMd5;
+            QDateTime lastModified;
+            qint64 fileSize = 0;
+            bool isCacheable = false;
+            bool isLoaded = false;
+        };
+
+        QMutexLocker locker(&m_loadLock);
+
+        KoResourceMd5Cache md5Cache(m_md5CacheFile);
+
+        QSet<QString> uniqueFiles;
+        QVector<LoadingItem> items;
 
         while (!filenames.empty()) {
 
@@ -195,34 +226,104 @@ public:
             //      the resource to find out whether they are really the same, but for now this
             //      will prevent the same brush etc. showing up twice.
             if (!uniqueFiles.contains(fname)) {
-                m_loadLock.lock();
-                uniqueFiles.append(fname);
+                uniqueFiles.insert(fname);
                 QList<PointerType> resources = createResources(front);
+
+                /**
+                 * The md5 of a file can be cached only when the file
+                 * contains a single resource, the resources of the
+                 * collections have their own md5s.
+                 */
+                const bool isCacheable = resources.size() == 1;
+
                 Q_FOREACH (PointerType resource, resources) {
                     Q_CHECK_PTR(resource);
-                    if (resource->load() && resource->valid() && !resource->md5().isEmpty()) {
-                        addResourceToMd5Registry(resource);
 
-                        m_resourcesByFilename[resource->shortFilename()] = resource;
-
-                        if (resource->name().isEmpty()) {
-                            resource->setName(fname);
-                        }
-                        if (m_resourcesByName.contains(resource->name())) {
-                            resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
-                        }
-                        m_resourcesByName[resource->name()] = resource;
-                        notifyResourceAdded(resource);
-                    }
-                    else {
-                        warnWidgets << "Loading resource " << front << "failed." << type();
-                        Policy::deleteResource(resource);
+                    LoadingItem item;
+                    item.fileName = front;
+                    item.shortName = fname;
+                    item.resource = resource;
+                    item.isCacheable = isCacheable;
+                    if (isCacheable) {
+                        item.cachedMd5 = md5Cache.md5(front);
+
+                        const QFileInfo info(front);
+                        item.lastModified = info.lastModified();
+                        item.fileSize = info.size();
                     }
+                    items.append(item);
                 }
-                m_loadLock.unlock();
             }
         }
 
+        /**
+         * Decoding of the resources and calculation of their md5 sums is
+         * the most expensive part, it doesn't touch the server, so it can
+         * be done in parallel. Everything else happens in the original
+         * order of the files, so the result doesn't depend on the timing.
+         */
+        auto loadItem = [] (LoadingItem &item) {
+            if (!item.cachedMd5.isEmpty()) {
+                item.resource->setMD5(item.cachedMd5);
+            }
+
+            const bool isLoaded = item.resource->load() && item.resource->valid();
+
+            /**
+             * Some resources rewrite their file while loading (e.g. the
+             * bundles with an old manifest are recreated), then the cached
+             * md5 belongs to the old file and should be calculated again
+             */
+            if (!item.cachedMd5.isEmpty()) {
+                const QFileInfo info(item.fileName);
+
+                if (info.lastModified() != item.lastModified ||
+                    info.size() != item.fileSize) {
+
+                    item.resource->setMD5(QByteArray());
+                }
+            }
+
+            item.isLoaded = isLoaded && !item.resource->md5().isEmpty();
+        };
+
+        if (m_concurrentLoading) {
+            QtConcurrent::blockingMap(items, loadItem);
+        } else {
+            for (int i = 0; i < items.size(); i++) {
+                loadItem(items[i]);
+            }
+        }
+
+        Q_FOREACH (const LoadingItem &item, items) {
+            PointerType resource = item.resource;
+
+            if (item.isLoaded) {
+                if (item.isCacheable && item.cachedMd5 != resource->md5()) {
+                    md5Cache.setMd5(item.fileName, resource->md5());
+                }
+
+                addResourceToMd5Registry(resource);
+
+                m_resourcesByFilename[resource->shortFilename()] = resource;
+
+                if (resource->name().isEmpty()) {
+                    resource->setName(item.shortName);
+                }
+                if (m_resourcesByName.contains(resource->name())) {
+                    resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
+                }
+                m_resourcesByName[resource->name()] = resource;
+                notifyResourceAdded(resource);
+            }
+            else {
+                warnWidgets << "Loading resource " << item.fileName << "failed." << type();
+                Policy::deleteResource(resource);
+            }
+        }
+
+        md5Cache.save();
+
         m_resources = sortedResources();
 
         Q_FOREACH (ObserverType* observer, m_observers) {
@@ -739,6 +840,7 @@ private:
     QList<PointerType> m_resources; ///< list of resources in order of addition
     QList<ObserverType*> m_observers;
     QString m_blackListFile;
+    QString m_md5CacheFile;
     KoResourceTagStore* m_tagStore;
 
 };
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoResourceMd5CacheTest.h"
+
+#include <QTest>
+#include <QFile>
+
+#include "KoResourceMd5Cache.h"
+
+namespace {
+
+QString outputFile(const QString &name)
+{
+    return QString(FILES_OUTPUT_DIR) + "/" + name;
+}
+
+void writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+}
+
+void KoResourceMd5CacheTest::testRoundTrip()
+{
+    const QString cacheFile = outputFile("md5cache_roundtrip.md5cache");
+    const QString resourceFile = outputFile("md5cache_roundtrip.pat");
+
+    QFile::remove(cacheFile);
+    writeFile(resourceFile, "resource data");
+
+    {
+        KoResourceMd5Cache cache(cacheFile);
+        QVERIFY(cache.md5(resourceFile).isEmpty());
+
+        cache.setMd5(resourceFile, "some md5");
+        QCOMPARE(cache.md5(resourceFile), QByteArray("some md5"));
+
+        cache.save();
+    }
+
+    KoResourceMd5Cache cache(cacheFile);
+    QCOMPARE(cache.md5(resourceFile), QByteArray("some md5"));
+}
+
+void KoResourceMd5CacheTest::testChangedFile()
+{
+    const QString cacheFile = outputFile("md5cache_changed.md5cache");
+    const QString resourceFile = outputFile("md5cache_changed.pat");
+
+    QFile::remove(cacheFile);
+    writeFile(resourceFile, "resource data");
+
+    {
+        KoResourceMd5Cache cache(cacheFile);
+        cache.setMd5(resourceFile, "some md5");
+        cache.save();
+    }
+
+    writeFile(resourceFile, "changed resource data");
+
+    KoResourceMd5Cache cache(cacheFile);
+    QVERIFY(cache.md5(resourceFile).isEmpty());
+}
+
+void KoResourceMd5CacheTest::testRemovedFile()
+{
+    const QString cacheFile = outputFile("md5cache_removed.md5cache");
+    const QString resourceFile1 = outputFile("md5cache_removed_1.pat");
+    const QString resourceFile2 = outputFile("md5cache_removed_2.pat");
+
+    QFile::remove(cacheFile);
+    writeFile(resourceFile1, "resource data 1");
+    writeFile(resourceFile2, "resource data 2");
+
+    {
+        KoResourceMd5Cache cache(cacheFile);
+        cache.setMd5(resourceFile1, "md5 1");
+        cache.setMd5(resourceFile2, "md5 2");
+        cache.save();
+    }
+
+    {
+        // the second file is not loaded anymore, so it should be dropped
+        KoResourceMd5Cache cache(cacheFile);
+        QCOMPARE(cache.md5(resourceFile1), QByteArray("md5 1"));
+        cache.save();
+    }
+
+    KoResourceMd5Cache cache(cacheFile);
+    QCOMPARE(cache.md5(resourceFile1), QByteArray("md5 1"));
+    QVERIFY(cache.md5(resourceFile2).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(KoResourceMd5CacheTest)
@@ -25,6 +25,21 @@
 #include <klocalizedstring.h>
 
 #include "LcmsColorSpace.h"
+#include "KoChannelInfo.h"
+
+namespace {
+
+int alphaChannelPos(const KoColorSpace *cs)
+{
+    Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+        if (channel->channelType() == KoChannelInfo::ALPHA) {
+            return channel->pos();
+        }
+    }
+    return -1;
+}
+
+}
 
 // -- KoLcmsColorConversionTransformation --
 
@@ -37,6 +52,9 @@ public:
                                         ConversionFlags conversionFlags)
         : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
         , m_transform(0)
+        , m_isU8ToU8(false)
+        , m_srcAlphaPos(-1)
+        , m_dstAlphaPos(-1)
     {
         Q_ASSERT(srcCs);
         Q_ASSERT(dstCs);
@@ -52,6 +70,14 @@ public:
             }
         }
 
+        if (srcCs->colorDepthId() == Integer8BitsColorDepthID &&
+            dstCs->colorDepthId() == Integer8BitsColorDepthID) {
+
+            m_isU8ToU8 = true;
+            m_srcAlphaPos = alphaChannelPos(srcCs);
+            m_dstAlphaPos = alphaChannelPos(dstCs);
+        }
+
         m_transform = cmsCreateTransform(srcProfile->lcmsProfile(),
                                          srcColorSpaceType,
                                          dstProfile->lcmsProfile(),
@@ -77,6 +103,31 @@ public:
         qint32 dstPixelSize = dstColorSpace()->pixelSize();
 
         cmsDoTransform(m_transform, const_cast<quint8 *>(src), dst, numPixels);
+
+        /**
+         * The 8-bit RGB conversions for the display go through the
+         * precalculated CLUT of LCMS, so copying of the alpha channel
+         * with two virtual calls per pixel used to be the slowest part
+         * of them. Between two 8-bit spaces the opacity is just copied.
+         */
+        if (m_isU8ToU8) {
+            if (m_dstAlphaPos < 0) return;
+
+            if (m_srcAlphaPos >= 0) {
+                const quint8 *srcAlpha = src + m_srcAlphaPos;
+                quint8 *dstAlpha = dst + m_dstAlphaPos;
+
+                while (numPixels > 0) {
+                    *dstAlpha = *srcAlpha;
+
+                    srcAlpha += srcPixelSize;
+                    dstAlpha += dstPixelSize;
+                    numPixels--;
+                }
+                return;
+            }
+        }
+
         // Lcms does nothing to the destination alpha channel so we must convert that manually.
         while (numPixels > 0) {
             qreal alpha = srcColorSpace()->opacityF(src);
@@ -90,6 +141,10 @@ public:
     }
 private:
     mutable cmsHTRANSFORM m_transform;
+
+    bool m_isU8ToU8;
+    int m_srcAlphaPos;
+    int m_dstAlphaPos;
 };
 
 class KoLcmsColorProofingConversionTransformation : public KoColorProofingConversionTransformation
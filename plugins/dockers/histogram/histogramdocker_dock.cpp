@@ -68,8 +68,9 @@ void HistogramDockerDock::setCanvas(KoCanvasBase * canvas)
 
         m_imageIdleWatcher->setTrackedImage(m_canvas->image());
 
-        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)), this, SLOT(startUpdateCanvasProjection()), Qt::UniqueConnection);
+        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)), this, SLOT(startUpdateCanvasProjection(QRect)), Qt::UniqueConnection);
         connect(m_canvas->image(), SIGNAL(sigColorSpaceChanged(const KoColorSpace*)), this, SLOT(sigColorSpaceChanged(const KoColorSpace*)), Qt::UniqueConnection);
+        connect(m_canvas->image(), SIGNAL(sigSizeChanged(QPointF,QPointF)), this, SLOT(slotImageSizeChanged()), Qt::UniqueConnection);
         m_imageIdleWatcher->startCountdown();
     }
 }
@@ -82,8 +83,10 @@ void HistogramDockerDock::unsetCanvas()
     m_imageIdleWatcher->startCountdown();
 }
 
-void HistogramDockerDock::startUpdateCanvasProjection()
+void HistogramDockerDock::startUpdateCanvasProjection(const QRect &rc)
 {
+    m_histogramWidget->addDirtyRect(rc);
+
     if (isVisible()) {
         m_imageIdleWatcher->startCountdown();
     }
@@ -103,6 +106,14 @@ void HistogramDockerDock::sigColorSpaceChanged(const KoColorSpace */*cs*/)
     }
 }
 
+void HistogramDockerDock::slotImageSizeChanged()
+{
+    // the widget rebuilds the histogram for the new bounds
+    if (isVisible()) {
+        m_imageIdleWatcher->startCountdown();
+    }
+}
+
 void HistogramDockerDock::updateHistogram()
 {
     if (isVisible()) {
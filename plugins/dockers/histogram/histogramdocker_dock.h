@@ -42,8 +42,9 @@ public:
     void unsetCanvas() override;
 
 public Q_SLOTS:
-    void startUpdateCanvasProjection();
+    void startUpdateCanvasProjection(const QRect &rc);
     void sigColorSpaceChanged(const KoColorSpace* cs);
+    void slotImageSizeChanged();
     void updateHistogram();
 
 protected:
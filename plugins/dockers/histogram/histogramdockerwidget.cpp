@@ -28,11 +28,14 @@
 #include "KoChannelInfo.h"
 #include "kis_paint_device.h"
 #include "KoColorSpace.h"
-#include "kis_iterator_ng.h"
+#include "KoHistogramProducer.h"
+#include "kis_histogram.h"
 #include "kis_canvas2.h"
+#include "kis_image.h"
 
 HistogramDockerWidget::HistogramDockerWidget(QWidget *parent, const char *name, Qt::WindowFlags f)
-    : QLabel(parent, f), m_paintDevice(nullptr), m_smoothHistogram(true)
+    : QLabel(parent, f), m_paintDevice(nullptr), m_smoothHistogram(true),
+      m_computationRunning(false), m_updatePending(false)
 {
     setObjectName(name);
 }
@@ -45,24 +48,75 @@ HistogramDockerWidget::~HistogramDockerWidget()
 void HistogramDockerWidget::setPaintDevice(KisCanvas2* canvas)
 {
     if (canvas) {
+        m_image = canvas->image();
         m_paintDevice = canvas->image()->projection();
-        m_bounds = canvas->image()->bounds();
     } else {
+        m_image.clear();
         m_paintDevice.clear();
-        m_bounds = QRect();
         m_histogramData.clear();
+        m_channelColors.clear();
     }
+
+    /**
+     * The results of the computation running for the previous canvas
+     * will be dropped, because they belong to another clone
+     */
+    m_devClone.clear();
+    m_histogram.clear();
+    m_bounds = QRect();
+    m_dirtyRect = QRect();
+}
+
+void HistogramDockerWidget::addDirtyRect(const QRect &rect)
+{
+    m_dirtyRect |= rect;
 }
 
 void HistogramDockerWidget::updateHistogram()
 {
-    if (!m_paintDevice.isNull()) {
-        KisPaintDeviceSP m_devClone = new KisPaintDevice(m_paintDevice->colorSpace());
+    if (m_computationRunning) {
+        m_updatePending = true;
+        return;
+    }
+
+    KisImageSP image = m_image;
+
+    if (!m_paintDevice.isNull() && image) {
+        const KoColorSpace *cs = m_paintDevice->colorSpace();
+
+        if (m_devClone && !(*m_devClone->colorSpace() == *cs)) {
+            m_devClone.clear();
+            m_histogram.clear();
+        }
+
+        /**
+         * The cells of the histogram cover the bounds it was created
+         * with, so the histogram is rebuilt when the image is resized
+         */
+        const QRect bounds = image->bounds();
+        if (bounds != m_bounds) {
+            m_bounds = bounds;
+            m_histogram.clear();
+        }
 
+        if (!m_devClone) {
+            m_devClone = new KisPaintDevice(cs);
+        }
+
+        /**
+         * The clone is never touched while the computation thread is
+         * running, so the thread can read it without any locking. The
+         * histogram keeps a pointer to the clone, so the new data is
+         * visible to it.
+         */
         m_devClone->makeCloneFrom(m_paintDevice, m_bounds);
 
-        HistogramComputationThread *workerThread = new HistogramComputationThread(m_devClone, m_bounds);
-        connect(workerThread, &HistogramComputationThread::resultReady, this, &HistogramDockerWidget::receiveNewHistogram);
+        HistogramComputationThread *workerThread =
+            new HistogramComputationThread(m_devClone, m_bounds, m_histogram, m_dirtyRect);
+        m_dirtyRect = QRect();
+        m_computationRunning = true;
+
+        connect(workerThread, &HistogramComputationThread::finished, this, &HistogramDockerWidget::slotComputationFinished);
         connect(workerThread, &HistogramComputationThread::finished, workerThread, &QObject::deleteLater);
         workerThread->start();
     } else {
@@ -71,17 +125,59 @@ void HistogramDockerWidget::updateHistogram()
     }
 }
 
+void HistogramDockerWidget::slotComputationFinished()
+{
+    HistogramComputationThread *workerThread =
+        qobject_cast<HistogramComputationThread*>(sender());
+
+    m_computationRunning = false;
+
+    if (workerThread && workerThread->device() == m_devClone) {
+        m_histogram = workerThread->histogram();
+        updateChannelColors();
+        receiveNewHistogram(workerThread->bins());
+    }
+
+    if (m_updatePending) {
+        m_updatePending = false;
+        updateHistogram();
+    }
+}
+
 void HistogramDockerWidget::receiveNewHistogram(HistVector *histogramData)
 {
     m_histogramData = *histogramData;
     update();
 }
 
+void HistogramDockerWidget::updateChannelColors()
+{
+    m_channelColors.clear();
+    if (!m_histogram) return;
+
+    /**
+     * The producer may count the channels in a different order than
+     * the color space, e.g. the generic producers, so the colors are
+     * taken from the producer's own list of channels
+     */
+    const QList<KoChannelInfo *> channels = m_histogram->producer()->channels();
+
+    for (int chan = 0; chan < channels.size(); chan++) {
+        if (channels.at(chan)->channelType() != KoChannelInfo::ALPHA) {
+            m_channelColors << qMakePair(chan, channels.at(chan)->color());
+        }
+    }
+
+    //special handling of grayscale color spaces. can't use color returned above.
+    if (m_channelColors.size() == 1) {
+        m_channelColors.first().second = QColor(Qt::gray);
+    }
+}
+
 void HistogramDockerWidget::paintEvent(QPaintEvent *event)
 {
     if (!m_histogramData.empty()) {
         int nBins = m_histogramData.at(0).size();
-        const KoColorSpace* cs = m_paintDevice->colorSpace();
 
         QLabel::paintEvent(event);
         QPainter painter(this);
@@ -93,61 +189,56 @@ void HistogramDockerWidget::paintEvent(QPaintEvent *event)
             painter.drawLine(0., this->height()*i / NGRID, this->width(), this->height()*i / NGRID);
         }
 
-        unsigned int nChannels = cs->channelCount();
-        QList<KoChannelInfo *> channels = cs->channels();
         unsigned int highest = 0;
         //find the most populous bin in the histogram to scale it properly
-        for (int chan = 0; chan < channels.size(); chan++) {
-            if (channels.at(chan)->channelType() != KoChannelInfo::ALPHA) {
-                std::vector<quint32> histogramTemp = m_histogramData.at(chan);
-                //use 98th percentile, rather than max for better visual appearance
-                int nthPercentile = 2 * histogramTemp.size() / 100;
-                //unsigned int max = *std::max_element(m_histogramData.at(chan).begin(),m_histogramData.at(chan).end());
-                std::nth_element(histogramTemp.begin(),
-                                 histogramTemp.begin() + nthPercentile, histogramTemp.end(), std::greater<int>());
-                unsigned int max = *(histogramTemp.begin() + nthPercentile);
-
-                highest = std::max(max, highest);
-            }
+        Q_FOREACH (const auto &channel, m_channelColors) {
+            const int chan = channel.first;
+            if (chan >= (int)m_histogramData.size()) continue;
+
+            std::vector<quint32> histogramTemp = m_histogramData.at(chan);
+            //use 98th percentile, rather than max for better visual appearance
+            int nthPercentile = 2 * histogramTemp.size() / 100;
+            //unsigned int max = *std::max_element(m_histogramData.at(chan).begin(),m_histogramData.at(chan).end());
+            std::nth_element(histogramTemp.begin(),
+                             histogramTemp.begin() + nthPercentile, histogramTemp.end(), std::greater<int>());
+            unsigned int max = *(histogramTemp.begin() + nthPercentile);
+
+            highest = std::max(max, highest);
         }
 
         painter.setWindow(QRect(-1, 0, nBins + 1, highest));
         painter.setCompositionMode(QPainter::CompositionMode_Plus);
 
-        for (int chan = 0; chan < (int)nChannels; chan++) {
-            if (channels.at(chan)->channelType() != KoChannelInfo::ALPHA) {
-                QColor color = channels.at(chan)->color();
+        Q_FOREACH (const auto &channel, m_channelColors) {
+            const int chan = channel.first;
+            if (chan >= (int)m_histogramData.size()) continue;
 
-                //special handling of grayscale color spaces. can't use color returned above.
-                if(cs->colorChannelCount()==1){
-                    color = QColor(Qt::gray);
-                }
+            const QColor color = channel.second;
 
-                QColor fill_color = color;
-                fill_color.setAlphaF(.25);
-                painter.setBrush(fill_color);
-                QPen pen = QPen(color);
-                pen.setWidth(0);
-                painter.setPen(pen);
+            QColor fill_color = color;
+            fill_color.setAlphaF(.25);
+            painter.setBrush(fill_color);
+            QPen pen = QPen(color);
+            pen.setWidth(0);
+            painter.setPen(pen);
+
+            if (m_smoothHistogram) {
+                QPainterPath path;
+                path.moveTo(QPointF(-1, highest));
+                for (qint32 i = 0; i < nBins; ++i) {
+                    float v = std::max((float)highest - m_histogramData[chan][i], 0.f);
+                    path.lineTo(QPointF(i, v));
 
-                if (m_smoothHistogram) {
-                    QPainterPath path;
-                    path.moveTo(QPointF(-1, highest));
-                    for (qint32 i = 0; i < nBins; ++i) {
-                        float v = std::max((float)highest - m_histogramData[chan][i], 0.f);
-                        path.lineTo(QPointF(i, v));
-
-                    }
-                    path.lineTo(QPointF(nBins + 1, highest));
-                    path.closeSubpath();
-                    painter.drawPath(path);
-                } else {
-                    pen.setWidth(1);
-                    painter.setPen(pen);
-                    for (qint32 i = 0; i < nBins; ++i) {
-                        float v = std::max((float)highest - m_histogramData[chan][i], 0.f);
-                        painter.drawLine(QPointF(i, highest), QPointF(i, v));
-                    }
+                }
+                path.lineTo(QPointF(nBins + 1, highest));
+                path.closeSubpath();
+                painter.drawPath(path);
+            } else {
+                pen.setWidth(1);
+                painter.setPen(pen);
+                for (qint32 i = 0; i < nBins; ++i) {
+                    float v = std::max((float)highest - m_histogramData[chan][i], 0.f);
+                    painter.drawLine(QPointF(i, highest), QPointF(i, v));
                 }
             }
         }
@@ -156,42 +247,38 @@ void HistogramDockerWidget::paintEvent(QPaintEvent *event)
 
 void HistogramComputationThread::run()
 {
-    const KoColorSpace *cs = m_dev->colorSpace();
-    quint32 channelCount = m_dev->channelCount();
-    quint32 pixelSize = m_dev->pixelSize();
+    if (!m_histogram) {
+        const KoColorSpace *cs = m_dev->colorSpace();
+
+        QList<QString> keys =
+            KoHistogramProducerFactoryRegistry::instance()->keysCompatibleWith(cs);
 
-    quint32 imageSize = m_bounds.width() * m_bounds.height();
-    quint32 nSkip = 1 + (imageSize >> 20); //for speed use about 1M pixels for computing histograms
+        if (keys.isEmpty()) return;
 
-    //allocate space for the histogram data
-    bins.resize((int)channelCount);
-    for (auto &bin : bins) {
-        bin.resize(std::numeric_limits<quint8>::max() + 1);
+        KoHistogramProducer *producer =
+            KoHistogramProducerFactoryRegistry::instance()->get(keys.at(0))->generate();
+
+        m_histogram = new KisHistogram(m_dev, m_bounds, producer, LINEAR);
     }
 
-    QRect bounds = m_dev->exactBounds();
-    if (bounds.isEmpty())
-        return;
+    /**
+     * The first call switches the histogram into the incremental mode
+     * and counts all the cells, the dirty rect is ignored then
+     */
+    m_histogram->updateHistogram(m_dirtyRect);
 
-    quint32 toSkip = nSkip;
+    const int channelCount = m_histogram->producer()->channels().count();
+    const int numberOfBins = m_histogram->producer()->numberOfBins();
 
-    KisSequentialConstIterator it(m_dev, m_dev->exactBounds());
+    m_bins.resize(channelCount);
+    for (int chan = 0; chan < channelCount; ++chan) {
+        m_histogram->setChannel(chan);
 
-    int numConseqPixels = it.nConseqPixels();
-    while (it.nextPixels(numConseqPixels)) {
+        std::vector<quint32> &bin = m_bins[chan];
+        bin.resize(numberOfBins);
 
-        numConseqPixels = it.nConseqPixels();
-        const quint8* pixel = it.rawDataConst();
-        for (int k = 0; k < numConseqPixels; ++k) {
-            if (--toSkip == 0) {
-                for (int chan = 0; chan < (int)channelCount; ++chan) {
-                    bins[chan][cs->scaleToU8(pixel, chan)]++;
-                }
-                toSkip = nSkip;
-            }
-            pixel += pixelSize;
+        for (int i = 0; i < numberOfBins; ++i) {
+            bin[i] = m_histogram->getValue(i);
         }
     }
-
-    emit resultReady(&bins);
 }
@@ -23,6 +23,9 @@
 #include <QWidget>
 #include <QLabel>
 #include <QThread>
+#include <QVector>
+#include <QPair>
+#include <QColor>
 #include "kis_types.h"
 #include <vector>
 
@@ -31,22 +34,40 @@ class KisCanvas2;
 typedef std::vector<std::vector<quint32> > HistVector; //Don't use QVector here - it's too slow for this purpose
 
 
+/**
+ * Updates the histogram of a clone of the projection in the background.
+ * The histogram is created on the first run, later runs recount only the
+ * cells of the histogram that intersect the dirty rect.
+ */
 class HistogramComputationThread : public QThread
 {
     Q_OBJECT
 public:
-    HistogramComputationThread(KisPaintDeviceSP _dev, const QRect& _bounds) : m_dev(_dev), m_bounds(_bounds)
+    HistogramComputationThread(KisPaintDeviceSP _dev, const QRect& _bounds,
+                               KisHistogramSP _histogram, const QRect& _dirtyRect)
+        : m_dev(_dev), m_bounds(_bounds), m_histogram(_histogram), m_dirtyRect(_dirtyRect)
     {}
 
     void run() override;
 
-Q_SIGNALS:
-    void resultReady(HistVector*);
+    KisPaintDeviceSP device() const {
+        return m_dev;
+    }
+
+    KisHistogramSP histogram() const {
+        return m_histogram;
+    }
+
+    HistVector* bins() {
+        return &m_bins;
+    }
 
 private:
     KisPaintDeviceSP m_dev;
     QRect m_bounds;
-    HistVector bins;
+    KisHistogramSP m_histogram;
+    QRect m_dirtyRect;
+    HistVector m_bins;
 };
 
 
@@ -60,15 +81,37 @@ public:
     void setPaintDevice(KisCanvas2* canvas);
     void paintEvent(QPaintEvent *event) override;
 
+    /// Marks \p rect of the projection as changed since the last update
+    void addDirtyRect(const QRect &rect);
+
 public Q_SLOTS:
     void updateHistogram();
     void receiveNewHistogram(HistVector*);
 
+private Q_SLOTS:
+    void slotComputationFinished();
+
 private:
+    void updateChannelColors();
+
+private:
+    KisImageWSP m_image;
     KisPaintDeviceSP m_paintDevice;
+    KisPaintDeviceSP m_devClone;
+    KisHistogramSP m_histogram;
     HistVector m_histogramData;
+
+    /**
+     * The indexes of the non-alpha channels of the histogram producer
+     * and the colors to paint them with
+     */
+    QVector<QPair<int, QColor>> m_channelColors;
+
     QRect m_bounds;
+    QRect m_dirtyRect;
     bool m_smoothHistogram;
+    bool m_computationRunning;
+    bool m_updatePending;
 };
 
 #endif // HISTOGRAMDOCKERWIDGET_H
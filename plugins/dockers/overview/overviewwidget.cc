@@ -242,6 +242,11 @@ void OverviewWidget::generateThumbnail()
 
                 strokeId = image->startStroke(stroke);
                 KisPaintDeviceSP dev = image->projection();
+
+                // the thumbnail tiles are sampled from the projection's
+                // mipmap, which is updated incrementally by the image
+                dev->mipmap();
+
                 KisPaintDeviceSP thumbDev = new KisPaintDevice(dev->colorSpace());
 
                 //creating a special stroke that computes thumbnail image in small chunks that can be quickly interrupted
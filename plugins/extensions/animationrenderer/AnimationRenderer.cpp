@@ -119,22 +119,37 @@ void AnimaterionRenderer::slotRenderAnimation()
 
         const bool batchMode = false; // TODO: fetch correctly!
 
-        KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
-                                                   KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
-                                                   baseFileName,
-                                                   sequenceConfig->getInt("sequence_start"),
-                                                   dlgAnimationRenderer.getFrameExportConfiguration());
-        exporter.setBatchMode(batchMode);
+        KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
 
+        const bool deleteSequence = videoConfig && videoConfig->getBool("delete_sequence", false);
 
-        KisAsyncAnimationFramesSaveDialog::Result result =
-            exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+        /**
+         * If the user doesn't need the image sequence, the frames are
+         * streamed directly into the encoder, so we don't need to save
+         * and decode the intermediate PNG files. GIFs are still encoded
+         * from the sequence, since their palette is generated in a separate
+         * pass over all the frames.
+         */
+        const bool streamFrames = deleteSequence &&
+            QFileInfo(videoConfig->getString("filename")).suffix().toLower() != "gif";
+
+        KisAsyncAnimationFramesSaveDialog::Result result = KisAsyncAnimationFramesSaveDialog::RenderComplete;
+        QString savedFilesMask;
+
+        if (!streamFrames) {
+            KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
+                                                       KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
+                                                       baseFileName,
+                                                       sequenceConfig->getInt("sequence_start"),
+                                                       dlgAnimationRenderer.getFrameExportConfiguration());
+            exporter.setBatchMode(batchMode);
+
+            result = exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+            savedFilesMask = exporter.savedFilesMask();
+        }
 
         // the folder could have been read-only or something else could happen
         if (result == KisAsyncAnimationFramesSaveDialog::RenderComplete) {
-            QString savedFilesMask = exporter.savedFilesMask();
-
-            KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
             if (videoConfig) {
                 kisConfig.setExportConfiguration("ANIMATION_RENDERER", videoConfig);
 
@@ -142,6 +157,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (encoderConfig) {
                     kisConfig.setExportConfiguration("FFMPEG_CONFIG", encoderConfig);
                     encoderConfig->setProperty("savedFilesMask", savedFilesMask);
+                    encoderConfig->setProperty("stream_frames", streamFrames);
                 }
 
                 const QString fileName = videoConfig->getString("filename");
@@ -176,7 +192,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (res != KisImportExportFilter::OK) {
                     QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("Could not render animation:\n%1", doc->errorMessage()));
                 }
-                if (videoConfig->getBool("delete_sequence", false)) {
+                if (deleteSequence && !streamFrames) {
                     QDir d(sequenceConfig->getString("directory"));
                     QStringList sequenceFiles = d.entryList(QStringList() << sequenceConfig->getString("basename") + "*." + extension, QDir::Files);
                     Q_FOREACH(const QString &f, sequenceFiles) {
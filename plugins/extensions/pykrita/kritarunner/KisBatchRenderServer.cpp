@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBatchRenderServer.h"
+
+#include <functional>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+
+#include <KisDocument.h>
+#include <KisImportExportFilter.h>
+#include <KisImportExportManager.h>
+#include <KisMimeDatabase.h>
+#include <KisPart.h>
+#include <kis_debug.h>
+#include <kis_filter_strategy.h>
+#include <kis_image.h>
+#include <kis_layer_utils.h>
+#include <kis_properties_configuration.h>
+#include <kis_simple_stroke_strategy.h>
+
+
+namespace {
+
+struct BatchJob
+{
+    QString id;
+    QString input;
+    QString output;
+    bool flatten = false;
+    QSize size;
+    QString filterStrategy;
+    QVariantMap options;
+
+    QElapsedTimer queuedTimer;
+};
+
+struct BatchJobResult
+{
+    QString id;
+    bool success = false;
+    QString error;
+
+    qint64 queued = 0;
+    qint64 load = 0;
+    qint64 flatten = 0;
+    qint64 scale = 0;
+    qint64 exportTime = 0;
+    qint64 total = 0;
+};
+
+bool parseJob(const QJsonObject &object, BatchJob *job, QString *error)
+{
+    job->id = object.value("id").toVariant().toString();
+    job->input = object.value("input").toString();
+    job->output = object.value("output").toString();
+    job->flatten = object.value("flatten").toBool(false);
+    job->size = QSize(object.value("width").toInt(0), object.value("height").toInt(0));
+    job->filterStrategy = object.value("filter").toString("Bicubic");
+    job->options = object.value("options").toObject().toVariantMap();
+
+    if (job->input.isEmpty() || job->output.isEmpty()) {
+        *error = "\"input\" and \"output\" are mandatory";
+        return false;
+    }
+
+    if (job->size.width() < 0 || job->size.height() < 0) {
+        *error = "the size of the image cannot be negative";
+        return false;
+    }
+
+    return true;
+}
+
+QSize calculateTargetSize(const QSize &requestedSize, const QSize &imageSize)
+{
+    QSize size = requestedSize;
+
+    if (size.width() <= 0 && size.height() <= 0) {
+        return imageSize;
+    } else if (size.width() <= 0) {
+        size.setWidth(qMax(1, qRound(qreal(imageSize.width()) * size.height() / imageSize.height())));
+    } else if (size.height() <= 0) {
+        size.setHeight(qMax(1, qRound(qreal(imageSize.height()) * size.width() / imageSize.width())));
+    }
+
+    return size;
+}
+
+QByteArray serializeResult(const BatchJobResult &result)
+{
+    QJsonObject timings;
+    timings["queued"] = double(result.queued);
+    timings["load"] = double(result.load);
+    timings["flatten"] = double(result.flatten);
+    timings["scale"] = double(result.scale);
+    timings["export"] = double(result.exportTime);
+    timings["total"] = double(result.total);
+
+    QJsonObject object;
+    object["id"] = result.id;
+    object["status"] = result.success ? "ok" : "failed";
+    object["error"] = result.error;
+    object["timings"] = timings;
+
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+/**
+ * An empty stroke that is started after the actions of a stage. Its
+ * finishing job is an exclusive barrier, so it runs only when all the
+ * strokes started before it and all the running updates are done.
+ */
+class StageNotifierStrokeStrategy : public KisSimpleStrokeStrategy
+{
+public:
+    StageNotifierStrokeStrategy(std::function<void()> callback)
+        : KisSimpleStrokeStrategy("batch-render-stage-stroke"),
+          m_callback(callback)
+    {
+        setClearsRedoOnStart(false);
+        setRequestsOtherStrokesToEnd(false);
+        enableJob(JOB_FINISH, true, KisStrokeJobData::BARRIER, KisStrokeJobData::EXCLUSIVE);
+    }
+
+    void finishStrokeCallback() override {
+        m_callback();
+    }
+
+private:
+    std::function<void()> m_callback;
+};
+
+}
+
+struct KisBatchRenderServer::RunningJob
+{
+    enum Stage {
+        Loading,
+        Flattening,
+        Scaling
+    };
+
+    BatchJob job;
+    QPointer<QLocalSocket> socket;
+    int serial = 0;
+    Stage stage = Loading;
+
+    QScopedPointer<KisDocument> document;
+    BatchJobResult result;
+
+    QElapsedTimer totalTimer;
+    QElapsedTimer stageTimer;
+};
+
+struct KisBatchRenderServer::Private
+{
+    QLocalServer server;
+    int maxParallelJobs = 1;
+
+    /**
+     * The jobs waiting for a free slot and the sockets their results
+     * should be sent to. A socket may disconnect while the job is still
+     * being processed, in which case the result is only logged.
+     */
+    QQueue<QPair<BatchJob, QPointer<QLocalSocket>>> pendingJobs;
+
+    /**
+     * The jobs whose documents are loaded. They are looked up by the
+     * serial number, because the notification about the end of a stage
+     * may arrive after the job has already failed.
+     */
+    QHash<int, RunningJob*> runningJobs;
+    int nextSerial = 0;
+
+    bool isStartingJobs = false;
+    bool quitRequested = false;
+};
+
+KisBatchRenderServer::KisBatchRenderServer(int maxParallelJobs, QObject *parent)
+    : QObject(parent),
+      m_d(new Private)
+{
+    m_d->maxParallelJobs = qMax(1, maxParallelJobs);
+
+    connect(&m_d->server, SIGNAL(newConnection()), SLOT(slotNewConnection()));
+}
+
+KisBatchRenderServer::~KisBatchRenderServer()
+{
+    m_d->server.close();
+
+    /**
+     * The stage notifiers refer to the server, so let them finish
+     * before it goes away.
+     */
+    Q_FOREACH (RunningJob *job, m_d->runningJobs) {
+        job->document->image()->waitForDone();
+    }
+    qDeleteAll(m_d->runningJobs);
+}
+
+bool KisBatchRenderServer::listen(const QString &name)
+{
+    QLocalServer::removeServer(name);
+    return m_d->server.listen(name);
+}
+
+QString KisBatchRenderServer::errorString() const
+{
+    return m_d->server.errorString();
+}
+
+KisPropertiesConfigurationSP KisBatchRenderServer::createExportConfiguration(const QString &mimeType,
+                                                                             const QVariantMap &options)
+{
+    KisPropertiesConfigurationSP configuration;
+
+    QScopedPointer<KisImportExportFilter> filter(
+        KisImportExportManager::filterForMimeType(mimeType, KisImportExportManager::Export));
+
+    if (filter) {
+        configuration = filter->defaultConfiguration(QByteArray(), mimeType.toLatin1());
+    }
+
+    if (!configuration) {
+        configuration = new KisPropertiesConfiguration();
+    }
+
+    for (auto it = options.constBegin(); it != options.constEnd(); ++it) {
+        configuration->setProperty(it.key(), it.value());
+    }
+
+    return configuration;
+}
+
+void KisBatchRenderServer::slotNewConnection()
+{
+    while (QLocalSocket *socket = m_d->server.nextPendingConnection()) {
+        connect(socket, SIGNAL(readyRead()), SLOT(slotReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void KisBatchRenderServer::slotReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(socket);
+
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (!line.isEmpty()) {
+            processLine(socket, line);
+        }
+    }
+
+    startPendingJobs();
+}
+
+void KisBatchRenderServer::processLine(QLocalSocket *socket, const QByteArray &line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument json = QJsonDocument::fromJson(line, &parseError);
+
+    BatchJob job;
+    job.queuedTimer.start();
+
+    QString error;
+
+    if (!json.isObject()) {
+        error = QString("malformed request: %1").arg(parseError.errorString());
+    } else if (json.object().value("command").toString() == "quit") {
+        m_d->quitRequested = true;
+        quitWhenIdle();
+        return;
+    } else if (m_d->quitRequested) {
+        error = "the server is shutting down";
+    } else {
+        parseJob(json.object(), &job, &error);
+    }
+
+    if (!error.isEmpty()) {
+        BatchJobResult result;
+        result.id = json.object().value("id").toVariant().toString();
+        result.error = error;
+        socket->write(serializeResult(result));
+        return;
+    }
+
+    m_d->pendingJobs.enqueue(qMakePair(job, QPointer<QLocalSocket>(socket)));
+}
+
+void KisBatchRenderServer::startPendingJobs()
+{
+    /**
+     * Loading a document may spin the event loop, so new requests
+     * may arrive while we are still here. They are picked up by the
+     * outer loop.
+     */
+    if (m_d->isStartingJobs) return;
+    m_d->isStartingJobs = true;
+
+    while (m_d->runningJobs.size() < m_d->maxParallelJobs &&
+           !m_d->pendingJobs.isEmpty()) {
+
+        const QPair<BatchJob, QPointer<QLocalSocket>> pending = m_d->pendingJobs.dequeue();
+
+        RunningJob *job = new RunningJob();
+        job->job = pending.first;
+        job->socket = pending.second;
+        job->serial = m_d->nextSerial++;
+        job->result.id = job->job.id;
+        job->result.queued = job->job.queuedTimer.elapsed();
+
+        m_d->runningJobs.insert(job->serial, job);
+
+        loadDocument(job);
+    }
+
+    m_d->isStartingJobs = false;
+}
+
+void KisBatchRenderServer::loadDocument(RunningJob *job)
+{
+    job->totalTimer.start();
+    job->stageTimer.start();
+
+    const QString outputMimeType = KisMimeDatabase::mimeTypeForFile(job->job.output, false);
+    if (outputMimeType.isEmpty() || outputMimeType == "application/octetstream") {
+        job->result.error = QString("unknown output format: %1").arg(job->job.output);
+        finishJob(job);
+        return;
+    }
+
+    job->document.reset(KisPart::instance()->createDocument());
+    job->document->setFileBatchMode(true);
+
+    if (!job->document->openUrl(QUrl::fromLocalFile(job->job.input), KisDocument::DontAddToRecent) ||
+        !job->document->image()) {
+
+        job->result.error = QString("could not open %1: %2").arg(job->job.input).arg(job->document->errorMessage());
+        finishJob(job);
+        return;
+    }
+
+    /**
+     * The loaded layers are still being merged into the projection, so
+     * the loading stage ends when the image becomes idle.
+     */
+    job->stage = RunningJob::Loading;
+    startStage(job);
+}
+
+void KisBatchRenderServer::startStage(RunningJob *job)
+{
+    KisImageSP image = job->document->image();
+
+    switch (job->stage) {
+    case RunningJob::Loading:
+        break;
+    case RunningJob::Flattening:
+        image->flatten(0);
+        break;
+    case RunningJob::Scaling: {
+        KisFilterStrategy *strategy = KisFilterStrategyRegistry::instance()->get(job->job.filterStrategy);
+        if (!strategy) {
+            warnKrita << "Unknown filter strategy" << job->job.filterStrategy << "falling back to Bicubic";
+            strategy = KisFilterStrategyRegistry::instance()->get("Bicubic");
+        }
+
+        image->scaleImage(calculateTargetSize(job->job.size, image->size()),
+                          image->xRes(), image->yRes(), strategy);
+        break;
+    }
+    }
+
+    const int serial = job->serial;
+
+    KisStrokeId strokeId = image->startStroke(
+        new StageNotifierStrokeStrategy(
+            [this, serial] () {
+                QMetaObject::invokeMethod(this, "slotStageFinished",
+                                          Qt::QueuedConnection, Q_ARG(int, serial));
+            }));
+
+    image->endStroke(strokeId);
+}
+
+void KisBatchRenderServer::slotStageFinished(int jobSerial)
+{
+    RunningJob *job = m_d->runningJobs.value(jobSerial, 0);
+    if (!job) return;
+
+    KisImageSP image = job->document->image();
+
+    const qint64 elapsed = job->stageTimer.restart();
+
+    switch (job->stage) {
+    case RunningJob::Loading:
+        job->result.load = elapsed;
+        break;
+    case RunningJob::Flattening:
+        job->result.flatten = elapsed;
+        break;
+    case RunningJob::Scaling:
+        job->result.scale = elapsed;
+        break;
+    }
+
+    if (job->stage < RunningJob::Flattening && job->job.flatten) {
+        job->stage = RunningJob::Flattening;
+        startStage(job);
+        return;
+    }
+
+    if (job->stage < RunningJob::Scaling &&
+        calculateTargetSize(job->job.size, image->size()) != image->size()) {
+
+        job->stage = RunningJob::Scaling;
+        startStage(job);
+        return;
+    }
+
+    exportDocument(job);
+}
+
+void KisBatchRenderServer::exportDocument(RunningJob *job)
+{
+    KisImageSP image = job->document->image();
+
+    // the same way as KisDocument::lockAndCloneForSaving() does
+    KisLayerUtils::forceAllDelayedNodesUpdate(image->root());
+    image->waitForDone();
+
+    const QString outputMimeType = KisMimeDatabase::mimeTypeForFile(job->job.output, false);
+
+    if (!job->document->exportDocumentSync(QUrl::fromLocalFile(job->job.output),
+                                           outputMimeType.toLatin1(),
+                                           createExportConfiguration(outputMimeType, job->job.options))) {
+
+        job->result.error = QString("could not export %1: %2").arg(job->job.output).arg(job->document->errorMessage());
+        finishJob(job);
+        return;
+    }
+
+    job->result.exportTime = job->stageTimer.elapsed();
+    job->result.total = job->totalTimer.elapsed();
+    job->result.success = true;
+
+    finishJob(job);
+}
+
+void KisBatchRenderServer::finishJob(RunningJob *job)
+{
+    m_d->runningJobs.remove(job->serial);
+
+    const BatchJobResult &result = job->result;
+
+    if (result.success) {
+        qDebug().noquote() << "Finished job" << result.id
+                           << "queued:" << result.queued
+                           << "load:" << result.load
+                           << "flatten:" << result.flatten
+                           << "scale:" << result.scale
+                           << "export:" << result.exportTime
+                           << "total:" << result.total;
+    } else {
+        qWarning().noquote() << "Failed job" << result.id << result.error;
+    }
+
+    if (job->socket) {
+        job->socket->write(serializeResult(result));
+    }
+
+    delete job;
+
+    startPendingJobs();
+    quitWhenIdle();
+}
+
+void KisBatchRenderServer::quitWhenIdle()
+{
+    if (m_d->quitRequested && m_d->runningJobs.isEmpty() && m_d->pendingJobs.isEmpty()) {
+        m_d->server.close();
+        QCoreApplication::quit();
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISBATCHRENDERSERVER_H
+#define KISBATCHRENDERSERVER_H
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QVariantMap>
+
+#include <kis_types.h>
+
+class QLocalSocket;
+
+/**
+ * A persistent headless service that converts documents on request.
+ *
+ * The server listens on a local socket (a Unix domain socket or a
+ * named pipe on Windows) and accepts the jobs as JSON objects, one
+ * object per line:
+ *
+ * \code
+ * {"id": "42", "input": "/in/a.kra", "output": "/out/a.png",
+ *  "flatten": true, "width": 512, "height": 0, "filter": "Bicubic",
+ *  "options": {"compression": 9}}
+ * \endcode
+ *
+ * Only "input" and "output" are mandatory. The output format is
+ * deduced from the extension of the output file. When only one of
+ * "width" and "height" is given, the other one is calculated to keep
+ * the aspect ratio. "options" override the corresponding properties of
+ * the default configuration of the export filter.
+ *
+ * For every job the server writes one line back into the same socket:
+ *
+ * \code
+ * {"id": "42", "status": "ok", "error": "",
+ *  "timings": {"queued": 3, "load": 410, "flatten": 57,
+ *              "scale": 120, "export": 230, "total": 820}}
+ * \endcode
+ *
+ * The timings are in milliseconds. The responses come in the order the
+ * jobs finish, not in the order they were sent, so clients should
+ * match them by "id".
+ *
+ * A line {"command": "quit"} makes the server finish all the queued
+ * jobs and quit the application.
+ *
+ * Up to maxParallelJobs documents are processed at the same time, but
+ * only the updates of the projection, the flattening and the scaling
+ * overlap, because they are done by the strokes of the images.
+ *
+ * NOTE: loading and exporting are synchronous and run in the GUI
+ *       thread, because neither KisDocument nor the import/export
+ *       filters may be used from other threads. While one document is
+ *       being loaded or exported, no other job can start loading or
+ *       exporting, and the new requests are not read from the socket.
+ *       So the throughput of jobs dominated by file I/O or encoding
+ *       (e.g. large PNG files) does not grow with maxParallelJobs.
+ *
+ * The resources, the plugins and the color space registry are loaded
+ * only once, when the application starts, and are reused by all the
+ * jobs.
+ */
+class KisBatchRenderServer : public QObject
+{
+    Q_OBJECT
+public:
+    KisBatchRenderServer(int maxParallelJobs, QObject *parent = 0);
+    ~KisBatchRenderServer() override;
+
+    /**
+     * Starts listening on a local socket \p name. A stale socket file
+     * left by a crashed server is removed.
+     */
+    bool listen(const QString &name);
+
+    QString errorString() const;
+
+    /**
+     * Returns the default configuration of the export filter for
+     * \p mimeType with the properties from \p options set on top of it.
+     */
+    static KisPropertiesConfigurationSP createExportConfiguration(const QString &mimeType,
+                                                                  const QVariantMap &options);
+
+private Q_SLOTS:
+    void slotNewConnection();
+    void slotReadyRead();
+    void slotStageFinished(int jobSerial);
+
+private:
+    struct RunningJob;
+
+    void processLine(QLocalSocket *socket, const QByteArray &line);
+    void startPendingJobs();
+    void loadDocument(RunningJob *job);
+    void startStage(RunningJob *job);
+    void exportDocument(RunningJob *job);
+    void finishJob(RunningJob *job);
+    void quitWhenIdle();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBATCHRENDERSERVER_H
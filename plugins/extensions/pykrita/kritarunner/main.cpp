@@ -21,12 +21,14 @@
 #include <QString>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
+#include <QThread>
 
 #include <KisApplication.h>
 #include <resources/KoHashGeneratorProvider.h>
 #include "kis_md5_generator.h"
 #include "PythonPluginManager.h"
 #include <opengl/kis_opengl.h>
+#include "KisBatchRenderServer.h"
 
 extern "C" int main(int argc, char **argv)
 {
@@ -44,7 +46,8 @@ extern "C" int main(int argc, char **argv)
     app.setOrganizationDomain("krita.org");
 
     QCommandLineParser parser;
-    parser.setApplicationDescription("kritarunner executes one python script and then returns.");
+    parser.setApplicationDescription("kritarunner executes one python script and then returns, "
+                                     "or runs as a batch conversion service with --daemon.");
     parser.addVersionOption();
     parser.addHelpOption();
 
@@ -55,10 +58,21 @@ extern "C" int main(int argc, char **argv)
                                       "The function to call (by default __main__ is called).", "function", "__main__");
     parser.addOption(functionOption);
 
+    QCommandLineOption daemonOption(QStringList() << "d" << "daemon",
+                                    "Do not run any script, but wait for conversion jobs on the local socket with the given name. "
+                                    "See KisBatchRenderServer for the format of the jobs.", "socket");
+    parser.addOption(daemonOption);
+
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                                  "The number of documents the daemon processes in parallel. Only the rendering "
+                                  "runs in parallel: the documents are loaded and exported one at a time.", "count",
+                                  QString::number(qMax(1, QThread::idealThreadCount() / 2)));
+    parser.addOption(jobsOption);
+
     parser.addPositionalArgument("[argument(s)]", "The arguments for the script");
     parser.process(app);
 
-    if (!parser.isSet(scriptOption)) {
+    if (!parser.isSet(scriptOption) && !parser.isSet(daemonOption)) {
         qDebug("No script given, aborting.");
         return 1;
     }
@@ -71,6 +85,18 @@ extern "C" int main(int argc, char **argv)
     app.loadResources();
     app.loadPlugins();
 
+    if (parser.isSet(daemonOption)) {
+        KisBatchRenderServer server(parser.value(jobsOption).toInt());
+
+        if (!server.listen(parser.value(daemonOption))) {
+            qWarning() << "Cannot listen on" << parser.value(daemonOption) << server.errorString();
+            return 1;
+        }
+
+        qDebug() << "Waiting for jobs on" << parser.value(daemonOption);
+        return app.exec();
+    }
+
 
     QByteArray pythonPath = qgetenv("PYTHONPATH");
     qDebug() << "\tPython path:" << pythonPath;
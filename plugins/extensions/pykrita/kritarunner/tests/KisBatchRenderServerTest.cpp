@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBatchRenderServerTest.h"
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QTemporaryDir>
+
+#include <kis_properties_configuration.h>
+
+#include "KisBatchRenderServer.h"
+
+#include <sdk/tests/kistest.h>
+
+
+void KisBatchRenderServerTest::testExportConfiguration()
+{
+    QVariantMap options;
+    options["compression"] = 9;
+    options["customOption"] = "value";
+
+    KisPropertiesConfigurationSP config =
+        KisBatchRenderServer::createExportConfiguration("image/png", options);
+
+    QCOMPARE(config->getInt("compression", -1), 9);
+    QCOMPARE(config->getString("customOption"), QString("value"));
+
+    // the defaults of the PNG filter should be kept
+    QCOMPARE(config->getBool("alpha", false), true);
+    QCOMPARE(config->getBool("forceSRGB", false), true);
+    QCOMPARE(config->getBool("interlaced", true), false);
+
+    // a format without an export filter gets the options only
+    config = KisBatchRenderServer::createExportConfiguration("application/x-unknown-format", options);
+    QCOMPARE(config->getInt("compression", -1), 9);
+    QCOMPARE(config->getString("customOption"), QString("value"));
+}
+
+void KisBatchRenderServerTest::testRenderJobs()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QImage source(64, 32, QImage::Format_ARGB32);
+    source.fill(Qt::red);
+    QVERIFY(source.save(dir.filePath("source.png")));
+
+    KisBatchRenderServer server(2);
+
+    const QString socketName =
+        QString("krita-batch-render-test-%1").arg(QCoreApplication::applicationPid());
+    QVERIFY(server.listen(socketName));
+
+    QLocalSocket socket;
+    socket.connectToServer(socketName);
+    QVERIFY(socket.waitForConnected(1000));
+
+    QJsonObject scaledJob;
+    scaledJob["id"] = "scaled";
+    scaledJob["input"] = dir.filePath("source.png");
+    scaledJob["output"] = dir.filePath("scaled.png");
+    scaledJob["width"] = 32;
+
+    QJsonObject options;
+    options["compression"] = 9;
+
+    QJsonObject flattenedJob;
+    flattenedJob["id"] = "flattened";
+    flattenedJob["input"] = dir.filePath("source.png");
+    flattenedJob["output"] = dir.filePath("flattened.png");
+    flattenedJob["flatten"] = true;
+    flattenedJob["options"] = options;
+
+    QJsonObject missingJob;
+    missingJob["id"] = "missing";
+    missingJob["input"] = dir.filePath("missing.png");
+    missingJob["output"] = dir.filePath("missing-result.png");
+
+    Q_FOREACH (const QJsonObject &job, QList<QJsonObject>() << scaledJob << flattenedJob << missingJob) {
+        socket.write(QJsonDocument(job).toJson(QJsonDocument::Compact) + '\n');
+    }
+    socket.flush();
+
+    QHash<QString, QJsonObject> results;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (results.size() < 3 && timer.elapsed() < 30000) {
+        QTest::qWait(50);
+
+        while (socket.canReadLine()) {
+            const QJsonObject result = QJsonDocument::fromJson(socket.readLine()).object();
+            results.insert(result.value("id").toString(), result);
+        }
+    }
+
+    QCOMPARE(results.size(), 3);
+
+    QCOMPARE(results["scaled"].value("status").toString(), QString("ok"));
+    QCOMPARE(results["flattened"].value("status").toString(), QString("ok"));
+    QCOMPARE(results["missing"].value("status").toString(), QString("failed"));
+    QVERIFY(!results["missing"].value("error").toString().isEmpty());
+
+    const QImage scaled(dir.filePath("scaled.png"));
+    QCOMPARE(scaled.size(), QSize(32, 16));
+
+    const QImage flattened(dir.filePath("flattened.png"));
+    QCOMPARE(flattened.size(), QSize(64, 32));
+    QCOMPARE(QColor(flattened.pixel(10, 10)), QColor(Qt::red));
+
+    QVERIFY(!QFile::exists(dir.filePath("missing-result.png")));
+}
+
+KISTEST_MAIN(KisBatchRenderServerTest)
@@ -236,7 +236,7 @@ void KisLevelConfigWidget::slotAutoLevel(void)
 
     int chosen_low_bin = 0, chosen_high_bin = num_bins-1;
     int count_thus_far = m_histogram->getValue(0);
-    const int total_count = m_histogram->producer()->count();
+    const int total_count = m_histogram->count();
     const double threshold = 0.006;
 
     // find the low and hi point/bins based on summing count percentages
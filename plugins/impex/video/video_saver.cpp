@@ -35,6 +35,9 @@
 #include <kis_time_range.h>
 
 #include "kis_config.h"
+#include "kis_image_config.h"
+#include <KisAnimationFrameStream.h>
+#include <dialogs/KisAsyncAnimationFramesStreamDialog.h>
 
 #include <QFileSystemWatcher>
 #include <QProcess>
@@ -42,7 +45,10 @@
 #include <QEventLoop>
 #include <QTemporaryFile>
 #include <QTemporaryDir>
+#include <QThread>
+#include <QApplication>
 #include <QTime>
+#include <QImage>
 
 #include "KisPart.h"
 
@@ -186,6 +192,99 @@ private:
 };
 
 
+/**
+ * Feeds the frames of a KisAnimationFrameStream into the standard input
+ * of an ffmpeg process. The process lives in the writer's own thread and
+ * the writes are blocking, so a slow encoder throttles the stream without
+ * freezing the GUI. If ffmpeg fails, the stream is aborted.
+ */
+class KisFFMpegFrameWriter : public QThread
+{
+public:
+    KisFFMpegFrameWriter(const QString &ffmpegPath,
+                         const QStringList &args,
+                         const QString &logPath,
+                         KisAnimationFrameStream *stream)
+        : m_ffmpegPath(ffmpegPath),
+          m_args(args),
+          m_logPath(logPath),
+          m_stream(stream)
+    {
+    }
+
+    KisImageBuilder_Result result() const {
+        return m_result;
+    }
+
+protected:
+    void run() override {
+        QProcess process;
+        process.setStandardOutputFile(m_logPath);
+        process.setProcessChannelMode(QProcess::MergedChannels);
+
+        qDebug() << "\t" << m_ffmpegPath << m_args.join(" ");
+
+        process.start(m_ffmpegPath, m_args);
+
+        if (!process.waitForStarted(-1)) {
+            m_stream->abort();
+            m_result = KisImageBuilder_RESULT_FAILURE;
+            return;
+        }
+
+        QImage frame;
+        bool writeFailed = false;
+
+        while (m_stream->popFrame(&frame)) {
+            const char *data = reinterpret_cast<const char*>(frame.constBits());
+            const qint64 size = qint64(frame.bytesPerLine()) * frame.height();
+
+            if (!writeFrame(process, data, size)) {
+                writeFailed = true;
+                m_stream->abort();
+                break;
+            }
+        }
+
+        if (m_stream->isAborted()) {
+            process.kill();
+            process.waitForFinished(-1);
+            m_result = writeFailed ? KisImageBuilder_RESULT_FAILURE : KisImageBuilder_RESULT_CANCEL;
+            return;
+        }
+
+        process.closeWriteChannel();
+        process.waitForFinished(-1);
+
+        m_result =
+            process.exitStatus() == QProcess::NormalExit && !process.exitCode() ?
+            KisImageBuilder_RESULT_OK : KisImageBuilder_RESULT_FAILURE;
+    }
+
+private:
+    static bool writeFrame(QProcess &process, const char *data, qint64 size) {
+        if (process.write(data, size) != size) return false;
+
+        /**
+         * Don't let QProcess buffer the frames, the pipe itself
+         * should limit the speed of the rendering
+         */
+        while (process.bytesToWrite() > 0) {
+            if (!process.waitForBytesWritten(-1)) return false;
+        }
+
+        return true;
+    }
+
+private:
+    QString m_ffmpegPath;
+    QStringList m_args;
+    QString m_logPath;
+    KisAnimationFrameStream *m_stream;
+    KisImageBuilder_Result m_result = KisImageBuilder_RESULT_FAILURE;
+};
+
+
 VideoSaver::VideoSaver(KisDocument *doc, const QString &ffmpegPath, bool batchMode)
     : m_image(doc->image())
     , m_doc(doc)
@@ -269,6 +368,36 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
 
     const QStringList additionalOptionsList = configuration->getString("customUserOptions").split(' ', QString::SkipEmptyParts);
 
+    /**
+     * In streaming mode the frames are rendered and passed to ffmpeg as
+     * raw RGBA data through a pipe, without saving them into an image
+     * sequence first. It is used when there is no sequence to encode.
+     *
+     * GIFs are never streamed: the palette can be generated only after
+     * ffmpeg has seen all the frames, so it would have to keep the whole
+     * raw animation in memory. The sequence on disk is read twice instead.
+     */
+    const bool streamFrames = suffix != "gif" &&
+        (configuration->getBool("stream_frames", false) || savedFilesMask.isEmpty());
+
+    const KisTimeRange renderRange =
+        KisTimeRange::fromTime(configuration->getInt("first_frame", fullRange.start()),
+                               configuration->getInt("last_frame", fullRange.end()));
+
+    QStringList inputArgs;
+
+    if (streamFrames) {
+        inputArgs << "-f" << "rawvideo"
+                  << "-pix_fmt" << "rgba"
+                  << "-s" << QString("%1x%2").arg(m_image->width()).arg(m_image->height())
+                  << "-r" << QString::number(frameRate)
+                  << "-i" << "pipe:0";
+    } else {
+        inputArgs << "-r" << QString::number(frameRate)
+                  << "-start_number" << QString::number(clipRange.start())
+                  << "-i" << savedFilesMask;
+    }
+
     if (suffix == "gif") {
         {
             QStringList args;
@@ -317,11 +446,7 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
         }
     } else {
         QStringList args;
-        args << "-r" << QString::number(frameRate)
-             << "-start_number" << QString::number(clipRange.start())
-             << "-i" << savedFilesMask;
-
-
+        args << inputArgs;
 
         QFileInfo audioFileInfo = animation->audioChannelFileName();
         if (includeAudio && audioFileInfo.exists()) {
@@ -350,14 +475,78 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
              << "-y" << resultFile;
 
 
-        result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
-                                     framesDir.filePath("log_encode.log"),
-                                     clipRange.duration());
+        if (streamFrames) {
+            result = encodeStreaming(args, framesDir.filePath("log_encode.log"), renderRange);
+        } else {
+            result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
+                                         framesDir.filePath("log_encode.log"),
+                                         clipRange.duration());
+        }
     }
 
     return result;
 }
 
+KisImageBuilder_Result VideoSaver::encodeStreaming(const QStringList &specialArgs,
+                                                   const QString &logPath,
+                                                   const KisTimeRange &range)
+{
+    KisImageConfig cfg(true);
+
+    /**
+     * Every clone of the image may have one frame in progress and
+     * one frame waiting for the encoder
+     */
+    KisAnimationFrameStream stream(range, 2 * cfg.frameRenderingClones());
+
+    QStringList args;
+    args << "-v" << "debug"
+         << specialArgs;
+
+    /**
+     * The renderer should be connected to the stream before ffmpeg is
+     * started, otherwise an early failure of ffmpeg would abort the stream
+     * unnoticed and the renderer would wait for it forever
+     */
+    KisAsyncAnimationFramesStreamDialog renderer(m_image, range, &stream);
+
+    /**
+     * The exporting filters may be called from a non-GUI thread, where
+     * the progress dialog cannot be shown
+     */
+    renderer.setBatchMode(m_batchMode || QThread::currentThread() != qApp->thread());
+
+    KisFFMpegFrameWriter writer(m_ffmpegPath, args, logPath, &stream);
+    writer.start();
+
+    const KisAsyncAnimationRenderDialogBase::Result renderResult =
+        renderer.regenerateRange(0);
+
+    if (renderResult != KisAsyncAnimationRenderDialogBase::RenderComplete) {
+        stream.abort();
+    }
+
+    // wait until ffmpeg encodes the frames still in the pipe
+    {
+        QEventLoop loop;
+        loop.connect(&writer, SIGNAL(finished()), SLOT(quit()));
+
+        if (!writer.isFinished()) {
+            loop.exec();
+        }
+
+        writer.wait();
+    }
+
+    if (renderResult == KisAsyncAnimationRenderDialogBase::RenderCancelled) {
+        return KisImageBuilder_RESULT_CANCEL;
+    } else if (renderResult == KisAsyncAnimationRenderDialogBase::RenderFailed) {
+        return KisImageBuilder_RESULT_FAILURE;
+    }
+
+    return writer.result();
+}
+
 void VideoSaver::cancel()
 {
     m_runner->cancel();
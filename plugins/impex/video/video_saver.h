@@ -29,6 +29,7 @@
 #include "kritavideoexport_export.h"
 
 class KisFFMpegRunner;
+class KisTimeRange;
 
 /* The KisImageBuilder_Result definitions come from kis_png_converter.h here */
 
@@ -68,6 +69,16 @@ public:
 private Q_SLOTS:
     void cancel();
 
+private:
+    /**
+     * Renders \p range of the image and pipes the frames directly into
+     * ffmpeg's stdin. \p specialArgs should read the input from "pipe:0"
+     * as raw RGBA video.
+     */
+    KisImageBuilder_Result encodeStreaming(const QStringList &specialArgs,
+                                           const QString &logPath,
+                                           const KisTimeRange &range);
+
 private:
     KisImageSP m_image;
     KisDocument* m_doc;
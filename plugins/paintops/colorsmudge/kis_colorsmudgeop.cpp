@@ -21,6 +21,7 @@
 #include <cmath>
 #include <memory>
 #include <QRect>
+#include <QtMath>
 
 #include <KoColorSpaceRegistry.h>
 #include <KoColor.h>
@@ -39,6 +40,46 @@
 #include <kis_lod_transform.h>
 #include <kis_spacing_information.h>
 #include <KoColorModelStandardIds.h>
+#include <kis_texture_option.h>
+#include <kis_image_config.h>
+#include <krita_utils.h>
+
+#include <KisDabRenderingExecutor.h>
+#include <KisDabCacheUtils.h>
+#include <KisRenderedDab.h>
+#include <KisRunnableStrokeJobData.h>
+#include <kis_pointer_utils.h>
+
+#include <QElapsedTimer>
+
+namespace {
+
+/**
+ * Blocks the updates of the image projection while the object exists
+ */
+class ProjectionUpdatesBlocker
+{
+public:
+    ProjectionUpdatesBlocker(KisImageSP image)
+        : m_image(image)
+    {
+        if (m_image) {
+            m_image->blockUpdates();
+        }
+    }
+
+    ~ProjectionUpdatesBlocker() {
+        if (m_image) {
+            m_image->unblockUpdates();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(ProjectionUpdatesBlocker)
+    KisImageSP m_image;
+};
+
+}
 
 KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image)
     : KisBrushBasedPaintOp(settings, painter)
@@ -46,13 +87,14 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     , m_image(image)
     , m_precisePainterWrapper(painter->device())
     , m_tempDev(m_precisePainterWrapper.createPreciseCompositionSourceDevice())
-    , m_backgroundPainter(new KisPainter(m_tempDev))
-    , m_smudgePainter(new KisPainter(m_tempDev))
-    , m_colorRatePainter(new KisPainter(m_tempDev))
     , m_finalPainter(new KisPainter(m_precisePainterWrapper.preciseDevice()))
     , m_smudgeRateOption()
     , m_colorRateOption("ColorRate", KisPaintOpOption::GENERAL, false)
     , m_smudgeRadiusOption()
+    , m_avgUpdateTimePerDab(50)
+    , m_idealNumStripes(KisImageConfig(true).maxNumberOfThreads())
+    , m_minUpdatePeriod(10)
+    , m_maxUpdatePeriod(100)
 {
     Q_UNUSED(node);
 
@@ -81,10 +123,6 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
 
     m_gradient = painter->gradient();
 
-    m_backgroundPainter->setCompositeOp(COMPOSITE_COPY);
-    // Smudge Painter works in default COMPOSITE_OVER mode
-    m_colorRatePainter->setCompositeOp(painter->compositeOp()->id());
-
     m_finalPainter->setCompositeOp(COMPOSITE_COPY);
     m_finalPainter->setSelection(painter->selection());
     m_finalPainter->setChannelFlags(painter->channelFlags());
@@ -92,7 +130,7 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
 
     m_paintColor = painter->paintColor().convertedTo(m_tempDev->colorSpace());
     m_preciseColorRateCompositeOp =
-        m_tempDev->colorSpace()->compositeOp(m_colorRatePainter->compositeOp()->id());
+        m_tempDev->colorSpace()->compositeOp(painter->compositeOp()->id());
 
     m_hsvOptions.append(KisPressureHSVOption::createHueOption());
     m_hsvOptions.append(KisPressureHSVOption::createSaturationOption());
@@ -110,59 +148,33 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     if(m_overlayModeOption.isChecked()){
         m_preciseImageDeviceWrapper.reset(new KisPrecisePaintDeviceWrapper(m_image->projection()));
     }
-}
-
-KisColorSmudgeOp::~KisColorSmudgeOp()
-{
-    qDeleteAll(m_hsvOptions);
-    delete m_hsvTransform;
-}
-
-void KisColorSmudgeOp::updateMask(const KisPaintInformation& info, double scale, double rotation, const QPointF &cursorPoint)
-{
-    static const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
-    static KoColor color(Qt::black, cs);
-
-    m_maskDab = m_dabCache->fetchDab(cs,
-                                     color,
-                                     cursorPoint,
-                                     KisDabShape(scale, 1.0, rotation),
-                                     info,
-                                     1.0,
-                                     &m_dstDabRect);
 
-    // sanity check
-    KIS_ASSERT_RECOVER_NOOP(m_dstDabRect.size() == m_maskDab->bounds().size());
-}
-
-inline void KisColorSmudgeOp::getTopLeftAligned(const QPointF &pos, const QPointF &hotSpot, qint32 *x, qint32 *y)
-{
-    QPointF topLeft = pos - hotSpot;
+    /**
+     * We do our own threading here, so we need to forbid the brushes
+     * to do threading internally
+     */
+    m_brush->setThreadingAllowed(false);
 
-    qreal xFraction, yFraction; // will not be used
-    splitCoordinate(topLeft.x(), x, &xFraction);
-    splitCoordinate(topLeft.y(), y, &yFraction);
-}
+    KisBrushSP baseBrush = m_brush;
+    auto resourcesFactory =
+        [baseBrush, settings, painter] () {
+            KisDabCacheUtils::DabRenderingResources *resources =
+                new KisDabCacheUtils::DabRenderingResources();
+            resources->brush = baseBrush->clone();
 
-KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
-{
-    KisBrushSP brush = m_brush;
-    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
-
-    /* This is a fix for dulling + overlay + paint,
-     * this should allow the image to composite paint addition effects correctly
-     * while also respecting overlay mode. */
-    bool useAlternatePrecisionSource = (m_overlayModeOption.isChecked() &&
-                                        useDullingMode &&
-                                        m_preciseImageDeviceWrapper!= nullptr);
+            resources->textureOption.reset(new KisTextureProperties(painter->device()->defaultBounds()->currentLevelOfDetail()));
+            resources->textureOption->fillProperties(settings);
 
-    KisPrecisePaintDeviceWrapper &activeWrapper = useAlternatePrecisionSource ? *m_preciseImageDeviceWrapper :
-                                                                                 m_precisePainterWrapper;
+            return resources;
+        };
 
-    // Simple error catching
-    if (!painter()->device() || !brush || !brush->canPaintFor(info)) {
-        return KisSpacingInformation(1.0);
-    }
+    m_dabExecutor.reset(
+        new KisDabRenderingExecutor(
+                    KoColorSpaceRegistry::instance()->alpha8(),
+                    resourcesFactory,
+                    painter->runnableStrokeJobsInterface(),
+                    &m_mirrorOption,
+                    &m_precisionOption));
 
     if (m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE) {
         /**
@@ -170,24 +182,29 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
         * should read from the aligned areas of the image, so having
         * additional internal offsets, created by the subpixel precision,
         * will worsen the quality (at least because
-        * QRectF(m_dstDabRect).center() will not point to the real center
+        * QRectF(dstDabRect).center() will not point to the real center
         * of the brush anymore).
         * Of course, this only really matters with smearing_mode (bug:327235),
         * and you only notice the lack of subpixel precision in the dulling methods.
         */
-        m_dabCache->disableSubpixelPrecision();
+        m_dabExecutor->disableSubpixelPrecision();
     }
+}
+
+KisColorSmudgeOp::~KisColorSmudgeOp()
+{
+    qDeleteAll(m_hsvOptions);
+    delete m_hsvTransform;
+}
+
+KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
+{
+    KisBrushSP brush = m_brush;
 
-#if 0
-    //if precision
-    KoColor colorSpaceChanger = painter()->paintColor();
-    const KoColorSpace* preciseColorSpace = colorSpaceChanger.colorSpace();
-    if (colorSpaceChanger.colorSpace()->colorDepthId().id() == "U8") {
-    preciseColorSpace = KoColorSpaceRegistry::instance()->colorSpace(colorSpaceChanger.colorSpace()->colorModelId().id(), "U16", colorSpaceChanger.profile() );
-        colorSpaceChanger.convertTo(preciseColorSpace);
+    // Simple error catching
+    if (!painter()->device() || !brush || !brush->canPaintFor(info)) {
+        return KisSpacingInformation(1.0);
     }
-    painter()->setPaintColor(colorSpaceChanger);
-#endif
 
     // get the scaling factor calculated by the size option
     qreal scale = m_sizeOption.apply(info);
@@ -202,154 +219,439 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
                               brush->maskWidth(shape, 0, 0, info),
                               brush->maskHeight(shape, 0, 0, info));
 
-    QPointF hotSpot = brush->hotSpot(shape, info);
+    DabParameters params;
+    params.info = info;
+    params.hotSpot = brush->hotSpot(shape, info);
+
+    const qreal fpOpacity = (qreal(painter()->opacity()) / 255.0) * m_opacityOption.getOpacityf(info);
+
+    // if the user selected the color smudge option,
+    // we will mix some color into the temporary painting device (m_tempDev)
+    if (m_colorRateOption.isChecked()) {
+        // this will calculate the opacity (selected by the user) of the color
+        // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
+        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
+        params.colorRateOpacity = m_colorRateOption.computeOpacity(info, 0.0, maxColorRate, fpOpacity);
+
+        // the current color (foreground color) or a gradient
+        // color (if enabled)
+        KoColor color = m_paintColor;
+        m_gradientOption.apply(color, m_gradient, info);
+        if (m_hsvTransform) {
+            Q_FOREACH (KisPressureHSVOption * option, m_hsvOptions) {
+                option->apply(m_hsvTransform, info);
+            }
+            m_hsvTransform->transform(color.data(), color.data(), 1);
+        }
+
+        KIS_SAFE_ASSERT_RECOVER(*m_tempDev->colorSpace() == *color.colorSpace()) {
+            color.convertTo(m_tempDev->colorSpace());
+        }
+
+        params.color = color;
+    }
+
+    // opacity calculated by the rate option
+    params.smudgeRateOpacity = m_smudgeRateOption.computeOpacity(info, 0.0, 1.0, fpOpacity);
 
     /**
-     * Update the brush mask.
-     *
-     * Upon leaving the function:
-     *   o m_maskDab stores the new mask
-     *   o m_maskBounds stores the extents of the mask paint device
-     *   o m_dstDabRect stores the destination rect where the mask is going
-     *     to be written to
+     * The parameters should be queued before the dab itself, otherwise
+     * doAsyncronousUpdate() may fetch the dab before its parameters
      */
-    updateMask(info, scale, rotation, scatteredPos);
+    {
+        QMutexLocker l(&m_dabParametersLock);
+        m_dabParameters.append(params);
+    }
+
+    static const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+    static KoColor color(Qt::black, cs);
+
+    KisDabCacheUtils::DabRequestInfo request(color,
+                                             scatteredPos,
+                                             shape,
+                                             info,
+                                             1.0);
+
+    m_dabExecutor->addDab(request, OPACITY_OPAQUE_F, OPACITY_OPAQUE_F);
+
+    return effectiveSpacing(scale, rotation,
+                            m_spacingOption, info);
+}
+
+struct KisColorSmudgeOp::DabState
+{
+    DabParameters params;
+    KisFixedPaintDeviceSP maskDab;
+    QRect dstDabRect;
+    QRect srcDabRect;
+
+    // stored in the color space of the paintColor
+    KoColor dullingFillColor;
 
-    QPointF newCenterPos = QRectF(m_dstDabRect).center();
     /**
-     * Save the center of the current dab to know where to read the
-     * data during the next pass. We do not save scatteredPos here,
-     * because it may differ slightly from the real center of the
-     * brush (due to rounding effects), which will result in a
-     * really weird quality.
+     * A copy of the areas of the image projection the dab reads in
+     * overlay mode. The projection itself may change while the
+     * stripes of the dab are processed.
      */
-    QRect srcDabRect = m_dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
+    KisPaintDeviceSP overlayDevice;
 
-    m_lastPaintPos = newCenterPos;
+    QMutex dirtyRectsLock;
+    QVector<QRect> dirtyRects;
+};
 
-    KisSpacingInformation spacingInfo =
-        effectiveSpacing(scale, rotation,
-                         m_spacingOption, info);
+struct KisColorSmudgeOp::UpdateSharedState
+{
+    ~UpdateSharedState() {
+        qDeleteAll(dabs);
+    }
+
+    QList<DabState*> dabs;
+    QElapsedTimer updateTimer;
+};
+
+std::pair<int, bool> KisColorSmudgeOp::doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    bool someDabsAreStillInQueue = false;
+    const bool hasPreparedDabsAtStart = m_dabExecutor->hasPreparedDabs();
+
+    if (!m_updateSharedState && hasPreparedDabsAtStart) {
+        /**
+         * Every dab reads the area written by the previous one, so the
+         * dabs are blended strictly one after another. We limit their
+         * number to fit the maximum update period and not make visual
+         * hiccups.
+         */
+        const qreal totalRenderingTimePerDab =
+            m_dabExecutor->averageDabRenderingTime() + m_avgUpdateTimePerDab.rollingMeanSafe();
+
+        const int dabsLimit =
+            totalRenderingTimePerDab > 0 ?
+                qMax(1, int(m_maxUpdatePeriod / totalRenderingTimePerDab)) :
+                -1;
+
+        QList<KisRenderedDab> renderedDabs =
+            m_dabExecutor->takeReadyDabs(false, dabsLimit, &someDabsAreStillInQueue);
+
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!renderedDabs.isEmpty(),
+                                             std::make_pair(m_currentUpdatePeriod, false));
+
+        QList<DabParameters> dabParameters;
+
+        {
+            QMutexLocker l(&m_dabParametersLock);
+            KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_dabParameters.size() >= renderedDabs.size(),
+                                                 std::make_pair(m_currentUpdatePeriod, false));
+
+            dabParameters = m_dabParameters.mid(0, renderedDabs.size());
+            m_dabParameters.erase(m_dabParameters.begin(),
+                                  m_dabParameters.begin() + renderedDabs.size());
+        }
 
-    if (m_firstRun) {
-        m_firstRun = false;
-        return spacingInfo;
+        m_updateSharedState = toQShared(new UpdateSharedState());
+        UpdateSharedStateSP state = m_updateSharedState;
+
+        state->updateTimer.start();
+
+        for (int i = 0; i < renderedDabs.size(); i++) {
+            const KisRenderedDab &renderedDab = renderedDabs[i];
+
+            const QRect dstDabRect = renderedDab.realBounds();
+            const QPointF newCenterPos = QRectF(dstDabRect).center();
+
+            /**
+             * Save the center of the current dab to know where to read the
+             * data during the next pass. We do not save scatteredPos here,
+             * because it may differ slightly from the real center of the
+             * brush (due to rounding effects), which will result in a
+             * really weird quality.
+             */
+            const QRect srcDabRect = dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
+            m_lastPaintPos = newCenterPos;
+
+            if (m_firstRun) {
+                m_firstRun = false;
+                continue;
+            }
+
+            DabState *dab = new DabState();
+            dab->params = dabParameters[i];
+            dab->maskDab = renderedDab.device;
+            dab->dstDabRect = dstDabRect;
+            dab->srcDabRect = srcDabRect;
+            dab->dullingFillColor = m_paintColor;
+
+            // sanity check
+            KIS_ASSERT_RECOVER_NOOP(dab->dstDabRect.size() == dab->maskDab->bounds().size());
+
+            state->dabs.append(dab);
+            addDabJobs(dab, state, jobs);
+        }
+
+        const int numDabs = renderedDabs.size();
+
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [state, this, numDabs, someDabsAreStillInQueue] () {
+                    const int updateRenderingTime = state->updateTimer.elapsed();
+                    const qreal currentUpdateTimePerDab = qreal(updateRenderingTime) / numDabs;
+                    m_avgUpdateTimePerDab(currentUpdateTimePerDab);
+
+                    m_currentUpdatePeriod =
+                        someDabsAreStillInQueue ? m_minUpdatePeriod :
+                        qBound(m_minUpdatePeriod, int(1.5 * updateRenderingTime), m_maxUpdatePeriod);
+
+                    m_updateSharedState.clear();
+                },
+                KisStrokeJobData::SEQUENTIAL));
+
+    } else if (m_updateSharedState && hasPreparedDabsAtStart) {
+        someDabsAreStillInQueue = true;
     }
 
-    const qreal fpOpacity = (qreal(painter()->opacity()) / 255.0) * m_opacityOption.getOpacityf(info);
+    return std::make_pair(m_currentUpdatePeriod, someDabsAreStillInQueue);
+}
 
-    if (m_image && m_overlayModeOption.isChecked()) {
-        m_image->blockUpdates();
-        m_backgroundPainter->bitBlt(QPoint(), m_image->projection(), srcDabRect);
-        m_image->unblockUpdates();
+void KisColorSmudgeOp::addDabJobs(DabState *dab,
+                                  UpdateSharedStateSP state,
+                                  QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    /**
+     * The stripes should be big enough to pay for the job, so small
+     * dabs are processed in one go
+     */
+    const int minStripeHeight = 32;
+    const int minStripedArea = 128 * 128;
+
+    const QRect dabRect(QPoint(), dab->dstDabRect.size());
+
+    const int numStripes =
+        dabRect.width() * dabRect.height() < minStripedArea ? 1 :
+        qBound(1, dabRect.height() / minStripeHeight, m_idealNumStripes);
+
+    if (numStripes <= 1) {
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [this, dab, dabRect, state] () {
+                    prepareDab(dab);
+                    sampleDab(dab, dabRect);
+                    blendDab(dab, dabRect);
+                    finishDab(dab);
+                },
+                KisStrokeJobData::SEQUENTIAL));
+        return;
     }
-    else {
-        // IMPORTANT: Clear the temporary painting device to transparent black.
-        //            It will only clear the extents of the brush.
-        m_tempDev->clear(QRect(QPoint(), m_dstDabRect.size()));
+
+    const int stripeHeight = qCeil(qreal(dabRect.height()) / numStripes);
+    const QVector<QRect> stripes =
+        KritaUtils::splitRectIntoPatches(dabRect, QSize(dabRect.width(), stripeHeight));
+
+    /**
+     * The source area of the dab overlaps the destination area of the
+     * previous one, so sampling of the stripes can start only after
+     * the previous dab has been written, and blending only after the
+     * whole source area has been sampled.
+     */
+    jobs.append(
+        new KisRunnableStrokeJobData(
+            [this, dab, state] () {
+                prepareDab(dab);
+            },
+            KisStrokeJobData::SEQUENTIAL));
+
+    Q_FOREACH (const QRect &rc, stripes) {
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [this, dab, rc, state] () {
+                    sampleDab(dab, rc);
+                },
+                KisStrokeJobData::CONCURRENT));
     }
 
-    // stored in the color space of the paintColor
-    KoColor dullingFillColor = m_paintColor;
+    jobs.append(new KisRunnableStrokeJobData(0, KisStrokeJobData::SEQUENTIAL));
+
+    Q_FOREACH (const QRect &rc, stripes) {
+        jobs.append(
+            new KisRunnableStrokeJobData(
+                [this, dab, rc, state] () {
+                    blendDab(dab, rc);
+                },
+                KisStrokeJobData::CONCURRENT));
+    }
+
+    jobs.append(
+        new KisRunnableStrokeJobData(
+            [this, dab, state] () {
+                finishDab(dab);
+            },
+            KisStrokeJobData::SEQUENTIAL));
+}
+
+void KisColorSmudgeOp::prepareDab(DabState *dab)
+{
+    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
+
+    /* This is a fix for dulling + overlay + paint,
+     * this should allow the image to composite paint addition effects correctly
+     * while also respecting overlay mode. */
+    bool useAlternatePrecisionSource = (m_overlayModeOption.isChecked() &&
+                                        useDullingMode &&
+                                        m_preciseImageDeviceWrapper!= nullptr);
 
-    QPoint canvasLocalSamplePoint = (srcDabRect.topLeft() + hotSpot).toPoint();
+    KisPrecisePaintDeviceWrapper &activeWrapper = useAlternatePrecisionSource ? *m_preciseImageDeviceWrapper :
+                                                                                 m_precisePainterWrapper;
+
+    KisImageSP image = m_image.toStrongRef();
+    const bool useOverlayMode = image && m_overlayModeOption.isChecked();
+
+    /**
+     * The projection can be read only while its updates are blocked. The
+     * other jobs of the dab may be cancelled, so the updates are blocked
+     * in this job only, and the overlay areas are copied for the rest of
+     * the dab.
+     */
+    ProjectionUpdatesBlocker blocker(useOverlayMode ? image : KisImageSP());
+
+    if (useOverlayMode) {
+        QRect overlayRect;
+
+        if (!useDullingMode) {
+            overlayRect |= dab->srcDabRect;
+        }
+
+        if (!m_colorRateOption.isChecked()) {
+            overlayRect |= dab->dstDabRect;
+        }
+
+        if (!overlayRect.isEmpty()) {
+            dab->overlayDevice = new KisPaintDevice(image->projection()->colorSpace());
+            KisPainter::copyAreaOptimized(overlayRect.topLeft(), image->projection(),
+                                          dab->overlayDevice, overlayRect);
+        }
+    }
+
+    QPoint canvasLocalSamplePoint = (dab->srcDabRect.topLeft() + dab->params.hotSpot).toPoint();
 
     if (!useDullingMode) {
-        activeWrapper.readRect(srcDabRect);
-        m_smudgePainter->bitBlt(QPoint(), activeWrapper.preciseDevice(), srcDabRect);
+        activeWrapper.readRect(dab->srcDabRect);
     } else {
         if (m_smudgeRadiusOption.isChecked()) {
-            const qreal effectiveSize = 0.5 * (m_dstDabRect.width() + m_dstDabRect.height());
+            const qreal effectiveSize = 0.5 * (dab->dstDabRect.width() + dab->dstDabRect.height());
 
-            const QRect sampleRect = m_smudgeRadiusOption.sampleRect(info, effectiveSize, canvasLocalSamplePoint);
+            const QRect sampleRect = m_smudgeRadiusOption.sampleRect(dab->params.info, effectiveSize, canvasLocalSamplePoint);
             activeWrapper.readRect(sampleRect);
 
-            m_smudgeRadiusOption.apply(&dullingFillColor, info, effectiveSize, canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), activeWrapper.preciseDevice());
-            KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
+            m_smudgeRadiusOption.apply(&dab->dullingFillColor, dab->params.info, effectiveSize, canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), activeWrapper.preciseDevice());
+            KIS_SAFE_ASSERT_RECOVER_NOOP(*dab->dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
         } else {
             // get the pixel on the canvas that lies beneath the hot spot
             // of the dab and fill  the temporary paint device with that color
             activeWrapper.readRect(QRect(canvasLocalSamplePoint, QSize(1,1)));
-            KisCrossDeviceColorPickerInt colorPicker(activeWrapper.preciseDevice(), dullingFillColor);
-            colorPicker.pickColor(canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), dullingFillColor.data());
-            KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
-        }
-    }
-
-    // if the user selected the color smudge option,
-    // we will mix some color into the temporary painting device (m_tempDev)
-    if (m_colorRateOption.isChecked()) {
-        // this will apply the opacity (selected by the user) to copyPainter
-        // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
-        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
-        m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
-
-        // paint a rectangle with the current color (foreground color)
-        // or a gradient color (if enabled)
-        // into the temporary painting device and use the user selected
-        // composite mode
-        KoColor color = m_paintColor;
-        m_gradientOption.apply(color, m_gradient, info);
-        if (m_hsvTransform) {
-            Q_FOREACH (KisPressureHSVOption * option, m_hsvOptions) {
-                option->apply(m_hsvTransform, info);
-            }
-            m_hsvTransform->transform(color.data(), color.data(), 1);
+            KisCrossDeviceColorPickerInt colorPicker(activeWrapper.preciseDevice(), dab->dullingFillColor);
+            colorPicker.pickColor(canvasLocalSamplePoint.x(), canvasLocalSamplePoint.y(), dab->dullingFillColor.data());
+            KIS_SAFE_ASSERT_RECOVER_NOOP(*dab->dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
         }
 
-        if (!useDullingMode) {
-            KIS_SAFE_ASSERT_RECOVER(*m_colorRatePainter->device()->colorSpace() == *color.colorSpace()) {
-                color.convertTo(m_colorRatePainter->device()->colorSpace());
-            }
-
-            m_colorRatePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
-        } else {
-            KIS_SAFE_ASSERT_RECOVER(*dullingFillColor.colorSpace() == *color.colorSpace()) {
-                color.convertTo(dullingFillColor.colorSpace());
-            }
-            KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
-            m_preciseColorRateCompositeOp->composite(dullingFillColor.data(), 0,
-                                                     color.data(), 0,
+        if (m_colorRateOption.isChecked()) {
+            KIS_SAFE_ASSERT_RECOVER_NOOP(*dab->dullingFillColor.colorSpace() == *dab->params.color.colorSpace());
+            m_preciseColorRateCompositeOp->composite(dab->dullingFillColor.data(), 0,
+                                                     dab->params.color.data(), 0,
                                                      0, 0,
                                                      1, 1,
-                                                     m_colorRatePainter->opacity());
+                                                     dab->params.colorRateOpacity);
         }
     }
 
+    m_precisePainterWrapper.readRects(m_finalPainter->calculateAllMirroredRects(dab->dstDabRect));
+}
+
+void KisColorSmudgeOp::sampleDab(DabState *dab, const QRect &rc)
+{
+    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
+
     if (useDullingMode) {
-        KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
-        m_tempDev->fill(QRect(0, 0, m_dstDabRect.width(), m_dstDabRect.height()), dullingFillColor);
+        // the fill color overwrites all the pixels of the dab
+        m_tempDev->fill(rc, dab->dullingFillColor);
+        return;
+    }
+
+    KisPainter gc(m_tempDev);
+    const QRect srcRect = rc.translated(dab->srcDabRect.topLeft());
+
+    if (dab->overlayDevice) {
+        gc.setCompositeOp(COMPOSITE_COPY);
+        gc.bitBlt(rc.topLeft(), dab->overlayDevice, srcRect);
+        gc.setCompositeOp(COMPOSITE_OVER);
+    }
+    else {
+        // IMPORTANT: Clear the temporary painting device to transparent black.
+        //            It will only clear the extents of the brush.
+        m_tempDev->clear(rc);
+    }
+
+    gc.bitBlt(rc.topLeft(), m_precisePainterWrapper.preciseDevice(), srcRect);
+
+    if (m_colorRateOption.isChecked()) {
+        // paint a rectangle with the color into the temporary painting
+        // device and use the user selected composite mode
+        gc.setCompositeOp(m_preciseColorRateCompositeOp);
+        gc.setOpacity(dab->params.colorRateOpacity);
+        gc.fill(rc.x(), rc.y(), rc.width(), rc.height(), dab->params.color);
     }
+}
 
-    m_precisePainterWrapper.readRects(m_finalPainter->calculateAllMirroredRects(m_dstDabRect));
+void KisColorSmudgeOp::blendDab(DabState *dab, const QRect &rc)
+{
+    KisPainter gc(m_precisePainterWrapper.preciseDevice());
+    gc.setCompositeOp(COMPOSITE_COPY);
+    gc.setSelection(m_finalPainter->selection());
+    gc.setChannelFlags(m_finalPainter->channelFlags());
+
+    const QRect dstRect = rc.translated(dab->dstDabRect.topLeft());
 
     // if color is disabled (only smudge) and "overlay mode" is enabled
     // then first blit the region under the brush from the image projection
     // to the painting device to prevent a rapid build up of alpha value
     // if the color to be smudged is semi transparent.
-    if (m_image && m_overlayModeOption.isChecked() && !m_colorRateOption.isChecked()) {
-        m_finalPainter->setOpacity(OPACITY_OPAQUE_U8);
-        m_image->blockUpdates();
+    if (dab->overlayDevice && !m_colorRateOption.isChecked()) {
         // TODO: check if this code is correct in mirrored mode! Technically, the
         //       painter renders the mirrored dab only, so we should also prepare
         //       the overlay for it in all the places.
-        m_finalPainter->bitBlt(m_dstDabRect.topLeft(), m_image->projection(), m_dstDabRect);
-        m_image->unblockUpdates();
+        gc.bitBlt(dstRect.topLeft(), dab->overlayDevice, dstRect);
     }
 
-    // set opacity calculated by the rate option
-    m_smudgeRateOption.apply(*m_finalPainter, info, 0.0, 1.0, fpOpacity);
+    gc.setOpacity(dab->params.smudgeRateOpacity);
 
     // then blit the temporary painting device on the canvas at the current brush position
     // the alpha mask (maskDab) will be used here to only blit the pixels that are in the area (shape) of the brush
-    m_finalPainter->bitBltWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_tempDev, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
-    m_finalPainter->renderMirrorMaskSafe(m_dstDabRect, m_tempDev, 0, 0, m_maskDab, !m_dabCache->needSeparateOriginal());
+    const QRect maskBounds = dab->maskDab->bounds();
+    gc.bitBltWithFixedSelection(dstRect.x(), dstRect.y(),
+                                m_tempDev, dab->maskDab,
+                                maskBounds.x() + rc.x(), maskBounds.y() + rc.y(),
+                                rc.x(), rc.y(),
+                                rc.width(), rc.height());
+
+    const QVector<QRect> dirtyRects = gc.takeDirtyRegion();
+
+    QMutexLocker l(&dab->dirtyRectsLock);
+    dab->dirtyRects.append(dirtyRects);
+}
+
+void KisColorSmudgeOp::finishDab(DabState *dab)
+{
+    m_finalPainter->setOpacity(dab->params.smudgeRateOpacity);
+
+    // the mask may be shared with the dabs cache, so it is never mirrored in-place
+    m_finalPainter->renderMirrorMaskSafe(dab->dstDabRect, m_tempDev, 0, 0, dab->maskDab, true);
+
+    QVector<QRect> dirtyRects = dab->dirtyRects;
+    dirtyRects.append(m_finalPainter->takeDirtyRegion());
 
-    const QVector<QRect> dirtyRects = m_finalPainter->takeDirtyRegion();
     m_precisePainterWrapper.writeRects(dirtyRects);
     painter()->addDirtyRects(dirtyRects);
 
-    return spacingInfo;
+    // release the mask and the overlay
+    dab->maskDab = 0;
+    dab->overlayDevice = 0;
 }
 
 KisSpacingInformation KisColorSmudgeOp::updateSpacingImpl(const KisPaintInformation &info) const
@@ -20,6 +20,8 @@
 #define _KIS_COLORSMUDGEOP_H_
 
 #include <QRect>
+#include <QMutex>
+#include <QSharedPointer>
 
 #include <kis_brush_based_paintop.h>
 #include <kis_types.h>
@@ -37,12 +39,15 @@
 #include "kis_smudge_option.h"
 #include "kis_smudge_radius_option.h"
 #include "KisPrecisePaintDeviceWrapper.h"
+#include <KisRollingMeanAccumulatorWrapper.h>
 
 class QPointF;
 class KoAbstractGradient;
 class KisBrushBasedPaintOpSettings;
 class KisPainter;
 class KoColorSpace;
+class KisDabRenderingExecutor;
+class KisRunnableStrokeJobData;
 
 class KisColorSmudgeOp: public KisBrushBasedPaintOp
 {
@@ -50,16 +55,39 @@ public:
     KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image);
     ~KisColorSmudgeOp() override;
 
+    std::pair<int, bool> doAsyncronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
     KisSpacingInformation updateSpacingImpl(const KisPaintInformation &info) const override;
 
 private:
-    // Sets the m_maskDab _and m_maskDabRect
-    void updateMask(const KisPaintInformation& info, double scale, double rotation, const QPointF &cursorPoint);
+    /**
+     * The values paintAt() calculates for a dab. They are used
+     * when the dab is blended into the device
+     */
+    struct DabParameters
+    {
+        KisPaintInformation info;
+        QPointF hotSpot;
+        KoColor color;
+        quint8 colorRateOpacity = OPACITY_TRANSPARENT_U8;
+        quint8 smudgeRateOpacity = OPACITY_OPAQUE_U8;
+    };
+
+    struct DabState;
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
 
-    inline void getTopLeftAligned(const QPointF &pos, const QPointF &hotSpot, qint32 *x, qint32 *y);
+    void addDabJobs(DabState *dab,
+                    UpdateSharedStateSP state,
+                    QVector<KisRunnableStrokeJobData*> &jobs);
+
+    void prepareDab(DabState *dab);
+    void sampleDab(DabState *dab, const QRect &rc);
+    void blendDab(DabState *dab, const QRect &rc);
+    void finishDab(DabState *dab);
 
 private:
     bool                      m_firstRun;
@@ -68,9 +96,6 @@ private:
     KoColor                   m_paintColor;
     KisPaintDeviceSP          m_tempDev;
     QScopedPointer<KisPrecisePaintDeviceWrapper> m_preciseImageDeviceWrapper;
-    QScopedPointer<KisPainter> m_backgroundPainter;
-    QScopedPointer<KisPainter> m_smudgePainter;
-    QScopedPointer<KisPainter> m_colorRatePainter;
     QScopedPointer<KisPainter> m_finalPainter;
     const KoAbstractGradient* m_gradient {0};
     KisPressureSizeOption     m_sizeOption;
@@ -84,12 +109,29 @@ private:
     KisPressureScatterOption  m_scatterOption;
     KisPressureGradientOption m_gradientOption;
     QList<KisPressureHSVOption*> m_hsvOptions;
-    QRect                     m_dstDabRect;
-    KisFixedPaintDeviceSP     m_maskDab;
     QPointF                   m_lastPaintPos;
 
     KoColorTransformation *m_hsvTransform {0};
     const KoCompositeOp *m_preciseColorRateCompositeOp {0};
+
+    QScopedPointer<KisDabRenderingExecutor> m_dabExecutor;
+
+    /**
+     * The parameters of the dabs passed to m_dabExecutor, in the same
+     * order. paintAt() and doAsyncronousUpdate() may run in different
+     * threads, so the list is guarded by m_dabParametersLock.
+     */
+    QList<DabParameters> m_dabParameters;
+    QMutex m_dabParametersLock;
+
+    UpdateSharedStateSP m_updateSharedState;
+    int m_currentUpdatePeriod = 20;
+    KisRollingMeanAccumulatorWrapper m_avgUpdateTimePerDab;
+
+    const int m_idealNumStripes;
+
+    const int m_minUpdatePeriod;
+    const int m_maxUpdatePeriod;
 };
 
 #endif // _KIS_COLORSMUDGEOP_H_
@@ -38,6 +38,13 @@ public:
      */
     void apply(KisPainter& painter, const KisPaintInformation& info, qreal scaleMin = 0.0, qreal scaleMax = 1.0, qreal multiplicator = 1.0) const;
 
+    /**
+     * \return the opacity apply() would set to the painter. It lets
+     * the paintop calculate the opacity in advance and use it later
+     * in a different thread
+     */
+    quint8 computeOpacity(const KisPaintInformation& info, qreal scaleMin = 0.0, qreal scaleMax = 1.0, qreal multiplicator = 1.0) const;
+
     void setRate(qreal rate) {
         KisCurveOption::setValue(rate);
     }
@@ -36,17 +36,7 @@ KisSmudgeOption::KisSmudgeOption():
 
 void KisSmudgeOption::apply(KisPainter& painter, const KisPaintInformation& info, qreal scaleMin, qreal scaleMax, qreal multiplicator) const
 {
-    if (!isChecked()) {
-        painter.setOpacity((quint8)(scaleMax * 255.0));
-        return;
-    }
-
-    qreal value = computeSizeLikeValue(info);
-
-    qreal  rate    = scaleMin + (scaleMax - scaleMin) * multiplicator * value; // scale m_rate into the range scaleMin - scaleMax
-    quint8 opacity = qBound(OPACITY_TRANSPARENT_U8, (quint8)(rate * 255.0), OPACITY_OPAQUE_U8);
-
-    painter.setOpacity(opacity);
+    painter.setOpacity(computeOpacity(info, scaleMin, scaleMax, multiplicator));
 }
 
 void KisSmudgeOption::writeOptionSetting(KisPropertiesConfigurationSP setting) const
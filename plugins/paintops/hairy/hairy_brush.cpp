@@ -31,6 +31,7 @@
 #include <kis_random_accessor_ng.h>
 #include <kis_cross_device_color_picker.h>
 #include <kis_fixed_paint_device.h>
+#include <KisParticleSplatter.h>
 
 
 #include <cmath>
@@ -60,6 +61,13 @@ void HairyBrush::initAndCache()
     m_compositeOp = m_dab->colorSpace()->compositeOp(COMPOSITE_OVER);
     m_pixelSize = m_dab->colorSpace()->pixelSize();
 
+    if (m_properties->antialias) {
+        m_particleSplatter.reset(
+            new KisParticleSplatter(m_properties->useCompositing ?
+                                    KisParticleSplatter::CompositeMode :
+                                    KisParticleSplatter::AddOpacityMode));
+    }
+
     if (m_properties->useSaturation) {
         m_transfo = m_dab->colorSpace()->createColorTransformation("hsv_adjustment", m_params);
         if (m_transfo) {
@@ -145,6 +153,10 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         initAndCache();
     }
 
+    if (m_particleSplatter) {
+        m_particleSplatter->setDevice(dab);
+    }
+
     /*If this is first time the brush touches the canvas and
     we are using soak ink while ink depletion is enabled...*/
     if (m_properties->inkDepletionEnabled &&
@@ -239,6 +251,11 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         }
 
     }
+
+    if (m_particleSplatter) {
+        m_particleSplatter->flush();
+    }
+
     m_dab = 0;
     m_dabAccessor = 0;
 }
@@ -339,33 +356,17 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
     quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
-    const KoColorSpace * cs = m_dab->colorSpace();
-
-    m_dabAccessor->moveTo(ipx  , ipy);
-    btl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy);
-    btr =  quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btr, 1);
-
-    m_dabAccessor->moveTo(ipx, ipy + 1);
-    bbl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy + 1);
-    bbr = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbr, 1);
+    // the splatter adds the opacities to the ones of the dab pixels
+    m_particleSplatter->setColor(color);
+    m_particleSplatter->addPixel(ipx    , ipy, btl);
+    m_particleSplatter->addPixel(ipx + 1, ipy, btr);
+    m_particleSplatter->addPixel(ipx    , ipy + 1, bbl);
+    m_particleSplatter->addPixel(ipx + 1, ipy + 1, bbr);
 }
 
 void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
 {
     // opacity top left, right, bottom left, right
-    memcpy(m_color.data(), color.data(), m_pixelSize);
     quint8 opacity = color.opacityU8();
 
     int ipx = int (pos.x());
@@ -378,17 +379,12 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
     quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
-    m_color.setOpacity(btl);
-    plotPixel(ipx  , ipy, m_color);
-
-    m_color.setOpacity(btr);
-    plotPixel(ipx + 1  , ipy, m_color);
-
-    m_color.setOpacity(bbl);
-    plotPixel(ipx  , ipy + 1, m_color);
-
-    m_color.setOpacity(bbr);
-    plotPixel(ipx + 1 , ipy + 1, m_color);
+    // the splatter composites the pixels over the dab
+    m_particleSplatter->setColor(color);
+    m_particleSplatter->addPixel(ipx    , ipy, btl);
+    m_particleSplatter->addPixel(ipx + 1, ipy, btr);
+    m_particleSplatter->addPixel(ipx    , ipy + 1, bbl);
+    m_particleSplatter->addPixel(ipx + 1, ipy + 1, bbr);
 }
 
 
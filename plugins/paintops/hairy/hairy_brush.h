@@ -22,6 +22,7 @@
 #include <QVector>
 #include <QList>
 #include <QTransform>
+#include <QScopedPointer>
 
 #include <KoColor.h>
 
@@ -33,6 +34,7 @@
 #include <kis_random_accessor_ng.h>
 
 class KoCompositeOp;
+class KisParticleSplatter;
 
 
 class KisHairyProperties
@@ -126,6 +128,8 @@ private:
     KisRandomAccessorSP m_dabAccessor;
     const KoCompositeOp * m_compositeOp;
     quint32 m_pixelSize;
+    // collects the wu particles and writes them into the dab at once
+    QScopedPointer<KisParticleSplatter> m_particleSplatter;
 
     int m_counter;
 
@@ -0,0 +1,342 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisParticleSplatter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QVector>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_algebra_2d.h>
+#include <kis_assert.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+namespace {
+
+/**
+ * The size of the cells the particles are grouped by. It is equal to the
+ * size of the tiles, so every cell is accessed via a single moveTo().
+ */
+const int cellSize = 64;
+
+struct Particle
+{
+    quint64 cellKey;
+    qint32 x;
+    qint32 y;
+    qint32 colorIndex;
+    quint8 opacity;
+};
+
+/**
+ * Gives access to the pixels of the device via a pointer into the tile
+ * the accessor was last moved to. The accessor is moved only when the
+ * requested pixel is outside of this tile.
+ */
+class TilePixelAccessor
+{
+public:
+    TilePixelAccessor(KisRandomAccessorSP accessor, int pixelSize)
+        : m_accessor(accessor),
+          m_pixelSize(pixelSize)
+    {
+    }
+
+    inline quint8* pixel(int x, int y) {
+        if (x < m_tileX || y < m_tileY ||
+            x >= m_tileX + m_tileSize || y >= m_tileY + m_tileSize) {
+
+            moveTo(x, y);
+        }
+
+        return m_tileData + (y - m_tileY) * m_rowStride + (x - m_tileX) * m_pixelSize;
+    }
+
+private:
+    void moveTo(int x, int y) {
+        m_accessor->moveTo(x, y);
+
+        m_rowStride = m_accessor->rowStride(x, y);
+        m_tileSize = m_rowStride / m_pixelSize;
+
+        const int xInTile = m_tileSize - m_accessor->numContiguousColumns(x);
+        const int yInTile = m_tileSize - m_accessor->numContiguousRows(y);
+
+        m_tileX = x - xInTile;
+        m_tileY = y - yInTile;
+        m_tileData = m_accessor->rawData() - yInTile * m_rowStride - xInTile * m_pixelSize;
+    }
+
+private:
+    KisRandomAccessorSP m_accessor;
+    const int m_pixelSize;
+
+    quint8 *m_tileData = 0;
+    int m_tileX = 0;
+    int m_tileY = 0;
+    int m_tileSize = 0;
+    int m_rowStride = 0;
+};
+
+}
+
+struct KisParticleSplatter::Private
+{
+    Private(Mode _mode) : mode(_mode) {}
+
+    const Mode mode;
+
+    KisPaintDeviceSP device;
+    const KoColorSpace *colorSpace = 0;
+    const KoCompositeOp *compositeOp = 0;
+    int pixelSize = 0;
+
+    /**
+     * The offset of the tiles of the device
+     */
+    int offsetX = 0;
+    int offsetY = 0;
+
+    QVector<Particle> particles;
+
+    /**
+     * The colors of the particles, the opacity is set to opaque, so
+     * that applyAlphaU8Mask() would just set the opacity of the particle
+     */
+    QVector<quint8> colors;
+    QVector<quint8> currentColor;
+    int currentColorIndex = -1;
+
+    /**
+     * The buffers used for processing a single cell
+     */
+    QVector<int> lastParticle;
+    QVector<quint16> coverage;
+    QVector<int> touchedPixels;
+    QVector<quint8> scratchPixels;
+    QVector<quint8> scratchAlpha;
+
+    quint64 cellKey(int x, int y) const {
+        const int cellX = KisAlgebra2D::divideFloor(x - offsetX, cellSize);
+        const int cellY = KisAlgebra2D::divideFloor(y - offsetY, cellSize);
+        return (quint64(quint32(cellY)) << 32) | quint32(cellX);
+    }
+
+    void processCell(TilePixelAccessor &accessor, const Particle *begin, const Particle *end);
+    void processCellComposite(TilePixelAccessor &accessor, const Particle *begin, const Particle *end);
+};
+
+KisParticleSplatter::KisParticleSplatter(Mode mode)
+    : m_d(new Private(mode))
+{
+    m_d->lastParticle.fill(-1, cellSize * cellSize);
+
+    if (mode == AddOpacityMode) {
+        m_d->coverage.resize(cellSize * cellSize);
+    }
+}
+
+KisParticleSplatter::~KisParticleSplatter()
+{
+}
+
+void KisParticleSplatter::setDevice(KisPaintDeviceSP device)
+{
+    m_d->particles.resize(0);
+    m_d->colors.resize(0);
+    m_d->currentColorIndex = -1;
+
+    m_d->device = device;
+    m_d->colorSpace = device->colorSpace();
+    m_d->compositeOp = m_d->colorSpace->compositeOp(COMPOSITE_OVER);
+    m_d->pixelSize = m_d->colorSpace->pixelSize();
+    m_d->offsetX = device->x();
+    m_d->offsetY = device->y();
+    m_d->currentColor.fill(0, m_d->pixelSize);
+}
+
+void KisParticleSplatter::setColor(const KoColor &color)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(color.colorSpace()->pixelSize() == quint32(m_d->pixelSize));
+
+    if (m_d->currentColorIndex >= 0 &&
+        !memcmp(m_d->currentColor.constData(), color.data(), m_d->pixelSize)) {
+
+        return;
+    }
+
+    memcpy(m_d->currentColor.data(), color.data(), m_d->pixelSize);
+    m_d->currentColorIndex = -1;
+}
+
+void KisParticleSplatter::addPixel(int x, int y, quint8 opacity)
+{
+    if (m_d->currentColorIndex < 0) {
+        m_d->currentColorIndex = m_d->colors.size() / m_d->pixelSize;
+        m_d->colors.resize(m_d->colors.size() + m_d->pixelSize);
+
+        quint8 *color = m_d->colors.data() + m_d->currentColorIndex * m_d->pixelSize;
+        memcpy(color, m_d->currentColor.constData(), m_d->pixelSize);
+        m_d->colorSpace->setOpacity(color, OPACITY_OPAQUE_U8, 1);
+    }
+
+    Particle particle = {m_d->cellKey(x, y), x, y, m_d->currentColorIndex, opacity};
+    m_d->particles.append(particle);
+}
+
+bool KisParticleSplatter::isEmpty() const
+{
+    return m_d->particles.isEmpty();
+}
+
+void KisParticleSplatter::flush()
+{
+    if (m_d->particles.isEmpty()) return;
+
+    /**
+     * The sort must be stable: the particles hitting the same pixel must
+     * be written in the order they were added
+     */
+    std::stable_sort(m_d->particles.begin(), m_d->particles.end(),
+                     [] (const Particle &lhs, const Particle &rhs) {
+                         return lhs.cellKey < rhs.cellKey;
+                     });
+
+    const Particle *begin = m_d->particles.constData();
+    const Particle *end = begin + m_d->particles.size();
+
+    KisRandomAccessorSP it = m_d->device->createRandomAccessorNG(begin->x, begin->y);
+    TilePixelAccessor accessor(it, m_d->pixelSize);
+
+    while (begin != end) {
+        const Particle *cellEnd = begin;
+        while (cellEnd != end && cellEnd->cellKey == begin->cellKey) {
+            ++cellEnd;
+        }
+
+        if (m_d->mode == CompositeMode) {
+            m_d->processCellComposite(accessor, begin, cellEnd);
+        } else {
+            m_d->processCell(accessor, begin, cellEnd);
+        }
+
+        begin = cellEnd;
+    }
+
+    m_d->particles.resize(0);
+    m_d->colors.resize(0);
+    m_d->currentColorIndex = -1;
+}
+
+void KisParticleSplatter::Private::processCell(TilePixelAccessor &accessor, const Particle *begin, const Particle *end)
+{
+    const int cellX = offsetX + KisAlgebra2D::divideFloor(begin->x - offsetX, cellSize) * cellSize;
+    const int cellY = offsetY + KisAlgebra2D::divideFloor(begin->y - offsetY, cellSize) * cellSize;
+
+    /**
+     * Only the last particle written into a pixel defines its color, so
+     * collapse the particles into one write per pixel. In AddOpacityMode
+     * the opacities are accumulated, the result is capped at opaque the
+     * same way as the sum of capped values is.
+     */
+    touchedPixels.resize(0);
+
+    for (const Particle *p = begin; p != end; ++p) {
+        const int idx = (p->y - cellY) * cellSize + (p->x - cellX);
+
+        if (lastParticle[idx] < 0) {
+            touchedPixels.append(idx);
+
+            if (mode == AddOpacityMode) {
+                coverage[idx] = p->opacity;
+            }
+        } else if (mode == AddOpacityMode) {
+            coverage[idx] = qMin<quint16>(OPACITY_OPAQUE_U8, coverage[idx] + p->opacity);
+        }
+
+        lastParticle[idx] = int(p - begin);
+    }
+
+    const int numPixels = touchedPixels.size();
+    scratchPixels.resize(numPixels * pixelSize);
+    scratchAlpha.resize(numPixels);
+
+    quint8 *dstColor = scratchPixels.data();
+
+    for (int i = 0; i < numPixels; i++) {
+        const int idx = touchedPixels[i];
+        const Particle &p = begin[lastParticle[idx]];
+
+        memcpy(dstColor, colors.constData() + p.colorIndex * pixelSize, pixelSize);
+        dstColor += pixelSize;
+
+        if (mode == AddOpacityMode) {
+            const quint8 *pixel = accessor.pixel(cellX + idx % cellSize, cellY + idx / cellSize);
+            scratchAlpha[i] = qMin<quint16>(OPACITY_OPAQUE_U8, coverage[idx] + colorSpace->opacityU8(pixel));
+        } else {
+            scratchAlpha[i] = p.opacity;
+        }
+    }
+
+    colorSpace->applyAlphaU8Mask(scratchPixels.data(), scratchAlpha.constData(), numPixels);
+
+    const quint8 *srcColor = scratchPixels.constData();
+
+    for (int i = 0; i < numPixels; i++) {
+        const int idx = touchedPixels[i];
+
+        memcpy(accessor.pixel(cellX + idx % cellSize, cellY + idx / cellSize), srcColor, pixelSize);
+        srcColor += pixelSize;
+
+        lastParticle[idx] = -1;
+    }
+}
+
+void KisParticleSplatter::Private::processCellComposite(TilePixelAccessor &accessor, const Particle *begin, const Particle *end)
+{
+    const int numParticles = end - begin;
+    scratchPixels.resize(numParticles * pixelSize);
+    scratchAlpha.resize(numParticles);
+
+    quint8 *dstColor = scratchPixels.data();
+
+    for (int i = 0; i < numParticles; i++) {
+        memcpy(dstColor, colors.constData() + begin[i].colorIndex * pixelSize, pixelSize);
+        dstColor += pixelSize;
+
+        scratchAlpha[i] = begin[i].opacity;
+    }
+
+    colorSpace->applyAlphaU8Mask(scratchPixels.data(), scratchAlpha.constData(), numParticles);
+
+    const quint8 *srcColor = scratchPixels.constData();
+
+    for (int i = 0; i < numParticles; i++) {
+        compositeOp->composite(accessor.pixel(begin[i].x, begin[i].y), pixelSize,
+                               srcColor, pixelSize,
+                               0, 0, 1, 1, OPACITY_OPAQUE_U8);
+        srcColor += pixelSize;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_PARTICLE_SPLATTER_H
+#define __KIS_PARTICLE_SPLATTER_H
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritapaintop_export.h"
+
+class KoColor;
+
+/**
+ * Writes a big number of single-pixel particles (e.g. the anti-aliased
+ * "wu-particles" of the hairy and spray brushes) into a paint device.
+ *
+ * Writing the particles one by one means a moveTo() of a random accessor
+ * and a couple of virtual calls of the color space per pixel. Instead,
+ * the splatter just records the particles with their 8-bit opacity. On
+ * flush() the records are (stably) sorted by 64x64 cells, each cell is
+ * accessed with a single moveTo() and its pixels are generated in a
+ * contiguous scratch buffer with a single call to the color space.
+ *
+ * The order of the writes into every pixel is preserved, so the result
+ * is exactly the same as if the particles were written one by one.
+ */
+class PAINTOP_EXPORT KisParticleSplatter
+{
+public:
+    enum Mode {
+        /**
+         * The pixel gets the color of the particle, its opacity is
+         * replaced with the opacity of the particle
+         */
+        OverwriteMode,
+
+        /**
+         * The pixel gets the color of the particle, the opacity of the
+         * particle is added to the opacity of the pixel
+         */
+        AddOpacityMode,
+
+        /**
+         * The particle is composited over the pixel with COMPOSITE_OVER
+         */
+        CompositeMode
+    };
+
+public:
+    KisParticleSplatter(Mode mode = OverwriteMode);
+    ~KisParticleSplatter();
+
+    /**
+     * Sets the device the particles are written into. The particles
+     * that were not flushed yet are dropped.
+     */
+    void setDevice(KisPaintDeviceSP device);
+
+    /**
+     * Sets the color of the particles added after the call. Only the
+     * color channels of \p color are used, the opacity of each particle
+     * is passed to addPixel(). \p color should be in the color space of
+     * the device.
+     */
+    void setColor(const KoColor &color);
+
+    /**
+     * Adds a pixel of a particle with the current color
+     */
+    void addPixel(int x, int y, quint8 opacity);
+
+    /**
+     * Writes all the added pixels into the device
+     */
+    void flush();
+
+    bool isEmpty() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_PARTICLE_SPLATTER_H */
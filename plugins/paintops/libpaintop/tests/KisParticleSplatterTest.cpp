@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisParticleSplatterTest.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+#include "KisParticleSplatter.h"
+
+namespace {
+
+struct TestParticle
+{
+    int x;
+    int y;
+    quint8 opacity;
+    KoColor color;
+};
+
+/**
+ * Writes the particles one by one, the same way the paintops did
+ * before the splatter was introduced
+ */
+void writeParticlesDirectly(KisPaintDeviceSP dev, KisParticleSplatter::Mode mode, const QVector<TestParticle> &particles)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    const KoCompositeOp *op = cs->compositeOp(COMPOSITE_OVER);
+    KisRandomAccessorSP it = dev->createRandomAccessorNG(0, 0);
+
+    Q_FOREACH (const TestParticle &p, particles) {
+        KoColor color = p.color;
+        it->moveTo(p.x, p.y);
+
+        switch (mode) {
+        case KisParticleSplatter::OverwriteMode:
+            color.setOpacity(p.opacity);
+            memcpy(it->rawData(), color.data(), cs->pixelSize());
+            break;
+        case KisParticleSplatter::AddOpacityMode:
+            color.setOpacity(quint8(qMin<quint16>(OPACITY_OPAQUE_U8, p.opacity + cs->opacityU8(it->rawData()))));
+            memcpy(it->rawData(), color.data(), cs->pixelSize());
+            break;
+        case KisParticleSplatter::CompositeMode:
+            color.setOpacity(p.opacity);
+            op->composite(it->rawData(), cs->pixelSize(), color.data(), cs->pixelSize(), 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        }
+    }
+}
+
+void writeParticlesWithSplatter(KisPaintDeviceSP dev, KisParticleSplatter::Mode mode, const QVector<TestParticle> &particles)
+{
+    KisParticleSplatter splatter(mode);
+    splatter.setDevice(dev);
+
+    Q_FOREACH (const TestParticle &p, particles) {
+        splatter.setColor(p.color);
+        splatter.addPixel(p.x, p.y, p.opacity);
+    }
+
+    splatter.flush();
+    QVERIFY(splatter.isEmpty());
+}
+
+}
+
+void KisParticleSplatterTest::testSplatter_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QPoint>("deviceOffset");
+
+    QTest::newRow("overwrite") << int(KisParticleSplatter::OverwriteMode) << Integer8BitsColorDepthID.id() << QPoint();
+    QTest::newRow("add-opacity") << int(KisParticleSplatter::AddOpacityMode) << Integer8BitsColorDepthID.id() << QPoint();
+    QTest::newRow("composite") << int(KisParticleSplatter::CompositeMode) << Integer8BitsColorDepthID.id() << QPoint();
+
+    QTest::newRow("overwrite-16") << int(KisParticleSplatter::OverwriteMode) << Integer16BitsColorDepthID.id() << QPoint();
+    QTest::newRow("add-opacity-16") << int(KisParticleSplatter::AddOpacityMode) << Integer16BitsColorDepthID.id() << QPoint();
+    QTest::newRow("composite-16") << int(KisParticleSplatter::CompositeMode) << Integer16BitsColorDepthID.id() << QPoint();
+
+    QTest::newRow("add-opacity-offset") << int(KisParticleSplatter::AddOpacityMode) << Integer8BitsColorDepthID.id() << QPoint(13, -27);
+}
+
+void KisParticleSplatterTest::testSplatter()
+{
+    QFETCH(int, mode);
+    QFETCH(QString, colorDepthId);
+    QFETCH(QPoint, deviceOffset);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, "");
+
+    QVector<KoColor> colors;
+    colors << KoColor(Qt::red, cs) << KoColor(Qt::green, cs) << KoColor(Qt::blue, cs);
+    colors[1].setOpacity(quint8(128));
+
+    /**
+     * The particles cover a few tiles on both sides of the origin and
+     * hit the same pixels many times
+     */
+    qsrand(1);
+
+    QVector<TestParticle> particles;
+    for (int i = 0; i < 20000; i++) {
+        TestParticle p;
+        p.x = qrand() % 200 - 100;
+        p.y = qrand() % 200 - 100;
+        p.opacity = qrand() % 256;
+        p.color = colors[i / 7 % colors.size()];
+        particles << p;
+    }
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    refDev->moveTo(deviceOffset);
+    dev->moveTo(deviceOffset);
+
+    writeParticlesDirectly(refDev, KisParticleSplatter::Mode(mode), particles);
+    writeParticlesWithSplatter(dev, KisParticleSplatter::Mode(mode), particles);
+
+    const QRect rc = refDev->exactBounds();
+    QCOMPARE(dev->exactBounds(), rc);
+    QCOMPARE(dev->extent(), refDev->extent());
+
+    QByteArray refBytes(rc.width() * rc.height() * cs->pixelSize(), 0);
+    QByteArray bytes(refBytes.size(), 0);
+
+    refDev->readBytes(reinterpret_cast<quint8*>(refBytes.data()), rc);
+    dev->readBytes(reinterpret_cast<quint8*>(bytes.data()), rc);
+
+    QVERIFY(bytes == refBytes);
+}
+
+QTEST_MAIN(KisParticleSplatterTest)
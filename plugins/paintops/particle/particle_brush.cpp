@@ -19,7 +19,6 @@
 #include "particle_brush.h"
 
 #include "kis_paint_device.h"
-#include "kis_random_accessor_ng.h"
 
 #include <KoColorSpace.h>
 #include <KoColor.h>
@@ -29,6 +28,7 @@
 const qreal TIME = 0.000030;
 
 ParticleBrush::ParticleBrush()
+    : m_particleSplatter(KisParticleSplatter::AddOpacityMode)
 {
     m_properties = 0;
 }
@@ -55,11 +55,10 @@ void ParticleBrush::setInitialPosition(const QPointF &pos)
 }
 
 
-void ParticleBrush::paintParticle(KisRandomAccessorSP accWrite, const KoColorSpace * cs, const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity)
+void ParticleBrush::paintParticle(const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity)
 {
     // opacity top left, right, bottom left, right
-    KoColor myColor(color);
-    quint8 opacity = respectOpacity ? myColor.opacityU8() : OPACITY_OPAQUE_U8;
+    quint8 opacity = respectOpacity ? color.opacityU8() : OPACITY_OPAQUE_U8;
 
     int ipx = floor(pos.x());
     int ipy = floor(pos.y());
@@ -71,21 +70,10 @@ void ParticleBrush::paintParticle(KisRandomAccessorSP accWrite, const KoColorSpa
     quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity * weight);
     quint8 bbr = qRound((fx)  * (fy)  * opacity * weight);
 
-    accWrite->moveTo(ipx  , ipy);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx + 1, ipy);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx, ipy + 1);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
-
-    accWrite->moveTo(ipx + 1, ipy + 1);
-    myColor.setOpacity(quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(accWrite->rawData()), OPACITY_OPAQUE_U8)));
-    memcpy(accWrite->rawData(), myColor.data(), cs->pixelSize());
+    m_particleSplatter.addPixel(ipx    , ipy, btl);
+    m_particleSplatter.addPixel(ipx + 1, ipy, btr);
+    m_particleSplatter.addPixel(ipx    , ipy + 1, bbl);
+    m_particleSplatter.addPixel(ipx + 1, ipy + 1, bbr);
 }
 
 
@@ -93,8 +81,8 @@ void ParticleBrush::paintParticle(KisRandomAccessorSP accWrite, const KoColorSpa
 
 void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPointF &pos)
 {
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG(qRound(pos.x()), qRound(pos.y()));
-    const KoColorSpace * cs = dab->colorSpace();
+    m_particleSplatter.setDevice(dab);
+    m_particleSplatter.setColor(color);
 
     QRect boundingRect;
 
@@ -141,11 +129,13 @@ void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPoin
             if (boundingRect.isEmpty() ||
                     boundingRect.contains(m_particlePos[j].toPoint())) {
 
-                paintParticle(accessor, cs, m_particlePos[j], color, m_properties->weight, true);
+                paintParticle(m_particlePos[j], color, m_properties->weight, true);
             }
 
         }//for j
     }//for i
+
+    m_particleSplatter.flush();
 }
 
 
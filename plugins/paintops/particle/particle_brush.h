@@ -24,6 +24,8 @@
 #include "kis_debug.h"
 #include <QPointF>
 
+#include "KisParticleSplatter.h"
+
 
 class KisParticleBrushProperties
 {
@@ -35,8 +37,6 @@ public:
     QPointF scale;
 };
 
-class KisRandomAccessor;
-class KoColorSpace;
 class KoColor;
 
 class ParticleBrush
@@ -57,13 +57,14 @@ public:
 private:
     /// paints wu particle, similar to spray version but you can turn on respecting opacity of the tool and add weight to opacity
     /// also the particle respects opacity in the destination pixel buffer
-    void paintParticle(KisRandomAccessorSP writeAccessor, const KoColorSpace *cs,const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity);
+    void paintParticle(const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity);
 
     QVector<QPointF> m_particlePos;
     QVector<QPointF> m_particleNextPos;
     QVector<qreal> m_accelaration;
 
     KisParticleBrushProperties * m_properties;
+    KisParticleSplatter m_particleSplatter;
 };
 
 #endif
@@ -20,6 +20,7 @@
 #include "kis_sketch_paintop.h"
 #include "kis_sketch_paintop_settings.h"
 
+#include <algorithm>
 #include <cmath>
 #include <QRect>
 
@@ -41,10 +42,33 @@
 #include <kis_pressure_opacity_option.h>
 #include <kis_dab_cache.h>
 #include "kis_lod_transform.h"
+#include "kis_algebra_2d.h"
 
 
 #include <QtGlobal>
 
+namespace {
+
+/**
+ * The size of the cells of the grid of the stroke points. The grid works
+ * well for any brush size: small brushes visit a few cells, big ones
+ * visit more cells, but each of them is still likely to contain points
+ * close enough to be connected.
+ */
+const int pointsGridCellSize = 64;
+
+inline quint64 pointsGridKey(int col, int row)
+{
+    return (quint64(quint32(col)) << 32) | quint32(row);
+}
+
+inline int pointsGridCell(qreal coord)
+{
+    return KisAlgebra2D::divideFloor(qFloor(coord), pointsGridCellSize);
+}
+
+}
+
 /*
 * Based on Harmony project http://github.com/mrdoob/harmony/
 */
@@ -123,6 +147,38 @@ void KisSketchPaintOp::updateBrushMask(const KisPaintInformation& info, qreal sc
                         0.5 * m_brushBoundingBox.height());
 }
 
+void KisSketchPaintOp::addPoint(const QPointF &pt)
+{
+    m_pointsGrid[pointsGridKey(pointsGridCell(pt.x()), pointsGridCell(pt.y()))].append(m_points.size());
+    m_points.append(pt);
+}
+
+void KisSketchPaintOp::fetchCandidatePoints(const QRectF &rect)
+{
+    m_candidatePoints.clear();
+
+    const int firstCol = pointsGridCell(rect.left());
+    const int lastCol = pointsGridCell(rect.right());
+    const int firstRow = pointsGridCell(rect.top());
+    const int lastRow = pointsGridCell(rect.bottom());
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            auto it = m_pointsGrid.constFind(pointsGridKey(col, row));
+            if (it != m_pointsGrid.constEnd()) {
+                m_candidatePoints += *it;
+            }
+        }
+    }
+
+    /**
+     * The random source is used only for the connected points, so the
+     * points should be visited in the order of the stroke to get exactly
+     * the same result as with the full scan
+     */
+    std::sort(m_candidatePoints.begin(), m_candidatePoints.end());
+}
+
 void KisSketchPaintOp::paintLine(const KisPaintInformation &pi1, const KisPaintInformation &pi2,
                                  KisDistanceInformation *currentDistance)
 {
@@ -150,7 +206,7 @@ void KisSketchPaintOp::doPaintLine(const KisPaintInformation &pi1, const KisPain
 
     QPointF prevMouse = pi1.pos();
     QPointF mousePosition = pi2.pos();
-    m_points.append(mousePosition);
+    addPoint(mousePosition);
 
 
     const qreal lodAdditionalScale = KisLodTransform::lodToScale(painter()->device());
@@ -207,9 +263,20 @@ void KisSketchPaintOp::doPaintLine(const KisPaintInformation &pi1, const KisPain
     QPoint  positionInMask;
     QPointF diff;
 
-    int size = m_points.size();
+    /**
+     * Only the points inside the circle or the brush mask can be
+     * connected, so fetch the ones from the cells around them
+     */
+    if (m_sketchProperties.simpleMode) {
+        const qreal radius = std::sqrt(thresholdDistance);
+        fetchCandidatePoints(QRectF(mousePosition - QPointF(radius, radius),
+                                    mousePosition + QPointF(radius, radius)));
+    } else {
+        fetchCandidatePoints(m_brushBoundingBox);
+    }
+
     // MAIN LOOP
-    for (int i = 0; i < size; i++) {
+    Q_FOREACH (const int i, m_candidatePoints) {
         diff = m_points.at(i) - mousePosition;
         distance = diff.x() * diff.x() + diff.y() * diff.y();
 
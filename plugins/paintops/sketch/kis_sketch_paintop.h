@@ -19,6 +19,9 @@
 #ifndef KIS_SKETCH_PAINTOP_H_
 #define KIS_SKETCH_PAINTOP_H_
 
+#include <QHash>
+#include <QVector>
+
 #include <brushengine/kis_paintop.h>
 #include <kis_types.h>
 
@@ -80,6 +83,15 @@ private:
     SketchProperties m_sketchProperties;
 
     QVector<QPointF> m_points;
+
+    /**
+     * The indices of m_points, bucketed into square cells of the image,
+     * so that a dab visits only the points around it instead of the
+     * whole history of the stroke
+     */
+    QHash<quint64, QVector<int>> m_pointsGrid;
+    QVector<int> m_candidatePoints;
+
     int m_count;
     KisPainter * m_painter;
     KisBrushSP m_brush;
@@ -89,6 +101,9 @@ private:
     void drawConnection(const QPointF &start, const QPointF &end, double lineWidth);
     void updateBrushMask(const KisPaintInformation& info, qreal scale, qreal rotation);
     void doPaintLine(const KisPaintInformation &pi1, const KisPaintInformation &pi2);
+
+    void addPoint(const QPointF &pt);
+    void fetchCandidatePoints(const QRectF &rect);
 };
 
 #endif // KIS_SKETCH_PAINTOP_H_
@@ -23,6 +23,7 @@
 #include <KoColorTransformation.h>
 #include <KoCompositeOp.h>
 #include <KoMixColorsOp.h>
+#include <KoColorSpaceMaths.h>
 
 #include <brushengine/kis_paintop.h>
 
@@ -134,6 +135,7 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
     qreal x = info.pos().x();
     qreal y = info.pos().y();
     KisRandomAccessorSP accessor = dab->createRandomAccessorNG(qRound(x), qRound(y));
+    m_particleSplatter.setDevice(dab);
 
     Q_ASSERT(color.colorSpace()->pixelSize() == dab->pixelSize());
     m_inkColor = color;
@@ -291,7 +293,7 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             }
             // wu-particle
             case 2: {
-                paintParticle(accessor, m_inkColor, nx + x, ny + y);
+                paintParticle(m_inkColor, nx + x, ny + y);
                 break;
             }
             // pixel
@@ -374,18 +376,19 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             m_inkColor=color;//reset color//
         }
     }
+
+    // write the wu-particles into the dab
+    m_particleSplatter.flush();
+
     // recover from jittering of color,
     // m_inkColor.opacity is recovered with every paint
 }
 
 
 
-void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry)
+void SprayBrush::paintParticle(const KoColor &color, qreal rx, qreal ry)
 {
     // opacity top left, right, bottom left, right
-    KoColor pcolor(color);
-    //int opacity = pcolor.opacityU8();
-
     int ipx = int (rx);
     int ipy = int (ry);
     qreal fx = rx - ipx;
@@ -400,21 +403,11 @@ void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor
     // to each other, the pixel with lower opacity can override other pixel.
     // Maybe some kind of compositing using here would be cool
 
-    pcolor.setOpacity(btl);
-    writeAccessor->moveTo(ipx  , ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(btr);
-    writeAccessor->moveTo(ipx + 1, ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbl);
-    writeAccessor->moveTo(ipx, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbr);
-    writeAccessor->moveTo(ipx + 1, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    m_particleSplatter.setColor(color);
+    m_particleSplatter.addPixel(ipx    , ipy, KoColorSpaceMaths<qreal, quint8>::scaleToA(btl));
+    m_particleSplatter.addPixel(ipx + 1, ipy, KoColorSpaceMaths<qreal, quint8>::scaleToA(btr));
+    m_particleSplatter.addPixel(ipx    , ipy + 1, KoColorSpaceMaths<qreal, quint8>::scaleToA(bbl));
+    m_particleSplatter.addPixel(ipx + 1, ipy + 1, KoColorSpaceMaths<qreal, quint8>::scaleToA(bbr));
 }
 
 void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius)
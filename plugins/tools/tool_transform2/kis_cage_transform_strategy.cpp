@@ -81,21 +81,24 @@ void KisCageTransformStrategy::drawConnectionLines(QPainter &gc,
     }
 }
 
-QImage KisCageTransformStrategy::calculateTransformedImage(ToolTransformArgs &currentArgs,
-                                                           const QImage &srcImage,
-                                                           const QVector<QPointF> &origPoints,
-                                                           const QVector<QPointF> &transfPoints,
-                                                           const QPointF &srcOffset,
-                                                           QPointF *dstOffset)
+KisTransformPreviewRenderer::TransformFunction
+KisCageTransformStrategy::createTransformFunction(const ToolTransformArgs &currentArgs,
+                                                  const QVector<QPointF> &origPoints,
+                                                  const QVector<QPointF> &transfPoints,
+                                                  const QPointF &srcOffset) const
 {
     Q_UNUSED(currentArgs);
 
-    KisCageTransformWorker worker(srcImage,
-                                  srcOffset,
-                                  origPoints,
-                                  0,
-                                  16);
-    worker.prepareTransform();
-    worker.setTransformedCage(transfPoints);
-    return worker.runOnQImage(dstOffset);
+    return [origPoints, transfPoints, srcOffset] (const QImage &srcImage, qreal scale, QPointF *dstOffset) {
+        const QTransform t = QTransform::fromScale(scale, scale);
+
+        KisCageTransformWorker worker(srcImage,
+                                      t.map(srcOffset),
+                                      t.map(QPolygonF(origPoints)),
+                                      0,
+                                      16);
+        worker.prepareTransform();
+        worker.setTransformedCage(t.map(QPolygonF(transfPoints)));
+        return worker.runOnQImage(dstOffset);
+    };
 }
@@ -47,12 +47,11 @@ protected:
                              const QVector<QPointF> &transfPoints,
                              bool isEditingPoints) override;
 
-    QImage calculateTransformedImage(ToolTransformArgs &currentArgs,
-                                     const QImage &srcImage,
-                                     const QVector<QPointF> &origPoints,
-                                     const QVector<QPointF> &transfPoints,
-                                     const QPointF &srcOffset,
-                                     QPointF *dstOffset) override;
+    KisTransformPreviewRenderer::TransformFunction
+    createTransformFunction(const ToolTransformArgs &currentArgs,
+                            const QVector<QPointF> &origPoints,
+                            const QVector<QPointF> &transfPoints,
+                            const QPointF &srcOffset) const override;
 
 private:
     struct Private;
@@ -22,6 +22,7 @@
 
 #include <QPointF>
 #include <QPainter>
+#include <QSharedPointer>
 
 #include "KoPointerEvent.h"
 
@@ -34,6 +35,7 @@
 #include "kis_algebra_2d.h"
 #include "kis_liquify_paint_helper.h"
 #include "kis_liquify_transform_worker.h"
+#include "kis_transform_preview_renderer.h"
 #include "KoCanvasResourceProvider.h"
 
 
@@ -67,14 +69,11 @@ struct KisLiquifyTransformStrategy::Private
     //////
     TransformTransactionProperties &transaction;
 
-    QTransform paintingTransform;
-    QPointF paintingOffset;
-
     QTransform handlesTransform;
 
     /// custom members ///
 
-    QImage transformedImage;
+    KisTransformPreviewRenderer previewRenderer;
 
     // size-gesture-related
     QPointF lastMouseWidgetPos;
@@ -96,6 +95,7 @@ KisLiquifyTransformStrategy::KisLiquifyTransformStrategy(const KisCoordinatesCon
 
     : m_d(new Private(this, converter, currentArgs, transaction, manager))
 {
+    connect(&m_d->previewRenderer, SIGNAL(sigPreviewUpdated()), SIGNAL(requestCanvasUpdate()));
 }
 
 KisLiquifyTransformStrategy::~KisLiquifyTransformStrategy()
@@ -130,8 +130,7 @@ void KisLiquifyTransformStrategy::paint(QPainter &gc)
     gc.save();
 
     gc.setOpacity(m_d->transaction.basePreviewOpacity());
-    gc.setTransform(m_d->paintingTransform, true);
-    gc.drawImage(m_d->paintingOffset, m_d->transformedImage);
+    m_d->previewRenderer.paint(gc);
 
     gc.restore();
 }
@@ -275,16 +274,7 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
     bool useFlakeOptimization = scale < 1.0 &&
         !KisTransformUtils::thumbnailTooSmall(resultThumbTransform, q->originalImage().rect());
 
-    paintingOffset = transaction.originalTopLeft();
     if (!q->originalImage().isNull()) {
-        if (useFlakeOptimization) {
-            transformedImage = q->originalImage().transformed(resultThumbTransform);
-            paintingTransform = QTransform();
-        } else {
-            transformedImage = q->originalImage();
-            paintingTransform = resultThumbTransform;
-        }
-
         QTransform imageToRealThumbTransform =
             useFlakeOptimization ?
             scaleTransform :
@@ -293,15 +283,28 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
         QPointF origTLInFlake =
             imageToRealThumbTransform.map(transaction.originalTopLeft());
 
-        transformedImage =
-            currentArgs.liquifyWorker()->runOnQImage(transformedImage,
-                                                     origTLInFlake,
-                                                     imageToRealThumbTransform,
-                                                     &paintingOffset);
+        /**
+         * The worker is modified by the liquify strokes in the GUI
+         * thread, so the preview is rendered with a copy of it
+         */
+        QSharedPointer<KisLiquifyTransformWorker> worker(
+            new KisLiquifyTransformWorker(*currentArgs.liquifyWorker()));
+
+        previewRenderer.requestPreview(q->originalImage(),
+                                       useFlakeOptimization ? resultThumbTransform : QTransform(),
+                                       useFlakeOptimization ? QTransform() : resultThumbTransform,
+            [worker, origTLInFlake, imageToRealThumbTransform] (const QImage &srcImage, qreal scale, QPointF *dstOffset) {
+                const QTransform t = QTransform::fromScale(scale, scale);
+
+                return worker->runOnQImage(srcImage,
+                                           t.map(origTLInFlake),
+                                           imageToRealThumbTransform * t,
+                                           dstOffset);
+            });
     } else {
-        transformedImage = q->originalImage();
-        paintingOffset = imageToThumb(transaction.originalTopLeft(), false);
-        paintingTransform = resultThumbTransform;
+        previewRenderer.setPreview(q->originalImage(),
+                                   imageToThumb(transaction.originalTopLeft(), false),
+                                   resultThumbTransform);
     }
 
     handlesTransform = scaleTransform;
@@ -0,0 +1,262 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_transform_preview_renderer.h"
+
+#include <cmath>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+namespace {
+
+/**
+ * The size of the downscaled preview. It is small enough to be
+ * rendered while the user moves the handle.
+ */
+const qreal coarsePreviewPixels = 256 * 256;
+
+/**
+ * One thread may still be busy with an outdated full-resolution
+ * preview, which cannot be interrupted, while the other one renders
+ * the new request
+ */
+const int maxRenderingThreads = 2;
+
+/**
+ * The pool is shared by all the renderers. It is not owned by any of
+ * them, so deleting a renderer doesn't wait for its outdated jobs.
+ */
+class PreviewRenderingThreadPool : public QThreadPool
+{
+public:
+    PreviewRenderingThreadPool() {
+        setMaxThreadCount(maxRenderingThreads);
+    }
+};
+
+Q_GLOBAL_STATIC(PreviewRenderingThreadPool, s_threadPool)
+
+struct Preview
+{
+    QImage image;
+    QPointF offset;
+    QTransform transform;
+};
+
+class PreviewRenderingRunnable : public QRunnable
+{
+public:
+    PreviewRenderingRunnable(std::function<void()> func)
+        : m_func(func)
+    {
+    }
+
+    void run() override {
+        m_func();
+    }
+
+private:
+    std::function<void()> m_func;
+};
+
+}
+
+/**
+ * The state shared by the renderer and its jobs. The jobs keep it alive,
+ * so it may outlive the renderer.
+ */
+struct KisTransformPreviewRenderer::SharedState
+{
+    SharedState(KisTransformPreviewRenderer *_q) : q(_q) {}
+
+    /**
+     * The renderer to notify about the new previews. Is reset by the
+     * renderer's destructor under previewLock.
+     */
+    KisTransformPreviewRenderer *q;
+
+    /**
+     * The id of the latest request. The results of all the other
+     * requests are outdated.
+     */
+    QAtomicInt currentRequest;
+
+    QMutex previewLock;
+    Preview preview;
+
+    void renderPreview(int requestId,
+                       const QImage &srcImage,
+                       const QTransform &srcTransform,
+                       const QTransform &paintingTransform,
+                       TransformFunction func);
+
+    bool isOutdated(int requestId) const;
+    bool tryPublishPreview(int requestId, const Preview &newPreview);
+    void dropPendingRequests();
+    void detach();
+};
+
+struct KisTransformPreviewRenderer::Private
+{
+    QSharedPointer<SharedState> state;
+};
+
+KisTransformPreviewRenderer::KisTransformPreviewRenderer(QObject *parent)
+    : QObject(parent),
+      m_d(new Private)
+{
+    m_d->state.reset(new SharedState(this));
+}
+
+KisTransformPreviewRenderer::~KisTransformPreviewRenderer()
+{
+    /**
+     * The jobs that are already running cannot be interrupted, so they
+     * are left to finish on their own. Their results are outdated, so
+     * nothing will be delivered to us anymore.
+     */
+    m_d->state->detach();
+}
+
+void KisTransformPreviewRenderer::requestPreview(const QImage &srcImage,
+                                                 const QTransform &srcTransform,
+                                                 const QTransform &paintingTransform,
+                                                 TransformFunction func)
+{
+    m_d->state->dropPendingRequests();
+    const int requestId = m_d->state->currentRequest.loadAcquire();
+
+    QSharedPointer<SharedState> state = m_d->state;
+
+    s_threadPool->start(
+        new PreviewRenderingRunnable(
+            [state, requestId, srcImage, srcTransform, paintingTransform, func] () {
+                state->renderPreview(requestId, srcImage, srcTransform, paintingTransform, func);
+            }));
+}
+
+void KisTransformPreviewRenderer::setPreview(const QImage &image,
+                                             const QPointF &offset,
+                                             const QTransform &paintingTransform)
+{
+    m_d->state->dropPendingRequests();
+
+    QMutexLocker l(&m_d->state->previewLock);
+    m_d->state->preview.image = image;
+    m_d->state->preview.offset = offset;
+    m_d->state->preview.transform = paintingTransform;
+}
+
+void KisTransformPreviewRenderer::paint(QPainter &gc) const
+{
+    Preview preview;
+
+    {
+        QMutexLocker l(&m_d->state->previewLock);
+        preview = m_d->state->preview;
+    }
+
+    gc.setTransform(preview.transform, true);
+    gc.drawImage(preview.offset, preview.image);
+}
+
+void KisTransformPreviewRenderer::slotPreviewReady()
+{
+    emit sigPreviewUpdated();
+}
+
+void KisTransformPreviewRenderer::SharedState::renderPreview(int requestId,
+                                                             const QImage &srcImage,
+                                                             const QTransform &srcTransform,
+                                                             const QTransform &paintingTransform,
+                                                             TransformFunction func)
+{
+    if (isOutdated(requestId)) return;
+
+    const QSize fullSize = srcTransform.mapRect(QRectF(srcImage.rect())).toAlignedRect().size();
+    const qreal numPixels = qreal(fullSize.width()) * fullSize.height();
+
+    if (numPixels > coarsePreviewPixels) {
+        const qreal scale = std::sqrt(coarsePreviewPixels / numPixels);
+
+        const QImage coarseImage =
+            srcImage.transformed(srcTransform * QTransform::fromScale(scale, scale))
+                .convertToFormat(srcImage.format());
+
+        Preview coarsePreview;
+        coarsePreview.image = func(coarseImage, scale, &coarsePreview.offset);
+        coarsePreview.transform = QTransform::fromScale(1.0 / scale, 1.0 / scale) * paintingTransform;
+
+        if (!tryPublishPreview(requestId, coarsePreview)) return;
+    }
+
+    const QImage fullImage =
+        srcTransform.isIdentity() ? srcImage :
+        srcImage.transformed(srcTransform).convertToFormat(srcImage.format());
+
+    if (isOutdated(requestId)) return;
+
+    Preview fullPreview;
+    fullPreview.image = func(fullImage, 1.0, &fullPreview.offset);
+    fullPreview.transform = paintingTransform;
+
+    tryPublishPreview(requestId, fullPreview);
+}
+
+bool KisTransformPreviewRenderer::SharedState::isOutdated(int requestId) const
+{
+    return requestId != currentRequest.loadAcquire();
+}
+
+bool KisTransformPreviewRenderer::SharedState::tryPublishPreview(int requestId, const Preview &newPreview)
+{
+    QMutexLocker l(&previewLock);
+    if (isOutdated(requestId)) return false;
+
+    preview = newPreview;
+
+    /**
+     * The event is posted under the lock, so the renderer cannot be
+     * deleted in the meantime. Qt drops the posted events of the
+     * deleted objects itself.
+     */
+    QMetaObject::invokeMethod(q, "slotPreviewReady", Qt::QueuedConnection);
+    return true;
+}
+
+void KisTransformPreviewRenderer::SharedState::dropPendingRequests()
+{
+    /**
+     * The pool is shared, so the pending jobs are not removed from it.
+     * They see that they are outdated and return right away.
+     */
+    currentRequest.ref();
+}
+
+void KisTransformPreviewRenderer::SharedState::detach()
+{
+    QMutexLocker l(&previewLock);
+    currentRequest.ref();
+    q = 0;
+}
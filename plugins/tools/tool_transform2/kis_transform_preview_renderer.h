@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TRANSFORM_PREVIEW_RENDERER_H
+#define __KIS_TRANSFORM_PREVIEW_RENDERER_H
+
+#include <functional>
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QImage>
+#include <QPointF>
+#include <QTransform>
+
+class QPainter;
+
+/**
+ * Renders the preview of warp, cage and liquify transformations
+ * outside the GUI thread.
+ *
+ * Every request is rendered twice: first from a downscaled copy of the
+ * source image, then at the full resolution. A new request drops all
+ * the pending ones, and the results of the outdated requests are never
+ * shown, so the time to the first preview after a handle move doesn't
+ * depend on the size of the layer.
+ *
+ * The jobs run in a thread pool shared by all the renderers. Deleting
+ * the renderer doesn't wait for its outdated jobs, they finish in
+ * the background and their results are dropped.
+ *
+ * All the methods should be called from the GUI thread.
+ */
+class KisTransformPreviewRenderer : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * A function transforming \p srcImage into the preview. The geometry
+     * of the transformation should be scaled by \p scale, the same way
+     * the source image is. The top-left corner of the result should be
+     * returned in \p dstOffset.
+     *
+     * The function is called from a worker thread, so it must not access
+     * any data that can be changed by the GUI thread.
+     */
+    typedef std::function<QImage(const QImage &srcImage, qreal scale, QPointF *dstOffset)> TransformFunction;
+
+public:
+    KisTransformPreviewRenderer(QObject *parent = 0);
+    ~KisTransformPreviewRenderer() override;
+
+    /**
+     * Starts rendering the preview of \p srcImage. The image is first
+     * transformed with \p srcTransform and then passed to \p func. The
+     * result is painted with \p paintingTransform.
+     */
+    void requestPreview(const QImage &srcImage,
+                        const QTransform &srcTransform,
+                        const QTransform &paintingTransform,
+                        TransformFunction func);
+
+    /**
+     * Shows \p image without any transformation and cancels all the
+     * pending requests
+     */
+    void setPreview(const QImage &image,
+                    const QPointF &offset,
+                    const QTransform &paintingTransform);
+
+    /**
+     * Paints the latest rendered preview
+     */
+    void paint(QPainter &gc) const;
+
+Q_SIGNALS:
+    void sigPreviewUpdated();
+
+private Q_SLOTS:
+    void slotPreviewReady();
+
+private:
+    struct SharedState;
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_TRANSFORM_PREVIEW_RENDERER_H */
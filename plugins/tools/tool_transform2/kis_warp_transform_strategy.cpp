@@ -31,6 +31,7 @@
 #include "kis_transform_utils.h"
 #include "kis_algebra_2d.h"
 #include "KisHandlePainterHelper.h"
+#include "kis_warptransform_worker.h"
 
 
 
@@ -65,14 +66,11 @@ struct KisWarpTransformStrategy::Private
     //////
     TransformTransactionProperties &transaction;
 
-    QTransform paintingTransform;
-    QPointF paintingOffset;
-
     QTransform handlesTransform;
 
     /// custom members ///
 
-    QImage transformedImage;
+    KisTransformPreviewRenderer previewRenderer;
 
     int pointIndexUnderCursor;
 
@@ -115,6 +113,7 @@ KisWarpTransformStrategy::KisWarpTransformStrategy(const KisCoordinatesConverter
     : KisSimplifiedActionPolicyStrategy(converter),
       m_d(new Private(this, converter, currentArgs, transaction))
 {
+    connect(&m_d->previewRenderer, SIGNAL(sigPreviewUpdated()), SIGNAL(requestCanvasUpdate()));
 }
 
 KisWarpTransformStrategy::~KisWarpTransformStrategy()
@@ -237,8 +236,7 @@ void KisWarpTransformStrategy::paint(QPainter &gc)
     gc.save();
 
     gc.setOpacity(m_d->transaction.basePreviewOpacity());
-    gc.setTransform(m_d->paintingTransform, true);
-    gc.drawImage(m_d->paintingOffset, m_d->transformedImage);
+    m_d->previewRenderer.paint(gc);
 
     gc.restore();
 
@@ -595,46 +593,46 @@ void KisWarpTransformStrategy::Private::recalculateTransformations()
         thumbTransfPoints[i] = imageToThumb(currentArgs.transfPoints()[i], useFlakeOptimization);
     }
 
-    paintingOffset = transaction.originalTopLeft();
-
     if (!q->originalImage().isNull() && !currentArgs.isEditingTransformPoints()) {
         QPointF origTLInFlake = imageToThumb(transaction.originalTopLeft(), useFlakeOptimization);
 
-        if (useFlakeOptimization) {
-            transformedImage = q->originalImage().transformed(resultThumbTransform);
-            paintingTransform = QTransform();
-        } else {
-            transformedImage = q->originalImage();
-            paintingTransform = resultThumbTransform;
-
-        }
-
-        transformedImage = q->calculateTransformedImage(currentArgs,
-                                                        transformedImage,
-                                                        thumbOrigPoints,
-                                                        thumbTransfPoints,
-                                                        origTLInFlake,
-                                                        &paintingOffset);
+        /**
+         * The thumbnail is transformed in a worker thread, the previous
+         * preview is shown until the new one is ready
+         */
+        previewRenderer.requestPreview(q->originalImage(),
+                                       useFlakeOptimization ? resultThumbTransform : QTransform(),
+                                       useFlakeOptimization ? QTransform() : resultThumbTransform,
+                                       q->createTransformFunction(currentArgs,
+                                                                  thumbOrigPoints,
+                                                                  thumbTransfPoints,
+                                                                  origTLInFlake));
     } else {
-        transformedImage = q->originalImage();
-        paintingOffset = imageToThumb(transaction.originalTopLeft(), false);
-        paintingTransform = resultThumbTransform;
+        previewRenderer.setPreview(q->originalImage(),
+                                   imageToThumb(transaction.originalTopLeft(), false),
+                                   resultThumbTransform);
     }
 
     handlesTransform = scaleTransform;
 }
 
-QImage KisWarpTransformStrategy::calculateTransformedImage(ToolTransformArgs &currentArgs,
-                                                           const QImage &srcImage,
-                                                           const QVector<QPointF> &origPoints,
-                                                           const QVector<QPointF> &transfPoints,
-                                                           const QPointF &srcOffset,
-                                                           QPointF *dstOffset)
+KisTransformPreviewRenderer::TransformFunction
+KisWarpTransformStrategy::createTransformFunction(const ToolTransformArgs &currentArgs,
+                                                  const QVector<QPointF> &origPoints,
+                                                  const QVector<QPointF> &transfPoints,
+                                                  const QPointF &srcOffset) const
 {
-    return KisWarpTransformWorker::transformQImage(
-        currentArgs.warpType(),
-        origPoints, transfPoints,
-        currentArgs.alpha(),
-        srcImage,
-        srcOffset, dstOffset);
+    const KisWarpTransformWorker::WarpType warpType = currentArgs.warpType();
+    const qreal alpha = currentArgs.alpha();
+
+    return [warpType, alpha, origPoints, transfPoints, srcOffset] (const QImage &srcImage, qreal scale, QPointF *dstOffset) {
+        const QTransform t = QTransform::fromScale(scale, scale);
+
+        return KisWarpTransformWorker::transformQImage(
+            warpType,
+            t.map(QPolygonF(origPoints)), t.map(QPolygonF(transfPoints)),
+            alpha,
+            srcImage,
+            t.map(srcOffset), dstOffset);
+    };
 }
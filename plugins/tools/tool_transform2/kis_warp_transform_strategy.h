@@ -23,6 +23,7 @@
 #include <QScopedPointer>
 
 #include "kis_simplified_action_policy_strategy.h"
+#include "kis_transform_preview_renderer.h"
 
 class QPointF;
 class QPainter;
@@ -83,12 +84,17 @@ protected:
                                      const QVector<QPointF> &transfPoints,
                                      bool isEditingPoints);
 
-    virtual QImage calculateTransformedImage(ToolTransformArgs &currentArgs,
-                                             const QImage &srcImage,
-                                             const QVector<QPointF> &origPoints,
-                                             const QVector<QPointF> &transfPoints,
-                                             const QPointF &srcOffset,
-                                             QPointF *dstOffset);
+    /**
+     * \return the function rendering the preview of the transformation
+     * of the thumbnail. It is called in a worker thread, so it should
+     * keep copies of all the data it needs.
+     */
+    virtual KisTransformPreviewRenderer::TransformFunction
+    createTransformFunction(const ToolTransformArgs &currentArgs,
+                            const QVector<QPointF> &origPoints,
+                            const QVector<QPointF> &transfPoints,
+                            const QPointF &srcOffset) const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
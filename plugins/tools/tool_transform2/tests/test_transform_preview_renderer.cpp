@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "test_transform_preview_renderer.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QSignalSpy>
+#include <QThread>
+
+#include "kis_transform_preview_renderer.h"
+
+
+namespace {
+
+bool waitForFlag(const QAtomicInt &flag, int timeout = 5000)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!flag.loadAcquire() && timer.elapsed() < timeout) {
+        QTest::qWait(1);
+    }
+
+    return flag.loadAcquire();
+}
+
+void waitForRelease(const QAtomicInt &flag)
+{
+    while (!flag.loadAcquire()) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+/**
+ * Fills the whole preview with \p color, so that the painted result
+ * shows which of the previews has been published
+ */
+QImage fillPreview(const QImage &srcImage, const QColor &color, QPointF *dstOffset)
+{
+    QImage result(srcImage.size(), QImage::Format_ARGB32);
+    result.fill(color);
+    *dstOffset = QPointF();
+    return result;
+}
+
+QColor paintedColor(const KisTransformPreviewRenderer &renderer, const QSize &size)
+{
+    QImage canvas(size, QImage::Format_ARGB32);
+    canvas.fill(Qt::transparent);
+
+    {
+        QPainter gc(&canvas);
+        renderer.paint(gc);
+    }
+
+    return canvas.pixelColor(size.width() / 2, size.height() / 2);
+}
+
+}
+
+void TestTransformPreviewRenderer::testCoarseThenFull()
+{
+    KisTransformPreviewRenderer renderer;
+    QSignalSpy spy(&renderer, SIGNAL(sigPreviewUpdated()));
+
+    QImage srcImage(1024, 1024, QImage::Format_ARGB32);
+    srcImage.fill(Qt::white);
+
+    QMutex lock;
+    QVector<qreal> scales;
+
+    renderer.requestPreview(srcImage, QTransform(), QTransform(),
+        [&] (const QImage &image, qreal scale, QPointF *dstOffset) {
+            {
+                QMutexLocker l(&lock);
+                scales << scale;
+            }
+            return fillPreview(image, scale < 1.0 ? Qt::red : Qt::green, dstOffset);
+        });
+
+    QVERIFY(spy.wait(5000));
+    if (spy.size() < 2) {
+        QVERIFY(spy.wait(5000));
+    }
+
+    QCOMPARE(spy.size(), 2);
+
+    {
+        QMutexLocker l(&lock);
+        QCOMPARE(scales.size(), 2);
+        QVERIFY(qFuzzyCompare(scales[0], 0.25));
+        QCOMPARE(scales[1], 1.0);
+    }
+
+    // the full-resolution preview replaces the coarse one
+    QCOMPARE(paintedColor(renderer, srcImage.size()), QColor(Qt::green));
+}
+
+void TestTransformPreviewRenderer::testOutdatedRequest()
+{
+    KisTransformPreviewRenderer renderer;
+    QSignalSpy spy(&renderer, SIGNAL(sigPreviewUpdated()));
+
+    // small enough to skip the coarse pass
+    QImage srcImage(64, 64, QImage::Format_ARGB32);
+    srcImage.fill(Qt::white);
+
+    QAtomicInt slowStarted;
+    QAtomicInt releaseSlow;
+    QAtomicInt slowFinished;
+
+    renderer.requestPreview(srcImage, QTransform(), QTransform(),
+        [&] (const QImage &image, qreal scale, QPointF *dstOffset) {
+            Q_UNUSED(scale);
+            slowStarted.storeRelease(1);
+            waitForRelease(releaseSlow);
+
+            QImage result = fillPreview(image, Qt::red, dstOffset);
+            slowFinished.storeRelease(1);
+            return result;
+        });
+
+    QVERIFY(waitForFlag(slowStarted));
+
+    renderer.requestPreview(srcImage, QTransform(), QTransform(),
+        [&] (const QImage &image, qreal scale, QPointF *dstOffset) {
+            Q_UNUSED(scale);
+            return fillPreview(image, Qt::green, dstOffset);
+        });
+
+    // the new request is not blocked by the outdated one
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.size(), 1);
+
+    releaseSlow.storeRelease(1);
+    QVERIFY(waitForFlag(slowFinished));
+    QTest::qWait(100);
+
+    // the result of the outdated request is never published
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(paintedColor(renderer, srcImage.size()), QColor(Qt::green));
+}
+
+void TestTransformPreviewRenderer::testDeleteWhileRendering()
+{
+    QScopedPointer<KisTransformPreviewRenderer> renderer(new KisTransformPreviewRenderer());
+
+    QImage srcImage(64, 64, QImage::Format_ARGB32);
+    srcImage.fill(Qt::white);
+
+    QAtomicInt started;
+    QAtomicInt release;
+    QAtomicInt finished;
+
+    renderer->requestPreview(srcImage, QTransform(), QTransform(),
+        [&] (const QImage &image, qreal scale, QPointF *dstOffset) {
+            Q_UNUSED(scale);
+            started.storeRelease(1);
+            waitForRelease(release);
+
+            QImage result = fillPreview(image, Qt::red, dstOffset);
+            finished.storeRelease(1);
+            return result;
+        });
+
+    QVERIFY(waitForFlag(started));
+
+    // doesn't wait for the running job
+    renderer.reset();
+
+    release.storeRelease(1);
+    QVERIFY(waitForFlag(finished));
+
+    // the job must not deliver anything to the deleted renderer
+    QTest::qWait(100);
+}
+
+QTEST_MAIN(TestTransformPreviewRenderer)